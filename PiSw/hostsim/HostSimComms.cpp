@@ -0,0 +1,49 @@
+// Bus Raider Host Simulation
+// Host versions of the CommandHandler functions used by the bus modules (see CommandInterface/CommandHandler.cpp)
+// Rob Dobson 2019
+
+#include <string.h>
+#include "HostSimComms.h"
+#include "../src/CommandInterface/CommandHandler.h"
+#include "../src/System/ee_sprintf.h"
+
+static std::vector<uint8_t> __hostSimSentFrames;
+static uint32_t __hostSimSentFrameCount = 0;
+
+std::vector<uint8_t>& HostSimComms::getSentFrames()
+{
+    return __hostSimSentFrames;
+}
+
+uint32_t HostSimComms::getSentFrameCount()
+{
+    return __hostSimSentFrameCount;
+}
+
+int CommandHandler::commsSocketAdd([[maybe_unused]] CommsSocketInfo& commsSocketInfo)
+{
+    return 0;
+}
+
+// The simulated serial link is never busy
+uint32_t CommandHandler::getTxAvailable()
+{
+    return 100000;
+}
+
+// Same frame layout and length limit as the Pi - null terminated JSON then binary then a null terminator
+bool CommandHandler::sendWithJSON(const char* cmdName, const char* cmdJson, uint32_t msgIdx,
+            const uint8_t* pData, uint32_t dataLen)
+{
+    char header[1000];
+    ee_sprintf(header, "{\"cmdName\":\"%s\"%s%s,\"msgIdx\":%u,\"dataLen\":%u}",
+                cmdName, (strlen(cmdJson) > 0) ? "," : "", cmdJson, msgIdx, dataLen);
+    if (strlen(header) + 1 + dataLen + 1 >= (uint32_t)MAX_SEND_FRAME_LEN)
+        return false;
+    __hostSimSentFrames.insert(__hostSimSentFrames.end(), (const uint8_t*)header, (const uint8_t*)header + strlen(header) + 1);
+    if (pData)
+        __hostSimSentFrames.insert(__hostSimSentFrames.end(), pData, pData + dataLen);
+    __hostSimSentFrames.push_back(0);
+    __hostSimSentFrameCount++;
+    return true;
+}
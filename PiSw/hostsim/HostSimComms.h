@@ -0,0 +1,16 @@
+// Bus Raider Host Simulation
+// Frames sent to the ESP32 are collected rather than HDLC encoded
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+class HostSimComms
+{
+public:
+    // Frames one after another as they would be received after HDLC decoding
+    static std::vector<uint8_t>& getSentFrames();
+    static uint32_t getSentFrameCount();
+};
@@ -0,0 +1,1815 @@
+// Bus Raider Host Simulation
+// Runs BusAccess against a simulated Z80 bus and reports wait-state path throughput
+// Rob Dobson 2019
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "SimBoard.h"
+#include "SimZ80.h"
+#include "HostSimComms.h"
+#include "../src/TargetBus/BusAccess.h"
+#include "../src/TargetBus/BusCapture.h"
+#include "../src/TargetBus/TargetProfiler.h"
+#include "../src/TargetBus/TargetTracker.h"
+#include "../src/TargetBus/TargetBreakpoints.h"
+#include "../src/TargetBus/TargetWatchpoints.h"
+#include "../src/TargetBus/TargetTracepoints.h"
+#include "../src/TargetBus/TargetCPUZ80.h"
+#include "../src/TargetBus/TargetCallStack.h"
+#include "../src/TargetBus/TargetHistory.h"
+#include "../src/TargetBus/TargetDisasmCache.h"
+#include "../src/TargetBus/TargetMemChanges.h"
+#include "../src/StepTracer/TraceStreamEncoder.h"
+#include "../src/StepTracer/Z80CycleModel.h"
+#include "../src/StepTracer/Z80CycleTable.h"
+#include "../src/Disassembler/src/mdZ80.h"
+#include "../src/Hardware/HwManager.h"
+#include "../src/DeZogInterface/DZRPHandler.h"
+#include "../src/System/lowlib.h"
+#include "../src/System/logging.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test program
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Memory read, memory write, IO write and IO read every pass
+static const uint8_t _testProgram[] = {
+    0x31, 0xF0, 0xFF,       // 0000 LD SP,FFF0
+    0x21, 0x00, 0x80,       // 0003 LD HL,8000
+    0x7E,                   // 0006 LD A,(HL)
+    0x3C,                   // 0007 INC A
+    0x77,                   // 0008 LD (HL),A
+    0xD3, 0x10,             // 0009 OUT (10),A
+    0xDB, 0x11,             // 000B IN A,(11)
+    0x32, 0x01, 0x80,       // 000D LD (8001),A
+    0xC3, 0x03, 0x00        // 0010 JP 0003
+};
+static const uint32_t TEST_COUNTER_ADDR = 0x8000;
+static const uint32_t TEST_IN_RESULT_ADDR = 0x8001;
+static const uint32_t TEST_IN_PORT = 0x11;
+static const uint32_t TEST_IN_VALUE = 0x5a;
+static const uint32_t TEST_OUT_PORT = 0x10;
+static const uint32_t TEST_BLOCK_ADDR = 0x90f0;
+static const uint32_t TEST_BLOCK_LEN = 0x300;
+static const uint32_t TEST_VECTOR_ADDR = 0xa0f0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bus socket
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t _simIOWriteCount = 0;
+static uint32_t _simIOWriteLast = 0;
+static uint32_t _simIOWriteErrors = 0;
+static uint32_t _simIOReadCount = 0;
+static uint32_t _simMemCount = 0;
+
+static void simBusAccessCallback([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
+            uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+{
+    if (flags & BR_CTRL_BUS_MREQ_MASK)
+        _simMemCount++;
+}
+
+// IO ports (via the BusAccess IO port table)
+static void simIOPortOutHandler([[maybe_unused]] void* pParam, [[maybe_unused]] uint32_t addr, uint32_t data, 
+            [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+{
+    // The counter is incremented before each OUT
+    if (_simIOWriteCount != 0 && (data != ((_simIOWriteLast + 1) & 0xff)))
+        _simIOWriteErrors++;
+    _simIOWriteLast = data;
+    _simIOWriteCount++;
+}
+
+static void simIOPortInHandler([[maybe_unused]] void* pParam, [[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
+            [[maybe_unused]] uint32_t flags, uint32_t& retVal)
+{
+    retVal = TEST_IN_VALUE;
+    _simIOReadCount++;
+}
+
+// Mask of reasons for BUSRQ callbacks seen (and number of callbacks)
+static uint32_t _simBusRqReasonMask = 0;
+static uint32_t _simBusRqCallbackCount = 0;
+
+static void simBusActionCallback(BR_BUS_ACTION actionType, BR_BUS_ACTION_REASON reason)
+{
+    if (actionType == BR_BUS_ACTION_BUSRQ)
+    {
+        _simBusRqReasonMask |= 1 << reason;
+        _simBusRqCallbackCount++;
+    }
+}
+
+static BusSocketInfo _simBusSocketInfo =
+{
+    true,
+    simBusAccessCallback,
+    simBusActionCallback,
+    false,
+    false,
+    // Reset
+    false,
+    0,
+    // NMI
+    false,
+    0,
+    // IRQ
+    false,
+    0,
+    false,
+    BR_BUS_ACTION_GENERAL,
+    false,
+    // All bus cycles and addresses
+    BR_BUS_CYCLE_ALL,
+    0,
+    0,
+    "HostSim"
+};
+
+// Second socket for bus request queueing
+static BusSocketInfo _simBusSocketInfo2 =
+{
+    true,
+    NULL,
+    simBusActionCallback,
+    false,
+    false,
+    // Reset
+    false,
+    0,
+    // NMI
+    false,
+    0,
+    // IRQ
+    false,
+    0,
+    false,
+    BR_BUS_ACTION_GENERAL,
+    false,
+    // No bus access callback
+    BR_BUS_CYCLE_ALL,
+    0,
+    0,
+    "HostSim2"
+};
+
+// Socket ids
+static int _simBusSocket = -1;
+static int _simBusSocket2 = -1;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Helpers
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static void simLogOut(const char* pStr)
+{
+    fputs(pStr, stdout);
+}
+
+static void simPiService()
+{
+    BusAccess::service();
+    BusCapture::service();
+    TargetProfiler::service();
+}
+
+static bool simRunFor(uint32_t runUs)
+{
+    uint32_t startUs = micros();
+    while (!isTimeout(micros(), startUs, runUs))
+    {
+        for (int i = 0; i < 1000; i++)
+            SimZ80::step();
+        if (SimBoard::isStalled())
+        {
+            printf("FAIL: processor stalled at PC %04x\n", SimZ80::getContext().PC);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool simCheck(bool cond, const char* msg)
+{
+    printf("%s: %s\n", cond ? "PASS" : "FAIL", msg);
+    return cond;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Register set injection - run on a separate libz80 context which is fed the injected bytes
+// for every memory read (as the bus does when injecting) and ignores writes
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const uint8_t* _injectCode = NULL;
+static uint32_t _injectLen = 0;
+static uint32_t _injectPos = 0;
+
+static byte injectMemRead([[maybe_unused]] int param, [[maybe_unused]] ushort address)
+{
+    return (_injectPos < _injectLen) ? _injectCode[_injectPos++] : 0;
+}
+
+static void injectMemWrite([[maybe_unused]] int param, [[maybe_unused]] ushort address, [[maybe_unused]] byte data)
+{
+}
+
+static void injectRun(Z80Context& ctx, const uint8_t* pCode, uint32_t codeLen)
+{
+    _injectCode = pCode;
+    _injectLen = codeLen;
+    _injectPos = 0;
+    ctx.memRead = injectMemRead;
+    ctx.memWrite = injectMemWrite;
+    while (_injectPos < _injectLen)
+        Z80Execute(&ctx);
+}
+
+static bool injectMatchesRegs(const Z80Context& ctx, const Z80Registers& regs)
+{
+    return (ctx.PC == regs.PC) && (ctx.R1.wr.SP == regs.SP) && (ctx.R1.wr.AF == regs.AF) &&
+            (ctx.R1.wr.BC == regs.BC) && (ctx.R1.wr.DE == regs.DE) && (ctx.R1.wr.HL == regs.HL) &&
+            (ctx.R1.wr.IX == regs.IX) && (ctx.R1.wr.IY == regs.IY) && (ctx.R2.wr.AF == regs.AFDASH) &&
+            (ctx.R2.wr.BC == regs.BCDASH) && (ctx.R2.wr.DE == regs.DEDASH) && (ctx.R2.wr.HL == regs.HLDASH) &&
+            (ctx.I == regs.I) && (ctx.R == regs.R) && (ctx.IM == regs.INTMODE) &&
+            (ctx.IFF1 == regs.INTENABLED) && (ctx.IFF2 == regs.INTENABLED);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shadow call stack - a libz80 processor running a program with its memory cycles fed to the call stack
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// ld sp,f000; call 0100; halt
+// 0038: reti (RST 38 and IM1 interrupt)
+// 0100: push ix; call 0200; pop ix; ret
+// 0200: xor a; call nz,0300 (not taken); rst 38; ret
+static const uint8_t _callStackProgram[] = { 0x31, 0x00, 0xf0, 0xcd, 0x00, 0x01, 0x76 };
+static const uint8_t _callStackIsr[] = { 0xed, 0x4d };
+static const uint8_t _callStackSub1[] = { 0xdd, 0xe5, 0xcd, 0x00, 0x02, 0xdd, 0xe1, 0xc9 };
+static const uint8_t _callStackSub2[] = { 0xaf, 0xc4, 0x00, 0x03, 0xff, 0xc9 };
+static Z80Context _callStackCtx;
+static uint8_t _callStackMem[STD_TARGET_MEMORY_LEN];
+static TargetCallStack* _pCallStack = NULL;
+
+// Call stack at each opcode fetch of an address being checked
+static const uint32_t CALL_STACK_PROBE_ADDRS[] = { 0x0038, 0x0105, 0x0200, 0x0006 };
+static const int CALL_STACK_MAX_PROBES = 10;
+static CallStackFrame _callStackProbeFrames[CALL_STACK_MAX_PROBES];
+static uint32_t _callStackProbeAddrs[CALL_STACK_MAX_PROBES];
+static uint32_t _callStackProbeDepths[CALL_STACK_MAX_PROBES];
+static int _callStackProbeCount = 0;
+
+static byte callStackMemRead([[maybe_unused]] int param, ushort address)
+{
+    uint32_t flags = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | (_callStackCtx.M1 ? BR_CTRL_BUS_M1_MASK : 0);
+    _pCallStack->handleBusCycle(address, _callStackMem[address], flags);
+    if (_callStackCtx.M1 && (_callStackProbeCount < CALL_STACK_MAX_PROBES))
+    {
+        for (uint32_t i = 0; i < sizeof(CALL_STACK_PROBE_ADDRS) / sizeof(CALL_STACK_PROBE_ADDRS[0]); i++)
+        {
+            if (address != CALL_STACK_PROBE_ADDRS[i])
+                continue;
+            _callStackProbeAddrs[_callStackProbeCount] = address;
+            _callStackProbeDepths[_callStackProbeCount] = _pCallStack->getDepth();
+            _pCallStack->getFrame(0, _callStackProbeFrames[_callStackProbeCount]);
+            _callStackProbeCount++;
+        }
+    }
+    return _callStackMem[address];
+}
+
+static void callStackMemWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    _pCallStack->handleBusCycle(address, data, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    _callStackMem[address] = data;
+}
+
+static bool callStackProbeMatch(int idx, uint32_t addr, uint32_t depth, uint32_t retAddr, uint32_t frameType)
+{
+    return (_callStackProbeAddrs[idx] == addr) && (_callStackProbeDepths[idx] == depth) &&
+            ((depth == 0) || ((_callStackProbeFrames[idx].retAddr == retAddr) && 
+                        (_callStackProbeFrames[idx].frameType == frameType)));
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Execution history - a libz80 processor running from the mirror memory with its opcode fetches and
+// memory writes fed to the history (before the mirror is written as on the bus) and a register
+// checkpoint taken at the first opcode fetch of every few instructions as the tracker does
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// 8000: ld sp,9000; ld hl,8800; ld b,6
+// 8008: ld (hl),b; inc hl; push hl; pop de; call 8020; djnz 8008; halt
+// 8020: ld a,(8900); inc a; ld (8900),a; ret
+static const uint8_t _historyProgram[] = { 0x31, 0x00, 0x90, 0x21, 0x00, 0x88, 0x06, 0x06, 
+            0x70, 0x23, 0xe5, 0xd1, 0xcd, 0x20, 0x80, 0x10, 0xf7, 0x76 };
+static const uint8_t _historySub[] = { 0x3a, 0x00, 0x89, 0x3c, 0x32, 0x00, 0x89, 0xc9 };
+static const uint32_t HISTORY_PROG_ADDR = 0x8000;
+static const uint32_t HISTORY_SUB_ADDR = 0x8020;
+static const uint32_t HISTORY_DATA_ADDR = 0x8800;
+static const uint32_t HISTORY_DATA_LEN = 0x0800;
+static const uint32_t HISTORY_CHECKPOINT_INTERVAL = 3;
+static const int HISTORY_MAX_SNAPSHOTS = 64;
+static Z80Context _historyCtx;
+static uint8_t* _pHistoryMem = NULL;
+static bool _historyInstrStart = false;
+static uint32_t _historyInstrCount = 0;
+static Z80Registers _historyRegs[HISTORY_MAX_SNAPSHOTS];
+static uint8_t _historyData[HISTORY_MAX_SNAPSHOTS][HISTORY_DATA_LEN];
+static int _historySnapshotCount = 0;
+
+static void historyGetRegs(Z80Registers& regs, uint32_t pc)
+{
+    regs.PC = pc;
+    regs.SP = _historyCtx.R1.wr.SP;
+    regs.AF = _historyCtx.R1.wr.AF;
+    regs.BC = _historyCtx.R1.wr.BC;
+    regs.DE = _historyCtx.R1.wr.DE;
+    regs.HL = _historyCtx.R1.wr.HL;
+}
+
+static byte historyMemRead([[maybe_unused]] int param, ushort address)
+{
+    if (!_historyCtx.M1)
+        return _pHistoryMem[address];
+    TargetHistory::handleBusCycle(address, _pHistoryMem[address], 
+                BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_M1_MASK);
+    if (_historyInstrStart && ((_historyInstrCount++ % HISTORY_CHECKPOINT_INTERVAL) == 0) && 
+                (_historySnapshotCount < HISTORY_MAX_SNAPSHOTS))
+    {
+        Z80Registers& regs = _historyRegs[_historySnapshotCount];
+        historyGetRegs(regs, address);
+        memcpy(_historyData[_historySnapshotCount], _pHistoryMem + HISTORY_DATA_ADDR, HISTORY_DATA_LEN);
+        _historySnapshotCount++;
+        TargetHistory::recordCheckpoint(regs);
+    }
+    _historyInstrStart = false;
+    return _pHistoryMem[address];
+}
+
+static void historyMemWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    TargetHistory::handleBusCycle(address, data, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    TargetMemChanges::handleBusCycle(address, data, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    _pHistoryMem[address] = data;
+}
+
+static void historyRun(uint32_t logLen)
+{
+    memset(&_historyCtx, 0, sizeof(_historyCtx));
+    memset(_pHistoryMem + HISTORY_DATA_ADDR, 0, HISTORY_DATA_LEN);
+    memcpy(_pHistoryMem + HISTORY_PROG_ADDR, _historyProgram, sizeof(_historyProgram));
+    memcpy(_pHistoryMem + HISTORY_SUB_ADDR, _historySub, sizeof(_historySub));
+    _historyCtx.memRead = historyMemRead;
+    _historyCtx.memWrite = historyMemWrite;
+    _historyCtx.PC = HISTORY_PROG_ADDR;
+    _historyInstrCount = 0;
+    _historySnapshotCount = 0;
+    TargetHistory::start(logLen, TargetHistory::DEFAULT_CHECKPOINTS, 0);
+    for (int i = 0; (i < 200) && !_historyCtx.halted; i++)
+    {
+        _historyInstrStart = true;
+        Z80Execute(&_historyCtx);
+    }
+}
+
+// Step back to each checkpoint in turn (re-recording each as the tracker does after setting the
+// registers) checking the registers and memory - the most recent checkpoint is the current position
+// so the first step goes to the one before - returns the number of steps back
+static int historyStepBackAll(bool& stepsOk)
+{
+    int stepCount = 0;
+    Z80Registers regs;
+    for (int snapIdx = _historySnapshotCount - 2; snapIdx >= 0; snapIdx--)
+    {
+        if (!TargetHistory::rollBack(regs))
+            break;
+        const Z80Registers& expRegs = _historyRegs[snapIdx];
+        stepsOk &= (regs.PC == expRegs.PC) && (regs.SP == expRegs.SP) && (regs.AF == expRegs.AF) &&
+                (regs.BC == expRegs.BC) && (regs.DE == expRegs.DE) && (regs.HL == expRegs.HL) &&
+                (memcmp(_pHistoryMem + HISTORY_DATA_ADDR, _historyData[snapIdx], HISTORY_DATA_LEN) == 0);
+        TargetHistory::recordCheckpoint(regs);
+        stepCount++;
+    }
+
+    // Nothing changed when there's nothing further back
+    static uint8_t dataBefore[HISTORY_DATA_LEN];
+    memcpy(dataBefore, _pHistoryMem + HISTORY_DATA_ADDR, HISTORY_DATA_LEN);
+    stepsOk &= !TargetHistory::rollBack(regs) &&
+                (memcmp(dataBefore, _pHistoryMem + HISTORY_DATA_ADDR, HISTORY_DATA_LEN) == 0);
+    return stepCount;
+}
+
+// Memory changes - expected memory is updated with each write and the pushed page records are
+// applied to a copy of the memory at subscription
+static uint8_t _memChangesExpected[STD_TARGET_MEMORY_LEN];
+static uint8_t _memChangesApplied[STD_TARGET_MEMORY_LEN];
+
+static void memChangesWrite(uint32_t addr, uint8_t data)
+{
+    TargetMemChanges::handleBusCycle(addr, data, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    _memChangesExpected[addr] = data;
+}
+
+// Apply the page records in the memChanges frames sent - returns the number of page records
+static uint32_t memChangesApplyFrames(uint32_t& frameCount)
+{
+    uint32_t pageCount = 0;
+    std::vector<uint8_t>& frames = HostSimComms::getSentFrames();
+    uint32_t pos = 0;
+    while (pos < frames.size())
+    {
+        const char* pHeader = (const char*)frames.data() + pos;
+        const char* pDataLen = strstr(pHeader, "\"dataLen\":");
+        uint32_t dataLen = pDataLen ? strtoul(pDataLen + strlen("\"dataLen\":"), NULL, 10) : 0;
+        const uint8_t* pData = frames.data() + pos + strlen(pHeader) + 1;
+        pos += strlen(pHeader) + 1 + dataLen + 1;
+        if (!strstr(pHeader, "\"cmdName\":\"memChanges\""))
+            continue;
+        frameCount++;
+        uint32_t recPos = 0;
+        while (recPos + 2 <= dataLen)
+        {
+            uint32_t pageAddr = pData[recPos] * TargetMemChanges::PAGE_LEN;
+            uint32_t numRanges = pData[recPos + 1];
+            recPos += 2;
+            for (uint32_t i = 0; i < numRanges; i++)
+            {
+                uint32_t offset = pData[recPos];
+                uint32_t rangeLen = pData[recPos + 1] + 1;
+                memcpy(_memChangesApplied + pageAddr + offset, pData + recPos + 2, rangeLen);
+                recPos += 2 + rangeLen;
+            }
+            pageCount++;
+        }
+    }
+    return pageCount;
+}
+
+// Trace stream - a libz80 processor copying blocks, calling, pushing, using an index register and IO
+// with some memory supplying data as a bus socket would - each cycle is encoded and optionally
+// written to a reference CSV in the decoder's format
+static const uint8_t _traceProgram[] = { 0x31, 0x00, 0xf0, 0x21, 0x00, 0x10, 0x11, 0x00, 0x20,
+            0x01, 0x40, 0x00, 0xed, 0xb0, 0xcd, 0x00, 0x03, 0xdb, 0x11, 0xd3, 0x10, 0xdd, 0x21,
+            0x00, 0x30, 0xdd, 0x34, 0x05, 0x18, 0xe5 };
+static const uint8_t _traceSub[] = { 0xe5, 0x3a, 0x05, 0x30, 0xe1, 0xc9 };
+static const uint32_t TRACE_SUB_ADDR = 0x0300;
+static Z80Context _traceCtx;
+static uint8_t _traceMem[STD_TARGET_MEMORY_LEN];
+static TraceStreamEncoder* _pTraceEncoder = NULL;
+static FILE* _pTraceRefFile = NULL;
+static uint32_t _traceCycles = 0;
+
+static void traceCycle(uint32_t addr, uint32_t busData, uint32_t retData, bool retDataValid, uint32_t flags)
+{
+    _pTraceEncoder->encodeCycle(addr, busData, retData, retDataValid, flags);
+    if (_pTraceRefFile)
+    {
+        fprintf(_pTraceRefFile, "%u,%04x,%02x,", _traceCycles, addr, busData);
+        if (retDataValid)
+            fprintf(_pTraceRefFile, "%02x", retData);
+        fprintf(_pTraceRefFile, ",%d,%d,%d,%d,%d\n", (flags & BR_CTRL_BUS_RD_MASK) ? 1 : 0,
+                    (flags & BR_CTRL_BUS_WR_MASK) ? 1 : 0, (flags & BR_CTRL_BUS_MREQ_MASK) ? 1 : 0,
+                    (flags & BR_CTRL_BUS_IORQ_MASK) ? 1 : 0, (flags & BR_CTRL_BUS_M1_MASK) ? 1 : 0);
+    }
+    _traceCycles++;
+}
+
+// Registers for a checkpoint in the trace (as the tracker grabs them)
+static void traceGetRegs(Z80Registers& regs)
+{
+    regs.PC = _traceCtx.PC;
+    regs.SP = _traceCtx.R1.wr.SP;
+    regs.AF = _traceCtx.R1.wr.AF;
+    regs.BC = _traceCtx.R1.wr.BC;
+    regs.DE = _traceCtx.R1.wr.DE;
+    regs.HL = _traceCtx.R1.wr.HL;
+    regs.IX = _traceCtx.R1.wr.IX;
+    regs.IY = _traceCtx.R1.wr.IY;
+    regs.AFDASH = _traceCtx.R2.wr.AF;
+    regs.BCDASH = _traceCtx.R2.wr.BC;
+    regs.DEDASH = _traceCtx.R2.wr.DE;
+    regs.HLDASH = _traceCtx.R2.wr.HL;
+    regs.I = _traceCtx.I;
+    regs.R = _traceCtx.R;
+    regs.INTMODE = _traceCtx.IM;
+    regs.INTENABLED = _traceCtx.IFF1;
+}
+
+// Block copy source supplied with the bus floating and the index variable supplied matching the bus
+static byte traceMemRead([[maybe_unused]] int param, ushort address)
+{
+    uint32_t flags = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | (_traceCtx.M1 ? BR_CTRL_BUS_M1_MASK : 0);
+    uint8_t val = _traceMem[address];
+    if ((address & 0xf000) == 0x1000)
+        traceCycle(address, 0xff, val, true, flags);
+    else if ((address & 0xf000) == 0x3000)
+        traceCycle(address, val, val, true, flags);
+    else
+        traceCycle(address, val, 0, false, flags);
+    return val;
+}
+
+static void traceMemWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    traceCycle(address, data, 0, false, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    _traceMem[address] = data;
+}
+
+static byte traceIORead([[maybe_unused]] int param, ushort address)
+{
+    traceCycle(address, 0xff, TEST_IN_VALUE, true, BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_RD_MASK);
+    return TEST_IN_VALUE;
+}
+
+static void traceIOWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    traceCycle(address, data, 0, false, BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_WR_MASK);
+}
+
+// Cycle model - every opcode in the cycle table is run on a libz80 processor with its accesses
+// recorded as the step tracer does and then put in bus order by the model
+static const uint32_t CYCLE_MODEL_INSTR_ADDR = 0x0100;
+static const uint8_t CYCLE_MODEL_OPERAND = 0x04;
+static Z80Context _cycleModelCtx;
+static uint8_t _cycleModelMem[STD_TARGET_MEMORY_LEN];
+static Z80BusCycle _cycleModelAccesses[Z80CycleModel::MAX_ACCESSES];
+static int _cycleModelAccessCount = 0;
+
+static void cycleModelAccess(uint32_t addr, uint32_t data, uint32_t flags)
+{
+    if (_cycleModelAccessCount >= Z80CycleModel::MAX_ACCESSES)
+        return;
+    _cycleModelAccesses[_cycleModelAccessCount].addr = addr;
+    _cycleModelAccesses[_cycleModelAccessCount].data = data;
+    _cycleModelAccesses[_cycleModelAccessCount].flags = flags;
+    _cycleModelAccessCount++;
+}
+
+static byte cycleModelMemRead([[maybe_unused]] int param, ushort address)
+{
+    cycleModelAccess(address, _cycleModelMem[address], BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK |
+                (_cycleModelCtx.M1 ? BR_CTRL_BUS_M1_MASK : 0));
+    return _cycleModelMem[address];
+}
+
+static void cycleModelMemWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    cycleModelAccess(address, data, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    _cycleModelMem[address] = data;
+}
+
+static byte cycleModelIORead([[maybe_unused]] int param, ushort address)
+{
+    cycleModelAccess(address, TEST_IN_VALUE, BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_RD_MASK);
+    return TEST_IN_VALUE;
+}
+
+static void cycleModelIOWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    cycleModelAccess(address, data, BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_WR_MASK);
+}
+
+// Run one instruction (prefix bytes, opcode and operands) and order its cycles - returns the
+// model's result and fills the ordered cycles
+static int cycleModelRun(const uint8_t* pInstr, int instrLen, Z80BusCycle* pCycles, int& numCycles)
+{
+    memset(&_cycleModelCtx, 0, sizeof(_cycleModelCtx));
+    memset(_cycleModelMem, 0, sizeof(_cycleModelMem));
+    memcpy(_cycleModelMem + CYCLE_MODEL_INSTR_ADDR, pInstr, instrLen);
+    _cycleModelCtx.memRead = cycleModelMemRead;
+    _cycleModelCtx.memWrite = cycleModelMemWrite;
+    _cycleModelCtx.ioRead = cycleModelIORead;
+    _cycleModelCtx.ioWrite = cycleModelIOWrite;
+    _cycleModelCtx.PC = CYCLE_MODEL_INSTR_ADDR;
+    _cycleModelCtx.R1.wr.SP = 0x8000;
+    _cycleModelCtx.R1.wr.BC = 0x0003;
+    _cycleModelCtx.R1.wr.DE = 0x7000;
+    _cycleModelCtx.R1.wr.HL = 0x4000;
+    _cycleModelCtx.R1.wr.IX = 0x5000;
+    _cycleModelCtx.R1.wr.IY = 0x6000;
+    _cycleModelAccessCount = 0;
+    Z80Execute(&_cycleModelCtx);
+    numCycles = _cycleModelAccessCount;
+    return Z80CycleModel::orderCycles(_cycleModelAccesses, _cycleModelAccessCount, pCycles);
+}
+
+// Check every opcode in a table - fetches and operands must come first in address order with M1
+// only on the fetches and every access must be in the pattern - returns the number of failures
+static int cycleModelCheckTable(int tableIdx, const Z80CycleTableEntry* pTable, const uint8_t* pPrefix, int prefixLen,
+                bool opcodeAfterOperands, uint32_t& entriesChecked)
+{
+    int failCount = 0;
+    for (uint32_t opcode = 0; opcode < 256; opcode++)
+    {
+        const Z80CycleTableEntry& entry = pTable[opcode];
+        if (!entry.pPattern)
+            continue;
+        uint8_t instr[8];
+        int instrLen = 0;
+        for (int i = 0; i < prefixLen; i++)
+            instr[instrLen++] = pPrefix[i];
+        if (!opcodeAfterOperands)
+            instr[instrLen++] = opcode;
+        for (int i = 0; i < entry.numOperands - (opcodeAfterOperands ? 1 : 0); i++)
+            instr[instrLen++] = CYCLE_MODEL_OPERAND;
+        if (opcodeAfterOperands)
+            instr[instrLen++] = opcode;
+        Z80BusCycle cycles[Z80CycleModel::MAX_ACCESSES];
+        int numCycles = 0;
+        bool entryOk = (cycleModelRun(instr, instrLen, cycles, numCycles) == 0) &&
+                    (numCycles >= entry.numFetches + entry.numOperands);
+        for (int i = 0; entryOk && (i < entry.numFetches + entry.numOperands); i++)
+        {
+            uint32_t expFlags = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | ((i < entry.numFetches) ? BR_CTRL_BUS_M1_MASK : 0);
+            entryOk = (cycles[i].addr == CYCLE_MODEL_INSTR_ADDR + i) && (cycles[i].flags == expFlags);
+        }
+        // Index used for the tracer's per-opcode stats (from the accesses libz80 made)
+        if (entryOk)
+            entryOk = (Z80CycleModel::getOpcodeIdx(_cycleModelAccesses, _cycleModelAccessCount) == (int)(tableIdx * 256 + opcode));
+        if (!entryOk)
+        {
+            printf("cycleModel prefix %02x opcode %02x failed\n", prefixLen > 0 ? pPrefix[0] : 0, opcode);
+            failCount++;
+        }
+        entriesChecked++;
+    }
+    return failCount;
+}
+
+// Check the cycles of an instruction against the expected (addr, flags) pairs
+static bool cycleModelCheckOrder(const uint8_t* pInstr, int instrLen, const uint32_t* pExpected, int numExpected)
+{
+    Z80BusCycle cycles[Z80CycleModel::MAX_ACCESSES];
+    int numCycles = 0;
+    if ((cycleModelRun(pInstr, instrLen, cycles, numCycles) != 0) || (numCycles != numExpected))
+        return false;
+    for (int i = 0; i < numExpected; i++)
+        if ((cycles[i].addr != pExpected[i * 2]) || (cycles[i].flags != pExpected[i * 2 + 1]))
+            return false;
+    return true;
+}
+
+// Host version of TargetTracker functions used by HwManager and TargetHistory - the tracker isn't run
+// so the bus is always available and nothing is injected
+bool TargetTracker::busAccessAvailable()
+{
+    return true;
+}
+
+bool TargetTracker::isInjecting()
+{
+    return false;
+}
+
+// Host version of the tracker's run control used by DZRPHandler - service runs the simulated
+// processor and checks the breakpoints at each instruction fetch as the tracker's wait handler does
+TargetBreakpoints TargetTracker::_breakpoints;
+Z80Registers TargetTracker::_z80Registers;
+TargetDisasmCache TargetTracker::_disasmCache;
+TargetTracker::STEP_MODE_TYPE TargetTracker::_stepMode = TargetTracker::STEP_MODE_STEP_PAUSED;
+static const uint32_t HOST_TRACKER_MAX_INSTRS = 100000;
+static int _hostTrackerHitIdx = -1;
+
+void TargetTracker::stepRun()
+{
+    _stepMode = STEP_MODE_RUN;
+}
+
+void TargetTracker::stepInto()
+{
+    _stepMode = STEP_MODE_STEP_INTO;
+}
+
+bool TargetTracker::setRegister(const char* pRegName, uint32_t value)
+{
+    uint32_t regsModifiedMask = 0;
+    return _z80Registers.setByName(pRegName, value, regsModifiedMask);
+}
+
+void TargetTracker::service()
+{
+    for (uint32_t i = 0; (i < HOST_TRACKER_MAX_INSTRS) && (_stepMode != STEP_MODE_STEP_PAUSED); i++)
+    {
+        SimZ80::step();
+        uint32_t pc = SimZ80::getContext().PC;
+        uint32_t retVal = 0;
+        bool bpHit = _breakpoints.checkForBreak(pc, 0, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_M1_MASK, retVal);
+        if (bpHit || (_stepMode == STEP_MODE_STEP_INTO))
+        {
+            _hostTrackerHitIdx = bpHit ? _breakpoints.getHitIndex() : -1;
+            _z80Registers.PC = pc;
+            _stepMode = STEP_MODE_STEP_PAUSED;
+        }
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DZRP - commands are fed to the handler in pieces and the responses are collected from the frames sent
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static std::vector<uint8_t> _dzrpRx;
+
+static void dzrpSendCmd(DZRPHandler& handler, uint32_t seqNo, uint32_t cmd, const uint8_t* pPayload, uint32_t payloadLen,
+            uint32_t chunkLen)
+{
+    std::vector<uint8_t> msg = { (uint8_t)payloadLen, (uint8_t)(payloadLen >> 8), (uint8_t)(payloadLen >> 16),
+                (uint8_t)(payloadLen >> 24), (uint8_t)seqNo, (uint8_t)cmd };
+    if (pPayload)
+        msg.insert(msg.end(), pPayload, pPayload + payloadLen);
+    for (uint32_t pos = 0; pos < msg.size(); pos += chunkLen)
+        handler.handleRxData(msg.data() + pos, (msg.size() - pos < chunkLen) ? msg.size() - pos : chunkLen);
+}
+
+// Move the bytes from the dzrp frames sent to the rx buffer - returns the number of frames
+static uint32_t dzrpCollect()
+{
+    uint32_t frameCount = 0;
+    std::vector<uint8_t>& frames = HostSimComms::getSentFrames();
+    uint32_t pos = 0;
+    while (pos < frames.size())
+    {
+        const char* pHeader = (const char*)frames.data() + pos;
+        const char* pDataLen = strstr(pHeader, "\"dataLen\":");
+        uint32_t dataLen = pDataLen ? strtoul(pDataLen + strlen("\"dataLen\":"), NULL, 10) : 0;
+        const uint8_t* pData = frames.data() + pos + strlen(pHeader) + 1;
+        pos += strlen(pHeader) + 1 + dataLen + 1;
+        if (!strstr(pHeader, "\"cmdName\":\"dzrp\""))
+            continue;
+        _dzrpRx.insert(_dzrpRx.end(), pData, pData + dataLen);
+        frameCount++;
+    }
+    frames.clear();
+    return frameCount;
+}
+
+// Check the next response (or notification - sequence number 0 and the notification number in the
+// header) in the rx buffer and remove it
+static bool dzrpCheckResp(uint32_t seqNo, const uint8_t* pExpected, uint32_t expectedLen, uint32_t ntf = 0)
+{
+    uint32_t headerLen = (seqNo == 0) ? DZRPHandler::DZRP_CMD_HEADER_LEN : DZRPHandler::DZRP_RESP_HEADER_LEN;
+    if (_dzrpRx.size() < headerLen)
+        return false;
+    uint32_t payloadLen = _dzrpRx[0] | (_dzrpRx[1] << 8) | (_dzrpRx[2] << 16) | (_dzrpRx[3] << 24);
+    bool respOk = (payloadLen == expectedLen) && (_dzrpRx[4] == seqNo) && ((seqNo != 0) || (_dzrpRx[5] == ntf)) &&
+                (_dzrpRx.size() >= headerLen + payloadLen) &&
+                (!pExpected || (memcmp(_dzrpRx.data() + headerLen, pExpected, expectedLen) == 0));
+    _dzrpRx.erase(_dzrpRx.begin(), _dzrpRx.begin() + ((_dzrpRx.size() < headerLen + payloadLen) ? _dzrpRx.size() : headerLen + payloadLen));
+    return respOk;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tests - one per feature, each returning false if any of its checks fail
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Block test data
+static void blockFillPattern(uint8_t* pBuf, uint32_t len, uint32_t mult, uint32_t add)
+{
+    for (uint32_t i = 0; i < len; i++)
+        pBuf[i] = (i * mult + add) & 0xff;
+}
+
+// Run the test program with waits on memory and IO - processor sees data driven by the Pi and Pi
+// sees processor writes
+static bool testWaitPath(uint32_t runMs, bool waitOnMemory, bool waitOnIO)
+{
+    bool testOk = simRunFor(runMs * 1000);
+    uint32_t instrCount = SimZ80::getInstrCount();
+    uint32_t busCycleCount = SimBoard::getBusCycleCount();
+    uint32_t waitCycleCount = SimBoard::getWaitCycleCount();
+    uint8_t* pTargetRAM = SimBoard::getTargetRAM();
+    if (waitOnIO)
+    {
+        testOk &= simCheck(_simIOWriteCount > 0 && _simIOWriteErrors == 0, "IO writes seen in sequence");
+        testOk &= simCheck(_simIOReadCount > 0 && pTargetRAM[TEST_IN_RESULT_ADDR] == TEST_IN_VALUE, "IO read data driven onto bus");
+        testOk &= simCheck(pTargetRAM[TEST_COUNTER_ADDR] == _simIOWriteLast, "Memory counter matches IO writes");
+    }
+    if (waitOnMemory)
+        testOk &= simCheck(_simMemCount > 0, "Memory waits serviced");
+    double runSecs = runMs / 1000.0;
+    printf("waitOnMemory %d waitOnIO %d runMs %u\n", waitOnMemory, waitOnIO, runMs);
+    printf("instrPerSec %.0f busCyclesPerSec %.0f waitCyclesPerSec %.0f\n",
+                instrCount / runSecs, busCycleCount / runSecs, waitCycleCount / runSecs);
+    return testOk;
+}
+
+// Block write and read back through BUSRQ
+static bool testBlockAccess()
+{
+    uint8_t writeBuf[TEST_BLOCK_LEN];
+    uint8_t readBuf[TEST_BLOCK_LEN];
+    blockFillPattern(writeBuf, TEST_BLOCK_LEN, 7, 3);
+    memset(readBuf, 0, sizeof(readBuf));
+    uint32_t blockStartUs = micros();
+    BR_RETURN_TYPE writeRslt = BusAccess::blockWrite(TEST_BLOCK_ADDR, writeBuf, TEST_BLOCK_LEN, true, false);
+    BR_RETURN_TYPE readRslt = BusAccess::blockRead(TEST_BLOCK_ADDR, readBuf, TEST_BLOCK_LEN, true, false);
+    uint32_t blockUs = micros() - blockStartUs;
+    bool testOk = simCheck((writeRslt == BR_OK) && (memcmp(SimBoard::getTargetRAM() + TEST_BLOCK_ADDR, writeBuf, TEST_BLOCK_LEN) == 0), "blockWrite");
+    testOk &= simCheck((readRslt == BR_OK) && (memcmp(readBuf, writeBuf, TEST_BLOCK_LEN) == 0), "blockRead");
+    printf("blockWriteRead %u bytes in %u us\n", TEST_BLOCK_LEN * 2, blockUs);
+    return testOk;
+}
+
+// Block read timed with the bus primitives specialised for each hardware version - SimBoard only
+// models V2.0 so the V1.7 data isn't checked but V2.0 must still read correctly afterwards (the
+// block written by testBlockAccess)
+static bool testHwVersionBlockRead()
+{
+    static const int HW_BENCH_REPEATS = 8;
+    static const int hwBenchVersions[] = { 17, 20 };
+    uint8_t expectedBuf[TEST_BLOCK_LEN];
+    uint8_t readBuf[TEST_BLOCK_LEN];
+    blockFillPattern(expectedBuf, TEST_BLOCK_LEN, 7, 3);
+    uint32_t hwBenchUs[2] = { 0, 0 };
+    bool hwBenchOk = BusAccess::controlRequestAndTake() == BR_OK;
+    for (int verIdx = 0; hwBenchOk && (verIdx < 2); verIdx++)
+    {
+        BusAccess::setHwVersion(hwBenchVersions[verIdx]);
+        uint32_t benchStartUs = micros();
+        for (int rep = 0; rep < HW_BENCH_REPEATS; rep++)
+            BusAccess::blockRead(TEST_BLOCK_ADDR, readBuf, TEST_BLOCK_LEN, false, false);
+        hwBenchUs[verIdx] = micros() - benchStartUs;
+    }
+    BusAccess::setHwVersion(20);
+    memset(readBuf, 0, sizeof(readBuf));
+    hwBenchOk = hwBenchOk && (BusAccess::blockRead(TEST_BLOCK_ADDR, readBuf, TEST_BLOCK_LEN, false, false) == BR_OK);
+    BusAccess::controlRelease();
+    printf("blockRead %u bytes x %d V1.7 %u us V2.0 %u us\n", TEST_BLOCK_LEN, HW_BENCH_REPEATS, hwBenchUs[0], hwBenchUs[1]);
+    return simCheck(hwBenchOk && (memcmp(readBuf, expectedBuf, TEST_BLOCK_LEN) == 0), "blockRead after hardware version switch");
+}
+
+// Burst and byte-wise block transfers agree - a block written by the burst engine is read back
+// in chunks too short for it and a block written in short chunks is read back by the burst
+// engine, both across page boundaries
+static bool testBurstTransfers()
+{
+    static const uint32_t BYTEWISE_CHUNK_LEN = BusAccess::MIN_LEN_FOR_BLOCK_BURST - 1;
+    uint8_t writeBuf[TEST_BLOCK_LEN];
+    uint8_t burstBuf[TEST_BLOCK_LEN];
+    uint8_t readBuf[TEST_BLOCK_LEN];
+    blockFillPattern(writeBuf, TEST_BLOCK_LEN, 7, 3);
+    blockFillPattern(burstBuf, TEST_BLOCK_LEN, 13, 5);
+    bool burstOk = BusAccess::controlRequestAndTake() == BR_OK;
+    burstOk &= BusAccess::blockWrite(TEST_BLOCK_ADDR, burstBuf, TEST_BLOCK_LEN, false, false) == BR_OK;
+    memset(readBuf, 0, sizeof(readBuf));
+    for (uint32_t pos = 0; pos < TEST_BLOCK_LEN; pos += BYTEWISE_CHUNK_LEN)
+        burstOk &= BusAccess::blockRead(TEST_BLOCK_ADDR + pos, readBuf + pos,
+                    (TEST_BLOCK_LEN - pos < BYTEWISE_CHUNK_LEN) ? TEST_BLOCK_LEN - pos : BYTEWISE_CHUNK_LEN, false, false) == BR_OK;
+    burstOk &= (memcmp(readBuf, burstBuf, TEST_BLOCK_LEN) == 0);
+    for (uint32_t pos = 0; pos < TEST_BLOCK_LEN; pos += BYTEWISE_CHUNK_LEN)
+        burstOk &= BusAccess::blockWrite(TEST_BLOCK_ADDR + pos, writeBuf + pos,
+                    (TEST_BLOCK_LEN - pos < BYTEWISE_CHUNK_LEN) ? TEST_BLOCK_LEN - pos : BYTEWISE_CHUNK_LEN, false, false) == BR_OK;
+    memset(readBuf, 0, sizeof(readBuf));
+    burstOk &= BusAccess::blockRead(TEST_BLOCK_ADDR, readBuf, TEST_BLOCK_LEN, false, false) == BR_OK;
+    BusAccess::controlRelease();
+    return simCheck(burstOk && (memcmp(readBuf, writeBuf, TEST_BLOCK_LEN) == 0) &&
+                (memcmp(SimBoard::getTargetRAM() + TEST_BLOCK_ADDR, writeBuf, TEST_BLOCK_LEN) == 0), "Burst and byte-wise block transfers agree");
+}
+
+// Scatter-gather under a single BUSRQ
+static bool testBlockAccessVector()
+{
+    uint8_t vecWriteBuf[40];
+    uint8_t vecReadBuf[sizeof(vecWriteBuf)];
+    uint8_t vecIOBuf[1] = { 0x55 };
+    blockFillPattern(vecWriteBuf, sizeof(vecWriteBuf), 13, 1);
+    memset(vecReadBuf, 0, sizeof(vecReadBuf));
+    const BusXfer xfers[] = {
+        { TEST_VECTOR_ADDR, vecWriteBuf, sizeof(vecWriteBuf), true, false },
+        { TEST_OUT_PORT, vecIOBuf, sizeof(vecIOBuf), true, true },
+        { TEST_VECTOR_ADDR, vecReadBuf, sizeof(vecReadBuf), false, false },
+        { TEST_VECTOR_ADDR, vecReadBuf, 0, false, false }
+    };
+    static const int NUM_XFERS = sizeof(xfers) / sizeof(xfers[0]);
+    BR_RETURN_TYPE xferResults[NUM_XFERS];
+    uint32_t busAckCountBefore = SimBoard::getBusAckCount();
+    BR_RETURN_TYPE vecRslt = BusAccess::blockAccessVector(xfers, NUM_XFERS, true, xferResults);
+    bool xferResultsOk = true;
+    for (int i = 0; i < NUM_XFERS; i++)
+        xferResultsOk &= (xferResults[i] == BR_OK);
+    return simCheck((vecRslt == BR_OK) && xferResultsOk && (SimBoard::getBusAckCount() == busAckCountBefore + 1) &&
+                (memcmp(vecReadBuf, vecWriteBuf, sizeof(vecWriteBuf)) == 0), "blockAccessVector");
+}
+
+// Bus requests from two sockets merged into one grant with a callback for each reason
+static bool testBusRqCoalesced()
+{
+    uint32_t busAckCountBefore = SimBoard::getBusAckCount();
+    _simBusRqReasonMask = 0;
+    _simBusRqCallbackCount = 0;
+    BusAccess::targetReqBus(_simBusSocket, BR_BUS_ACTION_DISPLAY);
+    BusAccess::targetReqBus(_simBusSocket2, BR_BUS_ACTION_HW_ACTION);
+    bool testOk = simRunFor(10000);
+    BusAccessStatusInfo busRqStatusInfo;
+    BusAccess::getStatus(busRqStatusInfo);
+    // Each callback goes to both sockets
+    testOk &= simCheck((SimBoard::getBusAckCount() == busAckCountBefore + 1) &&
+                (_simBusRqReasonMask == ((1 << BR_BUS_ACTION_DISPLAY) | (1 << BR_BUS_ACTION_HW_ACTION))) &&
+                (_simBusRqCallbackCount == 4) && (busRqStatusInfo.busRqCoalesced == 1), "Bus requests coalesced");
+    return testOk;
+}
+
+// Bus request that times out is counted as a failure and not as a grant delay - the processor
+// continues after the bus is released
+static bool testBusRqFailure()
+{
+    BusAccessStatusInfo busRqStatusInfo;
+    BusAccess::getStatus(busRqStatusInfo);
+    SimBoard::setBusAckWithheld(true);
+    _simBusRqCallbackCount = 0;
+    BusAccess::targetReqBus(_simBusSocket, BR_BUS_ACTION_DISPLAY);
+    bool testOk = simRunFor(10000);
+    SimBoard::setBusAckWithheld(false);
+    BusAccessStatusInfo busRqFailStatusInfo;
+    BusAccess::getStatus(busRqFailStatusInfo);
+    testOk &= simCheck((_simBusRqCallbackCount == 0) &&
+                (busRqFailStatusInfo.busrqFailCount == busRqStatusInfo.busrqFailCount + 1) &&
+                (busRqFailStatusInfo.busRqReasonFailCount[BR_BUS_ACTION_DISPLAY] == busRqStatusInfo.busRqReasonFailCount[BR_BUS_ACTION_DISPLAY] + 1) &&
+                (busRqFailStatusInfo.busRqReasonCount[BR_BUS_ACTION_DISPLAY] == busRqStatusInfo.busRqReasonCount[BR_BUS_ACTION_DISPLAY]),
+                "Bus request failure counted separately");
+    uint32_t instrBefore = SimZ80::getInstrCount();
+    testOk &= simRunFor(10000);
+    testOk &= simCheck(SimZ80::getInstrCount() > instrBefore, "Processor runs after BUSRQ");
+    return testOk;
+}
+
+// Capture triggered on an IO write to the output port with records before and after
+static bool testBusCapture(const char* pCaptureFile)
+{
+    static const uint32_t CAPTURE_PRE = 10;
+    static const uint32_t CAPTURE_POST = 200;
+    BusCaptureTrigger captureTrigger;
+    captureTrigger.enabled = true;
+    captureTrigger.addr = TEST_OUT_PORT;
+    captureTrigger.addrMask = 0xff;
+    captureTrigger.flags = BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_WR_MASK;
+    captureTrigger.flagsMask = BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_WR_MASK | BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_IORQ_MASK;
+    captureTrigger.preCount = CAPTURE_PRE;
+    captureTrigger.postCount = CAPTURE_POST;
+    HostSimComms::getSentFrames().clear();
+    BusCapture::start(captureTrigger, false, true, true);
+    bool testOk = simRunFor(20000);
+    char captureStatus[200];
+    BusCapture::getStatusJson(captureStatus, sizeof(captureStatus));
+    char captureExpected[100];
+    snprintf(captureExpected, sizeof(captureExpected), "\"state\":\"complete\",\"recs\":%u,\"ovf\":0,\"sent\":%u,\"trig\":%u",
+                CAPTURE_PRE + 1 + CAPTURE_POST, CAPTURE_PRE + 1 + CAPTURE_POST, CAPTURE_PRE);
+    testOk &= simCheck(strstr(captureStatus, captureExpected) != NULL, "Bus capture triggered and streamed");
+    if (pCaptureFile)
+    {
+        FILE* pFile = fopen(pCaptureFile, "wb");
+        if (pFile)
+        {
+            fwrite(HostSimComms::getSentFrames().data(), 1, HostSimComms::getSentFrames().size(), pFile);
+            fclose(pFile);
+        }
+        testOk &= simCheck(pFile != NULL, "Bus capture written");
+    }
+    printf("capture {%s} frames %u\n", captureStatus, HostSimComms::getSentFrameCount());
+    return testOk;
+}
+
+// Instructions in the test program loop
+static const uint32_t PROFILE_LOOP_ADDRS[] = { 0x0003, 0x0006, 0x0007, 0x0008, 0x0009, 0x000b, 0x000d, 0x0010 };
+static const int PROFILE_LOOP_LEN = sizeof(PROFILE_LOOP_ADDRS) / sizeof(PROFILE_LOOP_ADDRS[0]);
+
+// Profiler - each instruction in the loop is counted once per pass
+static bool testProfilerCount()
+{
+    uint8_t* pTargetRAM = SimBoard::getTargetRAM();
+    TargetProfiler::clear();
+    TargetProfiler::start(TargetProfiler::PROFILER_MODE_COUNT);
+    bool testOk = simRunFor(20000);
+    TargetProfiler::stop();
+    uint32_t profileLoopHits = 0;
+    bool profileEven = true;
+    for (int i = 0; i < PROFILE_LOOP_LEN; i++)
+    {
+        uint32_t hits = TargetProfiler::getHits(PROFILE_LOOP_ADDRS[i]);
+        profileLoopHits += hits;
+        profileEven &= (hits + 1 >= TargetProfiler::getHits(PROFILE_LOOP_ADDRS[0])) &&
+                    (hits <= TargetProfiler::getHits(PROFILE_LOOP_ADDRS[0]));
+    }
+    char profileTop[1000];
+    TargetProfiler::getTopJson(2, pTargetRAM, profileTop, sizeof(profileTop));
+    char profileRanges[1000];
+    TargetProfiler::getRangesJson("0000-0005,0006-0012", pTargetRAM, profileRanges, sizeof(profileRanges));
+    printf("profile total %u loopHits %u top %s\n", TargetProfiler::getTotalHits(), profileLoopHits, profileTop);
+    printf("profile ranges %s\n", profileRanges);
+    bool profileOk = (profileLoopHits > 0) && (profileLoopHits == TargetProfiler::getTotalHits()) && profileEven &&
+                (strstr(profileTop, "[\"0003\",") != NULL) && (strstr(profileTop, "\"LD hl,08000H\"") != NULL);
+    testOk &= simCheck(profileOk, "Profiler counts instructions");
+    return testOk;
+}
+
+// Sampled profile - one sample after each display refresh with no other memory waits
+static bool testProfilerSampled(bool waitOnMemory)
+{
+    static const uint32_t PROFILE_SAMPLES = 5;
+    bool testOk = true;
+    BusAccess::waitOnMemory(_simBusSocket, false);
+    TargetProfiler::clear();
+    TargetProfiler::start(TargetProfiler::PROFILER_MODE_SAMPLED);
+    for (uint32_t i = 0; i < PROFILE_SAMPLES; i++)
+    {
+        BusAccess::targetReqBus(_simBusSocket, BR_BUS_ACTION_DISPLAY);
+        testOk &= simRunFor(5000);
+    }
+    bool sampleWaitsOff = !BusAccess::waitIsOnMemory();
+    TargetProfiler::stop();
+    BusAccess::waitOnMemory(_simBusSocket, waitOnMemory);
+    uint32_t profileSampleHits = 0;
+    for (int i = 0; i < PROFILE_LOOP_LEN; i++)
+        profileSampleHits += TargetProfiler::getHits(PROFILE_LOOP_ADDRS[i]);
+    char profileStatus[200];
+    TargetProfiler::getStatusJson(profileStatus, sizeof(profileStatus));
+    printf("profile sampled %s\n", profileStatus);
+    testOk &= simCheck((profileSampleHits == PROFILE_SAMPLES) && (TargetProfiler::getTotalHits() == PROFILE_SAMPLES) &&
+                sampleWaitsOff && (strstr(profileStatus, "\"sampleReqs\":5") != NULL), "Profiler samples on display refresh");
+    return testOk;
+}
+
+// Memory emulation - the processor runs from the Pi's mirror memory (through the HwManager page
+// map) with its own RAM paged out and the program page set as ROM (needs memory waits) - the
+// RAMROM hardware is left enabled for the tests using the mirror memory
+static bool testMemoryEmulation()
+{
+    static const uint32_t MEM_EMUL_RUN_US = 100000;
+    uint8_t* pTargetRAM = SimBoard::getTargetRAM();
+    HwManager::init();
+    HwManager::enableHw("RAMROM", true);
+    uint8_t* pMirrorMemory = HwManager::getMirrorMemForAddr(0);
+    memcpy(pMirrorMemory, pTargetRAM, STD_TARGET_MEMORY_LEN);
+    HwManager::memPageMapSet(0, sizeof(_testProgram), HW_MEM_PAGE_ROM);
+    HwManager::setMemoryEmulationMode(true);
+    uint8_t targetCounter = pTargetRAM[TEST_COUNTER_ADDR];
+    uint8_t mirrorCounter = pMirrorMemory[TEST_COUNTER_ADDR];
+    BusAccessStatusInfo emulStatusBefore, emulStatusAfter;
+    BusAccess::getStatus(emulStatusBefore);
+    uint32_t emulStartUs = micros();
+    bool testOk = simRunFor(MEM_EMUL_RUN_US);
+    uint32_t emulUs = micros() - emulStartUs;
+    BusAccess::getStatus(emulStatusAfter);
+    uint32_t emulMreqs = (emulStatusAfter.isrMREQRD + emulStatusAfter.isrMREQWR) -
+                (emulStatusBefore.isrMREQRD + emulStatusBefore.isrMREQWR);
+    testOk &= simCheck(!SimBoard::targetRAMEnabled() && (pTargetRAM[TEST_COUNTER_ADDR] == targetCounter) &&
+                (pMirrorMemory[TEST_COUNTER_ADDR] != mirrorCounter) && (pMirrorMemory[TEST_COUNTER_ADDR] == _simIOWriteLast) &&
+                (_simIOWriteErrors == 0), "Memory emulation from page map");
+    HwManager::setMemoryEmulationMode(false);
+    testOk &= simCheck(SimBoard::targetRAMEnabled(), "Memory emulation ended");
+    printf("memEmulation mreqPerSec %.0f\n", emulMreqs * 1000000.0 / emulUs);
+    return testOk;
+}
+
+// Instruction fetch flags for breakpoint checks
+static const uint32_t BP_M1_FLAGS = BR_CTRL_BUS_M1_MASK | BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_MREQ_MASK;
+
+// Breakpoints - the M1 check is a bitmap lookup so a full table costs the same as one
+static bool testBreakpoints()
+{
+    static const uint32_t BP_ADDR_STEP = 0x13;
+    static const uint32_t BP_CHECK_REPEATS = 100;
+    TargetBreakpoints* pBreakpoints = new TargetBreakpoints();
+    for (int i = 0; i < TargetBreakpoints::MAX_BREAKPOINTS; i++)
+    {
+        pBreakpoints->setBreakpointPCAddr(i, 0x1000 + i * BP_ADDR_STEP);
+        pBreakpoints->enableBreakpoint(i, true);
+    }
+    pBreakpoints->setBreakpointPCAddr(TargetBreakpoints::MAX_BREAKPOINTS - 1, 0x1000 + 5 * BP_ADDR_STEP);
+    pBreakpoints->setFastBreakpoint(0x0100, true);
+    uint32_t bpRetVal = 0;
+    uint32_t bpHits = 0;
+    uint32_t bpStartUs = micros();
+    for (uint32_t rep = 0; rep < BP_CHECK_REPEATS; rep++)
+        for (uint32_t addr = 0; addr < STD_TARGET_MEMORY_LEN; addr++)
+            bpHits += pBreakpoints->checkForBreak(addr, 0, BP_M1_FLAGS, bpRetVal) ? 1 : 0;
+    uint32_t bpUs = micros() - bpStartUs;
+    bool bpOk = (bpHits == TargetBreakpoints::MAX_BREAKPOINTS * BP_CHECK_REPEATS);
+    bpOk &= pBreakpoints->checkForBreak(0x1000 + 7 * BP_ADDR_STEP, 0, BP_M1_FLAGS, bpRetVal) &&
+                (pBreakpoints->getHitIndex() == 7);
+    bpOk &= !pBreakpoints->checkForBreak(0x1000 + 7 * BP_ADDR_STEP, 0, BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_MREQ_MASK, bpRetVal);
+    pBreakpoints->enableBreakpoint(5, false);
+    bpOk &= pBreakpoints->checkForBreak(0x1000 + 5 * BP_ADDR_STEP, 0, BP_M1_FLAGS, bpRetVal) &&
+                (pBreakpoints->getHitIndex() == TargetBreakpoints::MAX_BREAKPOINTS - 1);
+    pBreakpoints->enableBreakpoints(false);
+    bpOk &= !pBreakpoints->checkForBreak(0x1000, 0, BP_M1_FLAGS, bpRetVal);
+    bpOk &= pBreakpoints->checkForBreak(0x0100, 0, BP_M1_FLAGS, bpRetVal) && (pBreakpoints->getFastHitAddr() == 0x0100);
+    pBreakpoints->clearFastBreakpoints();
+    bpOk &= !pBreakpoints->checkForBreak(0x0100, 0, BP_M1_FLAGS, bpRetVal);
+    delete pBreakpoints;
+    printf("breakpoints %d checks %u in %u us\n", TargetBreakpoints::MAX_BREAKPOINTS,
+                STD_TARGET_MEMORY_LEN * BP_CHECK_REPEATS, bpUs);
+    return simCheck(bpOk, "Breakpoint bitmap lookup");
+}
+
+// Conditional breakpoints
+static bool testBreakpointConditions()
+{
+    static const uint32_t BP_COND_ADDR = 0x1234;
+    Z80Registers bpRegs;
+    bpRegs.HL = 0x4000;
+    bpRegs.IX = 0x5000;
+    bpRegs.AF = 0x12c5;
+    static uint8_t bpMemory[STD_TARGET_MEMORY_LEN];
+    bpMemory[0x5003] = 0xff;
+    BreakpointCondition bpCond;
+    bool bpCondOk = bpCond.compile("HL==4000h && b@(IX+3)==0xFF") && bpCond.evaluate(bpRegs, bpMemory, 1);
+    bpMemory[0x5003] = 0xfe;
+    bpCondOk &= !bpCond.evaluate(bpRegs, bpMemory, 1);
+    bpCondOk &= bpCond.compile("(A = $12 and F & 1) or peekw(HL) <> 0") && bpCond.evaluate(bpRegs, bpMemory, 1);
+    bpCondOk &= bpCond.compile("-1 == 0xffff && !(IX - 0x5000)") && bpCond.evaluate(bpRegs, bpMemory, 1);
+    bpCondOk &= !bpCond.compile("HL == ") && !bpCond.compile("FFh") && !bpCond.compile("b@(1+(2+(3+(4+(5+(6+(7+(8+(9+(10+(11+(12+13))))))))))))");
+    bpCondOk &= bpCond.compile("  ") && !bpCond.isSet() && bpCond.evaluate(bpRegs, NULL, 0);
+    TargetBreakpoints* pBreakpoints = new TargetBreakpoints();
+    pBreakpoints->setBreakpointPCAddr(3, BP_COND_ADDR);
+    pBreakpoints->enableBreakpoint(3, true);
+    bpCondOk &= pBreakpoints->setBreakpointCondition(3, "hits >= 500");
+    uint32_t bpRetVal = 0;
+    uint32_t bpCondHits = 0;
+    for (int i = 0; i < 600; i++)
+        if (pBreakpoints->checkForBreak(BP_COND_ADDR, 0, BP_M1_FLAGS, bpRetVal) && pBreakpoints->isHitDeferred() &&
+                    pBreakpoints->isHitConditionMet(bpRegs, bpMemory))
+            bpCondHits++;
+    bpCondOk &= (bpCondHits == 101);
+    delete pBreakpoints;
+    return simCheck(bpCondOk, "Breakpoint conditions");
+}
+
+// Tracepoints - snapshot registers and the bytes at (IX+3) on every other hit and stream them
+static bool testTracepoints()
+{
+    static const uint32_t TP_ADDR = 0x1234;
+    static const uint32_t TP_HITS = 10;
+    Z80Registers tpRegs;
+    tpRegs.IX = 0x5000;
+    static uint8_t tpMemory[STD_TARGET_MEMORY_LEN];
+    tpMemory[0x5003] = 0xa5;
+    TargetBreakpoints* pBreakpoints = new TargetBreakpoints();
+    pBreakpoints->setBreakpointPCAddr(3, TP_ADDR);
+    pBreakpoints->enableBreakpoint(3, true);
+    bool tpOk = pBreakpoints->setBreakpointCondition(3, "hits & 1") && pBreakpoints->setBreakpointTrace(3, true, "IX+3", 4);
+    TargetTracepoints* pTracepoints = new TargetTracepoints();
+    uint32_t bpRetVal = 0;
+    for (uint32_t i = 0; i < TP_HITS; i++)
+    {
+        tpRegs.BC = i;
+        if (pBreakpoints->checkForBreak(TP_ADDR, 0, BP_M1_FLAGS, bpRetVal) && pBreakpoints->isHitDeferred() &&
+                    pBreakpoints->isHitConditionMet(tpRegs, tpMemory) && pBreakpoints->isHitTracepoint())
+            pTracepoints->record(pBreakpoints->getHitIndex(), tpRegs, tpMemory,
+                        pBreakpoints->getHitTraceMemAddr(tpRegs, tpMemory), pBreakpoints->getHitTraceMemLen());
+    }
+    tpOk &= (pTracepoints->getCount() == TP_HITS / 2);
+    HostSimComms::getSentFrames().clear();
+    tpOk &= pTracepoints->sendFrame() && !pTracepoints->sendFrame();
+    std::vector<uint8_t>& tpFrame = HostSimComms::getSentFrames();
+    const char* pTpHeader = (const char*)tpFrame.data();
+    tpOk &= (strstr(pTpHeader, "\"cmdName\":\"tracepointData\"") != NULL) &&
+                (tpFrame.size() == strlen(pTpHeader) + 2 + (TP_HITS / 2) * sizeof(TracepointRec));
+    if (tpOk)
+    {
+        const TracepointRec* pTpRecs = (const TracepointRec*)(pTpHeader + strlen(pTpHeader) + 1);
+        for (uint32_t i = 0; i < TP_HITS / 2; i++)
+            tpOk &= (pTpRecs[i].bpIdx == 3) && (pTpRecs[i].BC == i * 2) && (pTpRecs[i].IX == 0x5000) &&
+                        (pTpRecs[i].memAddr == 0x5003) && (pTpRecs[i].memLen == 4) && (pTpRecs[i].mem[0] == 0xa5);
+    }
+    delete pTracepoints;
+    delete pBreakpoints;
+    return simCheck(tpOk, "Tracepoint snapshots streamed");
+}
+
+// A full frame of tracepoints fits the frame limit and the rest follow in the next frame
+static bool testTracepointFullFrame()
+{
+    static const uint32_t TP_EXTRA_RECS = 7;
+    Z80Registers tpRegs;
+    static uint8_t tpMemory[STD_TARGET_MEMORY_LEN];
+    TargetTracepoints* pTracepoints = new TargetTracepoints();
+    for (uint32_t i = 0; i < TargetTracepoints::MAX_RECS_PER_FRAME + TP_EXTRA_RECS; i++)
+    {
+        tpRegs.BC = i;
+        pTracepoints->record(3, tpRegs, tpMemory, 0x5003, 4);
+    }
+    HostSimComms::getSentFrames().clear();
+    bool tpFullOk = pTracepoints->sendFrame() && (pTracepoints->getCount() == TP_EXTRA_RECS);
+    std::vector<uint8_t>& tpFullFrame = HostSimComms::getSentFrames();
+    const char* pTpFullHeader = (const char*)tpFullFrame.data();
+    tpFullOk &= (strstr(pTpFullHeader, "\"first\":0,") != NULL) && (strstr(pTpFullHeader, "\"more\":7,") != NULL) &&
+                (tpFullFrame.size() == strlen(pTpFullHeader) + 2 + TargetTracepoints::MAX_RECS_PER_FRAME * sizeof(TracepointRec));
+    if (tpFullOk)
+    {
+        const TracepointRec* pTpRecs = (const TracepointRec*)(pTpFullHeader + strlen(pTpFullHeader) + 1);
+        tpFullOk &= (pTpRecs[0].BC == 0) && (pTpRecs[TargetTracepoints::MAX_RECS_PER_FRAME - 1].BC == TargetTracepoints::MAX_RECS_PER_FRAME - 1);
+    }
+    HostSimComms::getSentFrames().clear();
+    tpFullOk &= pTracepoints->sendFrame() && (pTracepoints->getCount() == 0);
+    pTpFullHeader = (const char*)tpFullFrame.data();
+    char tpFirstStr[30];
+    snprintf(tpFirstStr, sizeof(tpFirstStr), "\"first\":%d,", TargetTracepoints::MAX_RECS_PER_FRAME);
+    tpFullOk &= (strstr(pTpFullHeader, tpFirstStr) != NULL) &&
+                (tpFullFrame.size() == strlen(pTpFullHeader) + 2 + TP_EXTRA_RECS * sizeof(TracepointRec));
+    delete pTracepoints;
+    return simCheck(tpFullOk, "Tracepoint full frame within limit");
+}
+
+// Watchpoints - one stopping on writes to a range and one logging reads in the same page
+static bool testWatchpoints()
+{
+    static const uint32_t WP_CHECK_REPEATS = 100;
+    TargetWatchpoints* pWatchpoints = new TargetWatchpoints();
+    pWatchpoints->setWatchpoint(0, 0x4010, 0x10, WATCHPOINT_ACCESS_WRITE, false);
+    pWatchpoints->enableWatchpoint(0, true);
+    pWatchpoints->setWatchpoint(1, 0x4080, 2, WATCHPOINT_ACCESS_READ, true);
+    pWatchpoints->enableWatchpoint(1, true);
+    uint32_t wpRdFlags = BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_MREQ_MASK;
+    uint32_t wpWrFlags = BR_CTRL_BUS_WR_MASK | BR_CTRL_BUS_MREQ_MASK;
+    uint32_t wpStops = 0;
+    uint32_t wpStartUs = micros();
+    for (uint32_t rep = 0; rep < WP_CHECK_REPEATS; rep++)
+        for (uint32_t addr = 0; addr < STD_TARGET_MEMORY_LEN; addr++)
+            wpStops += pWatchpoints->checkForWatch(addr, 0, wpWrFlags, 0) ? 1 : 0;
+    uint32_t wpUs = micros() - wpStartUs;
+    bool wpOk = (wpStops == 0x10 * WP_CHECK_REPEATS) && (pWatchpoints->getHitCount(0) == 0x10 * WP_CHECK_REPEATS);
+    wpOk &= !pWatchpoints->checkForWatch(0x4010, 0, wpRdFlags, 0x100) && !pWatchpoints->checkForWatch(0x4020, 0, wpWrFlags, 0x100);
+    wpOk &= !pWatchpoints->checkForWatch(0x4081, 0x5a, wpRdFlags, 0x123) && (pWatchpoints->getHitCount(1) == 1);
+    char wpLogJson[200];
+    pWatchpoints->getLogJson(wpLogJson, sizeof(wpLogJson));
+    wpOk &= strstr(wpLogJson, "\"log\":[[1,16513,90,291,1]],\"more\":0") != NULL;
+    wpOk &= pWatchpoints->setWatchpointAtAddr(0x4010, 1, 0) && !pWatchpoints->checkForWatch(0x4010, 0, wpWrFlags, 0);
+    delete pWatchpoints;
+    printf("watchpoints checks %u in %u us\n", STD_TARGET_MEMORY_LEN * WP_CHECK_REPEATS, wpUs);
+    return simCheck(wpOk, "Watchpoint page filter and log");
+}
+
+// Register set injection - the snippet for only the changed registers must leave the processor
+// in the same state as the full one
+static bool testRegisterInjection()
+{
+    Z80Context injBaseCtx;
+    memset(&injBaseCtx, 0, sizeof(injBaseCtx));
+    injBaseCtx.R1.wr.AF = 0x12c5; injBaseCtx.R1.wr.BC = 0x2345; injBaseCtx.R1.wr.DE = 0x3456;
+    injBaseCtx.R1.wr.HL = 0x4567; injBaseCtx.R1.wr.IX = 0x5678; injBaseCtx.R1.wr.IY = 0x6789;
+    injBaseCtx.R1.wr.SP = 0xf000; injBaseCtx.R2.wr.AF = 0x789a; injBaseCtx.R2.wr.BC = 0x89ab;
+    injBaseCtx.R2.wr.DE = 0x9abc; injBaseCtx.R2.wr.HL = 0xabcd; injBaseCtx.PC = 0x1234;
+    injBaseCtx.I = 0x3f; injBaseCtx.R = 0x81; injBaseCtx.IM = 1; injBaseCtx.IFF1 = injBaseCtx.IFF2 = 1;
+    Z80Registers injGrabbed;
+    injGrabbed.PC = injBaseCtx.PC; injGrabbed.SP = injBaseCtx.R1.wr.SP; injGrabbed.AF = injBaseCtx.R1.wr.AF;
+    injGrabbed.BC = injBaseCtx.R1.wr.BC; injGrabbed.DE = injBaseCtx.R1.wr.DE; injGrabbed.HL = injBaseCtx.R1.wr.HL;
+    injGrabbed.IX = injBaseCtx.R1.wr.IX; injGrabbed.IY = injBaseCtx.R1.wr.IY; injGrabbed.AFDASH = injBaseCtx.R2.wr.AF;
+    injGrabbed.BCDASH = injBaseCtx.R2.wr.BC; injGrabbed.DEDASH = injBaseCtx.R2.wr.DE; injGrabbed.HLDASH = injBaseCtx.R2.wr.HL;
+    injGrabbed.I = injBaseCtx.I; injGrabbed.R = injBaseCtx.R; injGrabbed.INTMODE = 1; injGrabbed.INTENABLED = 1;
+    const uint32_t injMasks[] = {
+        0, Z80Registers::REG_MASK_PC, Z80Registers::REG_MASK_SP, Z80Registers::REG_MASK_HL, Z80Registers::REG_MASK_DE,
+        Z80Registers::REG_MASK_BC, Z80Registers::REG_MASK_AF, Z80Registers::REG_MASK_IX, Z80Registers::REG_MASK_IY,
+        Z80Registers::REG_MASK_HLDASH, Z80Registers::REG_MASK_DEDASH, Z80Registers::REG_MASK_BCDASH,
+        Z80Registers::REG_MASK_AFDASH, Z80Registers::REG_MASK_I, Z80Registers::REG_MASK_R,
+        Z80Registers::REG_MASK_INTMODE, Z80Registers::REG_MASK_INTENABLED,
+        Z80Registers::REG_MASK_HL | Z80Registers::REG_MASK_BCDASH | Z80Registers::REG_MASK_SP,
+        Z80Registers::REG_MASK_HL | Z80Registers::REG_MASK_DE | Z80Registers::REG_MASK_BC | Z80Registers::REG_MASK_DEDASH,
+        Z80Registers::REG_MASK_ALL };
+    const char* injSetNames[] = { "PC", "SP", "HL", "DE", "BC", "AF", "IX", "IY", "HL'", "DE'", "BC'", "AF'", "I", "R", "IM", "IFF" };
+    const uint32_t injSetVals[] = { 0x4321, 0xe000, 0x1111, 0x2222, 0x3333, 0x44d7, 0x5555, 0x6666,
+                0x7777, 0x8888, 0x9999, 0xaa00, 0x40, 0x7f, 2, 0 };
+    uint8_t injFullCode[TargetCPUZ80::MAX_INJECT_SET_REGS_LEN];
+    uint8_t injDeltaCode[TargetCPUZ80::MAX_INJECT_SET_REGS_LEN];
+    int injFullLen = 0;
+    int injPCOnlyLen = 0;
+    bool injOk = true;
+    for (uint32_t maskIdx = 0; maskIdx < sizeof(injMasks) / sizeof(injMasks[0]); maskIdx++)
+    {
+        Z80Registers injRegs = injGrabbed;
+        uint32_t setMask = 0;
+        for (uint32_t regIdx = 0; regIdx < sizeof(injSetNames) / sizeof(injSetNames[0]); regIdx++)
+            if (injMasks[maskIdx] & (1 << regIdx))
+                injOk &= injRegs.setByName(injSetNames[regIdx], injSetVals[regIdx], setMask);
+        injOk &= (setMask == injMasks[maskIdx]);
+        Z80Context injFullCtx = injBaseCtx;
+        injFullLen = TargetCPUZ80::getInjectToSetRegs(injRegs, injFullCode, sizeof(injFullCode));
+        injectRun(injFullCtx, injFullCode, injFullLen);
+        Z80Context injDeltaCtx = injBaseCtx;
+        int injDeltaLen = TargetCPUZ80::getInjectToSetRegs(injRegs, injDeltaCode, sizeof(injDeltaCode), setMask);
+        injectRun(injDeltaCtx, injDeltaCode, injDeltaLen);
+        if (injMasks[maskIdx] == Z80Registers::REG_MASK_PC)
+            injPCOnlyLen = injDeltaLen;
+        if (!injectMatchesRegs(injFullCtx, injRegs) || !injectMatchesRegs(injDeltaCtx, injRegs))
+        {
+            printf("register injection mismatch mask %04x\n", injMasks[maskIdx]);
+            injOk = false;
+        }
+    }
+    uint32_t injNameMask = 0;
+    Z80Registers injHalves;
+    injOk &= injHalves.setByName("a", 0x12, injNameMask) && injHalves.setByName("IXL", 0x34, injNameMask) &&
+                !injHalves.setByName("Q", 0, injNameMask);
+    injOk &= (injHalves.AF == 0x1200) && (injHalves.IX == 0x34) &&
+                (injNameMask == (Z80Registers::REG_MASK_AF | Z80Registers::REG_MASK_IX));
+    printf("setRegsInject full %d bytes pcOnly %d bytes\n", injFullLen, injPCOnlyLen);
+    return simCheck(injOk && (injPCOnlyLen < injFullLen), "Register set injection of changed registers");
+}
+
+// Shadow call stack - an IM1 interrupt is raised on reaching 0200 so the ISR is entered both by
+// the interrupt and by the RST 38
+static bool testCallStack()
+{
+    _pCallStack = new TargetCallStack();
+    memset(&_callStackCtx, 0, sizeof(_callStackCtx));
+    memcpy(_callStackMem, _callStackProgram, sizeof(_callStackProgram));
+    memcpy(_callStackMem + 0x0038, _callStackIsr, sizeof(_callStackIsr));
+    memcpy(_callStackMem + 0x0100, _callStackSub1, sizeof(_callStackSub1));
+    memcpy(_callStackMem + 0x0200, _callStackSub2, sizeof(_callStackSub2));
+    _callStackCtx.memRead = callStackMemRead;
+    _callStackCtx.memWrite = callStackMemWrite;
+    _callStackCtx.IM = 1;
+    _callStackCtx.IFF1 = _callStackCtx.IFF2 = 1;
+    bool callStackIntDone = false;
+    for (int i = 0; (i < 100) && !_callStackCtx.halted; i++)
+    {
+        if ((_callStackCtx.PC == 0x0200) && !callStackIntDone)
+        {
+            Z80INT(&_callStackCtx, 0xff);
+            callStackIntDone = true;
+        }
+        Z80Execute(&_callStackCtx);
+    }
+    bool callStackOk = (_callStackProbeCount == 5) &&
+            callStackProbeMatch(0, 0x0038, 3, 0x0200, CALL_STACK_FRAME_INT) &&
+            callStackProbeMatch(1, 0x0200, 2, 0x0105, CALL_STACK_FRAME_CALL) &&
+            callStackProbeMatch(2, 0x0038, 3, 0x0205, CALL_STACK_FRAME_CALL) &&
+            callStackProbeMatch(3, 0x0105, 1, 0x0006, CALL_STACK_FRAME_CALL) &&
+            callStackProbeMatch(4, 0x0006, 0, 0, 0);
+    char callStackJson[200];
+    _pCallStack->getJson(callStackJson, sizeof(callStackJson));
+    callStackOk &= (strcmp(callStackJson, "\"err\":\"ok\",\"depth\":0,\"frames\":[]") == 0);
+    delete _pCallStack;
+    return simCheck(callStackOk, "Shadow call stack from bus cycles");
+}
+
+// Execution history - stepping back through every checkpoint restores the memory and registers
+// and with a short log only the most recent checkpoints can be reached (needs the mirror memory)
+static bool testExecutionHistory()
+{
+    static const uint32_t HISTORY_SHORT_LOG_RECS = 40;
+    _pHistoryMem = HwManager::getMirrorMemForAddr(0);
+    if (!_pHistoryMem)
+        return true;
+    bool historyOk = true;
+    historyRun(TargetHistory::DEFAULT_LOG_RECS);
+    historyOk &= _historyCtx.halted && (_pHistoryMem[0x8900] == 6) && (_historySnapshotCount > 10);
+    int historySteps = historyStepBackAll(historyOk);
+    historyOk &= (historySteps == _historySnapshotCount - 1);
+    historyRun(HISTORY_SHORT_LOG_RECS);
+    int historyShortSteps = historyStepBackAll(historyOk);
+    historyOk &= (historyShortSteps > 0) && (historyShortSteps < historySteps);
+    TargetHistory::stop();
+    printf("history stepsBack %d shortLogStepsBack %d\n", historySteps, historyShortSteps);
+    return simCheck(historyOk, "Execution history step back");
+}
+
+// Disassembly cache - a repeated view is all hits and text matches a fresh decode, changing an
+// instruction's bytes or looking up an address sharing the entry decodes again
+static bool testDisasmCache()
+{
+    static const uint32_t DISASM_ADDR = 0x8000;
+    // Instructions in the history test program
+    static const uint32_t DISASM_NUM_INSTRS = 10;
+    static const int DISASM_REPEATS = 10;
+    TargetDisasmCache* pDisasmCache = new TargetDisasmCache();
+    uint8_t* pDisasmMem = new uint8_t[STD_TARGET_MEMORY_LEN + TargetDisasmCache::MAX_INSTR_LEN];
+    memset(pDisasmMem, 0, STD_TARGET_MEMORY_LEN + TargetDisasmCache::MAX_INSTR_LEN);
+    memcpy(pDisasmMem + DISASM_ADDR, _historyProgram, sizeof(_historyProgram));
+    bool disasmOk = true;
+    char disasmDirect[TargetDisasmCache::MAX_DISASSEMBLY_LEN];
+    uint32_t disasmMissesPerView = 0;
+    for (int rep = 0; rep <= DISASM_REPEATS; rep++)
+    {
+        // Change the second instruction (ld hl,8800 to ld hl,8801) on the last view
+        if (rep == DISASM_REPEATS)
+            pDisasmMem[DISASM_ADDR + 4] = 0x01;
+        uint32_t missesBefore = pDisasmCache->getMisses();
+        uint32_t addr = DISASM_ADDR;
+        for (uint32_t i = 0; i < DISASM_NUM_INSTRS; i++)
+        {
+            const char* pText = NULL;
+            int instrLen = pDisasmCache->disassemble(pDisasmMem, addr, pText);
+            int directLen = disasmZ80(pDisasmMem, 0, addr, disasmDirect, INTEL, false, true);
+            disasmOk &= (instrLen == directLen) && (strcmp(pText, disasmDirect) == 0);
+            addr += instrLen;
+        }
+        uint32_t viewMisses = pDisasmCache->getMisses() - missesBefore;
+        if (rep == 0)
+            disasmMissesPerView = viewMisses;
+        else
+            disasmOk &= (viewMisses == ((rep == DISASM_REPEATS) ? 1u : 0u));
+    }
+    const char* pDisasmText = NULL;
+    uint32_t disasmMissesBefore = pDisasmCache->getMisses();
+    pDisasmCache->disassemble(pDisasmMem, DISASM_ADDR + TargetDisasmCache::NUM_ENTRIES, pDisasmText);
+    pDisasmCache->disassemble(pDisasmMem, DISASM_ADDR, pDisasmText);
+    disasmOk &= (pDisasmCache->getMisses() == disasmMissesBefore + 2) && (disasmMissesPerView > 0);
+
+    // ld hl,1234 at 0xfffe wraps to address 0 - the byte after the 64K image must not be used and
+    // changing the wrapped byte decodes again
+    pDisasmMem[0xfffe] = 0x21;
+    pDisasmMem[0xffff] = 0x34;
+    pDisasmMem[0x0000] = 0x12;
+    pDisasmMem[STD_TARGET_MEMORY_LEN] = 0xaa;
+    int wrapLen = pDisasmCache->disassemble(pDisasmMem, 0xfffe, pDisasmText);
+    disasmOk &= (wrapLen == 3) && (strstr(pDisasmText, "1234") != NULL);
+    disasmMissesBefore = pDisasmCache->getMisses();
+    pDisasmCache->disassemble(pDisasmMem, 0xfffe, pDisasmText);
+    disasmOk &= (pDisasmCache->getMisses() == disasmMissesBefore);
+    pDisasmMem[0x0000] = 0x56;
+    pDisasmCache->disassemble(pDisasmMem, 0xfffe, pDisasmText);
+    disasmOk &= (pDisasmCache->getMisses() == disasmMissesBefore + 1) && (strstr(pDisasmText, "5634") != NULL);
+    printf("disasmCache hits %u misses %u\n", pDisasmCache->getHits(), pDisasmCache->getMisses());
+    delete [] pDisasmMem;
+    delete pDisasmCache;
+    return simCheck(disasmOk, "Disassembly cache");
+}
+
+// Memory changes - scattered writes, a block across pages, a byte rewritten with its own value
+// and whole pages (needing more than one frame) are pushed as page records which recreate the
+// memory, and writes after unsubscribing aren't pushed
+static bool testMemChanges()
+{
+    static const uint32_t MEM_CHANGES_FULL_PAGES_ADDR = 0x4000;
+    static const uint32_t MEM_CHANGES_FULL_PAGES_LEN = 0x4000;
+    // Pages 0x40-0x7f, 0x88, 0x90-0x92 and 0xff
+    static const uint32_t MEM_CHANGES_EXPECTED_PAGES = 0x40 + 1 + 3 + 1;
+    HostSimComms::getSentFrames().clear();
+    TargetMemChanges::subscribe();
+    uint8_t* pMemChangesMirror = HwManager::getMirrorMemForAddr(0);
+    if (pMemChangesMirror)
+        memcpy(_memChangesExpected, pMemChangesMirror, STD_TARGET_MEMORY_LEN);
+    else
+        memset(_memChangesExpected, 0, STD_TARGET_MEMORY_LEN);
+    memcpy(_memChangesApplied, _memChangesExpected, STD_TARGET_MEMORY_LEN);
+    memChangesWrite(0x8810, _memChangesExpected[0x8810] + 1);
+    memChangesWrite(0x8812, _memChangesExpected[0x8812] + 1);
+    memChangesWrite(0x8820, _memChangesExpected[0x8820] + 1);
+    memChangesWrite(0x88ff, _memChangesExpected[0x88ff] + 1);
+    for (uint32_t addr = 0x90f0; addr < 0x9201; addr++)
+        memChangesWrite(addr, _memChangesExpected[addr] ^ 0x5a);
+    memChangesWrite(0xa000, _memChangesExpected[0xa000]);
+    memChangesWrite(0xffff, _memChangesExpected[0xffff] + 1);
+    for (uint32_t addr = MEM_CHANGES_FULL_PAGES_ADDR; addr < MEM_CHANGES_FULL_PAGES_ADDR + MEM_CHANGES_FULL_PAGES_LEN; addr++)
+        memChangesWrite(addr, ~_memChangesExpected[addr]);
+    while (TargetMemChanges::sendFrame())
+        ;
+    TargetMemChanges::unsubscribe();
+    TargetMemChanges::handleBusCycle(0x8000, _memChangesExpected[0x8000] + 1, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    bool memChangesOk = !TargetMemChanges::sendFrame();
+    uint32_t memChangesFrames = 0;
+    uint32_t memChangesPages = memChangesApplyFrames(memChangesFrames);
+    uint32_t memChangesBytes = HostSimComms::getSentFrames().size();
+    memChangesOk &= (memChangesPages == MEM_CHANGES_EXPECTED_PAGES) && (memChangesFrames > 1) &&
+                (memcmp(_memChangesApplied, _memChangesExpected, STD_TARGET_MEMORY_LEN) == 0);
+    printf("memChanges frames %u pages %u bytes %u\n", memChangesFrames, memChangesPages, memChangesBytes);
+    return simCheck(memChangesOk, "Memory changes pushed by page");
+}
+
+// DZRP - a command arriving a byte at a time, a 64K memory read streamed in several frames
+// (wrapping at the top of memory), breakpoints added in the tracker's top slots until they run
+// out then removed and the pause notification when one is hit (needs the mirror memory)
+static bool testDzrp()
+{
+    static const uint32_t DZRP_READ_MEM_ADDR = 0x8000;
+    // LD A,(HL) in the test program loop
+    static const uint32_t DZRP_BP_ADDR = 0x0006;
+    static const uint32_t DZRP_UNUSED_BP_ADDR = 0x4000;
+    if (!HwManager::getMirrorMemForAddr(0))
+        return true;
+    DZRPHandler* pDzrp = new DZRPHandler();
+    HostSimComms::getSentFrames().clear();
+    _dzrpRx.clear();
+    static const uint8_t DZRP_INIT_PAYLOAD[] = { 2, 0, 0, 'h', 'o', 's', 't', 0 };
+    static const uint8_t DZRP_INIT_RESP[] = { 0, 1, 6, 0, 0, 'B', 'u', 's', 'R', 'a', 'i', 'd', 'e', 'r', 0 };
+    dzrpSendCmd(*pDzrp, 1, DZRPHandler::DZRP_CMD_INIT, DZRP_INIT_PAYLOAD, sizeof(DZRP_INIT_PAYLOAD), 1);
+    bool dzrpOk = (dzrpCollect() == 1) && dzrpCheckResp(1, DZRP_INIT_RESP, sizeof(DZRP_INIT_RESP)) && _dzrpRx.empty();
+    bool testOk = simCheck(dzrpOk, "DZRP message split across frames");
+
+    // Read all of memory (with the bus held as it is when the target is paused)
+    static const uint8_t DZRP_READ_MEM_PAYLOAD[] = { 0, DZRP_READ_MEM_ADDR & 0xff, DZRP_READ_MEM_ADDR >> 8, 0, 0 };
+    dzrpOk = BusAccess::controlRequestAndTake() == BR_OK;
+    dzrpSendCmd(*pDzrp, 2, DZRPHandler::DZRP_CMD_READ_MEM, DZRP_READ_MEM_PAYLOAD, sizeof(DZRP_READ_MEM_PAYLOAD), 1000);
+    pDzrp->service();
+    BusAccess::controlRelease();
+    uint32_t dzrpReadFrames = dzrpCollect();
+    uint8_t* pTargetRAM = SimBoard::getTargetRAM();
+    std::vector<uint8_t> dzrpMemExpected(DZRPHandler::DZRP_MAX_MEM_LEN);
+    for (uint32_t i = 0; i < DZRPHandler::DZRP_MAX_MEM_LEN; i++)
+        dzrpMemExpected[i] = pTargetRAM[(DZRP_READ_MEM_ADDR + i) % DZRPHandler::DZRP_MAX_MEM_LEN];
+    dzrpOk &= (dzrpReadFrames > 1) && dzrpCheckResp(2, dzrpMemExpected.data(), DZRPHandler::DZRP_MAX_MEM_LEN) && _dzrpRx.empty();
+    testOk &= simCheck(dzrpOk, "DZRP 64K memory read streamed");
+    printf("dzrp readMem64K frames %u\n", dzrpReadFrames);
+
+    // Fill the breakpoint slots, free one and add it again then close to remove them all
+    dzrpOk = true;
+    for (int i = 0; i <= DZRPHandler::DZRP_MAX_BREAKPOINTS; i++)
+    {
+        uint8_t bpPayload[] = { (uint8_t)(DZRP_UNUSED_BP_ADDR + i), (uint8_t)((DZRP_UNUSED_BP_ADDR + i) >> 8), 0 };
+        dzrpSendCmd(*pDzrp, 3, DZRPHandler::DZRP_CMD_ADD_BREAKPOINT, bpPayload, sizeof(bpPayload), sizeof(bpPayload) + 6);
+        uint8_t bpIdExpected[] = { (uint8_t)((i < DZRPHandler::DZRP_MAX_BREAKPOINTS) ? i + 1 : 0), 0 };
+        dzrpCollect();
+        dzrpOk &= dzrpCheckResp(3, bpIdExpected, sizeof(bpIdExpected));
+    }
+    static const uint8_t DZRP_BP_ID_5[] = { 5, 0 };
+    static const uint8_t DZRP_BP_PAYLOAD[] = { DZRP_BP_ADDR & 0xff, DZRP_BP_ADDR >> 8, 0 };
+    dzrpSendCmd(*pDzrp, 4, DZRPHandler::DZRP_CMD_REMOVE_BREAKPOINT, DZRP_BP_ID_5, sizeof(DZRP_BP_ID_5), 100);
+    dzrpSendCmd(*pDzrp, 5, DZRPHandler::DZRP_CMD_ADD_BREAKPOINT, DZRP_BP_PAYLOAD, sizeof(DZRP_BP_PAYLOAD), 100);
+    dzrpCollect();
+    dzrpOk &= dzrpCheckResp(4, NULL, 0) && dzrpCheckResp(5, DZRP_BP_ID_5, sizeof(DZRP_BP_ID_5));
+
+    // Continue to the breakpoint - hit in the slot for id 5
+    static const uint8_t DZRP_PAUSE_NTF[] = { DZRPHandler::DZRP_BREAK_REASON_BREAKPOINT_HIT,
+                DZRP_BP_ADDR & 0xff, DZRP_BP_ADDR >> 8, 0, 0 };
+    dzrpSendCmd(*pDzrp, 6, DZRPHandler::DZRP_CMD_CONTINUE, NULL, 0, 100);
+    TargetTracker::service();
+    pDzrp->service();
+    dzrpCollect();
+    dzrpOk &= dzrpCheckResp(6, NULL, 0) && dzrpCheckResp(0, DZRP_PAUSE_NTF, sizeof(DZRP_PAUSE_NTF), DZRPHandler::DZRP_NTF_PAUSE) &&
+                (_hostTrackerHitIdx == TargetBreakpoints::MAX_BREAKPOINTS - DZRPHandler::DZRP_MAX_BREAKPOINTS + 4);
+
+    // Removed breakpoints aren't hit
+    dzrpSendCmd(*pDzrp, 7, DZRPHandler::DZRP_CMD_REMOVE_BREAKPOINT, DZRP_BP_ID_5, sizeof(DZRP_BP_ID_5), 100);
+    dzrpSendCmd(*pDzrp, 8, DZRPHandler::DZRP_CMD_CLOSE, NULL, 0, 100);
+    dzrpSendCmd(*pDzrp, 9, DZRPHandler::DZRP_CMD_CONTINUE, NULL, 0, 100);
+    TargetTracker::service();
+    pDzrp->service();
+    dzrpCollect();
+    dzrpOk &= dzrpCheckResp(7, NULL, 0) && dzrpCheckResp(8, NULL, 0) && dzrpCheckResp(9, NULL, 0) &&
+                _dzrpRx.empty() && !TargetTracker::isStepPaused();
+    testOk &= simCheck(dzrpOk, "DZRP breakpoints in the top slots and pause notification");
+    delete pDzrp;
+    return testOk;
+}
+
+// Memory written by the debugger (a DZRP WRITE_MEM) and restored by stepping back through the
+// execution history is pushed as memory changes (needs the mirror memory)
+static bool testMemChangesFromDebugger()
+{
+    static const uint32_t DZRP_WRITE_MEM_ADDR = 0x9a00;
+    static const uint8_t DZRP_WRITE_MEM_PAYLOAD[] = { 0, DZRP_WRITE_MEM_ADDR & 0xff, DZRP_WRITE_MEM_ADDR >> 8,
+                0x12, 0x34, 0x56, 0x78 };
+    if (!HwManager::getMirrorMemForAddr(0))
+        return true;
+    DZRPHandler* pDzrp = new DZRPHandler();
+    HostSimComms::getSentFrames().clear();
+    TargetMemChanges::subscribe();
+    memcpy(_memChangesApplied, HwManager::getMirrorMemForAddr(0), STD_TARGET_MEMORY_LEN);
+    bool memWritesOk = BusAccess::controlRequestAndTake() == BR_OK;
+    dzrpSendCmd(*pDzrp, 10, DZRPHandler::DZRP_CMD_WRITE_MEM, DZRP_WRITE_MEM_PAYLOAD, sizeof(DZRP_WRITE_MEM_PAYLOAD), 100);
+    BusAccess::controlRelease();
+    _pHistoryMem = HwManager::getMirrorMemForAddr(0);
+    historyRun(TargetHistory::DEFAULT_LOG_RECS);
+    Z80Registers memWritesRegs;
+    memWritesOk &= TargetHistory::rollBack(memWritesRegs) && TargetHistory::rollBack(memWritesRegs);
+    TargetHistory::stop();
+    while (TargetMemChanges::sendFrame())
+        ;
+    TargetMemChanges::unsubscribe();
+    uint32_t memWritesFrames = 0;
+    memChangesApplyFrames(memWritesFrames);
+    memWritesOk &= (memcmp(_memChangesApplied + DZRP_WRITE_MEM_ADDR, DZRP_WRITE_MEM_PAYLOAD + 3, sizeof(DZRP_WRITE_MEM_PAYLOAD) - 3) == 0) &&
+                (memcmp(_memChangesApplied + HISTORY_DATA_ADDR, _pHistoryMem + HISTORY_DATA_ADDR, HISTORY_DATA_LEN) == 0);
+    delete pDzrp;
+    return simCheck(memWritesOk, "Memory changes from debugger writes and step back");
+}
+
+// Trace stream - every cycle is encoded into frames (sent as they fill as the tracer's service
+// would) in well under the 5 bytes per cycle of the snapshot format with a register checkpoint
+// every few hundred instructions (for validation) - pTraceMemFile gets the memory at the start
+static bool testTraceStream(const char* pTraceFile, const char* pTraceRefFile, const char* pTraceMemFile)
+{
+    static const uint32_t TRACE_STREAM_CYCLES = 100000;
+    static const uint32_t TRACE_CHECKPOINT_INTERVAL = 500;
+    HostSimComms::getSentFrames().clear();
+    _pTraceEncoder = new TraceStreamEncoder();
+    _pTraceRefFile = pTraceRefFile ? fopen(pTraceRefFile, "w") : NULL;
+    if (_pTraceRefFile)
+        fprintf(_pTraceRefFile, "cycle,addr,data,retData,rd,wr,mreq,iorq,m1\n");
+    memset(&_traceCtx, 0, sizeof(_traceCtx));
+    memset(_traceMem, 0, sizeof(_traceMem));
+    memcpy(_traceMem, _traceProgram, sizeof(_traceProgram));
+    memcpy(_traceMem + TRACE_SUB_ADDR, _traceSub, sizeof(_traceSub));
+    for (uint32_t i = 0; i < 0x40; i++)
+        _traceMem[0x1000 + i] = i * 7;
+    _traceCtx.memRead = traceMemRead;
+    _traceCtx.memWrite = traceMemWrite;
+    _traceCtx.ioRead = traceIORead;
+    _traceCtx.ioWrite = traceIOWrite;
+    if (pTraceMemFile)
+    {
+        FILE* pFile = fopen(pTraceMemFile, "wb");
+        if (pFile)
+        {
+            fwrite(_traceMem, 1, sizeof(_traceMem), pFile);
+            fclose(pFile);
+        }
+    }
+    _traceCycles = 0;
+    for (uint32_t instrIdx = 0; _traceCycles < TRACE_STREAM_CYCLES; instrIdx++)
+    {
+        if ((instrIdx != 0) && (instrIdx % TRACE_CHECKPOINT_INTERVAL == 0))
+        {
+            Z80Registers regs;
+            traceGetRegs(regs);
+            _pTraceEncoder->encodeCheckpoint(regs);
+        }
+        Z80Execute(&_traceCtx);
+        _pTraceEncoder->sendFrame();
+    }
+    _pTraceEncoder->flush();
+    while (_pTraceEncoder->sendFrame())
+        ;
+    if (_pTraceRefFile)
+        fclose(_pTraceRefFile);
+    uint32_t traceFrames = 0;
+    uint32_t traceFrameRecs = 0;
+    std::vector<uint8_t>& traceFrameBuf = HostSimComms::getSentFrames();
+    for (uint32_t pos = 0; pos < traceFrameBuf.size(); )
+    {
+        const char* pHeader = (const char*)traceFrameBuf.data() + pos;
+        const char* pRecs = strstr(pHeader, "\"recs\":");
+        const char* pDataLen = strstr(pHeader, "\"dataLen\":");
+        traceFrameRecs += pRecs ? strtoul(pRecs + strlen("\"recs\":"), NULL, 10) : 0;
+        pos += strlen(pHeader) + 1 + (pDataLen ? strtoul(pDataLen + strlen("\"dataLen\":"), NULL, 10) : 0) + 1;
+        traceFrames++;
+    }
+    double traceBytesPerCycle = (double)_pTraceEncoder->getBytesEncoded() / _traceCycles;
+    bool traceOk = (_pTraceEncoder->getCycleCount() == _traceCycles) && (_pTraceEncoder->getOverflows() == 0) &&
+                (traceFrameRecs == _traceCycles) && (traceFrames > 1) && (traceBytesPerCycle < 3.0) &&
+                (_pTraceEncoder->getCheckpointCount() > 0);
+    if (pTraceFile)
+    {
+        FILE* pFile = fopen(pTraceFile, "wb");
+        if (pFile)
+        {
+            fwrite(traceFrameBuf.data(), 1, traceFrameBuf.size(), pFile);
+            fclose(pFile);
+        }
+        traceOk &= (pFile != NULL);
+    }
+    delete _pTraceEncoder;
+    printf("traceStream cycles %u frames %u bytesPerCycle %.2f\n", _traceCycles, traceFrames, traceBytesPerCycle);
+    return simCheck(traceOk, "Trace stream encoded");
+}
+
+// Cycle model - every table entry then the order of a DDCB instruction, EX (SP),HL and index
+// prefixes on opcodes without an index form (keeping the prefixed opcode index for the stats)
+static bool testCycleModel()
+{
+    static const uint8_t PREFIX_CB[] = { 0xcb };
+    static const uint8_t PREFIX_ED[] = { 0xed };
+    static const uint8_t PREFIX_DD[] = { 0xdd };
+    static const uint8_t PREFIX_FD[] = { 0xfd };
+    static const uint8_t PREFIX_DDCB[] = { 0xdd, 0xcb };
+    static const uint8_t PREFIX_FDCB[] = { 0xfd, 0xcb };
+    uint32_t cycleModelEntries = 0;
+    int cycleModelFails = cycleModelCheckTable(Z80CycleModel::TABLE_MAIN, z80CycleTable_MAIN, NULL, 0, false, cycleModelEntries);
+    cycleModelFails += cycleModelCheckTable(Z80CycleModel::TABLE_CB, z80CycleTable_CB, PREFIX_CB, 1, false, cycleModelEntries);
+    cycleModelFails += cycleModelCheckTable(Z80CycleModel::TABLE_ED, z80CycleTable_ED, PREFIX_ED, 1, false, cycleModelEntries);
+    cycleModelFails += cycleModelCheckTable(Z80CycleModel::TABLE_DD, z80CycleTable_DD, PREFIX_DD, 1, false, cycleModelEntries);
+    cycleModelFails += cycleModelCheckTable(Z80CycleModel::TABLE_FD, z80CycleTable_FD, PREFIX_FD, 1, false, cycleModelEntries);
+    cycleModelFails += cycleModelCheckTable(Z80CycleModel::TABLE_DDCB, z80CycleTable_DDCB, PREFIX_DDCB, 2, true, cycleModelEntries);
+    cycleModelFails += cycleModelCheckTable(Z80CycleModel::TABLE_FDCB, z80CycleTable_FDCB, PREFIX_FDCB, 2, true, cycleModelEntries);
+    static const uint32_t M1_RD = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | BR_CTRL_BUS_M1_MASK;
+    static const uint32_t MEM_RD = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK;
+    static const uint32_t MEM_WR = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK;
+    // rlc (ix+4)
+    static const uint8_t DDCB_INSTR[] = { 0xdd, 0xcb, 0x04, 0x06 };
+    static const uint32_t DDCB_CYCLES[] = { 0x0100, M1_RD, 0x0101, M1_RD, 0x0102, MEM_RD, 0x0103, MEM_RD,
+                0x5004, MEM_RD, 0x5004, MEM_WR };
+    // ex (sp),hl
+    static const uint8_t EX_SP_INSTR[] = { 0xe3 };
+    static const uint32_t EX_SP_CYCLES[] = { 0x0100, M1_RD, 0x8000, MEM_RD, 0x8001, MEM_RD, 0x8001, MEM_WR, 0x8000, MEM_WR };
+    bool cycleOrderOk = cycleModelCheckOrder(DDCB_INSTR, sizeof(DDCB_INSTR), DDCB_CYCLES, sizeof(DDCB_CYCLES) / 8) &&
+                cycleModelCheckOrder(EX_SP_INSTR, sizeof(EX_SP_INSTR), EX_SP_CYCLES, sizeof(EX_SP_CYCLES) / 8);
+    // ld (de),a and ld a,4 with a redundant prefix as a real Z80 makes them (libz80 runs the prefix
+    // and opcode as a NOP so these are given directly)
+    static const Z80BusCycle DD_LD_DE_A_ACCESSES[] = { { 0x0100, 0xdd, M1_RD }, { 0x0101, 0x12, M1_RD }, { 0x7000, 0x00, MEM_WR } };
+    static const Z80BusCycle FD_LD_A_N_ACCESSES[] = { { 0x0100, 0xfd, M1_RD }, { 0x0101, 0x3e, M1_RD }, { 0x0102, 0x04, MEM_RD } };
+    Z80BusCycle prefixCycles[Z80CycleModel::MAX_ACCESSES];
+    cycleOrderOk &= (Z80CycleModel::orderCycles(DD_LD_DE_A_ACCESSES, 3, prefixCycles) == 0) &&
+                (prefixCycles[2].flags == MEM_WR) &&
+                (Z80CycleModel::getOpcodeIdx(DD_LD_DE_A_ACCESSES, 3) == Z80CycleModel::TABLE_DD * 256 + 0x12);
+    cycleOrderOk &= (Z80CycleModel::orderCycles(FD_LD_A_N_ACCESSES, 3, prefixCycles) == 0) &&
+                (prefixCycles[1].flags == M1_RD) && (prefixCycles[2].flags == MEM_RD) &&
+                (Z80CycleModel::getOpcodeIdx(FD_LD_A_N_ACCESSES, 3) == Z80CycleModel::TABLE_FD * 256 + 0x3e);
+    printf("cycleModel entries %u fails %d orderOk %d\n", cycleModelEntries, cycleModelFails, cycleOrderOk);
+    return simCheck((cycleModelEntries > 1000) && (cycleModelFails == 0) && cycleOrderOk, "Cycle model orders libz80 accesses");
+}
+
+// Wait hold time is recorded for every wait handled (the last may still be held when the run
+// stops) and no wait is released before its handler returns - run last as the status includes
+// the waits of all the other tests
+static bool testWaitHoldHistogram()
+{
+    BusAccessStatusInfo statusInfo;
+    BusAccess::getStatus(statusInfo);
+    uint32_t waitsNotReleased = statusInfo.isrHist.total() - statusInfo.waitHist.total();
+    bool waitHistOk = (statusInfo.waitHist.total() > 0) && (waitsNotReleased <= 1);
+    uint32_t waitHistCum = 0;
+    uint32_t isrHistCum = 0;
+    for (int i = 0; i < BusLatencyHistogram::NUM_BUCKETS; i++)
+    {
+        waitHistCum += statusInfo.waitHist.counts[i];
+        isrHistCum += statusInfo.isrHist.counts[i];
+        waitHistOk &= (waitHistCum <= isrHistCum);
+    }
+    printf("status {%s}\n", statusInfo.getJson());
+    printf("latency {%s}\n", statusInfo.getLatencyJson());
+    return simCheck(waitHistOk, "Wait hold time histogram");
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Main
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+    // Args
+    uint32_t runMs = 1000;
+    bool waitOnMemory = true;
+    bool waitOnIO = true;
+    const char* pCaptureFile = NULL;
+    const char* pTraceFile = NULL;
+    const char* pTraceRefFile = NULL;
+    const char* pTraceMemFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+            runMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-nomem") == 0)
+            waitOnMemory = false;
+        else if (strcmp(argv[i], "-noio") == 0)
+            waitOnIO = false;
+        else if ((strcmp(argv[i], "-capture") == 0) && (i + 1 < argc))
+            pCaptureFile = argv[++i];
+        else if ((strcmp(argv[i], "-trace") == 0) && (i + 1 < argc))
+            pTraceFile = argv[++i];
+        else if ((strcmp(argv[i], "-traceref") == 0) && (i + 1 < argc))
+            pTraceRefFile = argv[++i];
+        else if ((strcmp(argv[i], "-tracemem") == 0) && (i + 1 < argc))
+            pTraceMemFile = argv[++i];
+        else
+        {
+            printf("Usage: %s [-t runMs] [-nomem] [-noio] [-capture file] [-trace file] [-traceref file] [-tracemem file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Logging
+    LogSetLevel(LOG_NOTICE);
+    LogSetOutFn(simLogOut);
+
+    // Board and processor
+    SimBoard::init();
+    SimBoard::setPiServiceFn(simPiService);
+    memcpy(SimBoard::getTargetRAM(), _testProgram, sizeof(_testProgram));
+    SimZ80::init();
+
+    // Bus access
+    BusAccess::init();
+    BusAccess::setHwVersion(20);
+    BusAccess::busAccessReset();
+    _simBusSocket = BusAccess::busSocketAdd(_simBusSocketInfo);
+    _simBusSocket2 = BusAccess::busSocketAdd(_simBusSocketInfo2);
+    BusAccess::waitOnMemory(_simBusSocket, waitOnMemory);
+    BusAccess::waitOnIO(_simBusSocket, waitOnIO);
+    BusAccess::ioPortHandlerAdd(0xff, TEST_OUT_PORT, BR_BUS_CYCLE_IORQ_WR_MASK, simIOPortOutHandler, NULL);
+    BusAccess::ioPortHandlerAdd(0xff, TEST_IN_PORT, BR_BUS_CYCLE_IORQ_RD_MASK, simIOPortInHandler, NULL);
+    BusAccess::clearStatus();
+
+    // Tests (in this order as the block tests share the block data, the tests using the mirror
+    // memory need the memory emulation test to have enabled the RAMROM hardware and the histogram
+    // covers the waits of all the others)
+    bool testOk = testWaitPath(runMs, waitOnMemory, waitOnIO);
+    testOk &= testBlockAccess();
+    testOk &= testHwVersionBlockRead();
+    testOk &= testBurstTransfers();
+    testOk &= testBlockAccessVector();
+    testOk &= testBusRqCoalesced();
+    testOk &= testBusRqFailure();
+    testOk &= testBusCapture(pCaptureFile);
+    testOk &= testProfilerCount();
+    testOk &= testProfilerSampled(waitOnMemory);
+    if (waitOnMemory)
+        testOk &= testMemoryEmulation();
+    testOk &= testBreakpoints();
+    testOk &= testBreakpointConditions();
+    testOk &= testTracepoints();
+    testOk &= testTracepointFullFrame();
+    testOk &= testWatchpoints();
+    testOk &= testRegisterInjection();
+    testOk &= testCallStack();
+    testOk &= testExecutionHistory();
+    testOk &= testDisasmCache();
+    testOk &= testMemChanges();
+    testOk &= testDzrp();
+    testOk &= testMemChangesFromDebugger();
+    testOk &= testTraceStream(pTraceFile, pTraceRefFile, pTraceMemFile);
+    testOk &= testCycleModel();
+    testOk &= testWaitHoldHistogram();
+    printf("%s\n", testOk ? "OK" : "FAILED");
+    return testOk ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+// Bus Raider Host Simulation
+// Host versions of the low-level library functions (see System/lowlib.cpp and System/lowlev.S)
+// Rob Dobson 2019
+
+#include <chrono>
+#include <limits.h>
+#include <string.h>
+#include "../src/System/lowlib.h"
+#include "../src/System/lowlev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const std::chrono::steady_clock::time_point __hostSimStartTime = std::chrono::steady_clock::now();
+
+uint32_t micros()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - __hostSimStartTime).count();
+}
+
+uint32_t millis()
+{
+    return micros() / 1000;
+}
+
+void microsDelay(uint32_t us)
+{
+    uint32_t timeNow = micros();
+    while (!isTimeout(micros(), timeNow, us)) {
+        // Do nothing
+    }
+}
+
+int isTimeout(unsigned long curTime, unsigned long lastTime, unsigned long maxDuration)
+{
+    // Times are 32 bit on the Pi
+    curTime &= 0xffffffff;
+    lastTime &= 0xffffffff;
+    if (curTime >= lastTime) {
+        return curTime > lastTime + maxDuration;
+    }
+    return ((UINT_MAX - lastTime) + curTime) > maxDuration;
+}
+
+uint32_t timeToTimeout(unsigned long curTime, unsigned long lastTime, unsigned long maxDuration)
+{
+    curTime &= 0xffffffff;
+    lastTime &= 0xffffffff;
+    if (curTime >= lastTime)
+    {
+        if (curTime > lastTime + maxDuration)
+        {
+            return 0;
+        }
+        return maxDuration - (curTime - lastTime);
+    }
+    if (UINT_MAX - (lastTime - curTime) > maxDuration)
+    {
+        return 0;
+    }
+    return maxDuration - (UINT_MAX - (lastTime - curTime));
+}
+
+// Machine cycle delays are only needed for settling of real hardware
+void lowlev_cycleDelay([[maybe_unused]] unsigned int cycles)
+{
+}
+
+// Cycle counter ticks are nanoseconds on the host
+void lowlev_cycleCounterEnable()
+{
+}
+
+uint32_t lowlev_cycleCounterRead()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - __hostSimStartTime).count();
+}
+
+size_t strlcpy(char * dst, const char * src, size_t dsize)
+{
+    size_t srcLen = strlen(src);
+    if (dsize != 0)
+    {
+        size_t copyLen = (srcLen >= dsize) ? dsize - 1 : srcLen;
+        memcpy(dst, src, copyLen);
+        dst[copyLen] = 0;
+    }
+    return srcLen;
+}
+
+void *memcopyfast(void *pDest, const void *pSrc, uint32_t nLength)
+{
+    return memcpy(pDest, pSrc, nLength);
+}
+
+size_t strlcat(char * dst, const char * src, size_t maxlen)
+{
+    size_t dstLen = strnlen(dst, maxlen);
+    if (dstLen == maxlen)
+        return maxlen + strlen(src);
+    return dstLen + strlcpy(dst + dstLen, src, maxlen - dstLen);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,487 @@
+// Bus Raider Host Simulation
+// Simulated BCM2835 peripheral registers and BusRaider V2.0 bus hardware
+// Rob Dobson 2019
+
+#include <string.h>
+#include "SimBoard.h"
+#include "../src/System/BCM2835.h"
+#include "../src/TargetBus/BusAccess.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Registers
+uint32_t SimBoard::_periphRegs[PERIPH_REG_COUNT];
+uint32_t SimBoard::_gpioOutLatch = 0;
+uint32_t SimBoard::_gpioOutMask = 0;
+uint32_t SimBoard::_pwmFifoChannel = 0;
+
+// Pi service function
+SimPiServiceFnType* SimBoard::_pPiServiceFn = NULL;
+
+// Processor pins
+bool SimBoard::_z80Mreq = false;
+bool SimBoard::_z80Iorq = false;
+bool SimBoard::_z80Rd = false;
+bool SimBoard::_z80Wr = false;
+bool SimBoard::_z80M1 = false;
+uint32_t SimBoard::_z80Addr = 0;
+uint8_t SimBoard::_z80Data = 0;
+bool SimBoard::_z80CycleActive = false;
+SimBoard::Z80_CYCLE_TYPE SimBoard::_z80CycleType = Z80_CYCLE_MEM_RD;
+uint8_t SimBoard::_z80CycleReadData = 0;
+bool SimBoard::_z80BusAck = false;
+bool SimBoard::_busAckWithheld = false;
+
+// Board state
+bool SimBoard::_waitMreqFF = false;
+bool SimBoard::_waitIorqFF = false;
+bool SimBoard::_dataOutputEnFF = false;
+uint32_t SimBoard::_lowAddrCounter = 0;
+uint32_t SimBoard::_lowAddrOut = 0;
+uint32_t SimBoard::_highAddrShift = 0;
+uint32_t SimBoard::_highAddrOut = 0;
+
+// Previous levels
+int SimBoard::_prevMuxActive = -1;
+bool SimBoard::_prevHaddrCk = false;
+bool SimBoard::_prevMreqLow = false;
+bool SimBoard::_prevIorqLow = false;
+bool SimBoard::_prevWaitLow = false;
+
+// Target RAM
+uint8_t SimBoard::_targetRAM[0x10000];
+
+// Stall
+bool SimBoard::_stalled = false;
+
+// Stats
+uint32_t SimBoard::_busCycleCount = 0;
+uint32_t SimBoard::_waitCycleCount = 0;
+uint32_t SimBoard::_busAckCount = 0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Register file access from the Pi side
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static inline uint32_t regIdx(uint32_t addr)
+{
+    return (addr - ARM_IO_BASE) / 4;
+}
+
+extern "C" uint32_t hostSimRD32(uint32_t addr)
+{
+    return SimBoard::regRead(addr);
+}
+
+extern "C" void hostSimWR32(uint32_t addr, uint32_t val)
+{
+    SimBoard::regWrite(addr, val);
+}
+
+void SimBoard::init()
+{
+    memset(_periphRegs, 0, sizeof(_periphRegs));
+    _gpioOutLatch = 0;
+    _gpioOutMask = 0;
+    _pwmFifoChannel = 0;
+    _z80Mreq = _z80Iorq = _z80Rd = _z80Wr = _z80M1 = false;
+    _z80Addr = 0;
+    _z80Data = 0;
+    _z80CycleActive = false;
+    _z80CycleReadData = 0;
+    _z80BusAck = false;
+    _busAckWithheld = false;
+    _waitMreqFF = _waitIorqFF = _dataOutputEnFF = false;
+    _lowAddrCounter = _lowAddrOut = 0;
+    _highAddrShift = _highAddrOut = 0;
+    _prevMuxActive = -1;
+    _prevHaddrCk = _prevMreqLow = _prevIorqLow = _prevWaitLow = false;
+    memset(_targetRAM, 0, sizeof(_targetRAM));
+    _stalled = false;
+    _busCycleCount = _waitCycleCount = _busAckCount = 0;
+}
+
+uint32_t SimBoard::regRead(uint32_t addr)
+{
+    if ((addr < ARM_IO_BASE) || (addr > ARM_IO_END))
+        return 0;
+    switch (addr)
+    {
+        case ARM_GPIO_GPLEV0:
+            // Once WAIT has been released the processor completes its cycle
+            if (_z80CycleActive && !_z80BusAck && !waitLow())
+                z80EndCycle();
+            return gpioLevels();
+        case ARM_PWM_STA:
+            // FIFO never full
+            return 0;
+        case ARM_CM_GP0CTL:
+        case ARM_CM_PWMCTL:
+            return _periphRegs[regIdx(addr)] & ~ARM_CM_CTL_BUSY;
+        default:
+            return _periphRegs[regIdx(addr)];
+    }
+}
+
+void SimBoard::regWrite(uint32_t addr, uint32_t val)
+{
+    if ((addr < ARM_IO_BASE) || (addr > ARM_IO_END))
+        return;
+    switch (addr)
+    {
+        case ARM_GPIO_GPSET0:
+            _gpioOutLatch |= val;
+            break;
+        case ARM_GPIO_GPCLR0:
+            _gpioOutLatch &= ~val;
+            break;
+        case ARM_GPIO_GPFSEL0:
+        case ARM_GPIO_GPFSEL1:
+        case ARM_GPIO_GPFSEL2:
+        {
+            _periphRegs[regIdx(addr)] = val;
+            int firstPin = (addr - ARM_GPIO_GPFSEL0) / 4 * 10;
+            for (int i = 0; i < 10; i++)
+            {
+                if (((val >> (i * 3)) & 0x07) == 1)
+                    _gpioOutMask |= (1 << (firstPin + i));
+                else
+                    _gpioOutMask &= ~(1 << (firstPin + i));
+            }
+            break;
+        }
+        case ARM_PWM_FIF1:
+        {
+            // The FIFO is shared by both channels so words alternate IORQ then MREQ
+            // and a non-zero word produces a pulse that clears that wait flip-flop
+            uint32_t chan = _pwmFifoChannel;
+            _pwmFifoChannel ^= 1;
+            if (val != 0)
+            {
+                if (chan == 0)
+                    _waitIorqFF = false;
+                else
+                    _waitMreqFF = false;
+            }
+            break;
+        }
+        case ARM_PWM_CTL:
+            if (val & ARM_PWM_CTL_CLRF1)
+                _pwmFifoChannel = 0;
+            _periphRegs[regIdx(addr)] = val & ~ARM_PWM_CTL_CLRF1;
+            break;
+        case ARM_PWM_STA:
+            break;
+        default:
+            _periphRegs[regIdx(addr)] = val;
+            break;
+    }
+    update();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Signal levels
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SimBoard::isPiOutput(int pin)
+{
+    return (_gpioOutMask & (1 << pin)) != 0;
+}
+
+bool SimBoard::piDrivesLow(int pin)
+{
+    return isPiOutput(pin) && ((_gpioOutLatch & (1 << pin)) == 0);
+}
+
+// Returns the active 74HC138 output or -1 if the mux is disabled
+int SimBoard::muxActive()
+{
+    if ((_gpioOutLatch & BR_MUX_EN_BAR_MASK) != 0)
+        return -1;
+    return (_gpioOutLatch & BR_MUX_CTRL_BIT_MASK) >> BR_MUX_LOW_BIT_POS;
+}
+
+// Control bus lines are driven by the Pi while the processor has granted the bus
+bool SimBoard::mreqLow()
+{
+    return _z80BusAck ? piDrivesLow(BR_MREQ_BAR) : _z80Mreq;
+}
+
+bool SimBoard::iorqLow()
+{
+    return _z80BusAck ? piDrivesLow(BR_IORQ_BAR) : _z80Iorq;
+}
+
+bool SimBoard::rdLow()
+{
+    return _z80BusAck ? piDrivesLow(BR_RD_BAR) : _z80Rd;
+}
+
+bool SimBoard::wrLow()
+{
+    return _z80BusAck ? piDrivesLow(BR_WR_BAR) : _z80Wr;
+}
+
+bool SimBoard::waitLow()
+{
+    if (isPiOutput(BR_WAIT_BAR_PIN))
+        return piDrivesLow(BR_WAIT_BAR_PIN);
+    return _waitMreqFF || _waitIorqFF;
+}
+
+bool SimBoard::targetRAMEnabled()
+{
+    // On V2.0 hardware the paging line is active low
+    if (!isPiOutput(BR_PAGING_RAM_PIN))
+        return true;
+    return (_gpioOutLatch & (1 << BR_PAGING_RAM_PIN)) != 0;
+}
+
+// Address bus - from the address counter/shift-register when the Pi has the bus
+uint32_t SimBoard::busAddr()
+{
+    if (_z80BusAck)
+        return (_highAddrOut << 8) | _lowAddrOut;
+    return _z80Addr & 0xffff;
+}
+
+uint8_t SimBoard::pibValue()
+{
+    return (_gpioOutLatch >> BR_DATA_BUS) & 0xff;
+}
+
+// Value on the processor data bus
+uint8_t SimBoard::dataBusValue()
+{
+    // Data bus buffer driving outward from the PIB
+    bool dirIn = (_gpioOutLatch & BR_DATA_DIR_IN_MASK) != 0;
+    if (_dataOutputEnFF && !dirIn)
+        return pibValue();
+    // Processor writing
+    if (!_z80BusAck && _z80Wr)
+        return _z80Data;
+    // Memory read
+    if (mreqLow() && rdLow() && targetRAMEnabled())
+        return _targetRAM[busAddr()];
+    return 0xff;
+}
+
+uint32_t SimBoard::gpioLevels()
+{
+    // Inputs are pulled-up unless driven
+    uint32_t inVals = 0xffffffff;
+    if (mreqLow())
+        inVals &= ~BR_MREQ_BAR_MASK;
+    if (iorqLow())
+        inVals &= ~BR_IORQ_BAR_MASK;
+    if (rdLow())
+        inVals &= ~BR_RD_BAR_MASK;
+    if (wrLow())
+        inVals &= ~BR_WR_BAR_MASK;
+    if (!_z80BusAck && _z80M1)
+        inVals &= ~BR_V20_M1_BAR_MASK;
+    if (_z80BusAck)
+        inVals &= ~BR_BUSACK_BAR_MASK;
+    if (_waitMreqFF || _waitIorqFF)
+        inVals &= ~BR_WAIT_BAR_MASK;
+
+    // PIB - address readback or data bus buffer
+    uint32_t pib = 0xff;
+    int mux = muxActive();
+    if (mux == BR_MUX_HADDR_OE_BAR)
+        pib = busAddr() >> 8;
+    else if (mux == BR_MUX_LADDR_OE_BAR)
+        pib = busAddr() & 0xff;
+    else if (_dataOutputEnFF && ((_gpioOutLatch & BR_DATA_DIR_IN_MASK) != 0))
+        pib = dataBusValue();
+    inVals = (inVals & BR_PIB_MASK) | (pib << BR_DATA_BUS);
+
+    return (_gpioOutLatch & _gpioOutMask) | (inVals & ~_gpioOutMask);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Update board logic after any change of level
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void SimBoard::update()
+{
+    // Mux outputs
+    int mux = muxActive();
+    if (mux != _prevMuxActive)
+    {
+        // Low address counter (and output register) clocked on rising edge
+        if (_prevMuxActive == BR_MUX_LADDR_CLK)
+        {
+            _lowAddrOut = _lowAddrCounter;
+            _lowAddrCounter = (_lowAddrCounter + 1) & 0xff;
+        }
+        // Data bus output enable flip-flop
+        if (mux == BR_MUX_DATA_OE_BAR_LOW)
+            _dataOutputEnFF = true;
+        _prevMuxActive = mux;
+    }
+    if (mux == BR_MUX_LADDR_CLR_BAR_LOW)
+        _lowAddrCounter = 0;
+
+    // High address shift register - serial in is the (inverted) low address clear line
+    bool haddrCk = (_gpioOutLatch & (1 << BR_HADDR_CK)) != 0;
+    if (haddrCk && !_prevHaddrCk)
+    {
+        _highAddrOut = _highAddrShift & 0xff;
+        _highAddrShift = ((_highAddrShift << 1) | ((mux == BR_MUX_LADDR_CLR_BAR_LOW) ? 0 : 1)) & 0xff;
+    }
+    _prevHaddrCk = haddrCk;
+
+    // Wait enables come from the PWM idle state - while low the flip-flops are held clear
+    uint32_t pwmCtl = _periphRegs[regIdx(ARM_PWM_CTL)];
+    bool ioWaitEn = (pwmCtl & ARM_PWM_CTL_SBIT1) != 0;
+    bool memWaitEn = (pwmCtl & ARM_PWM_CTL_SBIT2) != 0;
+    if (!ioWaitEn)
+        _waitIorqFF = false;
+    if (!memWaitEn)
+        _waitMreqFF = false;
+
+    // Bus request is granted between processor machine cycles
+    bool busRq = piDrivesLow(BR_BUSRQ_BAR);
+    if (busRq && !_z80CycleActive && !_z80BusAck && !_busAckWithheld)
+    {
+        _z80BusAck = true;
+        _busAckCount++;
+    }
+    else if (!busRq)
+    {
+        _z80BusAck = false;
+    }
+
+    // MREQ and IORQ edges
+    bool mreq = mreqLow();
+    bool iorq = iorqLow();
+    if (mreq && !_prevMreqLow && memWaitEn)
+        _waitMreqFF = true;
+    if (iorq && !_prevIorqLow && ioWaitEn)
+        _waitIorqFF = true;
+    if ((!mreq && _prevMreqLow) || (!iorq && _prevIorqLow))
+        _dataOutputEnFF = false;
+    _prevMreqLow = mreq;
+    _prevIorqLow = iorq;
+
+    // Memory write by either bus master
+    if (mreq && wrLow() && targetRAMEnabled())
+        _targetRAM[busAddr()] = dataBusValue();
+
+    // Wait stats
+    bool wait = waitLow();
+    if (wait && !_prevWaitLow)
+        _waitCycleCount++;
+    _prevWaitLow = wait;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Processor side
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint8_t SimBoard::z80BusCycle(Z80_CYCLE_TYPE cycleType, uint32_t addr, uint8_t data)
+{
+    _busCycleCount++;
+
+    // Start of cycle
+    _z80Addr = addr & 0xffff;
+    _z80Data = data;
+    _z80CycleType = cycleType;
+    _z80CycleReadData = 0xff;
+    _z80CycleActive = true;
+    _z80M1 = (cycleType == Z80_CYCLE_MEM_RD_M1) || (cycleType == Z80_CYCLE_IRQ_ACK);
+    switch (cycleType)
+    {
+        case Z80_CYCLE_MEM_RD:
+        case Z80_CYCLE_MEM_RD_M1:
+            _z80Mreq = _z80Rd = true;
+            break;
+        case Z80_CYCLE_MEM_WR:
+            // WR follows MREQ by half a clock
+            _z80Mreq = true;
+            update();
+            _z80Wr = true;
+            break;
+        case Z80_CYCLE_IO_RD:
+            _z80Iorq = _z80Rd = true;
+            break;
+        case Z80_CYCLE_IO_WR:
+            _z80Iorq = _z80Wr = true;
+            break;
+        case Z80_CYCLE_IRQ_ACK:
+            _z80Iorq = true;
+            break;
+    }
+    update();
+
+    // Processor is held while WAIT is asserted
+    piServiceWhile(cycleWaitActive);
+    if (_z80CycleActive)
+        z80EndCycle();
+
+    // Bus requests are granted at the end of the machine cycle
+    piServiceWhile(busAckActive);
+    return _z80CycleReadData;
+}
+
+void SimBoard::z80EndCycle()
+{
+    // Sample data at the end of a read
+    if ((_z80CycleType != Z80_CYCLE_MEM_WR) && (_z80CycleType != Z80_CYCLE_IO_WR))
+        _z80CycleReadData = dataBusValue();
+
+    // Release control lines
+    _z80Mreq = _z80Iorq = _z80Rd = _z80Wr = _z80M1 = false;
+    _z80CycleActive = false;
+    update();
+}
+
+bool SimBoard::z80ResetActive()
+{
+    return muxActive() == BR_MUX_RESET_Z80_BAR_LOW;
+}
+
+bool SimBoard::z80IrqActive()
+{
+    return muxActive() == BR_MUX_IRQ_BAR_LOW;
+}
+
+bool SimBoard::z80NmiActive()
+{
+    return muxActive() == BR_MUX_NMI_BAR_LOW;
+}
+
+void SimBoard::z80Idle()
+{
+    if (_pPiServiceFn)
+        _pPiServiceFn();
+    update();
+    piServiceWhile(busAckActive);
+}
+
+bool SimBoard::cycleWaitActive()
+{
+    return _z80CycleActive && waitLow();
+}
+
+bool SimBoard::busAckActive()
+{
+    return _z80BusAck;
+}
+
+void SimBoard::piServiceWhile(bool (*pCond)())
+{
+    uint32_t callCount = 0;
+    while (pCond())
+    {
+        if (!_pPiServiceFn || (callCount++ >= MAX_PI_SERVICE_CALLS_PER_STALL))
+        {
+            _stalled = true;
+            return;
+        }
+        _pPiServiceFn();
+    }
+}
@@ -0,0 +1,164 @@
+// Bus Raider Host Simulation
+// Simulated BCM2835 peripheral registers and BusRaider V2.0 bus hardware
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// The simulated board sits behind RD32/WR32 (see System/lowlib.h when built
+// with BR_HOST_SIM) so BusAccess runs unchanged. It models:
+// - GPIO function select, output latch and level registers
+// - the 74HC138 mux (enabled by MUX_EN_BAR) and the signals it decodes
+// - low address counter, high address shift register and address readback
+// - data bus buffer direction and its output-enable flip-flop
+// - MREQ/IORQ wait flip-flops enabled by the PWM idle state and cleared by
+//   writes to the PWM FIFO
+// - target RAM (64K) which can be paged out using the paging pin
+// - BUSRQ/BUSACK handshake and RESET/NMI/IRQ lines to the processor
+// The processor side is driven by SimZ80 through the z80* functions.
+
+// Called when the processor is stalled (in WAIT or BUSACK) so the Pi side can run
+typedef void SimPiServiceFnType();
+
+class SimBoard
+{
+public:
+    static void init();
+
+    // Register access (from hostSimRD32/hostSimWR32)
+    static uint32_t regRead(uint32_t addr);
+    static void regWrite(uint32_t addr, uint32_t val);
+
+    // Pi side service function used while the processor is stalled
+    static void setPiServiceFn(SimPiServiceFnType* pFn)
+    {
+        _pPiServiceFn = pFn;
+    }
+
+    // Processor bus cycles
+    enum Z80_CYCLE_TYPE
+    {
+        Z80_CYCLE_MEM_RD,
+        Z80_CYCLE_MEM_RD_M1,
+        Z80_CYCLE_MEM_WR,
+        Z80_CYCLE_IO_RD,
+        Z80_CYCLE_IO_WR,
+        Z80_CYCLE_IRQ_ACK
+    };
+    static uint8_t z80BusCycle(Z80_CYCLE_TYPE cycleType, uint32_t addr, uint8_t data);
+
+    // Processor input lines
+    static bool z80ResetActive();
+    static bool z80IrqActive();
+    static bool z80NmiActive();
+
+    // Let the Pi side run while the processor is between instructions
+    static void z80Idle();
+
+    // Target RAM
+    static uint8_t* getTargetRAM()
+    {
+        return _targetRAM;
+    }
+    static bool targetRAMEnabled();
+
+    // Stall detection - set if the processor was held for longer than the limit
+    static bool isStalled()
+    {
+        return _stalled;
+    }
+
+    // Stats
+    static uint32_t getBusCycleCount()
+    {
+        return _busCycleCount;
+    }
+    static uint32_t getWaitCycleCount()
+    {
+        return _waitCycleCount;
+    }
+    static uint32_t getBusAckCount()
+    {
+        return _busAckCount;
+    }
+
+    // Processor ignores BUSRQ (BUSACK never asserted) - e.g. a DMA controller holding the bus
+    static void setBusAckWithheld(bool withheld)
+    {
+        _busAckWithheld = withheld;
+    }
+
+private:
+    // Registers
+    static const uint32_t PERIPH_REG_COUNT = 0x1000000 / 4;
+    static uint32_t _periphRegs[PERIPH_REG_COUNT];
+    static uint32_t _gpioOutLatch;
+    static uint32_t _gpioOutMask;
+    static uint32_t _pwmFifoChannel;
+
+    // Pi service function
+    static SimPiServiceFnType* _pPiServiceFn;
+    static const uint32_t MAX_PI_SERVICE_CALLS_PER_STALL = 100000;
+
+    // Processor pins
+    static bool _z80Mreq;
+    static bool _z80Iorq;
+    static bool _z80Rd;
+    static bool _z80Wr;
+    static bool _z80M1;
+    static uint32_t _z80Addr;
+    static uint8_t _z80Data;
+    static bool _z80CycleActive;
+    static Z80_CYCLE_TYPE _z80CycleType;
+    static uint8_t _z80CycleReadData;
+    static bool _z80BusAck;
+    static bool _busAckWithheld;
+
+    // Board state
+    static bool _waitMreqFF;
+    static bool _waitIorqFF;
+    static bool _dataOutputEnFF;
+    static uint32_t _lowAddrCounter;
+    static uint32_t _lowAddrOut;
+    static uint32_t _highAddrShift;
+    static uint32_t _highAddrOut;
+
+    // Previous levels for edge detection
+    static int _prevMuxActive;
+    static bool _prevHaddrCk;
+    static bool _prevMreqLow;
+    static bool _prevIorqLow;
+    static bool _prevWaitLow;
+
+    // Target RAM
+    static uint8_t _targetRAM[0x10000];
+
+    // Stall
+    static bool _stalled;
+
+    // Stats
+    static uint32_t _busCycleCount;
+    static uint32_t _waitCycleCount;
+    static uint32_t _busAckCount;
+
+private:
+    static bool isPiOutput(int pin);
+    static bool piDrivesLow(int pin);
+    static int muxActive();
+    static bool mreqLow();
+    static bool iorqLow();
+    static bool rdLow();
+    static bool wrLow();
+    static bool waitLow();
+    static uint32_t busAddr();
+    static uint8_t dataBusValue();
+    static uint8_t pibValue();
+    static uint32_t gpioLevels();
+    static void update();
+    static void z80EndCycle();
+    static bool cycleWaitActive();
+    static bool busAckActive();
+    static void piServiceWhile(bool (*pCond)());
+};
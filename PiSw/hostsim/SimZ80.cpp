@@ -0,0 +1,81 @@
+// Bus Raider Host Simulation
+// Virtual Z80 (libz80) producing bus cycles on the simulated board
+// Rob Dobson 2019
+
+#include <string.h>
+#include "SimZ80.h"
+#include "SimBoard.h"
+
+Z80Context SimZ80::_cpu_z80;
+bool SimZ80::_prevNmiActive = false;
+bool SimZ80::_inReset = false;
+uint32_t SimZ80::_instrCount = 0;
+uint32_t SimZ80::_resetCount = 0;
+
+void SimZ80::init()
+{
+    memset(&_cpu_z80, 0, sizeof(_cpu_z80));
+    _cpu_z80.ioRead = io_read;
+    _cpu_z80.ioWrite = io_write;
+    _cpu_z80.memRead = mem_read;
+    _cpu_z80.memWrite = mem_write;
+    Z80RESET(&_cpu_z80);
+    _prevNmiActive = false;
+    _inReset = false;
+    _instrCount = 0;
+    _resetCount = 0;
+}
+
+void SimZ80::step()
+{
+    // Let the Pi side run between instructions (and handle BUSRQ)
+    SimBoard::z80Idle();
+
+    // Reset held
+    if (SimBoard::z80ResetActive())
+    {
+        if (!_inReset)
+            _resetCount++;
+        _inReset = true;
+        Z80RESET(&_cpu_z80);
+        return;
+    }
+    _inReset = false;
+
+    // NMI is edge triggered
+    bool nmiActive = SimBoard::z80NmiActive();
+    if (nmiActive && !_prevNmiActive)
+        Z80NMI(&_cpu_z80);
+    _prevNmiActive = nmiActive;
+
+    // IRQ is level triggered - acknowledge cycle supplies the vector
+    if (SimBoard::z80IrqActive() && _cpu_z80.IFF1 && !_cpu_z80.defer_int && !_cpu_z80.nmi_req)
+    {
+        uint8_t vector = SimBoard::z80BusCycle(SimBoard::Z80_CYCLE_IRQ_ACK, _cpu_z80.PC, 0);
+        Z80INT(&_cpu_z80, vector);
+    }
+
+    // Execute
+    Z80Execute(&_cpu_z80);
+    _instrCount++;
+}
+
+byte SimZ80::mem_read([[maybe_unused]] int param, ushort address)
+{
+    return SimBoard::z80BusCycle(_cpu_z80.M1 ? SimBoard::Z80_CYCLE_MEM_RD_M1 : SimBoard::Z80_CYCLE_MEM_RD, address, 0);
+}
+
+void SimZ80::mem_write([[maybe_unused]] int param, ushort address, byte data)
+{
+    SimBoard::z80BusCycle(SimBoard::Z80_CYCLE_MEM_WR, address, data);
+}
+
+byte SimZ80::io_read([[maybe_unused]] int param, ushort address)
+{
+    return SimBoard::z80BusCycle(SimBoard::Z80_CYCLE_IO_RD, address, 0);
+}
+
+void SimZ80::io_write([[maybe_unused]] int param, ushort address, byte data)
+{
+    SimBoard::z80BusCycle(SimBoard::Z80_CYCLE_IO_WR, address, data);
+}
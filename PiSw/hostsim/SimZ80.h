@@ -0,0 +1,46 @@
+// Bus Raider Host Simulation
+// Virtual Z80 (libz80) producing bus cycles on the simulated board
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include "../src/StepTracer/libz80/z80.h"
+
+class SimZ80
+{
+public:
+    static void init();
+
+    // Execute one instruction (or handle RESET/NMI/IRQ lines)
+    static void step();
+
+    // Context
+    static Z80Context& getContext()
+    {
+        return _cpu_z80;
+    }
+
+    // Stats
+    static uint32_t getInstrCount()
+    {
+        return _instrCount;
+    }
+    static uint32_t getResetCount()
+    {
+        return _resetCount;
+    }
+
+private:
+    static Z80Context _cpu_z80;
+    static bool _prevNmiActive;
+    static bool _inReset;
+    static uint32_t _instrCount;
+    static uint32_t _resetCount;
+
+    // Memory and IO functions
+    static byte mem_read(int param, ushort address);
+    static void mem_write(int param, ushort address, byte data);
+    static byte io_read(int param, ushort address);
+    static void io_write(int param, ushort address, byte data);
+};
@@ -49,7 +49,12 @@ BusSocketInfo BusController::_busSocketInfo =
     0,
     false,
     BR_BUS_ACTION_GENERAL,
-    false
+    false,
+    // All bus cycles and addresses
+    BR_BUS_CYCLE_ALL,
+    0,
+    0,
+    "BusController"
 };
 
 // This instance
@@ -440,6 +445,14 @@ bool BusController::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint
         strlcpy(pRespJson, statusInfo.getJson(), maxRespLen);
         return true;
     }
+    else if (strcasecmp(cmdName, "busLatency") == 0)
+    {
+        // Get wait hold time, wait handler and bus socket latency histograms
+        BusAccessStatusInfo statusInfo;
+        BusAccess::getStatus(statusInfo);
+        strlcpy(pRespJson, statusInfo.getLatencyJson(), maxRespLen);
+        return true;
+    }
     else if (strcasecmp(cmdName, "busStatusClear") == 0)
     {
         // Clear bus status
@@ -592,6 +605,50 @@ bool BusController::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint
         _stepCompletionPending = true;
         return true;
     }
+    else if (strcasecmp(cmdName, "stepOver") == 0)
+    {
+        TargetTracker::stepOver();
+        strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
+        _stepCompletionPending = true;
+        return true;
+    }
+    else if (strcasecmp(cmdName, "stepOut") == 0)
+    {
+        // Run until the current call returns
+        TargetTracker::stepOut();
+        strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
+        _stepCompletionPending = true;
+        return true;
+    }
+    else if (strcasecmp(cmdName, "stepRunTo") == 0)
+    {
+        // Run to an address
+        static const int MAX_CMD_PARAM_STR = 50;
+        char paramVal[MAX_CMD_PARAM_STR+1];
+        if (!jsonGetValueForKey("addr", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            return false;
+        TargetTracker::stepRunTo(strtoul(paramVal, NULL, 0));
+        strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
+        _stepCompletionPending = true;
+        return true;
+    }
+    else if (strcasecmp(cmdName, "stepBack") == 0)
+    {
+        // Step back using the execution history
+        if (!TargetTracker::stepBack())
+        {
+            strlcpy(pRespJson, "\"err\":\"NoHistory\"", maxRespLen);
+            return true;
+        }
+        strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
+        _stepCompletionPending = true;
+        return true;
+    }
+    else if (strcasecmp(cmdName, "callStack") == 0)
+    {
+        TargetTracker::getCallStack().getJson(pRespJson, maxRespLen);
+        return true;
+    }
     else if (strcasecmp(cmdName, "stepRun") == 0)
     {
         // Turn target tracker on
@@ -609,6 +666,110 @@ bool BusController::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint
         strlcat(pRespJson, "\"", maxRespLen);
         return true;
     }
+    else if (strcasecmp(cmdName, "tracepointSet") == 0)
+    {
+        // Tracepoint on a breakpoint slot with optional condition and memory bytes to record
+        static const int MAX_CMD_PARAM_STR = 50;
+        static const int MAX_EXPR_STR = 100;
+        char paramVal[MAX_CMD_PARAM_STR+1];
+        if (!jsonGetValueForKey("idx", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            return false;
+        int idx = strtol(paramVal, NULL, 10);
+        if (!jsonGetValueForKey("pc", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            return false;
+        uint32_t pcVal = strtoul(paramVal, NULL, 0);
+        char condition[MAX_EXPR_STR+1];
+        if (!jsonGetValueForKey("cond", pCmdJson, condition, MAX_EXPR_STR))
+            condition[0] = 0;
+        char memAddrExpr[MAX_EXPR_STR+1];
+        if (!jsonGetValueForKey("mem", pCmdJson, memAddrExpr, MAX_EXPR_STR))
+            memAddrExpr[0] = 0;
+        uint32_t memLen = 0;
+        if (jsonGetValueForKey("memLen", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            memLen = strtoul(paramVal, NULL, 0);
+        if (!TargetTracker::setTracepoint(idx, pcVal, condition, memAddrExpr, memLen))
+        {
+            strlcpy(pRespJson, "\"err\":\"invalidExpr\"", maxRespLen);
+            return true;
+        }
+        TargetTracker::getTracepointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "tracepointClear") == 0)
+    {
+        // Clear a tracepoint (if idx is given) and the recorded snapshots
+        static const int MAX_CMD_PARAM_STR = 50;
+        char paramVal[MAX_CMD_PARAM_STR+1];
+        if (jsonGetValueForKey("idx", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+        {
+            int idx = strtol(paramVal, NULL, 10);
+            TargetTracker::enableBreakpoint(idx, false);
+            TargetTracker::setBreakpointTrace(idx, false, NULL, 0);
+        }
+        TargetTracker::clearTracepointRecs();
+        TargetTracker::getTracepointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "tracepointGet") == 0)
+    {
+        // Snapshots are sent as a tracepointData frame (if there are any and there's room)
+        TargetTracker::sendTracepointFrame();
+        TargetTracker::getTracepointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "tracepointStatus") == 0)
+    {
+        TargetTracker::getTracepointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "watchSet") == 0)
+    {
+        // Watchpoint on an address range - access is r, w or rw and log=1 logs rather than stops
+        static const int MAX_CMD_PARAM_STR = 50;
+        char paramVal[MAX_CMD_PARAM_STR+1];
+        if (!jsonGetValueForKey("idx", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            return false;
+        int idx = strtol(paramVal, NULL, 10);
+        if (!jsonGetValueForKey("addr", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            return false;
+        uint32_t addr = strtoul(paramVal, NULL, 0);
+        uint32_t len = 1;
+        if (jsonGetValueForKey("len", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            len = strtoul(paramVal, NULL, 0);
+        uint32_t accessMask = WATCHPOINT_ACCESS_READ | WATCHPOINT_ACCESS_WRITE;
+        if (jsonGetValueForKey("access", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            accessMask = (strchr(paramVal, 'r') ? WATCHPOINT_ACCESS_READ : 0) | 
+                        (strchr(paramVal, 'w') ? WATCHPOINT_ACCESS_WRITE : 0);
+        bool logOnly = false;
+        if (jsonGetValueForKey("log", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            logOnly = strtol(paramVal, NULL, 10) != 0;
+        TargetTracker::setWatchpoint(idx, addr, len, accessMask, logOnly);
+        TargetTracker::enableWatchpoint(idx, accessMask != 0);
+        TargetTracker::getWatchpointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "watchClear") == 0)
+    {
+        // Clear one watchpoint or all of them
+        static const int MAX_CMD_PARAM_STR = 50;
+        char paramVal[MAX_CMD_PARAM_STR+1];
+        if (jsonGetValueForKey("idx", pCmdJson, paramVal, MAX_CMD_PARAM_STR))
+            TargetTracker::enableWatchpoint(strtol(paramVal, NULL, 10), false);
+        else
+            TargetTracker::clearWatchpoints();
+        TargetTracker::getWatchpointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "watchStatus") == 0)
+    {
+        TargetTracker::getWatchpointStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "watchLog") == 0)
+    {
+        TargetTracker::getWatchpointLogJson(pRespJson, maxRespLen);
+        return true;
+    }
     else if (strcasecmp(cmdName, "waitCycleUs") == 0)
     {
         // Get params
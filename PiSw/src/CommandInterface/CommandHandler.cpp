@@ -73,7 +73,10 @@ int CommandHandler::commsSocketAdd(CommsSocketInfo& commsSocketInfo)
 {
     // Check if all used
     if (_commsSocketCount >= MAX_COMMS_SOCKETS)
+    {
+        LogWrite(FromCmdHandler, LOG_WARNING, "commsSocketAdd all %d sockets used", MAX_COMMS_SOCKETS);
         return -1;
+    }
 
     // Add in available space
     _commsSockets[_commsSocketCount] = commsSocketInfo;
@@ -539,7 +542,7 @@ uint32_t CommandHandler::getTxAvailable()
 // Send with JSON payload
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void CommandHandler::sendWithJSON(const char* cmdName, const char* cmdJson, uint32_t msgIdx, 
+bool CommandHandler::sendWithJSON(const char* cmdName, const char* cmdJson, uint32_t msgIdx, 
             const uint8_t* pData, uint32_t dataLen)
 {
     // Form and send command
@@ -547,7 +550,7 @@ void CommandHandler::sendWithJSON(const char* cmdName, const char* cmdJson, uint
     // This JSON contains a dataLen value which determines the length of the binary part that follows
     // A pure binary part immediately follows the null terminator of the JSON
     // It is also null terminated and the null terminator is not included in the dataLan value
-    static const int MAX_DATAFRAME_LEN = 10000;
+    static const int MAX_DATAFRAME_LEN = MAX_SEND_FRAME_LEN;
     char dataFrame[MAX_DATAFRAME_LEN];
     char indexStr[20];
     itoa(msgIdx, indexStr, 10);
@@ -574,19 +577,20 @@ void CommandHandler::sendWithJSON(const char* cmdName, const char* cmdJson, uint
     if (dataFrameTotalLen >= MAX_DATAFRAME_LEN)
     {
         LogWrite(FromCmdHandler, LOG_DEBUG, "Frame too long");
-        return;
+        return false;
     }
     if (dataLen > 0)
     {
         if (pData)
             memcopyfast(dataFrame+dataFrameBinaryPos, pData, dataLen);
         else
-            return;
+            return false;
     }
     // Terminate the binary portion too (belt-and-braces!)
     dataFrame[dataFrameTotalLen-1] = 0;
     if (_pSingletonCommandHandler)
         _pSingletonCommandHandler->_miniHDLC.sendFrame((const uint8_t*)dataFrame, dataFrameTotalLen);
+    return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
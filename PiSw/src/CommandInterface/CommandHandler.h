@@ -85,9 +85,12 @@ public:
     // Num chars that can be sent
     static uint32_t getTxAvailable();
 
-    // Send
-    static void sendWithJSON(const char* cmdName, const char* cmdJson, uint32_t msgIdx = 0, 
+    // Send - returns false if the frame is too long to send
+    static bool sendWithJSON(const char* cmdName, const char* cmdJson, uint32_t msgIdx = 0, 
             const uint8_t* pData = NULL, uint32_t dataLen = 0);
+
+    // Longest frame sendWithJSON can send (JSON, binary and both terminators)
+    static const int MAX_SEND_FRAME_LEN = 10000;
     static void sendAPIReq(const char* reqLine);
     // Send unnumbered message
     static void sendUnnumberedMsg(const char* pCmdName, const char* pMsgJson);
@@ -108,7 +111,7 @@ public:
 
 private:
     // Comms Sockets
-    static const int MAX_COMMS_SOCKETS = 10;
+    static const int MAX_COMMS_SOCKETS = 16;
     static CommsSocketInfo _commsSockets[MAX_COMMS_SOCKETS];
     static int _commsSocketCount;
     void commsSocketHandleRxMsg(const char* pCmdJson, const uint8_t* pParams, int paramsLen,
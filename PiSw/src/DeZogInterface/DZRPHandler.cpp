@@ -0,0 +1,400 @@
+// Bus Raider
+// Rob Dobson 2019-2020
+
+#include "DZRPHandler.h"
+#include <string.h>
+#include "../System/logging.h"
+#include "../System/lowlib.h"
+#include "../CommandInterface/CommandHandler.h"
+#include "../TargetBus/TargetTracker.h"
+#include "../TargetBus/TargetMemChanges.h"
+#include "../Hardware/HwManager.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char MODULE_PREFIX[] = "DZRP";
+
+// Frame command name
+static const char DZRP_FRAME_CMD_NAME[] = "dzrp";
+
+// Version and name reported
+static const uint8_t DZRP_VERSION[] = { 1, 6, 0 };
+static const char DZRP_PROGRAM_NAME[] = "BusRaider";
+
+// Longest breakpoint condition accepted
+static const int MAX_CONDITION_LEN = 200;
+
+// Register numbers for SET_REGISTER
+static const char* DZRP_REG_NAMES[] =
+{
+    "PC", "SP", "AF", "BC", "DE", "HL", "IX", "IY", "AF'", "BC'", "DE'", "HL'", "R", "I", "IM", NULL,
+    "F", "A", "C", "B", "E", "D", "L", "H", "IXL", "IXH", "IYL", "IYH",
+    "F'", "A'", "C'", "B'", "E'", "D'", "L'", "H'"
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+DZRPHandler::DZRPHandler()
+{
+    _rxLen = 0;
+    _rxDiscardLen = 0;
+    _readMemActive = false;
+    _readMemSeqNo = 0;
+    _readMemAddr = 0;
+    _readMemRemaining = 0;
+    _readMemHeaderSent = false;
+    _continuePending = false;
+    _pauseRequested = false;
+    for (int i = 0; i < 2; i++)
+    {
+        _tempBreakpoints[i] = 0;
+        _tempBreakpointsEn[i] = false;
+    }
+    for (int i = 0; i < DZRP_MAX_BREAKPOINTS; i++)
+        _breakpointUsed[i] = false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Service
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DZRPHandler::service()
+{
+    // Stream memory read
+    if (_readMemActive)
+    {
+        if (!sendReadMemFrame())
+            return;
+        // Messages received while streaming
+        processRx();
+    }
+
+    // Check for target stopped
+    if (_continuePending && TargetTracker::isStepPaused())
+    {
+        sendPauseNotification();
+        _continuePending = false;
+        _pauseRequested = false;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Received data
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DZRPHandler::handleRxData(const uint8_t* pData, int dataLen)
+{
+    while (dataLen > 0)
+    {
+        // Skip the rest of a message that is too long
+        if (_rxDiscardLen > 0)
+        {
+            uint32_t skipLen = ((uint32_t)dataLen < _rxDiscardLen) ? dataLen : _rxDiscardLen;
+            _rxDiscardLen -= skipLen;
+            pData += skipLen;
+            dataLen -= skipLen;
+            continue;
+        }
+
+        // Add to buffer
+        uint32_t copyLen = DZRP_RX_BUF_LEN - _rxLen;
+        if (copyLen > (uint32_t)dataLen)
+            copyLen = dataLen;
+        if (copyLen == 0)
+        {
+            LogWrite(MODULE_PREFIX, LOG_DEBUG, "Rx buffer full - discarding %d bytes", dataLen);
+            break;
+        }
+        memcpy(_rxBuf + _rxLen, pData, copyLen);
+        _rxLen += copyLen;
+        pData += copyLen;
+        dataLen -= copyLen;
+
+        // Handle complete messages
+        processRx();
+    }
+}
+
+void DZRPHandler::processRx()
+{
+    uint32_t msgPos = 0;
+    while (!_readMemActive && (_rxLen - msgPos >= DZRP_CMD_HEADER_LEN))
+    {
+        // Check message is complete
+        const uint8_t* pMsg = _rxBuf + msgPos;
+        uint32_t payloadLen = getWord(pMsg) | (getWord(pMsg + 2) << 16);
+        if (payloadLen > DZRP_RX_BUF_LEN - DZRP_CMD_HEADER_LEN)
+        {
+            LogWrite(MODULE_PREFIX, LOG_DEBUG, "Message too long %u", payloadLen);
+            _rxDiscardLen = payloadLen - (_rxLen - msgPos - DZRP_CMD_HEADER_LEN);
+            msgPos = _rxLen;
+            break;
+        }
+        if (_rxLen - msgPos < DZRP_CMD_HEADER_LEN + payloadLen)
+            break;
+
+        // Handle
+        handleMessage(pMsg[4], pMsg[5], pMsg + DZRP_CMD_HEADER_LEN, payloadLen);
+        msgPos += DZRP_CMD_HEADER_LEN + payloadLen;
+    }
+
+    // Remove handled messages
+    if (msgPos > 0)
+    {
+        _rxLen -= msgPos;
+        if (_rxLen > 0)
+            memmove(_rxBuf, _rxBuf + msgPos, _rxLen);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Commands
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DZRPHandler::handleMessage(uint32_t seqNo, uint32_t cmd, const uint8_t* pPayload, uint32_t payloadLen)
+{
+    // Response payloads other than memory reads are short
+    static const int MAX_RESP_LEN = 100;
+    uint8_t resp[MAX_RESP_LEN];
+    uint32_t respLen = 0;
+
+    switch (cmd)
+    {
+        case DZRP_CMD_INIT:
+        {
+            resp[respLen++] = 0;
+            memcpy(resp + respLen, DZRP_VERSION, sizeof(DZRP_VERSION));
+            respLen += sizeof(DZRP_VERSION);
+            resp[respLen++] = 0;
+            strlcpy((char*)resp + respLen, DZRP_PROGRAM_NAME, MAX_RESP_LEN - respLen);
+            respLen += strlen(DZRP_PROGRAM_NAME) + 1;
+            LogWrite(MODULE_PREFIX, LOG_DEBUG, "Init client version %d.%d.%d",
+                        (payloadLen > 0) ? pPayload[0] : 0, (payloadLen > 1) ? pPayload[1] : 0,
+                        (payloadLen > 2) ? pPayload[2] : 0);
+            break;
+        }
+        case DZRP_CMD_CLOSE:
+        {
+            for (int i = 0; i < DZRP_MAX_BREAKPOINTS; i++)
+            {
+                if (_breakpointUsed[i])
+                    TargetTracker::enableBreakpoint(TargetBreakpoints::MAX_BREAKPOINTS - DZRP_MAX_BREAKPOINTS + i, false);
+                _breakpointUsed[i] = false;
+            }
+            break;
+        }
+        case DZRP_CMD_GET_REGISTERS:
+        {
+            Z80Registers& regs = TargetTracker::getRegs();
+            const int regVals[] = { regs.PC, regs.SP, regs.AF, regs.BC, regs.DE, regs.HL, regs.IX, regs.IY,
+                        regs.AFDASH, regs.BCDASH, regs.DEDASH, regs.HLDASH };
+            for (unsigned int i = 0; i < sizeof(regVals) / sizeof(regVals[0]); i++)
+            {
+                setWord(resp + respLen, regVals[i]);
+                respLen += 2;
+            }
+            resp[respLen++] = regs.R;
+            resp[respLen++] = regs.I;
+            resp[respLen++] = regs.INTMODE;
+            resp[respLen++] = 0;
+            break;
+        }
+        case DZRP_CMD_SET_REGISTER:
+        {
+            bool regSet = false;
+            if ((payloadLen >= 3) && (pPayload[0] < sizeof(DZRP_REG_NAMES) / sizeof(DZRP_REG_NAMES[0])) &&
+                        DZRP_REG_NAMES[pPayload[0]])
+                regSet = TargetTracker::setRegister(DZRP_REG_NAMES[pPayload[0]], getWord(pPayload + 1));
+            resp[respLen++] = regSet ? 0 : 1;
+            break;
+        }
+        case DZRP_CMD_CONTINUE:
+        {
+            // Temporary breakpoints are removed when stopped
+            for (int i = 0; i < 2; i++)
+            {
+                _tempBreakpointsEn[i] = (payloadLen >= (uint32_t)(i + 1) * 3) && (pPayload[i * 3] != 0);
+                if (_tempBreakpointsEn[i])
+                {
+                    _tempBreakpoints[i] = getWord(pPayload + i * 3 + 1);
+                    TargetTracker::setFastBreakpoint(_tempBreakpoints[i], true);
+                }
+            }
+            TargetTracker::stepRun();
+            _continuePending = true;
+            break;
+        }
+        case DZRP_CMD_PAUSE:
+        {
+            // Stop at the next instruction
+            TargetTracker::stepInto();
+            _pauseRequested = true;
+            _continuePending = true;
+            break;
+        }
+        case DZRP_CMD_READ_MEM:
+        {
+            if (payloadLen < 5)
+                break;
+            _readMemSeqNo = seqNo;
+            _readMemAddr = getWord(pPayload + 1);
+            _readMemRemaining = getWord(pPayload + 3);
+            if (_readMemRemaining == 0)
+                _readMemRemaining = DZRP_MAX_MEM_LEN;
+            _readMemHeaderSent = false;
+            _readMemActive = true;
+            sendReadMemFrame();
+            return;
+        }
+        case DZRP_CMD_WRITE_MEM:
+        {
+            BR_RETURN_TYPE rslt = BR_ERR;
+            if (payloadLen >= 3)
+            {
+                uint32_t addr = getWord(pPayload + 1);
+                uint32_t writeLen = payloadLen - 3;
+                if (addr + writeLen > DZRP_MAX_MEM_LEN)
+                    writeLen = DZRP_MAX_MEM_LEN - addr;
+                rslt = HwManager::blockWrite(addr, pPayload + 3, writeLen, false, false, false);
+                if (rslt == BR_OK)
+                    TargetMemChanges::handleMemWrite(addr, pPayload + 3, writeLen);
+            }
+            resp[respLen++] = (rslt == BR_OK) ? 0 : 1;
+            break;
+        }
+        case DZRP_CMD_ADD_BREAKPOINT:
+        {
+            uint32_t bpId = 0;
+            if (payloadLen >= 2)
+            {
+                for (int i = 0; i < DZRP_MAX_BREAKPOINTS; i++)
+                {
+                    if (_breakpointUsed[i])
+                        continue;
+                    // Condition (if present) after the address and bank
+                    char condition[MAX_CONDITION_LEN];
+                    condition[0] = 0;
+                    if (payloadLen > 3)
+                    {
+                        uint32_t condLen = payloadLen - 3;
+                        if (condLen > sizeof(condition) - 1)
+                            condLen = sizeof(condition) - 1;
+                        memcpy(condition, pPayload + 3, condLen);
+                        condition[condLen] = 0;
+                    }
+                    int bpIdx = TargetBreakpoints::MAX_BREAKPOINTS - DZRP_MAX_BREAKPOINTS + i;
+                    TargetTracker::setBreakpointPCAddr(bpIdx, getWord(pPayload));
+                    if (!TargetTracker::setBreakpointCondition(bpIdx, condition))
+                        LogWrite(MODULE_PREFIX, LOG_DEBUG, "Breakpoint condition invalid %s", condition);
+                    TargetTracker::setBreakpointTrace(bpIdx, false, NULL, 0);
+                    TargetTracker::enableBreakpoint(bpIdx, true);
+                    TargetTracker::enableBreakpoints(true);
+                    _breakpointUsed[i] = true;
+                    bpId = i + 1;
+                    break;
+                }
+            }
+            setWord(resp, bpId);
+            respLen = 2;
+            break;
+        }
+        case DZRP_CMD_REMOVE_BREAKPOINT:
+        {
+            uint32_t bpId = (payloadLen >= 2) ? getWord(pPayload) : 0;
+            if ((bpId > 0) && (bpId <= (uint32_t)DZRP_MAX_BREAKPOINTS) && _breakpointUsed[bpId - 1])
+            {
+                TargetTracker::enableBreakpoint(TargetBreakpoints::MAX_BREAKPOINTS - DZRP_MAX_BREAKPOINTS + bpId - 1, false);
+                _breakpointUsed[bpId - 1] = false;
+            }
+            break;
+        }
+        default:
+        {
+            LogWrite(MODULE_PREFIX, LOG_DEBUG, "Unsupported command %u", cmd);
+            break;
+        }
+    }
+    sendResponse(seqNo, resp, respLen);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Send
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void DZRPHandler::sendResponse(uint32_t seqNo, const uint8_t* pPayload, uint32_t payloadLen)
+{
+    static const int MAX_RESP_FRAME_LEN = 200;
+    uint8_t respFrame[MAX_RESP_FRAME_LEN];
+    if (payloadLen > MAX_RESP_FRAME_LEN - DZRP_RESP_HEADER_LEN)
+        payloadLen = MAX_RESP_FRAME_LEN - DZRP_RESP_HEADER_LEN;
+    setLong(respFrame, payloadLen);
+    respFrame[4] = seqNo;
+    memcpy(respFrame + DZRP_RESP_HEADER_LEN, pPayload, payloadLen);
+    CommandHandler::sendWithJSON(DZRP_FRAME_CMD_NAME, "", 0, respFrame, DZRP_RESP_HEADER_LEN + payloadLen);
+}
+
+void DZRPHandler::sendPauseNotification()
+{
+    // Temporary breakpoints
+    uint32_t pc = TargetTracker::getRegs().PC;
+    bool tempBreakpointHit = false;
+    for (int i = 0; i < 2; i++)
+    {
+        if (!_tempBreakpointsEn[i])
+            continue;
+        TargetTracker::setFastBreakpoint(_tempBreakpoints[i], false);
+        tempBreakpointHit |= (_tempBreakpoints[i] == pc);
+        _tempBreakpointsEn[i] = false;
+    }
+
+    // Notification
+    uint8_t ntfFrame[DZRP_CMD_HEADER_LEN + 5];
+    setLong(ntfFrame, 5);
+    ntfFrame[4] = 0;
+    ntfFrame[5] = DZRP_NTF_PAUSE;
+    ntfFrame[6] = _pauseRequested ? DZRP_BREAK_REASON_MANUAL :
+                (tempBreakpointHit ? DZRP_BREAK_REASON_NONE : DZRP_BREAK_REASON_BREAKPOINT_HIT);
+    setWord(ntfFrame + 7, pc);
+    ntfFrame[9] = 0;
+    ntfFrame[10] = 0;
+    CommandHandler::sendWithJSON(DZRP_FRAME_CMD_NAME, "", 0, ntfFrame, sizeof(ntfFrame));
+}
+
+// Send the next frame of a memory read - returns true when complete
+bool DZRPHandler::sendReadMemFrame()
+{
+    while (_readMemActive)
+    {
+        if (CommandHandler::getTxAvailable() < MIN_TX_AVAILABLE_FOR_FRAME)
+            return false;
+
+        // Response header goes in the first frame
+        uint8_t frame[DZRP_RESP_HEADER_LEN + MAX_BYTES_PER_FRAME];
+        uint32_t frameLen = 0;
+        if (!_readMemHeaderSent)
+        {
+            setLong(frame, _readMemRemaining);
+            frame[4] = _readMemSeqNo;
+            frameLen = DZRP_RESP_HEADER_LEN;
+            _readMemHeaderSent = true;
+        }
+
+        // Memory (wrapping at the top of the address space)
+        uint32_t readLen = (_readMemRemaining < MAX_BYTES_PER_FRAME) ? _readMemRemaining : MAX_BYTES_PER_FRAME;
+        if (_readMemAddr + readLen > DZRP_MAX_MEM_LEN)
+            readLen = DZRP_MAX_MEM_LEN - _readMemAddr;
+        HwManager::blockRead(_readMemAddr, frame + frameLen, readLen, false, false, false);
+        frameLen += readLen;
+        _readMemAddr = (_readMemAddr + readLen) % DZRP_MAX_MEM_LEN;
+        _readMemRemaining -= readLen;
+        CommandHandler::sendWithJSON(DZRP_FRAME_CMD_NAME, "", 0, frame, frameLen);
+        if (_readMemRemaining == 0)
+            _readMemActive = false;
+    }
+    return true;
+}
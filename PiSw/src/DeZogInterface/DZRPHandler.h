@@ -0,0 +1,120 @@
+// Bus Raider
+// Rob Dobson 2019-2020
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// DeZog Remote Protocol (binary)
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Carried in "dzrp" frames on the DeZog comms socket alongside the ZEsarUX text protocol. The frames
+// are a byte stream - a message may span several frames - and messages are length-prefixed
+// (little-endian throughout):
+//   command      - length(4) seq(1) cmd(1) payload(length)
+//   response     - length(4) seq(1) payload(length)
+//   notification - length(4) 0(1) ntf(1) payload(length)
+// Commands and response payloads:
+//   INIT            version(3) name\0           -> error(1) version(3) machineType(1) name\0
+//   CLOSE                                       -> (removes breakpoints added by DZRP)
+//   GET_REGISTERS                               -> PC SP AF BC DE HL IX IY AF' BC' DE' HL'(2 each) R I IM 0
+//   SET_REGISTER    regNum(1) value(2)          -> error(1)
+//   CONTINUE        en1(1) bp1(2) en2(1) bp2(2) -> (then a PAUSE notification when stopped)
+//   PAUSE                                       -> (then a PAUSE notification)
+//   READ_MEM        0(1) addr(2) len(2)         -> bytes(len) - 0 is 64K and the response is streamed
+//   WRITE_MEM       0(1) addr(2) bytes(n)       -> error(1)
+//   ADD_BREAKPOINT  addr(2) bank(1) cond\0      -> bpId(2) (0 if none free)
+//   REMOVE_BREAKPOINT bpId(2)                   ->
+//   NTF PAUSE       reason(1) addr(2) bank(1) reasonStr\0
+
+class DZRPHandler
+{
+public:
+    DZRPHandler();
+
+    // Service - sends streamed responses and the pause notification
+    void service();
+
+    // Handle bytes received in a dzrp frame
+    void handleRxData(const uint8_t* pData, int dataLen);
+
+    // Commands
+    enum DZRP_CMD
+    {
+        DZRP_CMD_INIT = 1,
+        DZRP_CMD_CLOSE = 2,
+        DZRP_CMD_GET_REGISTERS = 3,
+        DZRP_CMD_SET_REGISTER = 4,
+        DZRP_CMD_CONTINUE = 6,
+        DZRP_CMD_PAUSE = 7,
+        DZRP_CMD_READ_MEM = 8,
+        DZRP_CMD_WRITE_MEM = 9,
+        DZRP_CMD_ADD_BREAKPOINT = 40,
+        DZRP_CMD_REMOVE_BREAKPOINT = 41
+    };
+
+    // Notifications and break reasons
+    static const uint32_t DZRP_NTF_PAUSE = 1;
+    enum DZRP_BREAK_REASON
+    {
+        DZRP_BREAK_REASON_NONE = 0,
+        DZRP_BREAK_REASON_MANUAL = 1,
+        DZRP_BREAK_REASON_BREAKPOINT_HIT = 2
+    };
+
+    // Limits
+    static const uint32_t DZRP_MAX_MEM_LEN = 0x10000;
+    static const uint32_t DZRP_CMD_HEADER_LEN = 6;
+    static const uint32_t DZRP_RESP_HEADER_LEN = 5;
+    static const int DZRP_MAX_BREAKPOINTS = 100;
+
+private:
+    // Handle the complete messages in the rx buffer (held while a memory read is streaming)
+    void processRx();
+
+    // Handle a complete message
+    void handleMessage(uint32_t seqNo, uint32_t cmd, const uint8_t* pPayload, uint32_t payloadLen);
+    void sendResponse(uint32_t seqNo, const uint8_t* pPayload, uint32_t payloadLen);
+    void sendPauseNotification();
+    bool sendReadMemFrame();
+    static uint32_t getWord(const uint8_t* pBuf)
+    {
+        return pBuf[0] | (pBuf[1] << 8);
+    }
+    static void setWord(uint8_t* pBuf, uint32_t val)
+    {
+        pBuf[0] = val & 0xff;
+        pBuf[1] = (val >> 8) & 0xff;
+    }
+    static void setLong(uint8_t* pBuf, uint32_t val)
+    {
+        setWord(pBuf, val);
+        setWord(pBuf + 2, val >> 16);
+    }
+
+    // Received bytes - messages are handled when complete and one that can never fit is discarded
+    static const uint32_t DZRP_RX_BUF_LEN = DZRP_CMD_HEADER_LEN + DZRP_MAX_MEM_LEN + 8;
+    uint8_t _rxBuf[DZRP_RX_BUF_LEN];
+    uint32_t _rxLen;
+    uint32_t _rxDiscardLen;
+
+    // Memory read being streamed
+    bool _readMemActive;
+    uint32_t _readMemSeqNo;
+    uint32_t _readMemAddr;
+    uint32_t _readMemRemaining;
+    bool _readMemHeaderSent;
+    static const uint32_t MAX_BYTES_PER_FRAME = 8000;
+    static const uint32_t MIN_TX_AVAILABLE_FOR_FRAME = 12000;
+
+    // Running - pause notification is sent when the tracker stops
+    bool _continuePending;
+    bool _pauseRequested;
+    uint32_t _tempBreakpoints[2];
+    bool _tempBreakpointsEn[2];
+
+    // Breakpoints added - use the top of the tracker's numbered breakpoints
+    bool _breakpointUsed[DZRP_MAX_BREAKPOINTS];
+};
@@ -8,9 +8,9 @@
 #include "../System/lowlib.h"
 #include "../System/PiWiring.h"
 #include "../TargetBus/TargetTracker.h"
+#include "../TargetBus/TargetHistory.h"
 #include "../Hardware/HwManager.h"
 #include "../Machines/McManager.h"
-#include "../Disassembler/src/mdZ80.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Variables
@@ -122,7 +122,9 @@ void DeZogInterface::service()
             strlcpy(respMsg, "", DEZOG_RESP_MAX_LEN);
             if (pMirrorMemory)
             {
-                disasmZ80(pMirrorMemory, 0, curAddr, respMsg, INTEL, false, true);
+                const char* pDisassembly = NULL;
+                TargetTracker::getDisasmCache().disassemble(pMirrorMemory, curAddr, pDisassembly);
+                strlcpy(respMsg, pDisassembly, DEZOG_RESP_MAX_LEN);
                 mungeDisassembly(respMsg);
             }
             addPromptMsg(respMsg, DEZOG_RESP_MAX_LEN);
@@ -131,6 +133,9 @@ void DeZogInterface::service()
             _stepCompletionPending = false;
         }
     }
+
+    // Binary protocol
+    _dzrp.service();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -176,6 +181,12 @@ bool DeZogInterface::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uin
 
         return true;
     }
+    else if (strcasecmp(cmdName, "dzrp") == 0)
+    {
+        // Binary protocol - messages may span frames
+        _pThisInstance->_dzrp.handleRxData(pParams, paramsLen);
+        return true;
+    }
 
     return false;
 }
@@ -348,9 +359,32 @@ bool DeZogInterface::handleLine(char* pCmd, char* pResponse, int maxResponseLen,
     }
     else if (commandMatch(cmdStr, "set-register"))
     {
+        // Register and value (hex if it ends in h) e.g. HL=32768 or DE'=4000h - only the registers
+        // changed are injected into the target
+        char* pValStr = argStr ? strchr(argStr, '=') : NULL;
+        if (pValStr)
+        {
+            *pValStr++ = 0;
+            char* pEnd = NULL;
+            uint32_t value = strtoul(pValStr, &pEnd, 16);
+            if (!pEnd || ((*pEnd != 'h') && (*pEnd != 'H')))
+                value = strtoul(pValStr, NULL, 10);
+            if (!TargetTracker::setRegister(argStr, value))
+                LogWrite(MODULE_PREFIX, LOG_DEBUG, "set register %s invalid or injector busy", argStr);
+        }
+        TargetTracker::getRegsFormatted(pResponse, maxResponseLen);
     }
     else if (commandMatch(cmdStr, "get-stack-backtrace"))
     {
+        // Return addresses from the shadow call stack (innermost first) e.g. 1234H 0F00H
+        uint32_t maxFrames = (argStr && (*argStr != 0)) ? strtoul(argStr, NULL, 10) : TargetCallStack::MAX_DEPTH;
+        CallStackFrame frame;
+        char frameStr[10];
+        for (uint32_t i = 0; (i < maxFrames) && TargetTracker::getCallStack().getFrame(i, frame); i++)
+        {
+            ee_sprintf(frameStr, "%s%04XH", (i == 0) ? "" : " ", frame.retAddr);
+            strlcat(pResponse, frameStr, maxResponseLen);
+        }
     }
     else if (commandMatch(cmdStr, "read-memory"))
     {
@@ -397,13 +431,26 @@ bool DeZogInterface::handleLine(char* pCmd, char* pResponse, int maxResponseLen,
     }
     else if (commandMatch(cmdStr, "disassemble"))
     {
-        // Disassemble code at specified location
+        // Disassemble code at specified location (optionally a number of instructions)
         uint8_t* pMirrorMemory = HwManager::getMirrorMemForAddr(0);
-        if (pMirrorMemory)
+        if (pMirrorMemory && argStr)
         {
             uint32_t addr = strtol(argStr, NULL, 10);
-            disasmZ80(pMirrorMemory, 0, addr, pResponse, INTEL, false, true);
-            mungeDisassembly(pResponse);
+            uint32_t numLines = argStr2 ? strtol(argStr2, NULL, 10) : 1;
+            if (numLines > MAX_DISASSEMBLY_LINES)
+                numLines = MAX_DISASSEMBLY_LINES;
+            char lineStr[TargetDisasmCache::MAX_DISASSEMBLY_LEN];
+            for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++)
+            {
+                const char* pDisassembly = NULL;
+                int instrLen = TargetTracker::getDisasmCache().disassemble(pMirrorMemory, addr, pDisassembly);
+                strlcpy(lineStr, pDisassembly, sizeof(lineStr));
+                mungeDisassembly(lineStr);
+                if (lineIdx != 0)
+                    strlcat(pResponse, "\n", maxResponseLen);
+                strlcat(pResponse, lineStr, maxResponseLen);
+                addr = (addr + (instrLen > 0 ? instrLen : 1)) & 0xffff;
+            }
         }
         // LogWrite(FromDebugger, LOG_VERBOSE, "disassemble %s %s %s %d %s", argStr, argStr2, argRest, addr, pResponse);
     }
@@ -430,6 +477,16 @@ bool DeZogInterface::handleLine(char* pCmd, char* pResponse, int maxResponseLen,
         {
             int addr = strtol(argStr2+3, NULL, 16);
             TargetTracker::setBreakpointPCAddr(breakpointIdx, addr);
+
+            // Optional condition after the PC, e.g. PC=1234h and HL=4000h
+            const char* pCondition = argRest;
+            if (pCondition && (strncasecmp(pCondition, "and ", 4) == 0))
+                pCondition += 4;
+            else if (pCondition && (strncmp(pCondition, "&&", 2) == 0))
+                pCondition += 2;
+            if (!TargetTracker::setBreakpointCondition(breakpointIdx, pCondition))
+                LogWrite(MODULE_PREFIX, LOG_DEBUG, "breakpoint condition invalid %s", pCondition);
+            TargetTracker::setBreakpointTrace(breakpointIdx, false, NULL, 0);
         }        
     }
     else if (commandMatch(cmdStr, "set-breakpointaction"))
@@ -465,13 +522,22 @@ bool DeZogInterface::handleLine(char* pCmd, char* pResponse, int maxResponseLen,
     }
     else if (commandMatch(cmdStr, "clear-membreakpoints"))
     {
-        // TODO
-        // TargetTracker::enableBreakpoints();
+        TargetTracker::clearWatchpoints();
     }
     else if (commandMatch(cmdStr, "set-membreakpoint"))
     {
-        // TODO
-        // TargetTracker::setMemBreakpoint();
+        // Address (hex if it ends in h), type (0 = disable, 1 = read, 2 = write, 3 = both) and optional size
+        if (argStr)
+        {
+            char* pEnd = NULL;
+            uint32_t addr = strtoul(argStr, &pEnd, 16);
+            if (!pEnd || ((*pEnd != 'h') && (*pEnd != 'H')))
+                addr = strtoul(argStr, NULL, 10);
+            uint32_t accessMask = argStr2 ? strtoul(argStr2, NULL, 10) : 0;
+            uint32_t len = argRest ? strtoul(argRest, NULL, 10) : 1;
+            if (!TargetTracker::setWatchpointAtAddr(addr, len, accessMask))
+                LogWrite(MODULE_PREFIX, LOG_DEBUG, "set membreakpoint failed %s", argStr);
+        }
     }
     else if (commandMatch(cmdStr, "clear-fast-breakpoint"))
     {
@@ -542,6 +608,63 @@ bool DeZogInterface::handleLine(char* pCmd, char* pResponse, int maxResponseLen,
         // Return immediately (no prompt)
         return true;
     }
+    else if (commandMatch(cmdStr, "cpu-step-out"))
+    {
+        // Run until the current call returns
+        TargetTracker::stepOut();
+        _stepCompletionPending = true;
+        return true;
+    }
+    else if (commandMatch(cmdStr, "cpu-run-to"))
+    {
+        // Run to an address (hex if it ends in h)
+        if (argStr)
+        {
+            char* pEnd = NULL;
+            uint32_t addr = strtoul(argStr, &pEnd, 16);
+            if (!pEnd || ((*pEnd != 'h') && (*pEnd != 'H')))
+                addr = strtoul(argStr, NULL, 10);
+            TargetTracker::stepRunTo(addr);
+            _stepCompletionPending = true;
+            return true;
+        }
+    }
+    else if (commandMatch(cmdStr, "cpu-step-back"))
+    {
+        // Step back to the previous register checkpoint in the history
+        if (TargetTracker::stepBack())
+        {
+            _stepCompletionPending = true;
+            return true;
+        }
+        strlcat(pResponse, "Error. No history to step back to", maxResponseLen);
+    }
+    else if (commandMatch(cmdStr, "cpu-history"))
+    {
+        // History recording - enabled yes|no, is-enabled, clear, get-size
+        if (argStr && (strcasecmp(argStr, "enabled") == 0) && argStr2)
+        {
+            if (strcasecmp(argStr2, "yes") == 0)
+                TargetHistory::start(TargetHistory::DEFAULT_LOG_RECS, TargetHistory::DEFAULT_CHECKPOINTS,
+                            TargetHistory::DEFAULT_CHECKPOINT_INTERVAL);
+            else
+                TargetHistory::stop();
+        }
+        else if (argStr && (strcasecmp(argStr, "is-enabled") == 0))
+        {
+            strlcat(pResponse, TargetHistory::isRecording() ? "Yes" : "No", maxResponseLen);
+        }
+        else if (argStr && (strcasecmp(argStr, "clear") == 0))
+        {
+            TargetHistory::clear();
+        }
+        else if (argStr && (strcasecmp(argStr, "get-size") == 0))
+        {
+            char sizeStr[20];
+            ee_sprintf(sizeStr, "%u", TargetHistory::getNumRecs());
+            strlcat(pResponse, sizeStr, maxResponseLen);
+        }
+    }
     else if (commandMatch(cmdStr, "cpu-step"))
     {
         // Step into
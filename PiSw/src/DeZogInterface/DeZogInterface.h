@@ -9,6 +9,7 @@
 #include <stdlib.h>
 
 #include "../CommandInterface/CommandHandler.h"
+#include "DZRPHandler.h"
 
 class DeZogInterface
 {
@@ -42,6 +43,7 @@ private:
 
     static const int DEZOG_CMD_MAX_LEN = 1000;
     static const int DEZOG_RESP_MAX_LEN = 1000;
+    static const uint32_t MAX_DISASSEMBLY_LINES = 20;
 
     // Smartload state
     uint32_t _smartloadStartUs;
@@ -58,5 +60,8 @@ private:
 
     // Event pending
     bool _stepCompletionPending;
+
+    // Binary protocol (DZRP)
+    DZRPHandler _dzrp;
 };
 
@@ -39,7 +39,17 @@ BusSocketInfo HwManager::_busSocketInfo =
     0,
     false,
     BR_BUS_ACTION_GENERAL,
-    false
+    false,
+#ifdef DEBUG_IO_ACCESS
+    // All bus cycles and addresses
+    BR_BUS_CYCLE_ALL,
+#else
+    // Memory cycles only - hardware IO ports are handled by the BusAccess IO port table
+    BR_BUS_CYCLE_MREQ_RD_MASK | BR_BUS_CYCLE_MREQ_WR_MASK | BR_BUS_CYCLE_M1_MASK,
+#endif
+    0,
+    0,
+    "HwManager"
 };
 
 int HwManager::_commsSocketId = -1;
@@ -64,6 +74,15 @@ bool HwManager::_opcodeInjectEnable = false;
 // Mirror mode
 bool HwManager::_mirrorMode = false;
 
+// Memory page map
+HwManager::HwMemPage HwManager::_memPageMap[NUM_MEM_PAGES];
+uint8_t HwManager::_memPageTypes[NUM_MEM_PAGES];
+volatile bool HwManager::_memPageMapActive = false;
+volatile uint32_t HwManager::_memPageWriteProtectCount = 0;
+uint8_t HwManager::_memPageUnmappedRead[MEM_PAGE_SIZE];
+uint8_t HwManager::_memPageDiscardWrite[MEM_PAGE_SIZE];
+const char* HwManager::_memPageTypeNames[NUM_MEM_PAGE_TYPES] = { "RAM", "ROM", "WP", "IO", "UNMAPPED" };
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Statics
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -102,6 +121,10 @@ void HwManager::init()
 
     // Add hardware - HwBase constructor adds to HwManager
     new HwRAMROM();
+
+    // Memory page map - unmapped pages read as a floating bus
+    memset(_memPageUnmappedRead, 0xff, sizeof(_memPageUnmappedRead));
+    memPageMapClear();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -162,6 +185,7 @@ void HwManager::setMemoryEmulationMode(bool val)
 
     // Set
     _memoryEmulationMode = val;
+    memPageMapUpdate();
 }
 
 // Page out RAM/ROM for opcode injection
@@ -216,6 +240,7 @@ void HwManager::setMirrorMode(bool val)
 
     // Set
     _mirrorMode = val;
+    memPageMapUpdate();
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -280,6 +305,76 @@ BR_RETURN_TYPE HwManager::blockRead(uint32_t addr, uint8_t* pBuf, uint32_t len,
     return retVal;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory page map
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void HwManager::memPageMapSet(uint32_t addr, uint32_t len, HW_MEM_PAGE_TYPE pageType)
+{
+    if ((len == 0) || (addr >= STD_TARGET_MEMORY_LEN))
+        return;
+    uint32_t lastAddr = addr + len - 1;
+    if (lastAddr >= STD_TARGET_MEMORY_LEN)
+        lastAddr = STD_TARGET_MEMORY_LEN - 1;
+    for (uint32_t page = addr / MEM_PAGE_SIZE; page <= lastAddr / MEM_PAGE_SIZE; page++)
+        _memPageTypes[page] = pageType;
+    memPageMapUpdate();
+}
+
+void HwManager::memPageMapClear()
+{
+    for (int page = 0; page < NUM_MEM_PAGES; page++)
+        _memPageTypes[page] = HW_MEM_PAGE_RAM;
+    _memPageWriteProtectCount = 0;
+    memPageMapUpdate();
+}
+
+// Rebuild the page pointers - called when the page types, modes or hardware change
+void HwManager::memPageMapUpdate()
+{
+    // Stop the wait handler using the map while it is rebuilt
+    _memPageMapActive = false;
+    if (!_memoryEmulationMode && !_mirrorMode)
+        return;
+    uint8_t* pMirrorMemory = getMirrorMemForAddr(0);
+    if (!pMirrorMemory)
+        return;
+
+    for (int page = 0; page < NUM_MEM_PAGES; page++)
+    {
+        uint8_t* pPageMem = pMirrorMemory + page * MEM_PAGE_SIZE;
+        HwMemPage& memPage = _memPageMap[page];
+        switch (_memPageTypes[page])
+        {
+            case HW_MEM_PAGE_RAM:
+                memPage.pRead = pPageMem;
+                memPage.pWrite = pPageMem;
+                break;
+            case HW_MEM_PAGE_ROM:
+                memPage.pRead = pPageMem;
+                memPage.pWrite = _memPageDiscardWrite;
+                break;
+            case HW_MEM_PAGE_WRITE_PROTECTED:
+                memPage.pRead = pPageMem;
+                memPage.pWrite = NULL;
+                break;
+            case HW_MEM_PAGE_UNMAPPED:
+                memPage.pRead = _memPageUnmappedRead;
+                memPage.pWrite = _memPageDiscardWrite;
+                break;
+            default:
+                memPage.pRead = NULL;
+                memPage.pWrite = NULL;
+                break;
+        }
+
+        // In mirror mode reads come from the target's memory
+        if (!_memoryEmulationMode || _mirrorMode)
+            memPage.pRead = NULL;
+    }
+    _memPageMapActive = true;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Mirror memory
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -402,6 +497,52 @@ bool HwManager::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t*
         strlcat(pRespJson, "]", maxRespLen);
         return true;
     }
+    else if (strcasecmp(cmdName, "memMapSet") == 0)
+    {
+        // Address range and page type
+        static const int MAX_CMD_PARAM_STR = 100;
+        char paramStr[MAX_CMD_PARAM_STR+1];
+        if (!jsonGetValueForKey("addr", pCmdJson, paramStr, MAX_CMD_PARAM_STR))
+            return false;
+        uint32_t addr = strtoul(paramStr, NULL, 0);
+        if (!jsonGetValueForKey("len", pCmdJson, paramStr, MAX_CMD_PARAM_STR))
+            return false;
+        uint32_t len = strtoul(paramStr, NULL, 0);
+        if (!jsonGetValueForKey("type", pCmdJson, paramStr, MAX_CMD_PARAM_STR))
+            return false;
+        int pageType = -1;
+        for (int i = 0; i < NUM_MEM_PAGE_TYPES; i++)
+            if (strcasecmp(paramStr, _memPageTypeNames[i]) == 0)
+                pageType = i;
+        if (pageType < 0)
+        {
+            strlcpy(pRespJson, "\"err\":\"invalidType\"", maxRespLen);
+            return true;
+        }
+        memPageMapSet(addr, len, (HW_MEM_PAGE_TYPE)pageType);
+        strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "memMapClear") == 0)
+    {
+        memPageMapClear();
+        strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "memMapGet") == 0)
+    {
+        // One character per page - R=RAM, O=ROM, W=write protected, I=IO mapped, U=unmapped
+        static const char pageTypeCodes[NUM_MEM_PAGE_TYPES+1] = "ROWIU";
+        char pageChars[NUM_MEM_PAGES+1];
+        for (int page = 0; page < NUM_MEM_PAGES; page++)
+            pageChars[page] = pageTypeCodes[_memPageTypes[page]];
+        pageChars[NUM_MEM_PAGES] = 0;
+        ee_sprintf(pRespJson, "\"err\":\"ok\",\"active\":%d,\"wpWrites\":%u,\"pages\":\"",
+                    _memPageMapActive, _memPageWriteProtectCount);
+        strlcat(pRespJson, pageChars, maxRespLen);
+        strlcat(pRespJson, "\"", maxRespLen);
+        return true;
+    }
     return false;
 }
 
@@ -423,6 +564,24 @@ void HwManager::busActionCompleteStatic(BR_BUS_ACTION actionType, BR_BUS_ACTION_
 void HwManager::handleWaitInterruptStatic(uint32_t addr, uint32_t data, 
         uint32_t flags, uint32_t& retVal)
 {
+    // Memory cycles in emulation/mirror mode are handled by the page map
+    if (_memPageMapActive && (flags & BR_CTRL_BUS_MREQ_MASK))
+    {
+        const HwMemPage& memPage = _memPageMap[(addr >> 8) & 0xff];
+        if (flags & BR_CTRL_BUS_WR_MASK)
+        {
+            if (memPage.pWrite)
+                memPage.pWrite[addr & 0xff] = data;
+            else if (_memPageTypes[(addr >> 8) & 0xff] == HW_MEM_PAGE_WRITE_PROTECTED)
+                _memPageWriteProtectCount++;
+        }
+        else if (memPage.pRead)
+        {
+            retVal = memPage.pRead[addr & 0xff];
+        }
+        return;
+    }
+
     // Iterate hardware
     for (int i = 0; i < _numHardware; i++)
         if (_pHw[i] && _pHw[i]->isEnabled())
@@ -460,6 +619,7 @@ bool HwManager::enableHw(const char* hwName, bool enable)
         if (strcasecmp(_pHw[i]->name(), hwName) == 0)
         {
             _pHw[i]->enable(enable);
+            memPageMapUpdate();
             return true;
         }
     }
@@ -475,6 +635,7 @@ void HwManager::disableAll()
             continue;
         _pHw[i]->enable(false);
     }
+    memPageMapUpdate();
 }
 
 // Configure
@@ -487,7 +648,10 @@ void HwManager::configureHw(const char* hwName, const char* hwDefJson)
             continue;
         if (strcasecmp(_pHw[i]->name(), hwName) == 0)
         {
+            // Mirror memory may be reallocated
+            _memPageMapActive = false;
             _pHw[i]->configure(hwDefJson);
+            memPageMapUpdate();
             break;
         }
     }
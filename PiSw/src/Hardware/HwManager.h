@@ -21,6 +21,17 @@ public:
 };
 #endif
 
+// Memory page types used in memory emulation and mirror modes
+enum HW_MEM_PAGE_TYPE
+{
+    HW_MEM_PAGE_RAM,
+    HW_MEM_PAGE_ROM,
+    HW_MEM_PAGE_WRITE_PROTECTED,
+    HW_MEM_PAGE_IO_MAPPED,
+    HW_MEM_PAGE_UNMAPPED,
+    NUM_MEM_PAGE_TYPES
+};
+
 class HwManager
 {
 public:
@@ -81,6 +92,18 @@ public:
     // Get mirror memory for address
     static uint8_t* getMirrorMemForAddr(uint32_t addr);
 
+    // Memory page map - sets the type of the 256 byte pages covering addr to addr+len-1
+    static void memPageMapSet(uint32_t addr, uint32_t len, HW_MEM_PAGE_TYPE pageType);
+    static void memPageMapClear();
+    static HW_MEM_PAGE_TYPE memPageMapGetType(uint32_t addr)
+    {
+        return (HW_MEM_PAGE_TYPE)_memPageTypes[(addr >> 8) & 0xff];
+    }
+    static uint32_t memPageMapGetWriteProtectCount()
+    {
+        return _memPageWriteProtectCount;
+    }
+
     // Setup from Json
     static void setupFromJson(const char* jsonKey, const char* hwJson);
 
@@ -117,6 +140,25 @@ private:
     // Opcode injection mode
     static bool _opcodeInjectEnable;
 
+    // Memory page map - in emulation mode reads come from pRead and in emulation or
+    // mirror mode writes go to pWrite - NULL pointers leave the cycle to other sockets
+    // (IO mapped pages) or count it (write protected pages)
+    static const int MEM_PAGE_SIZE = 256;
+    static const int NUM_MEM_PAGES = STD_TARGET_MEMORY_LEN / MEM_PAGE_SIZE;
+    struct HwMemPage
+    {
+        uint8_t* pRead;
+        uint8_t* pWrite;
+    };
+    static HwMemPage _memPageMap[NUM_MEM_PAGES];
+    static uint8_t _memPageTypes[NUM_MEM_PAGES];
+    static volatile bool _memPageMapActive;
+    static volatile uint32_t _memPageWriteProtectCount;
+    static uint8_t _memPageUnmappedRead[MEM_PAGE_SIZE];
+    static uint8_t _memPageDiscardWrite[MEM_PAGE_SIZE];
+    static void memPageMapUpdate();
+    static const char* _memPageTypeNames[NUM_MEM_PAGE_TYPES];
+
     // Default hardware list (to add if no hardware specified)
     static const char* _pDefaultHardwareList;
 
@@ -38,6 +38,21 @@ HwRAMROM::HwRAMROM() : HwBase()
     hwReset();
 }
 
+// Enable
+void HwRAMROM::enable(bool en)
+{
+    HwBase::enable(en);
+
+    // Bank registers and page enable IO ports
+    BusAccess::ioPortHandlerRemove(handleIOPortStatic, this);
+    if (en)
+    {
+        for (int i = 0; i < NUM_BANKS; i++)
+            BusAccess::ioPortHandlerAdd(0xff, _bankHwBaseIOAddr + i, BR_BUS_CYCLE_IORQ_WR_MASK, handleIOPortStatic, this);
+        BusAccess::ioPortHandlerAdd(0xff, _bankHwPageEnIOAddr, BR_BUS_CYCLE_IORQ_WR_MASK, handleIOPortStatic, this);
+    }
+}
+
 // Configure
 void HwRAMROM::configure([[maybe_unused]] const char* jsonConfig)
 {
@@ -214,23 +229,18 @@ void HwRAMROM::mirrorClone()
 // Emulate 64K linear memory with banked memory card
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void HwRAMROM::setBanksToEmulate64KAddrSpace(bool upperChip)
+void HwRAMROM::setBanksToEmulate64KAddrSpace(bool upperChip, bool busRqAndRelease)
 {
-    // Write consecutive bank numbers to all bank registers 
-    if (upperChip)
-    {
-        const uint8_t bankNumData[] = { 32, 33, 34, 35 };
-        BusAccess::blockWrite(BANK_16K_BASE_ADDR, bankNumData, 4, false, true);
-    }
-    else
-    {
-        const uint8_t bankNumData[] = { 0, 1, 2, 3 };
-        BusAccess::blockWrite(BANK_16K_BASE_ADDR, bankNumData, 4, false, true);
-    }
-
-    // Enable register outputs
-    const uint8_t setRegEn[] = { 1 };
-    BusAccess::blockWrite(BANK_16K_PAGE_ENABLE, setRegEn, 1, false, true);
+    // Write consecutive bank numbers to all bank registers and enable register outputs
+    // - both writes share a single bus request when one is needed
+    uint8_t firstBank = upperChip ? 32 : 0;
+    uint8_t bankNumData[] = { firstBank, uint8_t(firstBank + 1), uint8_t(firstBank + 2), uint8_t(firstBank + 3) };
+    uint8_t setRegEn[] = { 1 };
+    const BusXfer xfers[] = {
+        { BANK_16K_BASE_ADDR, bankNumData, sizeof(bankNumData), true, true },
+        { BANK_16K_PAGE_ENABLE, setRegEn, 1, true, true }
+    };
+    BusAccess::blockAccessVector(xfers, sizeof(xfers) / sizeof(xfers[0]), busRqAndRelease);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -366,7 +376,7 @@ BR_RETURN_TYPE HwRAMROM::physicalBlockAccess(uint32_t addr, const uint8_t* pBuf,
 
         // Check if banks should be set to emulate 64K linear address space
         if ((_memCardOpts & MEM_OPT_EMULATE_LINEAR) || (_memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER))
-            setBanksToEmulate64KAddrSpace(_memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER);
+            setBanksToEmulate64KAddrSpace(_memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER, false);
     }
     return BR_NOT_HANDLED;
 }
@@ -596,7 +606,7 @@ void HwRAMROM::handleBusActionComplete([[maybe_unused]]BR_BUS_ACTION actionType,
                 // Check if banks should be set to emulate 64K linear address space
                 if ((_memCardOpts & MEM_OPT_EMULATE_LINEAR) || (_memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER))
                 {
-                    setBanksToEmulate64KAddrSpace(_memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER);
+                    setBanksToEmulate64KAddrSpace(_memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER, true);
                     // LogWrite(_logPrefix, LOG_DEBUG, "HWAction set to emulate 64K using %s 512K chip",
                     //             _memCardOpts & MEM_OPT_EMULATE_LINEAR_UPPER ? "upper" : "lower");
                 }
@@ -629,30 +639,26 @@ void HwRAMROM::handleMemOrIOReq([[maybe_unused]] uint32_t addr, [[maybe_unused]]
             else if ((flags & BR_CTRL_BUS_RD_MASK) && (!_mirrorMode))
             {
                 // In mirror mode only writes are handled - reads come from the systems memory
-                retVal = (retVal & 0xffff0000) | pMemory[addr];
+                retVal = pMemory[addr];
             }
         }
     }
+}
 
-    // Check for IO address range used by this card
-    if (flags & BR_CTRL_BUS_IORQ_MASK)
+// Handle IO writes to the bank registers and page enable (registered for these ports only)
+void HwRAMROM::handleIOPortStatic(void* pParam, uint32_t addr, uint32_t data, 
+        [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+{
+    HwRAMROM* pHw = (HwRAMROM*)pParam;
+    uint32_t ioAddr = (addr & 0xff);
+    if ((ioAddr >= pHw->_bankHwBaseIOAddr) && (ioAddr < pHw->_bankHwBaseIOAddr + NUM_BANKS))
     {
-        uint32_t ioAddr = (addr & 0xff);
-        if ((ioAddr >= _bankHwBaseIOAddr) && (ioAddr < _bankHwBaseIOAddr + NUM_BANKS))
-        {
-            if(flags & BR_CTRL_BUS_WR_MASK)
-            {
-                _bankRegisters[ioAddr - _bankHwBaseIOAddr] = data;
-                // ISR_VALUE(ISR_ASSERT_CODE_DEBUG_B + ioAddr - _bankHwBaseIOAddr, data);
-            }
-        }
-        else if (ioAddr == _bankHwPageEnIOAddr)
-        {
-            if (flags & BR_CTRL_BUS_WR_MASK)
-            {
-                _bankRegisterOutputEnable = ((data & 0x01) != 0);
-                // ISR_VALUE(ISR_ASSERT_CODE_DEBUG_K, data);
-            }
-        }
+        pHw->_bankRegisters[ioAddr - pHw->_bankHwBaseIOAddr] = data;
+        // ISR_VALUE(ISR_ASSERT_CODE_DEBUG_B + ioAddr - _bankHwBaseIOAddr, data);
+    }
+    else if (ioAddr == pHw->_bankHwPageEnIOAddr)
+    {
+        pHw->_bankRegisterOutputEnable = ((data & 0x01) != 0);
+        // ISR_VALUE(ISR_ASSERT_CODE_DEBUG_K, data);
     }
 }
@@ -11,6 +11,9 @@ public:
     // Configure
     virtual void configure(const char* jsonConfig);
 
+    // Enable (bank register IO ports are only handled when enabled)
+    virtual void enable(bool en);
+
     // Page out RAM/ROM due to emulation
     virtual void setMemoryEmulationMode(bool pageOut);
 
@@ -56,6 +59,9 @@ public:
 private:
     static const char* _logPrefix;
 
+    // Bank register IO port handler
+    static void handleIOPortStatic(void* pParam, uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
+
     // Paging hardware support
     bool _memoryEmulationMode;
     bool _pageOutEnabled;
@@ -128,7 +134,7 @@ private:
     // Access linear or banked memory
     BR_RETURN_TYPE physicalBlockAccess(uint32_t addr, const uint8_t* pBuf, uint32_t len,
             bool busRqAndRelease, bool iorq, bool write);
-    void setBanksToEmulate64KAddrSpace(bool upperChip);
+    void setBanksToEmulate64KAddrSpace(bool upperChip, bool busRqAndRelease);
     BR_RETURN_TYPE readWriteBankedMemory(uint32_t addr, uint8_t* pBuf, uint32_t len,
             bool iorq, bool write);
 
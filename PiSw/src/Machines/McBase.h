@@ -96,9 +96,6 @@ public:
     // Handle a file
     virtual bool fileHandler(const char* pFileInfo, const uint8_t* pFileData, int fileLen) = 0;
 
-    // Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-    virtual void busAccessCallback(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal) = 0;
-
     // Bus action complete callback
     virtual void busActionCompleteCallback(BR_BUS_ACTION actionType) = 0;
 
@@ -42,7 +42,8 @@ CommsSocketInfo McManager::_commsSocketInfo =
 BusSocketInfo McManager::_busSocketInfo = 
 {
     true,
-    handleWaitInterruptStatic,
+    // Machines decode IO through the BusAccess IO port table so no access callback
+    NULL,
     McManager::busActionCompleteStatic,
     false,
     false,
@@ -57,7 +58,11 @@ BusSocketInfo McManager::_busSocketInfo =
     0,
     false,
     BR_BUS_ACTION_DISPLAY,
-    false
+    false,
+    BR_BUS_CYCLE_IORQ_RD_MASK | BR_BUS_CYCLE_IORQ_WR_MASK,
+    0,
+    0,
+    "McManager"
 };
 
 // Pending actions
@@ -321,6 +326,10 @@ bool McManager::setupMachine(const char* mcJson)
     if (!pMc)
         return false;
 
+    // Disable previous machine (removes its IO port handlers)
+    if (_pCurMachine && (_pCurMachine != pMc))
+        _pCurMachine->disable();
+
     // Set cur machine
     _pCurMachine = pMc;
 
@@ -786,14 +795,3 @@ void McManager::busActionCompleteStatic(BR_BUS_ACTION actionType, [[maybe_unused
         }
     }
 }
-
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// Handle wait interrupt
-/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-void McManager::handleWaitInterruptStatic(uint32_t addr, uint32_t data, 
-        uint32_t flags, uint32_t& retVal)
-{
-    if (_pCurMachine)
-        _pCurMachine->busAccessCallback(addr, data, flags, retVal);
-}
\ No newline at end of file
@@ -80,10 +80,6 @@ private:
     // Bus action complete callback
     static void busActionCompleteStatic(BR_BUS_ACTION actionType, BR_BUS_ACTION_REASON reason);
 
-    // Wait interrupt handler
-    static void handleWaitInterruptStatic(uint32_t addr, uint32_t data, 
-            uint32_t flags, uint32_t& retVal);
-            
     // Characters received from the host
     static const uint32_t MAX_RX_HOST_CHARS = 10000;
     static uint8_t _rxHostCharsBuffer[MAX_RX_HOST_CHARS+1];
@@ -126,12 +126,6 @@ bool McRobsZ80::fileHandler(const char* pFileInfo, const uint8_t* pFileData, int
     return true;
 }
 
-// Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-void McRobsZ80::busAccessCallback([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
-        [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
-{
-}
-
 // Bus action complete callback
 void McRobsZ80::busActionCompleteCallback(BR_BUS_ACTION actionType)
 {
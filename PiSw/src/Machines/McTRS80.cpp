@@ -63,11 +63,16 @@ void McTRS80::enable()
     // Invalidate screen buffer
     _screenBufferValid = false;
     _keyBufferDirty = false;
+
+    // IO ports - joystick is 0x13 (full 16-bit decode)
+    BusAccess::ioPortHandlerRemove(handleIOPortJoystickStatic, this);
+    BusAccess::ioPortHandlerAdd(0xffff, 0x13, BR_BUS_CYCLE_IORQ_RD_MASK, handleIOPortJoystickStatic, this);
 }
 
 // Disable machine
 void McTRS80::disable()
 {
+    BusAccess::ioPortHandlerRemove(handleIOPortJoystickStatic, this);
 }
 
 // void McTRS80::handleRegisters(Z80Registers& regs)
@@ -330,34 +335,16 @@ bool McTRS80::fileHandler(const char* pFileInfo, const uint8_t* pFileData, int f
     return true;
 }
 
-// Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-void McTRS80::busAccessCallback([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
-            [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+// Joystick - indicate no buttons are pressed
+void McTRS80::handleIOPortJoystickStatic([[maybe_unused]] void* pParam, [[maybe_unused]] uint32_t addr, 
+            [[maybe_unused]] uint32_t data, [[maybe_unused]] uint32_t flags, uint32_t& retVal)
 {
     // if (flags & BR_CTRL_BUS_IORQ_MASK)
     //     LogWrite(_logPrefix, LOG_DEBUG, "IORQ %s from %04x %02x", 
     //             (flags & BR_CTRL_BUS_RD_MASK) ? "RD" : ((flags & BR_CTRL_BUS_WR_MASK) ? "WR" : "??"),
     //             addr, 
     //             (flags & BR_CTRL_BUS_WR_MASK) ? data : retVal);
-    // Check for read from IO
-    if ((flags & BR_CTRL_BUS_RD_MASK) && (flags & BR_CTRL_BUS_IORQ_MASK))
-    {
-        // Decode port
-        if (addr == 0x13)  // Joystick
-        {
-            // Indicate no buttons are pressed
-            retVal = 0xff;
-        }
-    }
-    // Check for read from IO
-    else if ((flags & BR_CTRL_BUS_RD_MASK) && (flags & BR_CTRL_BUS_IORQ_MASK))
-    {
-        // FDD
-        if ((addr >= 0x37ec) && (addr < 0x37ef))
-        {
-            handleWD1771DiskController(addr-0x37ec, data, flags, retVal);
-        }
-    }
+    retVal = 0xff;
 }
 
 // Bus action complete callback
@@ -383,9 +370,3 @@ void McTRS80::busActionCompleteCallback(BR_BUS_ACTION actionType)
         }
     }
 }
-
-// Handle WD1771 access
-void McTRS80::handleWD1771DiskController([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
-            [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
-{
-}
@@ -41,13 +41,10 @@ public:
     // Handle a file
     virtual bool fileHandler(const char* pFileInfo, const uint8_t* pFileData, int fileLen);
 
-    // Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-    virtual void busAccessCallback(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
-
     // Bus action complete callback
     virtual void busActionCompleteCallback(BR_BUS_ACTION actionType);
 
 private:
+    static void handleIOPortJoystickStatic(void* pParam, uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
     void updateDisplayFromBuffer(uint8_t* pScrnBuffer, uint32_t bufLen);
-    void handleWD1771DiskController(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
 };
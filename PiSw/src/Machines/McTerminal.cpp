@@ -112,6 +112,12 @@ void McTerminal::enable()
         _pTerminalEmulation->init(_activeDescriptorTable.displayPixelsX/_activeDescriptorTable.displayCellX, 
                     _activeDescriptorTable.displayPixelsY/_activeDescriptorTable.displayCellY);
 
+    // Emulated 6850 is on ports 0x80..0xbf (even ports control/status, odd ports data)
+    BusAccess::ioPortHandlerRemove(handleIOPort6850Static, this);
+    if (_emulate6850)
+        BusAccess::ioPortHandlerAdd(0xc0, 0x80, BR_BUS_CYCLE_IORQ_RD_MASK | BR_BUS_CYCLE_IORQ_WR_MASK,
+                    handleIOPort6850Static, this);
+
     // Invalidate screen caches
     invalidateScreenCaches(false);
 }
@@ -119,27 +125,24 @@ void McTerminal::enable()
 // Disable machine
 void McTerminal::disable()
 {
+    BusAccess::ioPortHandlerRemove(handleIOPort6850Static, this);
 }
 
 // Setup machine from JSON
 bool McTerminal::setupMachine(const char* mcName, const char* mcJson)
 {
-    // Setup via base class implementation
-    bool rslt = McBase::setupMachine(mcName, mcJson);
-
-    // Check for variations
+    // Check for variations - before the base class setup as that enables the machine
     _emulate6850 = true;
     _emulationInterruptOnRx = false;
-    getDescriptorTable()->monitorIORQ = true;
     static const int MAX_UART_EMULATION_STR = 100;
     char emulUartStr[MAX_UART_EMULATION_STR];
     bool emulUartValid = jsonGetValueForKey("emulate6850", mcJson, emulUartStr, MAX_UART_EMULATION_STR);
     if (emulUartValid)
-    {
         _emulate6850 = (strtol(emulUartStr, NULL, 10) != 0);
-        if (!_emulate6850)
-            getDescriptorTable()->monitorIORQ = false;
-    }
+
+    // Setup via base class implementation
+    bool rslt = McBase::setupMachine(mcName, mcJson);
+    getDescriptorTable()->monitorIORQ = _emulate6850;
 
     // Keyboard type
     static const int KEYBOARD_TYPE_STR_MAX = 100;
@@ -149,6 +152,7 @@ bool McTerminal::setupMachine(const char* mcName, const char* mcJson)
     {
         _keyConversion.setKeyboardTypeStr(keyboardTypeStr);
     }
+
     LogWrite(_logPrefix, LOG_DEBUG, "setupMachine emulate6850 %s keyboardType %s",
              _emulate6850 ? "Y" : "N",
              _keyConversion.getKeyboardTypeStr());
@@ -412,94 +416,90 @@ bool McTerminal::fileHandler(const char* pFileInfo, const uint8_t* pFileData, in
     return true;
 }
 
-// Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-void McTerminal::busAccessCallback([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
-            [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+// Handle IO to emulated 6850 UART (registered for IO port range)
+void McTerminal::handleIOPort6850Static(void* pParam, uint32_t addr, uint32_t data, 
+            uint32_t flags, uint32_t& retVal)
 {
+    ((McTerminal*)pParam)->handleIOPort6850(addr, data, flags, retVal);
+}
 
+void McTerminal::handleIOPort6850(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal)
+{
     // static int debugCount = 0;
 
-    // Check for uart emulation
-    if (_emulate6850)
+    if (flags & BR_CTRL_BUS_RD_MASK)
     {
-        // See if IORQ at appropriate address
-        if ((flags & BR_CTRL_BUS_IORQ_MASK) && (!(flags & BR_CTRL_BUS_M1_MASK)) && ((addr & 0xc0) == 0x80))
+        if ((addr & 0x01) == 0)
         {
-            if (flags & BR_CTRL_BUS_RD_MASK)
+            // Read status
+            // Set the transmit data empty high to indicate UART can transmit
+            retVal = 0x02;
+
+            // Check if anything to send to target
+            if (_sendToTargetBufPos.canGet())
             {
-                if ((addr & 0x01) == 0)
-                {
-                    // Read status
-                    // Set the transmit data empty high to indicate UART can transmit
-                    retVal = 0x02;
+                retVal |= 0x01;
+            }
 
-                    // Check if anything to send to target
-                    if (_sendToTargetBufPos.canGet())
-                    {
-                        retVal |= 0x01;
-                    }
+            // Check if reset needed - in which case return overrun and framing errors
+            if (_emulation6850NeedsReset)
+                retVal |= 0x30;
+            else if (_emulation6850NotSetup)
+                retVal = 0;
 
-                    // Check if reset needed - in which case return overrun and framing errors
-                    if (_emulation6850NeedsReset)
-                        retVal |= 0x30;
-                    else if (_emulation6850NotSetup)
-                        retVal = 0;
-        
-                    // LogWrite(_logPrefix, LOG_DEBUG, "IORQ READ %04x returning %02x", addr, retVal);
-                }
-                else
-                {
-                    // Read received data
-                    retVal = 0;
-                    if (_sendToTargetBufPos.canGet())
-                    {
-                        retVal = _sendToTargetBuf[_sendToTargetBufPos.posToGet()];
-                        _sendToTargetBufPos.hasGot();
+            // LogWrite(_logPrefix, LOG_DEBUG, "IORQ READ %04x returning %02x", addr, retVal);
+        }
+        else
+        {
+            // Read received data
+            retVal = 0;
+            if (_sendToTargetBufPos.canGet())
+            {
+                retVal = _sendToTargetBuf[_sendToTargetBufPos.posToGet()];
+                _sendToTargetBufPos.hasGot();
 
-                        // Interrupt if chars still available
-                        if ((_emulationInterruptOnRx) && _sendToTargetBufPos.canGet())
-                            McManager::targetIrq();
-                    }
-                    _emulation6850NeedsReset = false;
-                }
+                // Interrupt if chars still available
+                if ((_emulationInterruptOnRx) && _sendToTargetBufPos.canGet())
+                    McManager::targetIrq();
             }
-            else if (flags & BR_CTRL_BUS_WR_MASK)
+            _emulation6850NeedsReset = false;
+        }
+    }
+    else if (flags & BR_CTRL_BUS_WR_MASK)
+    {
+        if ((addr & 0x01) == 0)
+        {
+            // Write control
+            // Check interrupt on rx char available
+            _emulationInterruptOnRx = ((data & 0x80) != 0);
+            // Reset
+            if ((data & 0x03) == 0x03)
             {
-                if ((addr & 0x01) == 0)
-                {
-                    // Write control
-                    // Check interrupt on rx char available
-                    _emulationInterruptOnRx = ((data & 0x80) != 0);
-                    // Reset
-                    if ((data & 0x03) == 0x03)
-                    {
-                        _emulation6850NeedsReset = false;
-                        _emulation6850NotSetup = true;
-                    }
-                    else if (_emulation6850NotSetup)
-                    {
-                        _emulation6850NotSetup = false;
-                    }
-                }
-                else
-                {
-                    // Write data - send to terminal window
-                    if (_pTerminalEmulation)
-                        _pTerminalEmulation->putChar(data);
-                }
+                _emulation6850NeedsReset = false;
+                _emulation6850NotSetup = true;
             }
-            // if (debugCount < 50)
-            // {
-            // LogWrite(_logPrefix, LOG_DEBUG, "IORQ %s %04x data %02x retVal %02x irq %d",
-            //         (flags & BR_CTRL_BUS_RD_MASK) ? "RD" : ((flags & BR_CTRL_BUS_WR_MASK) ? "WR" : "??"),
-            //         addr, 
-            //         data,
-            //         retVal,
-            //         _emulationInterruptOnRx);
-            //     debugCount++;
-            // }
+            else if (_emulation6850NotSetup)
+            {
+                _emulation6850NotSetup = false;
+            }
+        }
+        else
+        {
+            // Write data - send to terminal window
+            if (_pTerminalEmulation)
+                _pTerminalEmulation->putChar(data);
         }
     }
+    // if (debugCount < 50)
+    // {
+    // LogWrite(_logPrefix, LOG_DEBUG, "IORQ %s %04x data %02x retVal %02x irq %d",
+    //         (flags & BR_CTRL_BUS_RD_MASK) ? "RD" : ((flags & BR_CTRL_BUS_WR_MASK) ? "WR" : "??"),
+    //         addr, 
+    //         data,
+    //         retVal,
+    //         _emulationInterruptOnRx);
+    //     debugCount++;
+    // }
 }
 
 // Bus action complete callback
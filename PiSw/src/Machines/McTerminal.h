@@ -37,6 +37,10 @@ private:
     RingBufferPosn _sendToTargetBufPos;
     uint8_t _sendToTargetBuf[MAX_SEND_TO_TARGET_CHARS];
 
+    // Emulated 6850 IO port handler
+    static void handleIOPort6850Static(void* pParam, uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
+    void handleIOPort6850(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
+
 public:
 
     McTerminal();
@@ -59,9 +63,6 @@ public:
     // Handle a file
     virtual bool fileHandler(const char* pFileInfo, const uint8_t* pFileData, int fileLen);
 
-    // Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-    virtual void busAccessCallback(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
-
     // Bus action complete callback
     virtual void busActionCompleteCallback(BR_BUS_ACTION actionType);
 
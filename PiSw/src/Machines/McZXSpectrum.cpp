@@ -93,11 +93,19 @@ void McZXSpectrum::enable()
     _screenBufferRefreshCount = 0;
     _pFrameBuffer = NULL;
     _pfbSize = 0;
+
+    // IO ports - keyboard is any even port and Kempston joystick is 0x1f
+    BusAccess::ioPortHandlerRemove(handleIOPortKeyboardStatic, this);
+    BusAccess::ioPortHandlerRemove(handleIOPortJoystickStatic, this);
+    BusAccess::ioPortHandlerAdd(0x01, 0x00, BR_BUS_CYCLE_IORQ_RD_MASK, handleIOPortKeyboardStatic, this);
+    BusAccess::ioPortHandlerAdd(0xff, 0x1f, BR_BUS_CYCLE_IORQ_RD_MASK, handleIOPortJoystickStatic, this);
 }
 
 // Disable machine
 void McZXSpectrum::disable()
 {
+    BusAccess::ioPortHandlerRemove(handleIOPortKeyboardStatic, this);
+    BusAccess::ioPortHandlerRemove(handleIOPortJoystickStatic, this);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -513,45 +521,38 @@ bool McZXSpectrum::fileHandler(const char* pFileInfo, const uint8_t* pFileData,
 // Bus access
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-// Handle a request for memory or IO - or possibly something like in interrupt vector in Z80
-void McZXSpectrum::busAccessCallback([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
-            [[maybe_unused]] uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+// Keyboard - read from any even port
+void McZXSpectrum::handleIOPortKeyboardStatic([[maybe_unused]] void* pParam, uint32_t addr, 
+            [[maybe_unused]] uint32_t data, [[maybe_unused]] uint32_t flags, uint32_t& retVal)
 {
-    
     #ifdef USE_PI_SPI0_CE0_AS_DEBUG_PIN
         digitalWrite(BR_DEBUG_PI_SPI0_CE0, 1);
     #endif
 
-    if ((flags & BR_CTRL_BUS_RD_MASK) && (flags & BR_CTRL_BUS_IORQ_MASK))
+    // Iterate bits in upper address to get the code by and-ing the key bits
+    // this emulates the operation of a bitmapped keyboard matrix
+    retVal = 0xff;
+    uint32_t addrBitMask = 0x0100;
+    for (int keyRow = 0; keyRow < ZXSPECTRUM_KEYBOARD_NUM_ROWS; keyRow++)
     {
-        // Check for a keyboard address range - any even port number
-        if ((addr & 0x01) == 0)
-        {
-            // Iterate bits in upper address to get the code by and-ing the key bits
-            // this emulates the operation of a bitmapped keyboard matrix
-            retVal = 0xff;
-            uint32_t addrBitMask = 0x0100;
-            for (int keyRow = 0; keyRow < ZXSPECTRUM_KEYBOARD_NUM_ROWS; keyRow++)
-            {
-                if ((addr & addrBitMask) == 0)
-                    retVal &= _spectrumKeyboardIOBitMap[keyRow];
-                addrBitMask = addrBitMask << 1;
-            }
-        }
-        else if ((addr & 0xff) == 0x1f)
-        {
-            // Kempston joystick - just say nothing pressed
-            retVal = 0;
-        }
-        // LogWrite(_logPrefix, LOG_DEBUG, "IO Read from %04x flags %04x data %02x retVal %02x", addr, flags, data, retVal);
-
+        if ((addr & addrBitMask) == 0)
+            retVal &= _spectrumKeyboardIOBitMap[keyRow];
+        addrBitMask = addrBitMask << 1;
     }
+    // LogWrite(_logPrefix, LOG_DEBUG, "IO Read from %04x flags %04x data %02x retVal %02x", addr, flags, data, retVal);
 
     #ifdef USE_PI_SPI0_CE0_AS_DEBUG_PIN
         digitalWrite(BR_DEBUG_PI_SPI0_CE0, 0);
     #endif
 }
 
+// Kempston joystick - just say nothing pressed
+void McZXSpectrum::handleIOPortJoystickStatic([[maybe_unused]] void* pParam, [[maybe_unused]] uint32_t addr, 
+            [[maybe_unused]] uint32_t data, [[maybe_unused]] uint32_t flags, uint32_t& retVal)
+{
+    retVal = 0;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Bus actions
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
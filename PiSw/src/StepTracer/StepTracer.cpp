@@ -7,6 +7,7 @@
 #include "../System/ee_sprintf.h"
 #include "../System/logging.h"
 #include "../System/rdutils.h"
+#include "../TargetBus/TargetTracker.h"
 #include "libz80/z80.h"
 
 // Uncomment the following line to use SPI0 CE0 of the Pi as a debug pin
@@ -35,7 +36,6 @@ int StepTracer::_commsSocketId = -1;
 // Step tracer
 StepTracerCycle StepTracer::_stepCycles[MAX_STEP_CYCLES_FOR_INSTR];
 int StepTracer::_stepCycleCount = 0;
-int StepTracer::_stepCyclePos = 0;
 BusSocketInfo StepTracer::_busSocketInfo = 
 {
     false,
@@ -54,7 +54,12 @@ BusSocketInfo StepTracer::_busSocketInfo =
     0,
     false,
     BR_BUS_ACTION_GENERAL,
-    false
+    false,
+    // All bus cycles and addresses
+    BR_BUS_CYCLE_ALL,
+    0,
+    0,
+    "StepTracer"
 };
 
 // This instance
@@ -66,19 +71,22 @@ StepTracer* StepTracer::_pThisInstance = NULL;
 
 // Constructor
 StepTracer::StepTracer() : 
-        _exceptionsPosn(NUM_DEBUG_VALS), _tracesPosn(NUM_TRACE_VALS)
+        _expInstrsPosn(EXP_INSTR_QUEUE_LEN), _exceptionsPosn(NUM_DEBUG_VALS), _tracesPosn(NUM_TRACE_VALS)
 {
     // Vars
     _isActive = false;
     _stepCycleCount = 0;
-    _stepCyclePos = 0;
+    _expCyclePos = 0;
     _pThisInstance = this;
     _logging = false;
     _recordAll = false;
+    _streamAll = false;
     _compareToEmulated = false;
     _primeFromMemPending = false;
+    _streamLastFrameMs = 0;
     _serviceCount = 0;
     _recordIsHoldingTarget = false;
+    clearOpcodeStats();
 
     // Tracer memory as required
 #ifdef STEP_VAL_WITHOUT_HW_MANAGER
@@ -140,10 +148,17 @@ bool StepTracer::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t
         if (jsonGetValueForKey("compare", pCmdJson, argStr, MAX_CMD_NAME_STR))
             if ((strlen(argStr) != 0) && (argStr[0] != '0'))
                 compareToEmulated = true;
+        bool streamAll = false;
+        if (jsonGetValueForKey("stream", pCmdJson, argStr, MAX_CMD_NAME_STR))
+            if ((strlen(argStr) != 0) && (argStr[0] != '0'))
+                streamAll = true;
 
         // Start tracing
         if (_pThisInstance)
+        {
+            _pThisInstance->_streamAll = streamAll;
             _pThisInstance->start(logging, recordAll, compareToEmulated, true);
+        }
         strlcpy(pRespJson, "\"err\":\"ok\"", maxRespLen);
         return true;
     }
@@ -172,6 +187,18 @@ bool StepTracer::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t
         if (_pThisInstance)
             _pThisInstance->getStatus(statusStr, MAX_STATUS_RESP_LEN, statusIdxStr);
         strlcpy(pRespJson, statusStr, maxRespLen);
+
+        // Per-opcode stats (json or bin) - requested in pages from "start"
+        char argStr[MAX_CMD_NAME_STR];
+        if (_pThisInstance && jsonGetValueForKey("opcodeStats", pCmdJson, argStr, MAX_CMD_NAME_STR))
+        {
+            bool asBinary = (strcasecmp(argStr, "bin") == 0);
+            int startIdx = 0;
+            if (jsonGetValueForKey("start", pCmdJson, argStr, MAX_CMD_NAME_STR))
+                startIdx = strtol(argStr, NULL, 10);
+            int curLen = strlen(pRespJson);
+            _pThisInstance->getOpcodeStats(asBinary, startIdx, pRespJson + curLen, maxRespLen - curLen);
+        }
         // LogWrite(FromStepTracer, LOG_DEBUG, "TracerStatus %s", statusStr);
         return true;
     }
@@ -202,8 +229,8 @@ void StepTracer::start(bool logging, bool recordAll, bool compareToEmulated, boo
     _recordAll = recordAll;
     _compareToEmulated = compareToEmulated;
     if (_logging)
-        LogWrite(FromStepTracer, LOG_DEBUG, "TracerStart logging %d record %d compare %d",
-                    _logging, _recordAll, _compareToEmulated);
+        LogWrite(FromStepTracer, LOG_DEBUG, "TracerStart logging %d record %d compare %d stream %d",
+                    _logging, _recordAll, _compareToEmulated, _streamAll);
 
     // Connect to the bus socket
     if (_busSocketId < 0)
@@ -263,6 +290,10 @@ void StepTracer::stop(bool logging)
     _tracesPosn.clear();
     _exceptionsPosn.clear();
 
+    // Streamed frames not yet sent are still sent
+    _traceStream.flush();
+    _streamAll = false;
+
     // Clear stats
     _stats.clear();
 
@@ -306,16 +337,20 @@ void StepTracer::resetComplete()
     // Clear log buffers
     _tracesPosn.clear();
     _exceptionsPosn.clear();
+    _traceStream.clear();
+    _streamLastFrameMs = millis();
 
     // Reset the emulated CPU
     Z80RESET(&_cpu_z80);
 
-    // Clear stats
+    // Clear stats - per-opcode stats are kept after stopping so they can be read
     _stats.clear();
+    clearOpcodeStats();
 
     // Clear test case variables
     _stepCycleCount = 0;
-    _stepCyclePos = 0;
+    _expInstrsPosn.clear();
+    _expCyclePos = 0;
     _isActive = true;
 
     #ifdef USE_PI_SPI0_CE0_AS_DEBUG_PIN
@@ -357,27 +392,63 @@ void StepTracer::handleWaitInterrupt([[maybe_unused]] uint32_t addr, [[maybe_unu
 
 
     // Handle comparison with an emulated processor
-    if (_compareToEmulated)
+    if (_compareToEmulated && !_expInstrsPosn.canGet())
     {
-        // Get Z80 expected behaviour from emulated CPU
+        // Expected queue has run dry - skip the comparison rather than emulating here
+        _stats.skippedCycles++;
+    }
+    else if (_compareToEmulated)
+    {
+        // Get Z80 expected behaviour from the instructions run ahead in service
+        StepTracerExpInstr& expInstr = _expInstrs[_expInstrsPosn.posToGet()];
         uint32_t expCtrl = 0;
         uint32_t expAddr = 0;
         uint32_t expData = 0;
-        if (_stepCyclePos == _stepCycleCount)
+        int cycleIdx = _expCyclePos;
+        if (cycleIdx < expInstr.cycleCount)
         {
-            _stepCyclePos = 0;
-            _stepCycleCount = 0;
-            Z80Execute(&_cpu_z80);
-            _stats.instructionCount++;
+            expCtrl = expInstr.cycles[cycleIdx].flags;
+            expAddr = expInstr.cycles[cycleIdx].addr;
+            expData = expInstr.cycles[cycleIdx].data;
+        }
+        uint32_t expInstrAddr = expInstr.instrAddr;
+        int expOpcodeIdx = expInstr.opcodeIdx;
+
+        // Move on to the next instruction when all cycles are used
+        _expCyclePos++;
+        if (_expCyclePos >= expInstr.cycleCount)
+        {
+            _expCyclePos = 0;
+            _expInstrsPosn.hasGot();
         }
-        expCtrl = _stepCycles[_stepCyclePos].flags;
-        expAddr = _stepCycles[_stepCyclePos].addr;
-        expData = _stepCycles[_stepCyclePos].data;
-        _stepCyclePos++;
 
         // Check against what we got from the real system
-        if ((addr != expAddr) || (expCtrl != (flags & ~BR_CTRL_BUS_WAIT_MASK)) || (expData != data))
+        bool addrMismatch = (addr != expAddr);
+        bool flagsMismatch = (expCtrl != (flags & ~BR_CTRL_BUS_WAIT_MASK));
+        bool dataMismatch = (expData != data);
+        if (addrMismatch || flagsMismatch || dataMismatch)
         {
+            // Per-opcode stats
+            if (expOpcodeIdx >= 0)
+            {
+                StepTracerOpcodeStats& opStats = _opcodeStats[expOpcodeIdx];
+                if (opStats.mismatches == 0)
+                {
+                    opStats.firstStepCount = _stats.isrCalls;
+                    opStats.firstInstrAddr = expInstrAddr;
+                    opStats.firstCycleIdx = cycleIdx;
+                    opStats.firstAddr = addr;
+                    opStats.firstData = data;
+                    opStats.firstFlags = flags;
+                    opStats.firstExpAddr = expAddr;
+                    opStats.firstExpData = expData;
+                    opStats.firstExpFlags = expCtrl;
+                }
+                opStats.mismatches++;
+                opStats.addrMismatches += addrMismatch;
+                opStats.dataMismatches += dataMismatch;
+                opStats.flagsMismatches += flagsMismatch;
+            }
             if (_exceptionsPosn.canPut())
             {
                 int pos = _exceptionsPosn.posToPut();
@@ -389,12 +460,14 @@ void StepTracer::handleWaitInterrupt([[maybe_unused]] uint32_t addr, [[maybe_unu
                 _exceptions[pos].flags = flags;
                 _exceptions[pos].expectedFlags = expCtrl;
                 _exceptions[pos].stepCount = _stats.isrCalls;
+                _exceptions[pos].instrAddr = expInstrAddr;
+                _exceptions[pos].cycleIdx = cycleIdx;
                 _exceptionsPosn.hasPut();
             }
             _stats.errors++;
 
     #ifdef USE_PI_SPI0_CE0_AS_DEBUG_PIN
-            for (int i = 0; i < _stepCycleCount + 3; i++)
+            for (int i = 0; i < cycleIdx + 3; i++)
             {
                 digitalWrite(BR_DEBUG_PI_SPI0_CE0, 1);
                 microsDelay(1);
@@ -439,16 +512,63 @@ void StepTracer::handleWaitInterrupt([[maybe_unused]] uint32_t addr, [[maybe_unu
         }
     }
 
+    // Handle streaming of all activity (cycles injected by the tracker aren't the target's)
+    if (_streamAll && !TargetTracker::isInjecting())
+    {
+        _traceStream.encodeCycle(addr, data, retVal, !(retVal & BR_MEM_ACCESS_RSLT_NOT_DECODED), flags);
+
+        // Hold while there's still a frame of space for the accesses that follow
+        if (_traceStream.getFramesFree() <= MIN_FRAMES_FREE_IN_STREAM)
+        {
+            _recordIsHoldingTarget = true;
+            BusAccess::waitHold(_busSocketId, true);
+        }
+    }
+
     // Bump instruction count
     _stats.isrCalls++;
 }
 
+void StepTracer::recordCheckpoint(const Z80Registers& regs)
+{
+    if (_pThisInstance && _pThisInstance->_isActive && _pThisInstance->_streamAll)
+        _pThisInstance->_traceStream.encodeCheckpoint(regs);
+}
+
+void StepTracer::prepareExpectedCycles()
+{
+    while (_expInstrsPosn.canPut())
+    {
+        StepTracerExpInstr& expInstr = _expInstrs[_expInstrsPosn.posToPut()];
+        _stepCycleCount = 0;
+        Z80Execute(&_cpu_z80);
+        _stats.instructionCount++;
+
+        // Put the accesses into bus order
+        if (Z80CycleModel::orderCycles(_stepCycles, _stepCycleCount, expInstr.cycles) != 0)
+            _stats.unmodelledInstrs++;
+        expInstr.cycleCount = _stepCycleCount;
+        expInstr.instrAddr = (_stepCycleCount > 0) ? _stepCycles[0].addr : 0;
+        expInstr.opcodeIdx = Z80CycleModel::getOpcodeIdx(_stepCycles, _stepCycleCount);
+        if (expInstr.opcodeIdx >= 0)
+            _opcodeStats[expInstr.opcodeIdx].execCount++;
+        _expInstrsPosn.hasPut();
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Service
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void StepTracer::service()
 {
+    // Streamed trace
+    serviceTraceStream();
+
+    // Run the emulated CPU ahead so the wait handler only has to compare
+    if (_isActive && _compareToEmulated)
+        prepareExpectedCycles();
+
     _serviceCount++;
     if (_serviceCount < 10000)
         return;
@@ -469,8 +589,10 @@ void StepTracer::service()
             uint32_t pos = _exceptionsPosn.posToGet();
             uint32_t flags = _exceptions[pos].flags;
             uint32_t expFlags = _exceptions[pos].expectedFlags;
-            ee_sprintf(debugMsg, "%07u got %04x %02x",
+            ee_sprintf(debugMsg, "%07u instr %04x cycle %u got %04x %02x",
                         _exceptions[pos].stepCount,
+                        _exceptions[pos].instrAddr,
+                        _exceptions[pos].cycleIdx,
                         _exceptions[pos].addr, 
                         _exceptions[pos].dataFromZ80);
             char tmpStr[100];
@@ -499,7 +621,115 @@ void StepTracer::service()
 
 void StepTracer::getStatus(char* pRespJson, [[maybe_unused]]int maxRespLen, const char* statusIdxStr)
 {
-    ee_sprintf(pRespJson, "\"isrCount\":%u,\"errors\":%d,\"msgIdx\":%s", _stats.isrCalls, _stats.errors, statusIdxStr);
+    ee_sprintf(pRespJson, "\"isrCount\":%u,\"errors\":%d,\"instrs\":%u,\"unmodelled\":%u,\"skipped\":%u,\"msgIdx\":%s,",
+                _stats.isrCalls, _stats.errors, _stats.instructionCount, _stats.unmodelledInstrs,
+                _stats.skippedCycles, statusIdxStr);
+    int curLen = strlen(pRespJson);
+    _traceStream.getStatusJson(pRespJson + curLen, maxRespLen - curLen);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Per-opcode stats
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void StepTracer::clearOpcodeStats()
+{
+    for (int i = 0; i < Z80CycleModel::NUM_OPCODE_IDXS; i++)
+        _opcodeStats[i].clear();
+}
+
+void StepTracer::getOpcodeStats(bool asBinary, int startIdx, char* pRespJson, int maxRespLen)
+{
+    // Totals
+    uint32_t opcodesExecuted = 0;
+    uint32_t opcodesMismatched = 0;
+    for (int i = 0; i < Z80CycleModel::NUM_OPCODE_IDXS; i++)
+    {
+        if (_opcodeStats[i].execCount != 0)
+            opcodesExecuted++;
+        if (_opcodeStats[i].mismatches != 0)
+            opcodesMismatched++;
+    }
+    if ((startIdx < 0) || (startIdx > Z80CycleModel::NUM_OPCODE_IDXS))
+        startIdx = Z80CycleModel::NUM_OPCODE_IDXS;
+    char tmpStr[200];
+    ee_sprintf(tmpStr, ",\"opcodes\":%u,\"opcodesMismatched\":%u", opcodesExecuted, opcodesMismatched);
+    strlcpy(pRespJson, tmpStr, maxRespLen);
+
+    // Opcodes executed from startIdx - as many as fit
+    int opcodeIdx = startIdx;
+    if (asBinary)
+    {
+        // Check if we would be able to transmit without issues - nothing is sent and next is
+        // the same as start if not
+        OpcodeStatsBinFormat binRecs[MAX_OPCODE_STATS_BIN_RECS];
+        int numRecs = 0;
+        if (CommandHandler::getTxAvailable() >= MIN_TX_AVAILABLE_FOR_BIN_FRAME)
+        {
+            for (; (opcodeIdx < Z80CycleModel::NUM_OPCODE_IDXS) && (numRecs < MAX_OPCODE_STATS_BIN_RECS); opcodeIdx++)
+            {
+                StepTracerOpcodeStats& opStats = _opcodeStats[opcodeIdx];
+                if (opStats.execCount == 0)
+                    continue;
+                OpcodeStatsBinFormat& rec = binRecs[numRecs++];
+                memset(&rec, 0, sizeof(rec));
+                rec.opcodeIdx = opcodeIdx;
+                rec.execCount = opStats.execCount;
+                rec.mismatches = opStats.mismatches;
+                rec.addrMismatches = opStats.addrMismatches;
+                rec.dataMismatches = opStats.dataMismatches;
+                rec.flagsMismatches = opStats.flagsMismatches;
+                if (opStats.mismatches == 0)
+                    continue;
+                rec.firstStepCount = opStats.firstStepCount;
+                rec.firstInstrAddr = opStats.firstInstrAddr;
+                rec.firstCycleIdx = opStats.firstCycleIdx;
+                rec.firstAddr = opStats.firstAddr;
+                rec.firstData = opStats.firstData;
+                rec.firstFlags = opStats.firstFlags;
+                rec.firstExpAddr = opStats.firstExpAddr;
+                rec.firstExpData = opStats.firstExpData;
+                rec.firstExpFlags = opStats.firstExpFlags;
+            }
+            ee_sprintf(tmpStr, "\"start\":%d,\"next\":%d,\"recs\":%d", startIdx, opcodeIdx, numRecs);
+            CommandHandler::sendWithJSON("tracerOpcodeStats", tmpStr, 0,
+                        (const uint8_t*)binRecs, numRecs * sizeof(OpcodeStatsBinFormat));
+        }
+    }
+    else
+    {
+        // Each entry is [op, execs, mismatches, addr, data, flags] with the first mismatch
+        // [step, instrAddr, cycleIdx, addr, data, flags, expAddr, expData, expFlags] appended
+        static const int MIN_SPACE_AFTER_ENTRIES = 40;
+        strlcat(pRespJson, ",\"opcodeStats\":[", maxRespLen);
+        bool firstEntry = true;
+        for (; opcodeIdx < Z80CycleModel::NUM_OPCODE_IDXS; opcodeIdx++)
+        {
+            StepTracerOpcodeStats& opStats = _opcodeStats[opcodeIdx];
+            if (opStats.execCount == 0)
+                continue;
+            ee_sprintf(tmpStr, "%s[\"%s%02X\",%u,%u,%u,%u,%u", firstEntry ? "" : ",",
+                        Z80CycleModel::getTableName(opcodeIdx), opcodeIdx % 256,
+                        opStats.execCount, opStats.mismatches, opStats.addrMismatches,
+                        opStats.dataMismatches, opStats.flagsMismatches);
+            int entryLen = strlen(tmpStr);
+            if (opStats.mismatches != 0)
+            {
+                ee_sprintf(tmpStr + entryLen, ",%u,%u,%u,%u,%u,%u,%u,%u,%u",
+                            opStats.firstStepCount, opStats.firstInstrAddr, opStats.firstCycleIdx,
+                            opStats.firstAddr, opStats.firstData, opStats.firstFlags,
+                            opStats.firstExpAddr, opStats.firstExpData, opStats.firstExpFlags);
+            }
+            strlcat(tmpStr, "]", sizeof(tmpStr));
+            if ((int)(strlen(pRespJson) + strlen(tmpStr)) > maxRespLen - MIN_SPACE_AFTER_ENTRIES)
+                break;
+            strlcat(pRespJson, tmpStr, maxRespLen);
+            firstEntry = false;
+        }
+        strlcat(pRespJson, "]", maxRespLen);
+    }
+    ee_sprintf(tmpStr, ",\"opcodesNext\":%d", opcodeIdx);
+    strlcat(pRespJson, tmpStr, maxRespLen);
 }
 
 void StepTracer::getTraceLong(char* pRespJson, int maxRespLen)
@@ -614,6 +844,31 @@ void StepTracer::getTraceBin()
     }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Streamed execution trace
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void StepTracer::serviceTraceStream()
+{
+    // Send a frame that has been partly filled for a while
+    if (_traceStream.isFrameFilling() && !_traceStream.isFrameWaiting() &&
+                isTimeout(millis(), _streamLastFrameMs, MAX_MS_BETWEEN_STREAM_FRAMES))
+        _traceStream.flush();
+
+    // Send
+    if (!_traceStream.sendFrame())
+        return;
+    _streamLastFrameMs = millis();
+
+    // No longer hold
+    if (_streamAll && _recordIsHoldingTarget && (_traceStream.getFramesFree() > MIN_FRAMES_FREE_IN_STREAM))
+    {
+        _recordIsHoldingTarget = false;
+        BusAccess::waitHold(_busSocketId, false);
+        BusAccess::waitRelease();
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Tracer mem/IO access
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +12,8 @@
 #include "../TargetBus/BusAccess.h"
 #include "../CommandInterface/CommandHandler.h"
 #include "libz80/z80.h"
+#include "TraceStreamEncoder.h"
+#include "Z80CycleModel.h"
 
 // #define STEP_VAL_WITHOUT_HW_MANAGER 1
 #ifndef STEP_VAL_WITHOUT_HW_MANAGER
@@ -31,10 +33,14 @@ public:
         isrCalls = 0;
         errors = 0;
         instructionCount = 0;
+        unmodelledInstrs = 0;
+        skippedCycles = 0;
     }
     uint32_t isrCalls;
     uint32_t errors;
     uint32_t instructionCount;
+    uint32_t unmodelledInstrs;
+    uint32_t skippedCycles;
 };
 
 // Exceptions
@@ -49,6 +55,38 @@ public:
     uint32_t flags;
     uint32_t expectedFlags;
     uint32_t stepCount;
+    uint32_t instrAddr;
+    uint32_t cycleIdx;
+};
+
+// Per-opcode stats - executions, cycles that didn't match (and which fields differed) and the
+// first mismatch seen
+class StepTracerOpcodeStats
+{
+public:
+    void clear()
+    {
+        execCount = 0;
+        mismatches = 0;
+        addrMismatches = 0;
+        dataMismatches = 0;
+        flagsMismatches = 0;
+    }
+    uint32_t execCount;
+    uint32_t mismatches;
+    uint32_t addrMismatches;
+    uint32_t dataMismatches;
+    uint32_t flagsMismatches;
+    // First mismatch - only valid when mismatches != 0
+    uint32_t firstStepCount;
+    uint16_t firstInstrAddr;
+    uint16_t firstAddr;
+    uint16_t firstExpAddr;
+    uint16_t firstFlags;
+    uint16_t firstExpFlags;
+    uint8_t firstData;
+    uint8_t firstExpData;
+    uint8_t firstCycleIdx;
 };
 
 // Trace
@@ -63,12 +101,17 @@ public:
 };
 
 // Cycle info
-class StepTracerCycle
+typedef Z80BusCycle StepTracerCycle;
+
+// Expected instruction - the cycles expected on the bus (the accesses in bus order)
+class StepTracerExpInstr
 {
 public:
-    uint32_t addr;
-    uint32_t data;
-    uint32_t flags;
+    static const int MAX_CYCLES = 10;
+    StepTracerCycle cycles[MAX_CYCLES];
+    int cycleCount;
+    uint32_t instrAddr;
+    int opcodeIdx;
 };
 
 // Tracer
@@ -88,6 +131,10 @@ public:
 
     // Stats
     StepTracerStats& getStats();
+
+    // Register checkpoint from the tracker - added to the trace stream so a recorded trace can be
+    // validated offline in parallel from each checkpoint
+    static void recordCheckpoint(const Z80Registers& regs);
     
 private:
 
@@ -97,6 +144,7 @@ private:
     // Flags
     bool _logging;
     bool _recordAll;
+    bool _streamAll;
     bool _compareToEmulated;
     bool _recordIsHoldingTarget;
 
@@ -124,9 +172,15 @@ private:
     // Get status
     void getStatus(char* pRespJson, int maxRespLen, const char* statusIdxStr);
 
+    // Get per-opcode stats from opcode index startIdx - as JSON appended to the status or as
+    // binary in a tracerOpcodeStats frame - the response says where the next request should start
+    void getOpcodeStats(bool asBinary, int startIdx, char* pRespJson, int maxRespLen);
+    void clearOpcodeStats();
+
     // Get trace
     void getTraceLong(char* pRespJson, int maxRespLen);
     void getTraceBin();
+    void serviceTraceStream();
 
     // Reset complete callback
     static void busActionCompleteStatic(BR_BUS_ACTION actionType, BR_BUS_ACTION_REASON reason);
@@ -144,17 +198,52 @@ private:
     static byte io_read(int param, ushort address);
     static void io_write(int param, ushort address, byte data);
 
-    // Record step information for instruction
-    static const int MAX_STEP_CYCLES_FOR_INSTR = 10;
+    // Record step information for instruction - accesses made by the emulated CPU
+    static const int MAX_STEP_CYCLES_FOR_INSTR = StepTracerExpInstr::MAX_CYCLES;
     static StepTracerCycle _stepCycles[MAX_STEP_CYCLES_FOR_INSTR];
     static int _stepCycleCount;
-    static int _stepCyclePos;
+
+    // Queue of instructions run ahead on the emulated CPU (filled in service) - the wait handler
+    // compares one cycle per wait and only counts a skipped comparison if the queue runs dry
+    static const int EXP_INSTR_QUEUE_LEN = 8;
+    StepTracerExpInstr _expInstrs[EXP_INSTR_QUEUE_LEN];
+    RingBufferPosn _expInstrsPosn;
+    int _expCyclePos;
+
+    // Execute instructions on the emulated CPU until the expected queue is full
+    void prepareExpectedCycles();
 
     // Exception list
     static const int NUM_DEBUG_VALS = 20;
     volatile StepTracerException _exceptions[NUM_DEBUG_VALS];
     RingBufferPosn _exceptionsPosn;
 
+    // Per-opcode stats indexed by Z80CycleModel opcode index
+    StepTracerOpcodeStats _opcodeStats[Z80CycleModel::NUM_OPCODE_IDXS];
+
+    // Per-opcode stats binary format
+    #pragma pack(push, 1)
+    struct OpcodeStatsBinFormat
+    {
+        uint16_t opcodeIdx;
+        uint32_t execCount;
+        uint32_t mismatches;
+        uint32_t addrMismatches;
+        uint32_t dataMismatches;
+        uint32_t flagsMismatches;
+        uint32_t firstStepCount;
+        uint16_t firstInstrAddr;
+        uint8_t firstCycleIdx;
+        uint16_t firstAddr;
+        uint8_t firstData;
+        uint16_t firstFlags;
+        uint16_t firstExpAddr;
+        uint8_t firstExpData;
+        uint16_t firstExpFlags;
+    };
+    #pragma pack(pop)
+    static const int MAX_OPCODE_STATS_BIN_RECS = 200;
+
     // Execution trace list
     static const int NUM_TRACE_VALS = 1000;
     static const int MIN_SPACES_IN_TRACES = 50;
@@ -180,6 +269,12 @@ private:
     // Tx chars available in tx buffer for bin frame transmission
     static const int MIN_TX_AVAILABLE_FOR_BIN_FRAME = 16000;
 
+    // Streamed trace - the target is held when only a couple of frames are free
+    TraceStreamEncoder _traceStream;
+    static const uint32_t MIN_FRAMES_FREE_IN_STREAM = 2;
+    static const int MAX_MS_BETWEEN_STREAM_FRAMES = 100;
+    uint32_t _streamLastFrameMs;
+
     // Active
     bool _isActive;
 
@@ -0,0 +1,200 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TraceStreamEncoder.h"
+#include "../CommandInterface/CommandHandler.h"
+#include "../System/ee_sprintf.h"
+#include "../System/lowlib.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Construction
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TraceStreamEncoder::TraceStreamEncoder() :
+        _framesPosn(NUM_FRAMES)
+{
+    clear();
+}
+
+void TraceStreamEncoder::clear()
+{
+    _framesPosn.clear();
+    _cycleCount = 0;
+    _bytesEncoded = 0;
+    _overflows = 0;
+    _framesSent = 0;
+    _checkpointCount = 0;
+    _frames[_framesPosn.posToPut()].len = 0;
+}
+
+TraceStreamEncoder::TraceStreamFrame* TraceStreamEncoder::getFrameForRec(uint32_t recLen)
+{
+    // Complete the frame if full
+    if (_frames[_framesPosn.posToPut()].len + recLen > FRAME_LEN)
+    {
+        if (!_framesPosn.canPut())
+            return NULL;
+        _framesPosn.hasPut();
+        _frames[_framesPosn.posToPut()].len = 0;
+    }
+
+    // Start a frame
+    TraceStreamFrame& frame = _frames[_framesPosn.posToPut()];
+    if (frame.len == 0)
+    {
+        frame.firstCycle = _cycleCount;
+        frame.numRecs = 0;
+        for (int i = 0; i < NUM_ADDR_KINDS; i++)
+            _prevAddr[i] = 0xffff;
+        _pcAddr = 0xffff;
+    }
+    return &frame;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Encode
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TraceStreamEncoder::encodeCycle(uint32_t addr, uint32_t busData, uint32_t retData, bool retDataValid, uint32_t flags)
+{
+    TraceStreamFrame* pFrame = getFrameForRec(MAX_REC_LEN);
+    if (!pFrame)
+    {
+        _overflows++;
+        _cycleCount++;
+        return false;
+    }
+    TraceStreamFrame& frame = *pFrame;
+
+    // Flags
+    addr &= 0xffff;
+    uint32_t header = ((flags & BR_CTRL_BUS_RD_MASK) ? TRACE_FLAG_RD : 0) |
+                ((flags & BR_CTRL_BUS_WR_MASK) ? TRACE_FLAG_WR : 0) |
+                ((flags & BR_CTRL_BUS_IORQ_MASK) ? TRACE_FLAG_IORQ : 0) |
+                ((flags & BR_CTRL_BUS_M1_MASK) ? TRACE_FLAG_M1 : 0);
+
+    // Address - exact predictions first then the smaller difference
+    uint32_t& prevAddr = _prevAddr[addrKind(flags)];
+    uint32_t pcNext = (_pcAddr + 1) & 0xffff;
+    uint32_t varintVal = 0;
+    uint32_t addrMode = TRACE_ADDR_PC_NEXT;
+    if (addr == pcNext)
+    {
+        addrMode = TRACE_ADDR_PC_NEXT;
+    }
+    else if (addr == ((prevAddr + 1) & 0xffff))
+    {
+        addrMode = TRACE_ADDR_PREV_NEXT;
+    }
+    else
+    {
+        uint32_t prevDelta = zigzag(addr, prevAddr);
+        uint32_t pcDelta = zigzag(addr, pcNext);
+        addrMode = (varintLen(pcDelta) < varintLen(prevDelta)) ? TRACE_ADDR_PC_DELTA : TRACE_ADDR_PREV_DELTA;
+        varintVal = (addrMode == TRACE_ADDR_PC_DELTA) ? pcDelta : prevDelta;
+    }
+    header |= addrMode << TRACE_ADDR_MODE_POS;
+
+    // Data
+    busData &= 0xff;
+    retData &= 0xff;
+    if (retDataValid)
+        header |= (busData == retData) ? (TRACE_RET_DATA | TRACE_BUS_DATA_OMITTED) : TRACE_RET_DATA;
+
+    // Record
+    uint8_t* pRec = frame.data + frame.len;
+    uint32_t recLen = 0;
+    pRec[recLen++] = header;
+    if (addrMode >= TRACE_ADDR_PREV_DELTA)
+    {
+        while (varintVal >= 0x80)
+        {
+            pRec[recLen++] = (varintVal & 0x7f) | 0x80;
+            varintVal >>= 7;
+        }
+        pRec[recLen++] = varintVal;
+    }
+    if (!(header & TRACE_BUS_DATA_OMITTED))
+        pRec[recLen++] = busData;
+    if (header & TRACE_RET_DATA)
+        pRec[recLen++] = retData;
+    frame.len += recLen;
+    frame.numRecs++;
+
+    // Predictors - the PC follows opcode fetches and the memory reads that continue from them
+    if ((flags & BR_CTRL_BUS_M1_MASK) && !(flags & BR_CTRL_BUS_IORQ_MASK))
+        _pcAddr = addr;
+    else if ((addr == pcNext) && (flags & BR_CTRL_BUS_RD_MASK) && !(flags & BR_CTRL_BUS_IORQ_MASK))
+        _pcAddr = addr;
+    else
+        prevAddr = addr;
+    _cycleCount++;
+    _bytesEncoded += recLen;
+    return true;
+}
+
+bool TraceStreamEncoder::encodeCheckpoint(const Z80Registers& regs)
+{
+    TraceStreamFrame* pFrame = getFrameForRec(CHECKPOINT_REC_LEN);
+    if (!pFrame)
+        return false;
+    const int regVals[] = { regs.PC, regs.SP, regs.AF, regs.BC, regs.DE, regs.HL, regs.IX, regs.IY,
+                regs.AFDASH, regs.BCDASH, regs.DEDASH, regs.HLDASH };
+    uint8_t* pRec = pFrame->data + pFrame->len;
+    uint32_t recLen = 0;
+    pRec[recLen++] = TRACE_CHECKPOINT;
+    for (uint32_t i = 0; i < sizeof(regVals) / sizeof(regVals[0]); i++)
+    {
+        pRec[recLen++] = regVals[i] & 0xff;
+        pRec[recLen++] = (regVals[i] >> 8) & 0xff;
+    }
+    pRec[recLen++] = regs.I;
+    pRec[recLen++] = regs.R;
+    pRec[recLen++] = regs.INTMODE;
+    pRec[recLen++] = regs.INTENABLED;
+    pFrame->len += recLen;
+
+    // Next opcode fetch is at the PC
+    _pcAddr = (regs.PC - 1) & 0xffff;
+    _bytesEncoded += recLen;
+    _checkpointCount++;
+    return true;
+}
+
+void TraceStreamEncoder::flush()
+{
+    if ((_frames[_framesPosn.posToPut()].len == 0) || !_framesPosn.canPut())
+        return;
+    _framesPosn.hasPut();
+    _frames[_framesPosn.posToPut()].len = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Send
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TraceStreamEncoder::sendFrame()
+{
+    if (!_framesPosn.canGet() || (CommandHandler::getTxAvailable() < MIN_TX_AVAILABLE_FOR_FRAME))
+        return false;
+    TraceStreamFrame& frame = _frames[_framesPosn.posToGet()];
+    char jsonResp[100];
+    ee_sprintf(jsonResp, "\"seq\":%u,\"first\":%u,\"recs\":%u,\"ovf\":%u",
+                _framesSent, frame.firstCycle, frame.numRecs, _overflows);
+    CommandHandler::sendWithJSON("tracerStreamData", jsonResp, 0, frame.data, frame.len);
+    _framesPosn.hasGot();
+    _framesSent++;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TraceStreamEncoder::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    char tmpResp[200];
+    ee_sprintf(tmpResp, "\"streamCycles\":%u,\"streamBytes\":%u,\"streamFrames\":%u,\"streamOvf\":%u,\"streamCps\":%u",
+                _cycleCount, _bytesEncoded, _framesSent, _overflows, _checkpointCount);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+}
@@ -0,0 +1,153 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../System/RingBufferPosn.h"
+#include "../TargetBus/BusAccess.h"
+#include "../TargetBus/TargetRegisters.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Trace stream encoder - compact encoding of every bus cycle for continuous tracing
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Cycles are encoded into fixed size frames which are sent as "tracerStreamData" frames whenever
+// one is full (or tracing stops or goes quiet). Each record starts with a header byte:
+//   bits 0..3 - flags RD, WR, IORQ, M1 (MREQ is implied when IORQ is clear)
+//   bits 4..5 - address mode:
+//       0 - predicted PC + 1 (the address after the last opcode or operand fetch)
+//       1 - previous address + 1
+//       2 - varint follows with the zigzag encoded difference from the previous address
+//       3 - varint follows with the zigzag encoded difference from the predicted PC + 1
+//   bit 6     - a bus socket supplied data (retData follows the bus data)
+//   bit 7     - bus data omitted as it is the same as retData
+// followed by the varint (7 bits per byte, least significant first, top bit set if more follow),
+// the bus data byte (unless omitted) and the retData byte (if present).
+// The previous address is kept separately for memory reads, memory writes and IO (so a block copy
+// or a stack push predicts well even with opcode fetches in between) and is only updated by cycles
+// that don't update the predicted PC.
+// The address predictors restart at every frame (previous addresses and predicted PC all 0xffff) so
+// each frame decodes on its own and a gap after an overflow is shown by the frame's first cycle.
+// A header byte of 0 (no RD or WR so never a bus cycle) is a register checkpoint taken before the
+// next cycle - PC SP AF BC DE HL IX IY AF' BC' DE' HL' (2 bytes each, little-endian) then I R IM IFF
+// - and sets the predicted PC so the next opcode fetch is predicted. Checkpoints aren't counted in
+// the frame's records.
+
+class TraceStreamEncoder
+{
+public:
+    TraceStreamEncoder();
+
+    // Clear frames and stats
+    void clear();
+
+    // Encode a bus cycle - returns false if there is no frame free (the cycle is dropped)
+    bool encodeCycle(uint32_t addr, uint32_t busData, uint32_t retData, bool retDataValid, uint32_t flags);
+
+    // Encode a register checkpoint - returns false if there is no frame free
+    bool encodeCheckpoint(const Z80Registers& regs);
+
+    // Complete the frame being filled so it can be sent
+    void flush();
+
+    // Frames
+    uint32_t getFramesFree()
+    {
+        return _framesPosn.size() - _framesPosn.count();
+    }
+    bool isFrameWaiting()
+    {
+        return _framesPosn.canGet();
+    }
+    bool isFrameFilling()
+    {
+        return _frames[_framesPosn.posToPut()].len > 0;
+    }
+
+    // Send the oldest complete frame - returns false if there isn't one
+    bool sendFrame();
+
+    // Status
+    void getStatusJson(char* pRespJson, int maxRespLen);
+    uint32_t getCycleCount()
+    {
+        return _cycleCount;
+    }
+    uint32_t getBytesEncoded()
+    {
+        return _bytesEncoded;
+    }
+    uint32_t getOverflows()
+    {
+        return _overflows;
+    }
+    uint32_t getCheckpointCount()
+    {
+        return _checkpointCount;
+    }
+
+    // Header bits
+    static const uint32_t TRACE_FLAG_RD = 0x01;
+    static const uint32_t TRACE_FLAG_WR = 0x02;
+    static const uint32_t TRACE_FLAG_IORQ = 0x04;
+    static const uint32_t TRACE_FLAG_M1 = 0x08;
+    static const uint32_t TRACE_ADDR_MODE_POS = 4;
+    static const uint32_t TRACE_ADDR_PC_NEXT = 0;
+    static const uint32_t TRACE_ADDR_PREV_NEXT = 1;
+    static const uint32_t TRACE_ADDR_PREV_DELTA = 2;
+    static const uint32_t TRACE_ADDR_PC_DELTA = 3;
+    static const uint32_t TRACE_RET_DATA = 0x40;
+    static const uint32_t TRACE_BUS_DATA_OMITTED = 0x80;
+    static const uint32_t TRACE_CHECKPOINT = 0x00;
+
+    // Limits
+    static const uint32_t FRAME_LEN = 4000;
+    static const uint32_t MAX_REC_LEN = 6;
+    static const uint32_t CHECKPOINT_REC_LEN = 29;
+    static const int NUM_FRAMES = 8;
+    static const uint32_t MIN_TX_AVAILABLE_FOR_FRAME = 12000;
+
+private:
+    struct TraceStreamFrame
+    {
+        uint32_t firstCycle;
+        uint32_t numRecs;
+        uint32_t len;
+        uint8_t data[FRAME_LEN];
+    };
+    TraceStreamFrame _frames[NUM_FRAMES];
+    RingBufferPosn _framesPosn;
+
+    // Get the frame to add a record to - completing the current frame if the record won't fit -
+    // returns NULL if there is no frame free
+    TraceStreamFrame* getFrameForRec(uint32_t recLen);
+
+    // Predictors
+    static const int NUM_ADDR_KINDS = 3;
+    uint32_t _prevAddr[NUM_ADDR_KINDS];
+    uint32_t _pcAddr;
+
+    // Stats
+    uint32_t _cycleCount;
+    uint32_t _bytesEncoded;
+    uint32_t _overflows;
+    uint32_t _framesSent;
+    uint32_t _checkpointCount;
+
+    // Zigzag varint length and encoding
+    static uint32_t zigzag(uint32_t addr, uint32_t refAddr)
+    {
+        int32_t delta = (int16_t)(addr - refAddr);
+        return (delta < 0) ? ((-delta) << 1) - 1 : (delta << 1);
+    }
+    static int addrKind(uint32_t flags)
+    {
+        return (flags & BR_CTRL_BUS_IORQ_MASK) ? 2 : ((flags & BR_CTRL_BUS_WR_MASK) ? 1 : 0);
+    }
+    static uint32_t varintLen(uint32_t val)
+    {
+        return (val < 0x80) ? 1 : ((val < 0x4000) ? 2 : 3);
+    }
+};
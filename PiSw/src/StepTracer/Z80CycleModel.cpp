@@ -0,0 +1,155 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "Z80CycleModel.h"
+#include "Z80CycleTable.h"
+#include "../TargetBus/TargetCPU.h"
+#include <string.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Table lookup
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Tables in Z80_CYCLE_TABLE order
+static const Z80CycleTableEntry* const z80CycleTables[Z80CycleModel::NUM_TABLES] =
+{
+    z80CycleTable_MAIN,
+    z80CycleTable_CB,
+    z80CycleTable_ED,
+    z80CycleTable_DD,
+    z80CycleTable_FD,
+    z80CycleTable_DDCB,
+    z80CycleTable_FDCB
+};
+
+bool Z80CycleModel::getEntry(const Z80BusCycle* pAccesses, int numAccesses, Z80CycleTableEntry& entry)
+{
+    int opcodeIdx = getOpcodeIdx(pAccesses, numAccesses);
+    if (opcodeIdx < 0)
+        return false;
+    int table = opcodeIdx / 256;
+    int opcode = opcodeIdx % 256;
+    entry = z80CycleTables[table][opcode];
+    if (entry.pPattern)
+        return true;
+
+    // A DD or FD prefix on an opcode that doesn't use IX or IY just adds a fetch to the unprefixed instruction
+    if ((table != TABLE_DD) && (table != TABLE_FD))
+        return false;
+    entry = z80CycleTables[TABLE_MAIN][opcode];
+    if (!entry.pPattern)
+        return false;
+    entry.numFetches++;
+    return true;
+}
+
+int Z80CycleModel::getOpcodeIdx(const Z80BusCycle* pAccesses, int numAccesses)
+{
+    // Opcode bytes in the order libz80 fetched them (the DDCB/FDCB opcode is fetched third)
+    static const int MAX_OPCODES = 3;
+    uint32_t opcodes[MAX_OPCODES];
+    int numOpcodes = 0;
+    for (int i = 0; (i < numAccesses) && (numOpcodes < MAX_OPCODES); i++)
+        if (pAccesses[i].flags & BR_CTRL_BUS_M1_MASK)
+            opcodes[numOpcodes++] = pAccesses[i].data & 0xff;
+    if (numOpcodes == 0)
+        return -1;
+
+    // Prefixes
+    int table = TABLE_MAIN;
+    uint32_t opcode = opcodes[0];
+    if ((opcodes[0] == 0xcb) || (opcodes[0] == 0xed) || (opcodes[0] == 0xdd) || (opcodes[0] == 0xfd))
+    {
+        if (numOpcodes < 2)
+            return -1;
+        opcode = opcodes[1];
+        if (opcodes[0] == 0xcb)
+            table = TABLE_CB;
+        else if (opcodes[0] == 0xed)
+            table = TABLE_ED;
+        else if (opcodes[1] != 0xcb)
+            table = (opcodes[0] == 0xdd) ? TABLE_DD : TABLE_FD;
+        else
+        {
+            if (numOpcodes < 3)
+                return -1;
+            opcode = opcodes[2];
+            table = (opcodes[0] == 0xdd) ? TABLE_DDCB : TABLE_FDCB;
+        }
+    }
+    return table * 256 + opcode;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Order cycles
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int Z80CycleModel::orderCycles(const Z80BusCycle* pAccesses, int numAccesses, Z80BusCycle* pCycles)
+{
+    // Instructions start with an opcode fetch
+    Z80CycleTableEntry entry;
+    if ((numAccesses <= 0) || (numAccesses > MAX_ACCESSES) || !(pAccesses[0].flags & BR_CTRL_BUS_M1_MASK) ||
+                !getEntry(pAccesses, numAccesses, entry))
+    {
+        for (int i = 0; i < numAccesses; i++)
+            pCycles[i] = pAccesses[i];
+        return -1;
+    }
+    bool used[MAX_ACCESSES];
+    memset(used, 0, sizeof(used));
+    int numCycles = 0;
+
+    // Opcode fetches then operand reads - matched by address
+    static const uint32_t MEM_RD_FLAGS = BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK;
+    uint32_t instrAddr = pAccesses[0].addr;
+    for (uint32_t byteIdx = 0; byteIdx < (uint32_t)(entry.numFetches + entry.numOperands); byteIdx++)
+    {
+        uint32_t byteAddr = (instrAddr + byteIdx) & 0xffff;
+        for (int i = 0; i < numAccesses; i++)
+        {
+            if (used[i] || (pAccesses[i].addr != byteAddr) ||
+                        ((pAccesses[i].flags & (MEM_RD_FLAGS | BR_CTRL_BUS_WR_MASK)) != MEM_RD_FLAGS))
+                continue;
+            pCycles[numCycles] = pAccesses[i];
+            pCycles[numCycles].flags = MEM_RD_FLAGS | ((byteIdx < entry.numFetches) ? BR_CTRL_BUS_M1_MASK : 0);
+            numCycles++;
+            used[i] = true;
+            break;
+        }
+    }
+
+    // Remaining cycles in pattern order - matched by kind
+    for (const char* pPat = entry.pPattern; *pPat; pPat++)
+    {
+        bool isWrite = (*pPat == 'w') || (*pPat == 'x') || (*pPat == 'o');
+        uint32_t reqFlag = ((*pPat == 'i') || (*pPat == 'o')) ? BR_CTRL_BUS_IORQ_MASK : BR_CTRL_BUS_MREQ_MASK;
+        uint32_t dirFlag = isWrite ? BR_CTRL_BUS_WR_MASK : BR_CTRL_BUS_RD_MASK;
+        int found = -1;
+        for (int i = 0; i < numAccesses; i++)
+        {
+            if (used[i] || !(pAccesses[i].flags & reqFlag) || !(pAccesses[i].flags & dirFlag))
+                continue;
+            found = i;
+            // The last write is wanted for 'x'
+            if (*pPat != 'x')
+                break;
+        }
+        if (found < 0)
+            continue;
+        pCycles[numCycles] = pAccesses[found];
+        pCycles[numCycles].flags = reqFlag | dirFlag;
+        numCycles++;
+        used[found] = true;
+    }
+
+    // Accesses the pattern didn't account for
+    int numUnmatched = 0;
+    for (int i = 0; i < numAccesses; i++)
+    {
+        if (used[i])
+            continue;
+        pCycles[numCycles++] = pAccesses[i];
+        numUnmatched++;
+    }
+    return numUnmatched;
+}
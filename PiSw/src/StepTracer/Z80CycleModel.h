@@ -0,0 +1,79 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Z80 cycle model - the bus cycles a real Z80 makes for an instruction
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// libz80 gives the right values for every access an instruction makes but not always in the order
+// (or with the M1 flag) seen on the bus - e.g. for DDCB instructions it fetches the final opcode
+// before the displacement and EX (SP),HL writes the low byte first.
+// The table in Z80CycleTable.h (generated by libz80/codegen/mkcycles.py from opcodes.lst) gives,
+// for every opcode, the number of opcode fetches (M1), the number of operand bytes and the order
+// of the remaining memory and IO cycles, and orderCycles() uses it to put libz80's accesses into
+// bus order. Fetches and operands are matched by address and the other cycles by kind so cycles
+// that a conditional instruction doesn't make are simply skipped.
+
+// Bus cycle - flags are BR_CTRL_BUS_xxx_MASK
+class Z80BusCycle
+{
+public:
+    uint32_t addr;
+    uint32_t data;
+    uint32_t flags;
+};
+
+// Table entry - pattern letters are r/w memory read/write, x a memory write made after the other
+// writes, i/o IO read/write - pattern is NULL if the opcode isn't in the table
+struct Z80CycleTableEntry
+{
+    uint8_t numFetches;
+    uint8_t numOperands;
+    const char* pPattern;
+};
+
+class Z80CycleModel
+{
+public:
+    // Put the accesses libz80 made for one instruction into bus order - returns the number of
+    // accesses not in the instruction's pattern (they go at the end) or -1 if the instruction
+    // isn't in the table (the accesses are copied unchanged)
+    static int orderCycles(const Z80BusCycle* pAccesses, int numAccesses, Z80BusCycle* pCycles);
+
+    // Table entry for the instruction from the data of its opcode fetches - a DD or FD prefix on an
+    // opcode without an index form gets the unprefixed entry with an extra fetch - false if not found
+    static bool getEntry(const Z80BusCycle* pAccesses, int numAccesses, Z80CycleTableEntry& entry);
+
+    // Tables
+    enum Z80_CYCLE_TABLE
+    {
+        TABLE_MAIN,
+        TABLE_CB,
+        TABLE_ED,
+        TABLE_DD,
+        TABLE_FD,
+        TABLE_DDCB,
+        TABLE_FDCB,
+        NUM_TABLES
+    };
+    static const int NUM_OPCODE_IDXS = NUM_TABLES * 256;
+
+    // Opcode index (table * 256 + opcode) from the data of the accesses libz80 flagged M1 (which
+    // includes the DDCB/FDCB opcode) - -1 if there are too few fetches for the prefixes
+    static int getOpcodeIdx(const Z80BusCycle* pAccesses, int numAccesses);
+
+    // Prefix bytes of the opcode index's table (e.g. "DDCB")
+    static const char* getTableName(int opcodeIdx)
+    {
+        static const char* tableNames[NUM_TABLES] = { "", "CB", "ED", "DD", "FD", "DDCB", "FDCB" };
+        return ((opcodeIdx < 0) || (opcodeIdx >= NUM_OPCODE_IDXS)) ? "" : tableNames[opcodeIdx / 256];
+    }
+
+    // Limits
+    static const int MAX_ACCESSES = 16;
+};
@@ -0,0 +1,1821 @@
+// Bus Raider
+// Rob Dobson 2019
+// Generated by libz80/codegen/mkcycles.py from opcodes.lst - do not edit
+
+#pragma once
+
+#include "Z80CycleModel.h"
+
+static const Z80CycleTableEntry z80CycleTable_MAIN[256] = {
+    { 1, 0, ""      },   // 00 NOP
+    { 1, 2, ""      },   // 01 LD BC,nn
+    { 1, 0, "w"     },   // 02 LD (BC),A
+    { 1, 0, ""      },   // 03 INC BC
+    { 1, 0, ""      },   // 04 INC B
+    { 1, 0, ""      },   // 05 DEC B
+    { 1, 1, ""      },   // 06 LD B,n
+    { 1, 0, ""      },   // 07 RLCA
+    { 1, 0, ""      },   // 08 EX AF,AF'
+    { 1, 0, ""      },   // 09 ADD HL,BC
+    { 1, 0, "r"     },   // 0A LD A,(BC)
+    { 1, 0, ""      },   // 0B DEC BC
+    { 1, 0, ""      },   // 0C INC C
+    { 1, 0, ""      },   // 0D DEC C
+    { 1, 1, ""      },   // 0E LD C,n
+    { 1, 0, ""      },   // 0F RRCA
+    { 1, 1, ""      },   // 10 DJNZ (PC+e)
+    { 1, 2, ""      },   // 11 LD DE,nn
+    { 1, 0, "w"     },   // 12 LD (DE),A
+    { 1, 0, ""      },   // 13 INC DE
+    { 1, 0, ""      },   // 14 INC D
+    { 1, 0, ""      },   // 15 DEC D
+    { 1, 1, ""      },   // 16 LD D,n
+    { 1, 0, ""      },   // 17 RLA
+    { 1, 1, ""      },   // 18 JR (PC+e)
+    { 1, 0, ""      },   // 19 ADD HL,DE
+    { 1, 0, "r"     },   // 1A LD A,(DE)
+    { 1, 0, ""      },   // 1B DEC DE
+    { 1, 0, ""      },   // 1C INC E
+    { 1, 0, ""      },   // 1D DEC E
+    { 1, 1, ""      },   // 1E LD E,n
+    { 1, 0, ""      },   // 1F RRA
+    { 1, 1, ""      },   // 20 JR NZ,(PC+e)
+    { 1, 2, ""      },   // 21 LD HL,nn
+    { 1, 2, "ww"    },   // 22 LD (nn),HL
+    { 1, 0, ""      },   // 23 INC HL
+    { 1, 0, ""      },   // 24 INC H
+    { 1, 0, ""      },   // 25 DEC H
+    { 1, 1, ""      },   // 26 LD H,n
+    { 1, 0, ""      },   // 27 DAA
+    { 1, 1, ""      },   // 28 JR Z,(PC+e)
+    { 1, 0, ""      },   // 29 ADD HL,HL
+    { 1, 2, "rr"    },   // 2A LD HL,(nn)
+    { 1, 0, ""      },   // 2B DEC HL
+    { 1, 0, ""      },   // 2C INC L
+    { 1, 0, ""      },   // 2D DEC L
+    { 1, 1, ""      },   // 2E LD L,n
+    { 1, 0, ""      },   // 2F CPL
+    { 1, 1, ""      },   // 30 JR NC,(PC+e)
+    { 1, 2, ""      },   // 31 LD SP,nn
+    { 1, 2, "w"     },   // 32 LD (nn),A
+    { 1, 0, ""      },   // 33 INC SP
+    { 1, 0, "rw"    },   // 34 INC (HL)
+    { 1, 0, "rw"    },   // 35 DEC (HL)
+    { 1, 1, "w"     },   // 36 LD (HL),n
+    { 1, 0, ""      },   // 37 SCF
+    { 1, 1, ""      },   // 38 JR C,(PC+e)
+    { 1, 0, ""      },   // 39 ADD HL,SP
+    { 1, 2, "r"     },   // 3A LD A,(nn)
+    { 1, 0, ""      },   // 3B DEC SP
+    { 1, 0, ""      },   // 3C INC A
+    { 1, 0, ""      },   // 3D DEC A
+    { 1, 1, ""      },   // 3E LD A,n
+    { 1, 0, ""      },   // 3F CCF
+    { 1, 0, ""      },   // 40 LD B,B
+    { 1, 0, ""      },   // 41 LD B,C
+    { 1, 0, ""      },   // 42 LD B,D
+    { 1, 0, ""      },   // 43 LD B,E
+    { 1, 0, ""      },   // 44 LD B,H
+    { 1, 0, ""      },   // 45 LD B,L
+    { 1, 0, "r"     },   // 46 LD B,(HL)
+    { 1, 0, ""      },   // 47 LD B,A
+    { 1, 0, ""      },   // 48 LD C,B
+    { 1, 0, ""      },   // 49 LD C,C
+    { 1, 0, ""      },   // 4A LD C,D
+    { 1, 0, ""      },   // 4B LD C,E
+    { 1, 0, ""      },   // 4C LD C,H
+    { 1, 0, ""      },   // 4D LD C,L
+    { 1, 0, "r"     },   // 4E LD C,(HL)
+    { 1, 0, ""      },   // 4F LD C,A
+    { 1, 0, ""      },   // 50 LD D,B
+    { 1, 0, ""      },   // 51 LD D,C
+    { 1, 0, ""      },   // 52 LD D,D
+    { 1, 0, ""      },   // 53 LD D,E
+    { 1, 0, ""      },   // 54 LD D,H
+    { 1, 0, ""      },   // 55 LD D,L
+    { 1, 0, "r"     },   // 56 LD D,(HL)
+    { 1, 0, ""      },   // 57 LD D,A
+    { 1, 0, ""      },   // 58 LD E,B
+    { 1, 0, ""      },   // 59 LD E,C
+    { 1, 0, ""      },   // 5A LD E,D
+    { 1, 0, ""      },   // 5B LD E,E
+    { 1, 0, ""      },   // 5C LD E,H
+    { 1, 0, ""      },   // 5D LD E,L
+    { 1, 0, "r"     },   // 5E LD E,(HL)
+    { 1, 0, ""      },   // 5F LD E,A
+    { 1, 0, ""      },   // 60 LD H,B
+    { 1, 0, ""      },   // 61 LD H,C
+    { 1, 0, ""      },   // 62 LD H,D
+    { 1, 0, ""      },   // 63 LD H,E
+    { 1, 0, ""      },   // 64 LD H,H
+    { 1, 0, ""      },   // 65 LD H,L
+    { 1, 0, "r"     },   // 66 LD H,(HL)
+    { 1, 0, ""      },   // 67 LD H,A
+    { 1, 0, ""      },   // 68 LD L,B
+    { 1, 0, ""      },   // 69 LD L,C
+    { 1, 0, ""      },   // 6A LD L,D
+    { 1, 0, ""      },   // 6B LD L,E
+    { 1, 0, ""      },   // 6C LD L,H
+    { 1, 0, ""      },   // 6D LD L,L
+    { 1, 0, "r"     },   // 6E LD L,(HL)
+    { 1, 0, ""      },   // 6F LD L,A
+    { 1, 0, "w"     },   // 70 LD (HL),B
+    { 1, 0, "w"     },   // 71 LD (HL),C
+    { 1, 0, "w"     },   // 72 LD (HL),D
+    { 1, 0, "w"     },   // 73 LD (HL),E
+    { 1, 0, "w"     },   // 74 LD (HL),H
+    { 1, 0, "w"     },   // 75 LD (HL),L
+    { 1, 0, ""      },   // 76 HALT
+    { 1, 0, "w"     },   // 77 LD (HL),A
+    { 1, 0, ""      },   // 78 LD A,B
+    { 1, 0, ""      },   // 79 LD A,C
+    { 1, 0, ""      },   // 7A LD A,D
+    { 1, 0, ""      },   // 7B LD A,E
+    { 1, 0, ""      },   // 7C LD A,H
+    { 1, 0, ""      },   // 7D LD A,L
+    { 1, 0, "r"     },   // 7E LD A,(HL)
+    { 1, 0, ""      },   // 7F LD A,A
+    { 1, 0, ""      },   // 80 ADD A,B
+    { 1, 0, ""      },   // 81 ADD A,C
+    { 1, 0, ""      },   // 82 ADD A,D
+    { 1, 0, ""      },   // 83 ADD A,E
+    { 1, 0, ""      },   // 84 ADD A,H
+    { 1, 0, ""      },   // 85 ADD A,L
+    { 1, 0, "r"     },   // 86 ADD A,(HL)
+    { 1, 0, ""      },   // 87 ADD A,A
+    { 1, 0, ""      },   // 88 ADC A,B
+    { 1, 0, ""      },   // 89 ADC A,C
+    { 1, 0, ""      },   // 8A ADC A,D
+    { 1, 0, ""      },   // 8B ADC A,E
+    { 1, 0, ""      },   // 8C ADC A,H
+    { 1, 0, ""      },   // 8D ADC A,L
+    { 1, 0, "r"     },   // 8E ADC A,(HL)
+    { 1, 0, ""      },   // 8F ADC A,A
+    { 1, 0, ""      },   // 90 SUB A,B
+    { 1, 0, ""      },   // 91 SUB A,C
+    { 1, 0, ""      },   // 92 SUB A,D
+    { 1, 0, ""      },   // 93 SUB A,E
+    { 1, 0, ""      },   // 94 SUB A,H
+    { 1, 0, ""      },   // 95 SUB A,L
+    { 1, 0, "r"     },   // 96 SUB A,(HL)
+    { 1, 0, ""      },   // 97 SUB A,A
+    { 1, 0, ""      },   // 98 SBC A,B
+    { 1, 0, ""      },   // 99 SBC A,C
+    { 1, 0, ""      },   // 9A SBC A,D
+    { 1, 0, ""      },   // 9B SBC A,E
+    { 1, 0, ""      },   // 9C SBC A,H
+    { 1, 0, ""      },   // 9D SBC A,L
+    { 1, 0, "r"     },   // 9E SBC A,(HL)
+    { 1, 0, ""      },   // 9F SBC A,A
+    { 1, 0, ""      },   // A0 AND B
+    { 1, 0, ""      },   // A1 AND C
+    { 1, 0, ""      },   // A2 AND D
+    { 1, 0, ""      },   // A3 AND E
+    { 1, 0, ""      },   // A4 AND H
+    { 1, 0, ""      },   // A5 AND L
+    { 1, 0, "r"     },   // A6 AND (HL)
+    { 1, 0, ""      },   // A7 AND A
+    { 1, 0, ""      },   // A8 XOR B
+    { 1, 0, ""      },   // A9 XOR C
+    { 1, 0, ""      },   // AA XOR D
+    { 1, 0, ""      },   // AB XOR E
+    { 1, 0, ""      },   // AC XOR H
+    { 1, 0, ""      },   // AD XOR L
+    { 1, 0, "r"     },   // AE XOR (HL)
+    { 1, 0, ""      },   // AF XOR A
+    { 1, 0, ""      },   // B0 OR B
+    { 1, 0, ""      },   // B1 OR C
+    { 1, 0, ""      },   // B2 OR D
+    { 1, 0, ""      },   // B3 OR E
+    { 1, 0, ""      },   // B4 OR H
+    { 1, 0, ""      },   // B5 OR L
+    { 1, 0, "r"     },   // B6 OR (HL)
+    { 1, 0, ""      },   // B7 OR A
+    { 1, 0, ""      },   // B8 CP B
+    { 1, 0, ""      },   // B9 CP C
+    { 1, 0, ""      },   // BA CP D
+    { 1, 0, ""      },   // BB CP E
+    { 1, 0, ""      },   // BC CP H
+    { 1, 0, ""      },   // BD CP L
+    { 1, 0, "r"     },   // BE CP (HL)
+    { 1, 0, ""      },   // BF CP A
+    { 1, 0, "rr"    },   // C0 RET NZ
+    { 1, 0, "rr"    },   // C1 POP BC
+    { 1, 2, ""      },   // C2 JP NZ,(nn)
+    { 1, 2, ""      },   // C3 JP (nn)
+    { 1, 2, "ww"    },   // C4 CALL NZ,(nn)
+    { 1, 0, "ww"    },   // C5 PUSH BC
+    { 1, 1, ""      },   // C6 ADD A,n
+    { 1, 0, "ww"    },   // C7 RST 0H
+    { 1, 0, "rr"    },   // C8 RET Z
+    { 1, 0, "rr"    },   // C9 RET
+    { 1, 2, ""      },   // CA JP Z,(nn)
+    { 1, 0, NULL    },   // CB
+    { 1, 2, "ww"    },   // CC CALL Z,(nn)
+    { 1, 2, "ww"    },   // CD CALL (nn)
+    { 1, 1, ""      },   // CE ADC A,n
+    { 1, 0, "ww"    },   // CF RST 8H
+    { 1, 0, "rr"    },   // D0 RET NC
+    { 1, 0, "rr"    },   // D1 POP DE
+    { 1, 2, ""      },   // D2 JP NC,(nn)
+    { 1, 1, "o"     },   // D3 OUT (n),A
+    { 1, 2, "ww"    },   // D4 CALL NC,(nn)
+    { 1, 0, "ww"    },   // D5 PUSH DE
+    { 1, 1, ""      },   // D6 SUB A,n
+    { 1, 0, "ww"    },   // D7 RST 10H
+    { 1, 0, "rr"    },   // D8 RET C
+    { 1, 0, ""      },   // D9 EXX
+    { 1, 2, ""      },   // DA JP C,(nn)
+    { 1, 1, "i"     },   // DB IN A,(n)
+    { 1, 2, "ww"    },   // DC CALL C,(nn)
+    { 1, 0, NULL    },   // DD
+    { 1, 1, ""      },   // DE SBC A,n
+    { 1, 0, "ww"    },   // DF RST 18H
+    { 1, 0, "rr"    },   // E0 RET PO
+    { 1, 0, "rr"    },   // E1 POP HL
+    { 1, 2, ""      },   // E2 JP PO,(nn)
+    { 1, 0, "rrxx"  },   // E3 EX (SP),HL
+    { 1, 2, "ww"    },   // E4 CALL PO,(nn)
+    { 1, 0, "ww"    },   // E5 PUSH HL
+    { 1, 1, ""      },   // E6 AND n
+    { 1, 0, "ww"    },   // E7 RST 20H
+    { 1, 0, "rr"    },   // E8 RET PE
+    { 1, 0, ""      },   // E9 JP (HL)
+    { 1, 2, ""      },   // EA JP PE,(nn)
+    { 1, 0, ""      },   // EB EX DE,HL
+    { 1, 2, "ww"    },   // EC CALL PE,(nn)
+    { 1, 0, NULL    },   // ED
+    { 1, 1, ""      },   // EE XOR n
+    { 1, 0, "ww"    },   // EF RST 28H
+    { 1, 0, "rr"    },   // F0 RET P
+    { 1, 0, "rr"    },   // F1 POP AF
+    { 1, 2, ""      },   // F2 JP P,(nn)
+    { 1, 0, ""      },   // F3 DI
+    { 1, 2, "ww"    },   // F4 CALL P,(nn)
+    { 1, 0, "ww"    },   // F5 PUSH AF
+    { 1, 1, ""      },   // F6 OR n
+    { 1, 0, "ww"    },   // F7 RST 30H
+    { 1, 0, "rr"    },   // F8 RET M
+    { 1, 0, ""      },   // F9 LD SP,HL
+    { 1, 2, ""      },   // FA JP M,(nn)
+    { 1, 0, ""      },   // FB EI
+    { 1, 2, "ww"    },   // FC CALL M,(nn)
+    { 1, 0, NULL    },   // FD
+    { 1, 1, ""      },   // FE CP n
+    { 1, 0, "ww"    },   // FF RST 38H
+};
+
+static const Z80CycleTableEntry z80CycleTable_CB[256] = {
+    { 2, 0, ""      },   // 00 RLC B
+    { 2, 0, ""      },   // 01 RLC C
+    { 2, 0, ""      },   // 02 RLC D
+    { 2, 0, ""      },   // 03 RLC E
+    { 2, 0, ""      },   // 04 RLC H
+    { 2, 0, ""      },   // 05 RLC L
+    { 2, 0, "rw"    },   // 06 RLC (HL)
+    { 2, 0, ""      },   // 07 RLC A
+    { 2, 0, ""      },   // 08 RRC B
+    { 2, 0, ""      },   // 09 RRC C
+    { 2, 0, ""      },   // 0A RRC D
+    { 2, 0, ""      },   // 0B RRC E
+    { 2, 0, ""      },   // 0C RRC H
+    { 2, 0, ""      },   // 0D RRC L
+    { 2, 0, "rw"    },   // 0E RRC (HL)
+    { 2, 0, ""      },   // 0F RRC A
+    { 2, 0, ""      },   // 10 RL B
+    { 2, 0, ""      },   // 11 RL C
+    { 2, 0, ""      },   // 12 RL D
+    { 2, 0, ""      },   // 13 RL E
+    { 2, 0, ""      },   // 14 RL H
+    { 2, 0, ""      },   // 15 RL L
+    { 2, 0, "rw"    },   // 16 RL (HL)
+    { 2, 0, ""      },   // 17 RL A
+    { 2, 0, ""      },   // 18 RR B
+    { 2, 0, ""      },   // 19 RR C
+    { 2, 0, ""      },   // 1A RR D
+    { 2, 0, ""      },   // 1B RR E
+    { 2, 0, ""      },   // 1C RR H
+    { 2, 0, ""      },   // 1D RR L
+    { 2, 0, "rw"    },   // 1E RR (HL)
+    { 2, 0, ""      },   // 1F RR A
+    { 2, 0, ""      },   // 20 SLA B
+    { 2, 0, ""      },   // 21 SLA C
+    { 2, 0, ""      },   // 22 SLA D
+    { 2, 0, ""      },   // 23 SLA E
+    { 2, 0, ""      },   // 24 SLA H
+    { 2, 0, ""      },   // 25 SLA L
+    { 2, 0, "rw"    },   // 26 SLA (HL)
+    { 2, 0, ""      },   // 27 SLA A
+    { 2, 0, ""      },   // 28 SRA B
+    { 2, 0, ""      },   // 29 SRA C
+    { 2, 0, ""      },   // 2A SRA D
+    { 2, 0, ""      },   // 2B SRA E
+    { 2, 0, ""      },   // 2C SRA H
+    { 2, 0, ""      },   // 2D SRA L
+    { 2, 0, "rw"    },   // 2E SRA (HL)
+    { 2, 0, ""      },   // 2F SRA A
+    { 2, 0, ""      },   // 30 SLL B
+    { 2, 0, ""      },   // 31 SLL C
+    { 2, 0, ""      },   // 32 SLL D
+    { 2, 0, ""      },   // 33 SLL E
+    { 2, 0, ""      },   // 34 SLL H
+    { 2, 0, ""      },   // 35 SLL L
+    { 2, 0, "rw"    },   // 36 SLL (HL)
+    { 2, 0, ""      },   // 37 SLL A
+    { 2, 0, ""      },   // 38 SRL B
+    { 2, 0, ""      },   // 39 SRL C
+    { 2, 0, ""      },   // 3A SRL D
+    { 2, 0, ""      },   // 3B SRL E
+    { 2, 0, ""      },   // 3C SRL H
+    { 2, 0, ""      },   // 3D SRL L
+    { 2, 0, "rw"    },   // 3E SRL (HL)
+    { 2, 0, ""      },   // 3F SRL A
+    { 2, 0, ""      },   // 40 BIT 0,B
+    { 2, 0, ""      },   // 41 BIT 0,C
+    { 2, 0, ""      },   // 42 BIT 0,D
+    { 2, 0, ""      },   // 43 BIT 0,E
+    { 2, 0, ""      },   // 44 BIT 0,H
+    { 2, 0, ""      },   // 45 BIT 0,L
+    { 2, 0, "r"     },   // 46 BIT 0,(HL)
+    { 2, 0, ""      },   // 47 BIT 0,A
+    { 2, 0, ""      },   // 48 BIT 1,B
+    { 2, 0, ""      },   // 49 BIT 1,C
+    { 2, 0, ""      },   // 4A BIT 1,D
+    { 2, 0, ""      },   // 4B BIT 1,E
+    { 2, 0, ""      },   // 4C BIT 1,H
+    { 2, 0, ""      },   // 4D BIT 1,L
+    { 2, 0, "r"     },   // 4E BIT 1,(HL)
+    { 2, 0, ""      },   // 4F BIT 1,A
+    { 2, 0, ""      },   // 50 BIT 2,B
+    { 2, 0, ""      },   // 51 BIT 2,C
+    { 2, 0, ""      },   // 52 BIT 2,D
+    { 2, 0, ""      },   // 53 BIT 2,E
+    { 2, 0, ""      },   // 54 BIT 2,H
+    { 2, 0, ""      },   // 55 BIT 2,L
+    { 2, 0, "r"     },   // 56 BIT 2,(HL)
+    { 2, 0, ""      },   // 57 BIT 2,A
+    { 2, 0, ""      },   // 58 BIT 3,B
+    { 2, 0, ""      },   // 59 BIT 3,C
+    { 2, 0, ""      },   // 5A BIT 3,D
+    { 2, 0, ""      },   // 5B BIT 3,E
+    { 2, 0, ""      },   // 5C BIT 3,H
+    { 2, 0, ""      },   // 5D BIT 3,L
+    { 2, 0, "r"     },   // 5E BIT 3,(HL)
+    { 2, 0, ""      },   // 5F BIT 3,A
+    { 2, 0, ""      },   // 60 BIT 4,B
+    { 2, 0, ""      },   // 61 BIT 4,C
+    { 2, 0, ""      },   // 62 BIT 4,D
+    { 2, 0, ""      },   // 63 BIT 4,E
+    { 2, 0, ""      },   // 64 BIT 4,H
+    { 2, 0, ""      },   // 65 BIT 4,L
+    { 2, 0, "r"     },   // 66 BIT 4,(HL)
+    { 2, 0, ""      },   // 67 BIT 4,A
+    { 2, 0, ""      },   // 68 BIT 5,B
+    { 2, 0, ""      },   // 69 BIT 5,C
+    { 2, 0, ""      },   // 6A BIT 5,D
+    { 2, 0, ""      },   // 6B BIT 5,E
+    { 2, 0, ""      },   // 6C BIT 5,H
+    { 2, 0, ""      },   // 6D BIT 5,L
+    { 2, 0, "r"     },   // 6E BIT 5,(HL)
+    { 2, 0, ""      },   // 6F BIT 5,A
+    { 2, 0, ""      },   // 70 BIT 6,B
+    { 2, 0, ""      },   // 71 BIT 6,C
+    { 2, 0, ""      },   // 72 BIT 6,D
+    { 2, 0, ""      },   // 73 BIT 6,E
+    { 2, 0, ""      },   // 74 BIT 6,H
+    { 2, 0, ""      },   // 75 BIT 6,L
+    { 2, 0, "r"     },   // 76 BIT 6,(HL)
+    { 2, 0, ""      },   // 77 BIT 6,A
+    { 2, 0, ""      },   // 78 BIT 7,B
+    { 2, 0, ""      },   // 79 BIT 7,C
+    { 2, 0, ""      },   // 7A BIT 7,D
+    { 2, 0, ""      },   // 7B BIT 7,E
+    { 2, 0, ""      },   // 7C BIT 7,H
+    { 2, 0, ""      },   // 7D BIT 7,L
+    { 2, 0, "r"     },   // 7E BIT 7,(HL)
+    { 2, 0, ""      },   // 7F BIT 7,A
+    { 2, 0, ""      },   // 80 RES 0,B
+    { 2, 0, ""      },   // 81 RES 0,C
+    { 2, 0, ""      },   // 82 RES 0,D
+    { 2, 0, ""      },   // 83 RES 0,E
+    { 2, 0, ""      },   // 84 RES 0,H
+    { 2, 0, ""      },   // 85 RES 0,L
+    { 2, 0, "rw"    },   // 86 RES 0,(HL)
+    { 2, 0, ""      },   // 87 RES 0,A
+    { 2, 0, ""      },   // 88 RES 1,B
+    { 2, 0, ""      },   // 89 RES 1,C
+    { 2, 0, ""      },   // 8A RES 1,D
+    { 2, 0, ""      },   // 8B RES 1,E
+    { 2, 0, ""      },   // 8C RES 1,H
+    { 2, 0, ""      },   // 8D RES 1,L
+    { 2, 0, "rw"    },   // 8E RES 1,(HL)
+    { 2, 0, ""      },   // 8F RES 1,A
+    { 2, 0, ""      },   // 90 RES 2,B
+    { 2, 0, ""      },   // 91 RES 2,C
+    { 2, 0, ""      },   // 92 RES 2,D
+    { 2, 0, ""      },   // 93 RES 2,E
+    { 2, 0, ""      },   // 94 RES 2,H
+    { 2, 0, ""      },   // 95 RES 2,L
+    { 2, 0, "rw"    },   // 96 RES 2,(HL)
+    { 2, 0, ""      },   // 97 RES 2,A
+    { 2, 0, ""      },   // 98 RES 3,B
+    { 2, 0, ""      },   // 99 RES 3,C
+    { 2, 0, ""      },   // 9A RES 3,D
+    { 2, 0, ""      },   // 9B RES 3,E
+    { 2, 0, ""      },   // 9C RES 3,H
+    { 2, 0, ""      },   // 9D RES 3,L
+    { 2, 0, "rw"    },   // 9E RES 3,(HL)
+    { 2, 0, ""      },   // 9F RES 3,A
+    { 2, 0, ""      },   // A0 RES 4,B
+    { 2, 0, ""      },   // A1 RES 4,C
+    { 2, 0, ""      },   // A2 RES 4,D
+    { 2, 0, ""      },   // A3 RES 4,E
+    { 2, 0, ""      },   // A4 RES 4,H
+    { 2, 0, ""      },   // A5 RES 4,L
+    { 2, 0, "rw"    },   // A6 RES 4,(HL)
+    { 2, 0, ""      },   // A7 RES 4,A
+    { 2, 0, ""      },   // A8 RES 5,B
+    { 2, 0, ""      },   // A9 RES 5,C
+    { 2, 0, ""      },   // AA RES 5,D
+    { 2, 0, ""      },   // AB RES 5,E
+    { 2, 0, ""      },   // AC RES 5,H
+    { 2, 0, ""      },   // AD RES 5,L
+    { 2, 0, "rw"    },   // AE RES 5,(HL)
+    { 2, 0, ""      },   // AF RES 5,A
+    { 2, 0, ""      },   // B0 RES 6,B
+    { 2, 0, ""      },   // B1 RES 6,C
+    { 2, 0, ""      },   // B2 RES 6,D
+    { 2, 0, ""      },   // B3 RES 6,E
+    { 2, 0, ""      },   // B4 RES 6,H
+    { 2, 0, ""      },   // B5 RES 6,L
+    { 2, 0, "rw"    },   // B6 RES 6,(HL)
+    { 2, 0, ""      },   // B7 RES 6,A
+    { 2, 0, ""      },   // B8 RES 7,B
+    { 2, 0, ""      },   // B9 RES 7,C
+    { 2, 0, ""      },   // BA RES 7,D
+    { 2, 0, ""      },   // BB RES 7,E
+    { 2, 0, ""      },   // BC RES 7,H
+    { 2, 0, ""      },   // BD RES 7,L
+    { 2, 0, "rw"    },   // BE RES 7,(HL)
+    { 2, 0, ""      },   // BF RES 7,A
+    { 2, 0, ""      },   // C0 SET 0,B
+    { 2, 0, ""      },   // C1 SET 0,C
+    { 2, 0, ""      },   // C2 SET 0,D
+    { 2, 0, ""      },   // C3 SET 0,E
+    { 2, 0, ""      },   // C4 SET 0,H
+    { 2, 0, ""      },   // C5 SET 0,L
+    { 2, 0, "rw"    },   // C6 SET 0,(HL)
+    { 2, 0, ""      },   // C7 SET 0,A
+    { 2, 0, ""      },   // C8 SET 1,B
+    { 2, 0, ""      },   // C9 SET 1,C
+    { 2, 0, ""      },   // CA SET 1,D
+    { 2, 0, ""      },   // CB SET 1,E
+    { 2, 0, ""      },   // CC SET 1,H
+    { 2, 0, ""      },   // CD SET 1,L
+    { 2, 0, "rw"    },   // CE SET 1,(HL)
+    { 2, 0, ""      },   // CF SET 1,A
+    { 2, 0, ""      },   // D0 SET 2,B
+    { 2, 0, ""      },   // D1 SET 2,C
+    { 2, 0, ""      },   // D2 SET 2,D
+    { 2, 0, ""      },   // D3 SET 2,E
+    { 2, 0, ""      },   // D4 SET 2,H
+    { 2, 0, ""      },   // D5 SET 2,L
+    { 2, 0, "rw"    },   // D6 SET 2,(HL)
+    { 2, 0, ""      },   // D7 SET 2,A
+    { 2, 0, ""      },   // D8 SET 3,B
+    { 2, 0, ""      },   // D9 SET 3,C
+    { 2, 0, ""      },   // DA SET 3,D
+    { 2, 0, ""      },   // DB SET 3,E
+    { 2, 0, ""      },   // DC SET 3,H
+    { 2, 0, ""      },   // DD SET 3,L
+    { 2, 0, "rw"    },   // DE SET 3,(HL)
+    { 2, 0, ""      },   // DF SET 3,A
+    { 2, 0, ""      },   // E0 SET 4,B
+    { 2, 0, ""      },   // E1 SET 4,C
+    { 2, 0, ""      },   // E2 SET 4,D
+    { 2, 0, ""      },   // E3 SET 4,E
+    { 2, 0, ""      },   // E4 SET 4,H
+    { 2, 0, ""      },   // E5 SET 4,L
+    { 2, 0, "rw"    },   // E6 SET 4,(HL)
+    { 2, 0, ""      },   // E7 SET 4,A
+    { 2, 0, ""      },   // E8 SET 5,B
+    { 2, 0, ""      },   // E9 SET 5,C
+    { 2, 0, ""      },   // EA SET 5,D
+    { 2, 0, ""      },   // EB SET 5,E
+    { 2, 0, ""      },   // EC SET 5,H
+    { 2, 0, ""      },   // ED SET 5,L
+    { 2, 0, "rw"    },   // EE SET 5,(HL)
+    { 2, 0, ""      },   // EF SET 5,A
+    { 2, 0, ""      },   // F0 SET 6,B
+    { 2, 0, ""      },   // F1 SET 6,C
+    { 2, 0, ""      },   // F2 SET 6,D
+    { 2, 0, ""      },   // F3 SET 6,E
+    { 2, 0, ""      },   // F4 SET 6,H
+    { 2, 0, ""      },   // F5 SET 6,L
+    { 2, 0, "rw"    },   // F6 SET 6,(HL)
+    { 2, 0, ""      },   // F7 SET 6,A
+    { 2, 0, ""      },   // F8 SET 7,B
+    { 2, 0, ""      },   // F9 SET 7,C
+    { 2, 0, ""      },   // FA SET 7,D
+    { 2, 0, ""      },   // FB SET 7,E
+    { 2, 0, ""      },   // FC SET 7,H
+    { 2, 0, ""      },   // FD SET 7,L
+    { 2, 0, "rw"    },   // FE SET 7,(HL)
+    { 2, 0, ""      },   // FF SET 7,A
+};
+
+static const Z80CycleTableEntry z80CycleTable_ED[256] = {
+    { 2, 0, NULL    },   // 00
+    { 2, 0, NULL    },   // 01
+    { 2, 0, NULL    },   // 02
+    { 2, 0, NULL    },   // 03
+    { 2, 0, NULL    },   // 04
+    { 2, 0, NULL    },   // 05
+    { 2, 0, NULL    },   // 06
+    { 2, 0, NULL    },   // 07
+    { 2, 0, NULL    },   // 08
+    { 2, 0, NULL    },   // 09
+    { 2, 0, NULL    },   // 0A
+    { 2, 0, NULL    },   // 0B
+    { 2, 0, NULL    },   // 0C
+    { 2, 0, NULL    },   // 0D
+    { 2, 0, NULL    },   // 0E
+    { 2, 0, NULL    },   // 0F
+    { 2, 0, NULL    },   // 10
+    { 2, 0, NULL    },   // 11
+    { 2, 0, NULL    },   // 12
+    { 2, 0, NULL    },   // 13
+    { 2, 0, NULL    },   // 14
+    { 2, 0, NULL    },   // 15
+    { 2, 0, NULL    },   // 16
+    { 2, 0, NULL    },   // 17
+    { 2, 0, NULL    },   // 18
+    { 2, 0, NULL    },   // 19
+    { 2, 0, NULL    },   // 1A
+    { 2, 0, NULL    },   // 1B
+    { 2, 0, NULL    },   // 1C
+    { 2, 0, NULL    },   // 1D
+    { 2, 0, NULL    },   // 1E
+    { 2, 0, NULL    },   // 1F
+    { 2, 0, NULL    },   // 20
+    { 2, 0, NULL    },   // 21
+    { 2, 0, NULL    },   // 22
+    { 2, 0, NULL    },   // 23
+    { 2, 0, NULL    },   // 24
+    { 2, 0, NULL    },   // 25
+    { 2, 0, NULL    },   // 26
+    { 2, 0, NULL    },   // 27
+    { 2, 0, NULL    },   // 28
+    { 2, 0, NULL    },   // 29
+    { 2, 0, NULL    },   // 2A
+    { 2, 0, NULL    },   // 2B
+    { 2, 0, NULL    },   // 2C
+    { 2, 0, NULL    },   // 2D
+    { 2, 0, NULL    },   // 2E
+    { 2, 0, NULL    },   // 2F
+    { 2, 0, NULL    },   // 30
+    { 2, 0, NULL    },   // 31
+    { 2, 0, NULL    },   // 32
+    { 2, 0, NULL    },   // 33
+    { 2, 0, NULL    },   // 34
+    { 2, 0, NULL    },   // 35
+    { 2, 0, NULL    },   // 36
+    { 2, 0, NULL    },   // 37
+    { 2, 0, NULL    },   // 38
+    { 2, 0, NULL    },   // 39
+    { 2, 0, NULL    },   // 3A
+    { 2, 0, NULL    },   // 3B
+    { 2, 0, NULL    },   // 3C
+    { 2, 0, NULL    },   // 3D
+    { 2, 0, NULL    },   // 3E
+    { 2, 0, NULL    },   // 3F
+    { 2, 0, "i"     },   // 40 IN B,(C)
+    { 2, 0, "o"     },   // 41 OUT (C),B
+    { 2, 0, ""      },   // 42 SBC HL,BC
+    { 2, 2, "ww"    },   // 43 LD (nn),BC
+    { 2, 0, ""      },   // 44 NEG
+    { 2, 0, "rr"    },   // 45 RETN
+    { 2, 0, ""      },   // 46 IM 0
+    { 2, 0, ""      },   // 47 LD I,A
+    { 2, 0, "i"     },   // 48 IN C,(C)
+    { 2, 0, "o"     },   // 49 OUT (C),C
+    { 2, 0, ""      },   // 4A ADC HL,BC
+    { 2, 2, "rr"    },   // 4B LD BC,(nn)
+    { 2, 0, ""      },   // 4C NEG
+    { 2, 0, "rr"    },   // 4D RETI
+    { 2, 0, ""      },   // 4E IM 0
+    { 2, 0, ""      },   // 4F LD R,A
+    { 2, 0, "i"     },   // 50 IN D,(C)
+    { 2, 0, "o"     },   // 51 OUT (C),D
+    { 2, 0, ""      },   // 52 SBC HL,DE
+    { 2, 2, "ww"    },   // 53 LD (nn),DE
+    { 2, 0, ""      },   // 54 NEG
+    { 2, 0, "rr"    },   // 55 RETN
+    { 2, 0, ""      },   // 56 IM 1
+    { 2, 0, ""      },   // 57 LD A,I
+    { 2, 0, "i"     },   // 58 IN E,(C)
+    { 2, 0, "o"     },   // 59 OUT (C),E
+    { 2, 0, ""      },   // 5A ADC HL,DE
+    { 2, 2, "rr"    },   // 5B LD DE,(nn)
+    { 2, 0, ""      },   // 5C NEG
+    { 2, 0, "rr"    },   // 5D RETN
+    { 2, 0, ""      },   // 5E IM 2
+    { 2, 0, ""      },   // 5F LD A,R
+    { 2, 0, "i"     },   // 60 IN H,(C)
+    { 2, 0, "o"     },   // 61 OUT (C),H
+    { 2, 0, ""      },   // 62 SBC HL,HL
+    { 2, 2, "ww"    },   // 63 LD (nn),HL
+    { 2, 0, ""      },   // 64 NEG
+    { 2, 0, "rr"    },   // 65 RETN
+    { 2, 0, ""      },   // 66 IM 0
+    { 2, 0, "rw"    },   // 67 RRD
+    { 2, 0, "i"     },   // 68 IN L,(C)
+    { 2, 0, "o"     },   // 69 OUT (C),L
+    { 2, 0, ""      },   // 6A ADC HL,HL
+    { 2, 2, "rr"    },   // 6B LD HL,(nn)
+    { 2, 0, ""      },   // 6C NEG
+    { 2, 0, "rr"    },   // 6D RETN
+    { 2, 0, ""      },   // 6E IM 0
+    { 2, 0, "rw"    },   // 6F RLD
+    { 2, 0, "i"     },   // 70 IN F,(C)
+    { 2, 0, "o"     },   // 71 OUT (C),0
+    { 2, 0, ""      },   // 72 SBC HL,SP
+    { 2, 2, "ww"    },   // 73 LD (nn),SP
+    { 2, 0, ""      },   // 74 NEG
+    { 2, 0, "rr"    },   // 75 RETN
+    { 2, 0, ""      },   // 76 IM 1
+    { 2, 0, NULL    },   // 77
+    { 2, 0, "i"     },   // 78 IN A,(C)
+    { 2, 0, "o"     },   // 79 OUT (C),A
+    { 2, 0, ""      },   // 7A ADC HL,SP
+    { 2, 2, "rr"    },   // 7B LD SP,(nn)
+    { 2, 0, ""      },   // 7C NEG
+    { 2, 0, "rr"    },   // 7D RETN
+    { 2, 0, ""      },   // 7E IM 2
+    { 2, 0, NULL    },   // 7F
+    { 2, 0, NULL    },   // 80
+    { 2, 0, NULL    },   // 81
+    { 2, 0, NULL    },   // 82
+    { 2, 0, NULL    },   // 83
+    { 2, 0, NULL    },   // 84
+    { 2, 0, NULL    },   // 85
+    { 2, 0, NULL    },   // 86
+    { 2, 0, NULL    },   // 87
+    { 2, 0, NULL    },   // 88
+    { 2, 0, NULL    },   // 89
+    { 2, 0, NULL    },   // 8A
+    { 2, 0, NULL    },   // 8B
+    { 2, 0, NULL    },   // 8C
+    { 2, 0, NULL    },   // 8D
+    { 2, 0, NULL    },   // 8E
+    { 2, 0, NULL    },   // 8F
+    { 2, 0, NULL    },   // 90
+    { 2, 0, NULL    },   // 91
+    { 2, 0, NULL    },   // 92
+    { 2, 0, NULL    },   // 93
+    { 2, 0, NULL    },   // 94
+    { 2, 0, NULL    },   // 95
+    { 2, 0, NULL    },   // 96
+    { 2, 0, NULL    },   // 97
+    { 2, 0, NULL    },   // 98
+    { 2, 0, NULL    },   // 99
+    { 2, 0, NULL    },   // 9A
+    { 2, 0, NULL    },   // 9B
+    { 2, 0, NULL    },   // 9C
+    { 2, 0, NULL    },   // 9D
+    { 2, 0, NULL    },   // 9E
+    { 2, 0, NULL    },   // 9F
+    { 2, 0, "rw"    },   // A0 LDI
+    { 2, 0, "r"     },   // A1 CPI
+    { 2, 0, "iw"    },   // A2 INI
+    { 2, 0, "ro"    },   // A3 OUTI
+    { 2, 0, NULL    },   // A4
+    { 2, 0, NULL    },   // A5
+    { 2, 0, NULL    },   // A6
+    { 2, 0, NULL    },   // A7
+    { 2, 0, "rw"    },   // A8 LDD
+    { 2, 0, "r"     },   // A9 CPD
+    { 2, 0, "iw"    },   // AA IND
+    { 2, 0, "ro"    },   // AB OUTD
+    { 2, 0, NULL    },   // AC
+    { 2, 0, NULL    },   // AD
+    { 2, 0, NULL    },   // AE
+    { 2, 0, NULL    },   // AF
+    { 2, 0, "rw"    },   // B0 LDIR
+    { 2, 0, "r"     },   // B1 CPIR
+    { 2, 0, "iw"    },   // B2 INIR
+    { 2, 0, "ro"    },   // B3 OTIR
+    { 2, 0, NULL    },   // B4
+    { 2, 0, NULL    },   // B5
+    { 2, 0, NULL    },   // B6
+    { 2, 0, NULL    },   // B7
+    { 2, 0, "rw"    },   // B8 LDDR
+    { 2, 0, "r"     },   // B9 CPDR
+    { 2, 0, "iw"    },   // BA INDR
+    { 2, 0, "ro"    },   // BB OTDR
+    { 2, 0, NULL    },   // BC
+    { 2, 0, NULL    },   // BD
+    { 2, 0, NULL    },   // BE
+    { 2, 0, NULL    },   // BF
+    { 2, 0, NULL    },   // C0
+    { 2, 0, NULL    },   // C1
+    { 2, 0, NULL    },   // C2
+    { 2, 0, NULL    },   // C3
+    { 2, 0, NULL    },   // C4
+    { 2, 0, NULL    },   // C5
+    { 2, 0, NULL    },   // C6
+    { 2, 0, NULL    },   // C7
+    { 2, 0, NULL    },   // C8
+    { 2, 0, NULL    },   // C9
+    { 2, 0, NULL    },   // CA
+    { 2, 0, NULL    },   // CB
+    { 2, 0, NULL    },   // CC
+    { 2, 0, NULL    },   // CD
+    { 2, 0, NULL    },   // CE
+    { 2, 0, NULL    },   // CF
+    { 2, 0, NULL    },   // D0
+    { 2, 0, NULL    },   // D1
+    { 2, 0, NULL    },   // D2
+    { 2, 0, NULL    },   // D3
+    { 2, 0, NULL    },   // D4
+    { 2, 0, NULL    },   // D5
+    { 2, 0, NULL    },   // D6
+    { 2, 0, NULL    },   // D7
+    { 2, 0, NULL    },   // D8
+    { 2, 0, NULL    },   // D9
+    { 2, 0, NULL    },   // DA
+    { 2, 0, NULL    },   // DB
+    { 2, 0, NULL    },   // DC
+    { 2, 0, NULL    },   // DD
+    { 2, 0, NULL    },   // DE
+    { 2, 0, NULL    },   // DF
+    { 2, 0, NULL    },   // E0
+    { 2, 0, NULL    },   // E1
+    { 2, 0, NULL    },   // E2
+    { 2, 0, NULL    },   // E3
+    { 2, 0, NULL    },   // E4
+    { 2, 0, NULL    },   // E5
+    { 2, 0, NULL    },   // E6
+    { 2, 0, NULL    },   // E7
+    { 2, 0, NULL    },   // E8
+    { 2, 0, NULL    },   // E9
+    { 2, 0, NULL    },   // EA
+    { 2, 0, NULL    },   // EB
+    { 2, 0, NULL    },   // EC
+    { 2, 0, NULL    },   // ED
+    { 2, 0, NULL    },   // EE
+    { 2, 0, NULL    },   // EF
+    { 2, 0, NULL    },   // F0
+    { 2, 0, NULL    },   // F1
+    { 2, 0, NULL    },   // F2
+    { 2, 0, NULL    },   // F3
+    { 2, 0, NULL    },   // F4
+    { 2, 0, NULL    },   // F5
+    { 2, 0, NULL    },   // F6
+    { 2, 0, NULL    },   // F7
+    { 2, 0, NULL    },   // F8
+    { 2, 0, NULL    },   // F9
+    { 2, 0, NULL    },   // FA
+    { 2, 0, NULL    },   // FB
+    { 2, 0, NULL    },   // FC
+    { 2, 0, NULL    },   // FD
+    { 2, 0, NULL    },   // FE
+    { 2, 0, NULL    },   // FF
+};
+
+static const Z80CycleTableEntry z80CycleTable_DD[256] = {
+    { 2, 0, NULL    },   // 00
+    { 2, 0, NULL    },   // 01
+    { 2, 0, NULL    },   // 02
+    { 2, 0, NULL    },   // 03
+    { 2, 0, NULL    },   // 04
+    { 2, 0, NULL    },   // 05
+    { 2, 0, NULL    },   // 06
+    { 2, 0, NULL    },   // 07
+    { 2, 0, NULL    },   // 08
+    { 2, 0, ""      },   // 09 ADD IX,BC
+    { 2, 0, NULL    },   // 0A
+    { 2, 0, NULL    },   // 0B
+    { 2, 0, NULL    },   // 0C
+    { 2, 0, NULL    },   // 0D
+    { 2, 0, NULL    },   // 0E
+    { 2, 0, NULL    },   // 0F
+    { 2, 0, NULL    },   // 10
+    { 2, 0, NULL    },   // 11
+    { 2, 0, NULL    },   // 12
+    { 2, 0, NULL    },   // 13
+    { 2, 0, NULL    },   // 14
+    { 2, 0, NULL    },   // 15
+    { 2, 0, NULL    },   // 16
+    { 2, 0, NULL    },   // 17
+    { 2, 0, NULL    },   // 18
+    { 2, 0, ""      },   // 19 ADD IX,DE
+    { 2, 0, NULL    },   // 1A
+    { 2, 0, NULL    },   // 1B
+    { 2, 0, NULL    },   // 1C
+    { 2, 0, NULL    },   // 1D
+    { 2, 0, NULL    },   // 1E
+    { 2, 0, NULL    },   // 1F
+    { 2, 0, NULL    },   // 20
+    { 2, 2, ""      },   // 21 LD IX,nn
+    { 2, 2, "ww"    },   // 22 LD (nn),IX
+    { 2, 0, ""      },   // 23 INC IX
+    { 2, 0, ""      },   // 24 INC IXh
+    { 2, 0, ""      },   // 25 DEC IXh
+    { 2, 1, ""      },   // 26 LD IXh,n
+    { 2, 0, NULL    },   // 27
+    { 2, 0, NULL    },   // 28
+    { 2, 0, ""      },   // 29 ADD IX,IX
+    { 2, 2, "rr"    },   // 2A LD IX,(nn)
+    { 2, 0, ""      },   // 2B DEC IX
+    { 2, 0, ""      },   // 2C INC IXl
+    { 2, 0, ""      },   // 2D DEC IXl
+    { 2, 1, ""      },   // 2E LD IXl,n
+    { 2, 0, NULL    },   // 2F
+    { 2, 0, NULL    },   // 30
+    { 2, 0, NULL    },   // 31
+    { 2, 0, NULL    },   // 32
+    { 2, 0, NULL    },   // 33
+    { 2, 1, "rw"    },   // 34 INC (IX+d)
+    { 2, 1, "rw"    },   // 35 DEC (IX+d)
+    { 2, 2, "w"     },   // 36 LD (IX+d),n
+    { 2, 0, NULL    },   // 37
+    { 2, 0, NULL    },   // 38
+    { 2, 0, ""      },   // 39 ADD IX,SP
+    { 2, 0, NULL    },   // 3A
+    { 2, 0, NULL    },   // 3B
+    { 2, 0, NULL    },   // 3C
+    { 2, 0, NULL    },   // 3D
+    { 2, 0, NULL    },   // 3E
+    { 2, 0, NULL    },   // 3F
+    { 2, 0, NULL    },   // 40
+    { 2, 0, NULL    },   // 41
+    { 2, 0, NULL    },   // 42
+    { 2, 0, NULL    },   // 43
+    { 2, 0, ""      },   // 44 LD B,IXh
+    { 2, 0, ""      },   // 45 LD B,IXl
+    { 2, 1, "r"     },   // 46 LD B,(IX+d)
+    { 2, 0, NULL    },   // 47
+    { 2, 0, NULL    },   // 48
+    { 2, 0, NULL    },   // 49
+    { 2, 0, NULL    },   // 4A
+    { 2, 0, NULL    },   // 4B
+    { 2, 0, ""      },   // 4C LD C,IXh
+    { 2, 0, ""      },   // 4D LD C,IXl
+    { 2, 1, "r"     },   // 4E LD C,(IX+d)
+    { 2, 0, NULL    },   // 4F
+    { 2, 0, NULL    },   // 50
+    { 2, 0, NULL    },   // 51
+    { 2, 0, NULL    },   // 52
+    { 2, 0, NULL    },   // 53
+    { 2, 0, ""      },   // 54 LD D,IXh
+    { 2, 0, ""      },   // 55 LD D,IXl
+    { 2, 1, "r"     },   // 56 LD D,(IX+d)
+    { 2, 0, NULL    },   // 57
+    { 2, 0, NULL    },   // 58
+    { 2, 0, NULL    },   // 59
+    { 2, 0, NULL    },   // 5A
+    { 2, 0, NULL    },   // 5B
+    { 2, 0, ""      },   // 5C LD E,IXh
+    { 2, 0, ""      },   // 5D LD E,IXl
+    { 2, 1, "r"     },   // 5E LD E,(IX+d)
+    { 2, 0, NULL    },   // 5F
+    { 2, 0, ""      },   // 60 LD IXh,B
+    { 2, 0, ""      },   // 61 LD IXh,C
+    { 2, 0, ""      },   // 62 LD IXh,D
+    { 2, 0, ""      },   // 63 LD IXh,E
+    { 2, 0, ""      },   // 64 LD IXh,IXh
+    { 2, 0, ""      },   // 65 LD IXh,IXl
+    { 2, 1, "r"     },   // 66 LD H,(IX+d)
+    { 2, 0, ""      },   // 67 LD IXh,A
+    { 2, 0, ""      },   // 68 LD IXl,B
+    { 2, 0, ""      },   // 69 LD IXl,C
+    { 2, 0, ""      },   // 6A LD IXl,D
+    { 2, 0, ""      },   // 6B LD IXl,E
+    { 2, 0, ""      },   // 6C LD IXl,IXh
+    { 2, 0, ""      },   // 6D LD IXl,IXl
+    { 2, 1, "r"     },   // 6E LD L,(IX+d)
+    { 2, 0, ""      },   // 6F LD IXl,A
+    { 2, 1, "w"     },   // 70 LD (IX+d),B
+    { 2, 1, "w"     },   // 71 LD (IX+d),C
+    { 2, 1, "w"     },   // 72 LD (IX+d),D
+    { 2, 1, "w"     },   // 73 LD (IX+d),E
+    { 2, 1, "w"     },   // 74 LD (IX+d),H
+    { 2, 1, "w"     },   // 75 LD (IX+d),L
+    { 2, 0, NULL    },   // 76
+    { 2, 1, "w"     },   // 77 LD (IX+d),A
+    { 2, 0, NULL    },   // 78
+    { 2, 0, NULL    },   // 79
+    { 2, 0, NULL    },   // 7A
+    { 2, 0, NULL    },   // 7B
+    { 2, 0, ""      },   // 7C LD A,IXh
+    { 2, 0, ""      },   // 7D LD A,IXl
+    { 2, 1, "r"     },   // 7E LD A,(IX+d)
+    { 2, 0, NULL    },   // 7F
+    { 2, 0, NULL    },   // 80
+    { 2, 0, NULL    },   // 81
+    { 2, 0, NULL    },   // 82
+    { 2, 0, NULL    },   // 83
+    { 2, 0, ""      },   // 84 ADD A,IXh
+    { 2, 0, ""      },   // 85 ADD A,IXl
+    { 2, 1, "r"     },   // 86 ADD A,(IX+d)
+    { 2, 0, NULL    },   // 87
+    { 2, 0, NULL    },   // 88
+    { 2, 0, NULL    },   // 89
+    { 2, 0, NULL    },   // 8A
+    { 2, 0, NULL    },   // 8B
+    { 2, 0, ""      },   // 8C ADC A,IXh
+    { 2, 0, ""      },   // 8D ADC A,IXl
+    { 2, 1, "r"     },   // 8E ADC A,(IX+d)
+    { 2, 0, NULL    },   // 8F
+    { 2, 0, NULL    },   // 90
+    { 2, 0, NULL    },   // 91
+    { 2, 0, NULL    },   // 92
+    { 2, 0, NULL    },   // 93
+    { 2, 0, ""      },   // 94 SUB A,IXh
+    { 2, 0, ""      },   // 95 SUB A,IXl
+    { 2, 1, "r"     },   // 96 SUB A,(IX+d)
+    { 2, 0, NULL    },   // 97
+    { 2, 0, NULL    },   // 98
+    { 2, 0, NULL    },   // 99
+    { 2, 0, NULL    },   // 9A
+    { 2, 0, NULL    },   // 9B
+    { 2, 0, ""      },   // 9C SBC A,IXh
+    { 2, 0, ""      },   // 9D SBC A,IXl
+    { 2, 1, "r"     },   // 9E SBC A,(IX+d)
+    { 2, 0, NULL    },   // 9F
+    { 2, 0, NULL    },   // A0
+    { 2, 0, NULL    },   // A1
+    { 2, 0, NULL    },   // A2
+    { 2, 0, NULL    },   // A3
+    { 2, 0, ""      },   // A4 AND IXh
+    { 2, 0, ""      },   // A5 AND IXl
+    { 2, 1, "r"     },   // A6 AND (IX+d)
+    { 2, 0, NULL    },   // A7
+    { 2, 0, NULL    },   // A8
+    { 2, 0, NULL    },   // A9
+    { 2, 0, NULL    },   // AA
+    { 2, 0, NULL    },   // AB
+    { 2, 0, ""      },   // AC XOR IXh
+    { 2, 0, ""      },   // AD XOR IXl
+    { 2, 1, "r"     },   // AE XOR (IX+d)
+    { 2, 0, NULL    },   // AF
+    { 2, 0, NULL    },   // B0
+    { 2, 0, NULL    },   // B1
+    { 2, 0, NULL    },   // B2
+    { 2, 0, NULL    },   // B3
+    { 2, 0, ""      },   // B4 OR IXh
+    { 2, 0, ""      },   // B5 OR IXl
+    { 2, 1, "r"     },   // B6 OR (IX+d)
+    { 2, 0, NULL    },   // B7
+    { 2, 0, NULL    },   // B8
+    { 2, 0, NULL    },   // B9
+    { 2, 0, NULL    },   // BA
+    { 2, 0, NULL    },   // BB
+    { 2, 0, ""      },   // BC CP IXh
+    { 2, 0, ""      },   // BD CP IXl
+    { 2, 1, "r"     },   // BE CP (IX+d)
+    { 2, 0, NULL    },   // BF
+    { 2, 0, NULL    },   // C0
+    { 2, 0, NULL    },   // C1
+    { 2, 0, NULL    },   // C2
+    { 2, 0, NULL    },   // C3
+    { 2, 0, NULL    },   // C4
+    { 2, 0, NULL    },   // C5
+    { 2, 0, NULL    },   // C6
+    { 2, 0, NULL    },   // C7
+    { 2, 0, NULL    },   // C8
+    { 2, 0, NULL    },   // C9
+    { 2, 0, NULL    },   // CA
+    { 2, 0, NULL    },   // CB
+    { 2, 0, NULL    },   // CC
+    { 2, 0, NULL    },   // CD
+    { 2, 0, NULL    },   // CE
+    { 2, 0, NULL    },   // CF
+    { 2, 0, NULL    },   // D0
+    { 2, 0, NULL    },   // D1
+    { 2, 0, NULL    },   // D2
+    { 2, 0, NULL    },   // D3
+    { 2, 0, NULL    },   // D4
+    { 2, 0, NULL    },   // D5
+    { 2, 0, NULL    },   // D6
+    { 2, 0, NULL    },   // D7
+    { 2, 0, NULL    },   // D8
+    { 2, 0, NULL    },   // D9
+    { 2, 0, NULL    },   // DA
+    { 2, 0, NULL    },   // DB
+    { 2, 0, NULL    },   // DC
+    { 2, 0, NULL    },   // DD
+    { 2, 0, NULL    },   // DE
+    { 2, 0, NULL    },   // DF
+    { 2, 0, NULL    },   // E0
+    { 2, 0, "rr"    },   // E1 POP IX
+    { 2, 0, NULL    },   // E2
+    { 2, 0, "rrxx"  },   // E3 EX (SP),IX
+    { 2, 0, NULL    },   // E4
+    { 2, 0, "ww"    },   // E5 PUSH IX
+    { 2, 0, NULL    },   // E6
+    { 2, 0, NULL    },   // E7
+    { 2, 0, NULL    },   // E8
+    { 2, 0, ""      },   // E9 JP (IX)
+    { 2, 0, NULL    },   // EA
+    { 2, 0, NULL    },   // EB
+    { 2, 0, NULL    },   // EC
+    { 2, 0, NULL    },   // ED
+    { 2, 0, NULL    },   // EE
+    { 2, 0, NULL    },   // EF
+    { 2, 0, NULL    },   // F0
+    { 2, 0, NULL    },   // F1
+    { 2, 0, NULL    },   // F2
+    { 2, 0, NULL    },   // F3
+    { 2, 0, NULL    },   // F4
+    { 2, 0, NULL    },   // F5
+    { 2, 0, NULL    },   // F6
+    { 2, 0, NULL    },   // F7
+    { 2, 0, NULL    },   // F8
+    { 2, 0, ""      },   // F9 LD SP,IX
+    { 2, 0, NULL    },   // FA
+    { 2, 0, NULL    },   // FB
+    { 2, 0, NULL    },   // FC
+    { 2, 0, NULL    },   // FD
+    { 2, 0, NULL    },   // FE
+    { 2, 0, NULL    },   // FF
+};
+
+static const Z80CycleTableEntry z80CycleTable_FD[256] = {
+    { 2, 0, NULL    },   // 00
+    { 2, 0, NULL    },   // 01
+    { 2, 0, NULL    },   // 02
+    { 2, 0, NULL    },   // 03
+    { 2, 0, NULL    },   // 04
+    { 2, 0, NULL    },   // 05
+    { 2, 0, NULL    },   // 06
+    { 2, 0, NULL    },   // 07
+    { 2, 0, NULL    },   // 08
+    { 2, 0, ""      },   // 09 ADD IY,BC
+    { 2, 0, NULL    },   // 0A
+    { 2, 0, NULL    },   // 0B
+    { 2, 0, NULL    },   // 0C
+    { 2, 0, NULL    },   // 0D
+    { 2, 0, NULL    },   // 0E
+    { 2, 0, NULL    },   // 0F
+    { 2, 0, NULL    },   // 10
+    { 2, 0, NULL    },   // 11
+    { 2, 0, NULL    },   // 12
+    { 2, 0, NULL    },   // 13
+    { 2, 0, NULL    },   // 14
+    { 2, 0, NULL    },   // 15
+    { 2, 0, NULL    },   // 16
+    { 2, 0, NULL    },   // 17
+    { 2, 0, NULL    },   // 18
+    { 2, 0, ""      },   // 19 ADD IY,DE
+    { 2, 0, NULL    },   // 1A
+    { 2, 0, NULL    },   // 1B
+    { 2, 0, NULL    },   // 1C
+    { 2, 0, NULL    },   // 1D
+    { 2, 0, NULL    },   // 1E
+    { 2, 0, NULL    },   // 1F
+    { 2, 0, NULL    },   // 20
+    { 2, 2, ""      },   // 21 LD IY,nn
+    { 2, 2, "ww"    },   // 22 LD (nn),IY
+    { 2, 0, ""      },   // 23 INC IY
+    { 2, 0, ""      },   // 24 INC IYh
+    { 2, 0, ""      },   // 25 DEC IYh
+    { 2, 1, ""      },   // 26 LD IYh,n
+    { 2, 0, NULL    },   // 27
+    { 2, 0, NULL    },   // 28
+    { 2, 0, ""      },   // 29 ADD IY,IY
+    { 2, 2, "rr"    },   // 2A LD IY,(nn)
+    { 2, 0, ""      },   // 2B DEC IY
+    { 2, 0, ""      },   // 2C INC IYl
+    { 2, 0, ""      },   // 2D DEC IYl
+    { 2, 1, ""      },   // 2E LD IYl,n
+    { 2, 0, NULL    },   // 2F
+    { 2, 0, NULL    },   // 30
+    { 2, 0, NULL    },   // 31
+    { 2, 0, NULL    },   // 32
+    { 2, 0, NULL    },   // 33
+    { 2, 1, "rw"    },   // 34 INC (IY+d)
+    { 2, 1, "rw"    },   // 35 DEC (IY+d)
+    { 2, 2, "w"     },   // 36 LD (IY+d),n
+    { 2, 0, NULL    },   // 37
+    { 2, 0, NULL    },   // 38
+    { 2, 0, ""      },   // 39 ADD IY,SP
+    { 2, 0, NULL    },   // 3A
+    { 2, 0, NULL    },   // 3B
+    { 2, 0, NULL    },   // 3C
+    { 2, 0, NULL    },   // 3D
+    { 2, 0, NULL    },   // 3E
+    { 2, 0, NULL    },   // 3F
+    { 2, 0, NULL    },   // 40
+    { 2, 0, NULL    },   // 41
+    { 2, 0, NULL    },   // 42
+    { 2, 0, NULL    },   // 43
+    { 2, 0, ""      },   // 44 LD B,IYh
+    { 2, 0, ""      },   // 45 LD B,IYl
+    { 2, 1, "r"     },   // 46 LD B,(IY+d)
+    { 2, 0, NULL    },   // 47
+    { 2, 0, NULL    },   // 48
+    { 2, 0, NULL    },   // 49
+    { 2, 0, NULL    },   // 4A
+    { 2, 0, NULL    },   // 4B
+    { 2, 0, ""      },   // 4C LD C,IYh
+    { 2, 0, ""      },   // 4D LD C,IYl
+    { 2, 1, "r"     },   // 4E LD C,(IY+d)
+    { 2, 0, NULL    },   // 4F
+    { 2, 0, NULL    },   // 50
+    { 2, 0, NULL    },   // 51
+    { 2, 0, NULL    },   // 52
+    { 2, 0, NULL    },   // 53
+    { 2, 0, ""      },   // 54 LD D,IYh
+    { 2, 0, ""      },   // 55 LD D,IYl
+    { 2, 1, "r"     },   // 56 LD D,(IY+d)
+    { 2, 0, NULL    },   // 57
+    { 2, 0, NULL    },   // 58
+    { 2, 0, NULL    },   // 59
+    { 2, 0, NULL    },   // 5A
+    { 2, 0, NULL    },   // 5B
+    { 2, 0, ""      },   // 5C LD E,IYh
+    { 2, 0, ""      },   // 5D LD E,IYl
+    { 2, 1, "r"     },   // 5E LD E,(IY+d)
+    { 2, 0, NULL    },   // 5F
+    { 2, 0, ""      },   // 60 LD IYh,B
+    { 2, 0, ""      },   // 61 LD IYh,C
+    { 2, 0, ""      },   // 62 LD IYh,D
+    { 2, 0, ""      },   // 63 LD IYh,E
+    { 2, 0, ""      },   // 64 LD IYh,IYh
+    { 2, 0, ""      },   // 65 LD IYh,IYl
+    { 2, 1, "r"     },   // 66 LD H,(IY+d)
+    { 2, 0, ""      },   // 67 LD IYh,A
+    { 2, 0, ""      },   // 68 LD IYl,B
+    { 2, 0, ""      },   // 69 LD IYl,C
+    { 2, 0, ""      },   // 6A LD IYl,D
+    { 2, 0, ""      },   // 6B LD IYl,E
+    { 2, 0, ""      },   // 6C LD IYl,IYh
+    { 2, 0, ""      },   // 6D LD IYl,IYl
+    { 2, 1, "r"     },   // 6E LD L,(IY+d)
+    { 2, 0, ""      },   // 6F LD IYl,A
+    { 2, 1, "w"     },   // 70 LD (IY+d),B
+    { 2, 1, "w"     },   // 71 LD (IY+d),C
+    { 2, 1, "w"     },   // 72 LD (IY+d),D
+    { 2, 1, "w"     },   // 73 LD (IY+d),E
+    { 2, 1, "w"     },   // 74 LD (IY+d),H
+    { 2, 1, "w"     },   // 75 LD (IY+d),L
+    { 2, 0, NULL    },   // 76
+    { 2, 1, "w"     },   // 77 LD (IY+d),A
+    { 2, 0, NULL    },   // 78
+    { 2, 0, NULL    },   // 79
+    { 2, 0, NULL    },   // 7A
+    { 2, 0, NULL    },   // 7B
+    { 2, 0, ""      },   // 7C LD A,IYh
+    { 2, 0, ""      },   // 7D LD A,IYl
+    { 2, 1, "r"     },   // 7E LD A,(IY+d)
+    { 2, 0, NULL    },   // 7F
+    { 2, 0, NULL    },   // 80
+    { 2, 0, NULL    },   // 81
+    { 2, 0, NULL    },   // 82
+    { 2, 0, NULL    },   // 83
+    { 2, 0, ""      },   // 84 ADD A,IYh
+    { 2, 0, ""      },   // 85 ADD A,IYl
+    { 2, 1, "r"     },   // 86 ADD A,(IY+d)
+    { 2, 0, NULL    },   // 87
+    { 2, 0, NULL    },   // 88
+    { 2, 0, NULL    },   // 89
+    { 2, 0, NULL    },   // 8A
+    { 2, 0, NULL    },   // 8B
+    { 2, 0, ""      },   // 8C ADC A,IYh
+    { 2, 0, ""      },   // 8D ADC A,IYl
+    { 2, 1, "r"     },   // 8E ADC A,(IY+d)
+    { 2, 0, NULL    },   // 8F
+    { 2, 0, NULL    },   // 90
+    { 2, 0, NULL    },   // 91
+    { 2, 0, NULL    },   // 92
+    { 2, 0, NULL    },   // 93
+    { 2, 0, ""      },   // 94 SUB A,IYh
+    { 2, 0, ""      },   // 95 SUB A,IYl
+    { 2, 1, "r"     },   // 96 SUB A,(IY+d)
+    { 2, 0, NULL    },   // 97
+    { 2, 0, NULL    },   // 98
+    { 2, 0, NULL    },   // 99
+    { 2, 0, NULL    },   // 9A
+    { 2, 0, NULL    },   // 9B
+    { 2, 0, ""      },   // 9C SBC A,IYh
+    { 2, 0, ""      },   // 9D SBC A,IYl
+    { 2, 1, "r"     },   // 9E SBC A,(IY+d)
+    { 2, 0, NULL    },   // 9F
+    { 2, 0, NULL    },   // A0
+    { 2, 0, NULL    },   // A1
+    { 2, 0, NULL    },   // A2
+    { 2, 0, NULL    },   // A3
+    { 2, 0, ""      },   // A4 AND IYh
+    { 2, 0, ""      },   // A5 AND IYl
+    { 2, 1, "r"     },   // A6 AND (IY+d)
+    { 2, 0, NULL    },   // A7
+    { 2, 0, NULL    },   // A8
+    { 2, 0, NULL    },   // A9
+    { 2, 0, NULL    },   // AA
+    { 2, 0, NULL    },   // AB
+    { 2, 0, ""      },   // AC XOR IYh
+    { 2, 0, ""      },   // AD XOR IYl
+    { 2, 1, "r"     },   // AE XOR (IY+d)
+    { 2, 0, NULL    },   // AF
+    { 2, 0, NULL    },   // B0
+    { 2, 0, NULL    },   // B1
+    { 2, 0, NULL    },   // B2
+    { 2, 0, NULL    },   // B3
+    { 2, 0, ""      },   // B4 OR IYh
+    { 2, 0, ""      },   // B5 OR IYl
+    { 2, 1, "r"     },   // B6 OR (IY+d)
+    { 2, 0, NULL    },   // B7
+    { 2, 0, NULL    },   // B8
+    { 2, 0, NULL    },   // B9
+    { 2, 0, NULL    },   // BA
+    { 2, 0, NULL    },   // BB
+    { 2, 0, ""      },   // BC CP IYh
+    { 2, 0, ""      },   // BD CP IYl
+    { 2, 1, "r"     },   // BE CP (IY+d)
+    { 2, 0, NULL    },   // BF
+    { 2, 0, NULL    },   // C0
+    { 2, 0, NULL    },   // C1
+    { 2, 0, NULL    },   // C2
+    { 2, 0, NULL    },   // C3
+    { 2, 0, NULL    },   // C4
+    { 2, 0, NULL    },   // C5
+    { 2, 0, NULL    },   // C6
+    { 2, 0, NULL    },   // C7
+    { 2, 0, NULL    },   // C8
+    { 2, 0, NULL    },   // C9
+    { 2, 0, NULL    },   // CA
+    { 2, 0, NULL    },   // CB
+    { 2, 0, NULL    },   // CC
+    { 2, 0, NULL    },   // CD
+    { 2, 0, NULL    },   // CE
+    { 2, 0, NULL    },   // CF
+    { 2, 0, NULL    },   // D0
+    { 2, 0, NULL    },   // D1
+    { 2, 0, NULL    },   // D2
+    { 2, 0, NULL    },   // D3
+    { 2, 0, NULL    },   // D4
+    { 2, 0, NULL    },   // D5
+    { 2, 0, NULL    },   // D6
+    { 2, 0, NULL    },   // D7
+    { 2, 0, NULL    },   // D8
+    { 2, 0, NULL    },   // D9
+    { 2, 0, NULL    },   // DA
+    { 2, 0, NULL    },   // DB
+    { 2, 0, NULL    },   // DC
+    { 2, 0, NULL    },   // DD
+    { 2, 0, NULL    },   // DE
+    { 2, 0, NULL    },   // DF
+    { 2, 0, NULL    },   // E0
+    { 2, 0, "rr"    },   // E1 POP IY
+    { 2, 0, NULL    },   // E2
+    { 2, 0, "rrxx"  },   // E3 EX (SP),IY
+    { 2, 0, NULL    },   // E4
+    { 2, 0, "ww"    },   // E5 PUSH IY
+    { 2, 0, NULL    },   // E6
+    { 2, 0, NULL    },   // E7
+    { 2, 0, NULL    },   // E8
+    { 2, 0, ""      },   // E9 JP (IY)
+    { 2, 0, NULL    },   // EA
+    { 2, 0, NULL    },   // EB
+    { 2, 0, NULL    },   // EC
+    { 2, 0, NULL    },   // ED
+    { 2, 0, NULL    },   // EE
+    { 2, 0, NULL    },   // EF
+    { 2, 0, NULL    },   // F0
+    { 2, 0, NULL    },   // F1
+    { 2, 0, NULL    },   // F2
+    { 2, 0, NULL    },   // F3
+    { 2, 0, NULL    },   // F4
+    { 2, 0, NULL    },   // F5
+    { 2, 0, NULL    },   // F6
+    { 2, 0, NULL    },   // F7
+    { 2, 0, NULL    },   // F8
+    { 2, 0, ""      },   // F9 LD SP,IY
+    { 2, 0, NULL    },   // FA
+    { 2, 0, NULL    },   // FB
+    { 2, 0, NULL    },   // FC
+    { 2, 0, NULL    },   // FD
+    { 2, 0, NULL    },   // FE
+    { 2, 0, NULL    },   // FF
+};
+
+static const Z80CycleTableEntry z80CycleTable_DDCB[256] = {
+    { 2, 2, "rw"    },   // 00 LD B,RLC (IX+d)
+    { 2, 2, "rw"    },   // 01 LD C,RLC (IX+d)
+    { 2, 2, "rw"    },   // 02 LD D,RLC (IX+d)
+    { 2, 2, "rw"    },   // 03 LD E,RLC (IX+d)
+    { 2, 2, "rw"    },   // 04 LD H,RLC (IX+d)
+    { 2, 2, "rw"    },   // 05 LD L,RLC (IX+d)
+    { 2, 2, "rw"    },   // 06 RLC (IX+d)
+    { 2, 2, "rw"    },   // 07 LD A,RLC (IX+d)
+    { 2, 2, "rw"    },   // 08 LD B,RRC (IX+d)
+    { 2, 2, "rw"    },   // 09 LD C,RRC (IX+d)
+    { 2, 2, "rw"    },   // 0A LD D,RRC (IX+d)
+    { 2, 2, "rw"    },   // 0B LD E,RRC (IX+d)
+    { 2, 2, "rw"    },   // 0C LD H,RRC (IX+d)
+    { 2, 2, "rw"    },   // 0D LD L,RRC (IX+d)
+    { 2, 2, "rw"    },   // 0E RRC (IX+d)
+    { 2, 2, "rw"    },   // 0F LD A,RRC (IX+d)
+    { 2, 2, "rw"    },   // 10 LD B,RL (IX+d)
+    { 2, 2, "rw"    },   // 11 LD C,RL (IX+d)
+    { 2, 2, "rw"    },   // 12 LD D,RL (IX+d)
+    { 2, 2, "rw"    },   // 13 LD E,RL (IX+d)
+    { 2, 2, "rw"    },   // 14 LD H,RL (IX+d)
+    { 2, 2, "rw"    },   // 15 LD L,RL (IX+d)
+    { 2, 2, "rw"    },   // 16 RL (IX+d)
+    { 2, 2, "rw"    },   // 17 LD A,RL (IX+d)
+    { 2, 2, "rw"    },   // 18 LD B,RR (IX+d)
+    { 2, 2, "rw"    },   // 19 LD C,RR (IX+d)
+    { 2, 2, "rw"    },   // 1A LD D,RR (IX+d)
+    { 2, 2, "rw"    },   // 1B LD E,RR (IX+d)
+    { 2, 2, "rw"    },   // 1C LD H,RR (IX+d)
+    { 2, 2, "rw"    },   // 1D LD L,RR (IX+d)
+    { 2, 2, "rw"    },   // 1E RR (IX+d)
+    { 2, 2, "rw"    },   // 1F LD A,RR (IX+d)
+    { 2, 2, "rw"    },   // 20 LD B,SLA (IX+d)
+    { 2, 2, "rw"    },   // 21 LD C,SLA (IX+d)
+    { 2, 2, "rw"    },   // 22 LD D,SLA (IX+d)
+    { 2, 2, "rw"    },   // 23 LD E,SLA (IX+d)
+    { 2, 2, "rw"    },   // 24 LD H,SLA (IX+d)
+    { 2, 2, "rw"    },   // 25 LD L,SLA (IX+d)
+    { 2, 2, "rw"    },   // 26 SLA (IX+d)
+    { 2, 2, "rw"    },   // 27 LD A,SLA (IX+d)
+    { 2, 2, "rw"    },   // 28 LD B,SRA (IX+d)
+    { 2, 2, "rw"    },   // 29 LD C,SRA (IX+d)
+    { 2, 2, "rw"    },   // 2A LD D,SRA (IX+d)
+    { 2, 2, "rw"    },   // 2B LD E,SRA (IX+d)
+    { 2, 2, "rw"    },   // 2C LD H,SRA (IX+d)
+    { 2, 2, "rw"    },   // 2D LD L,SRA (IX+d)
+    { 2, 2, "rw"    },   // 2E SRA (IX+d)
+    { 2, 2, "rw"    },   // 2F LD A,SRA (IX+d)
+    { 2, 2, "rw"    },   // 30 LD B,SLL (IX+d)
+    { 2, 2, "rw"    },   // 31 LD C,SLL (IX+d)
+    { 2, 2, "rw"    },   // 32 LD D,SLL (IX+d)
+    { 2, 2, "rw"    },   // 33 LD E,SLL (IX+d)
+    { 2, 2, "rw"    },   // 34 LD H,SLL (IX+d)
+    { 2, 2, "rw"    },   // 35 LD L,SLL (IX+d)
+    { 2, 2, "rw"    },   // 36 SLL (IX+d)
+    { 2, 2, "rw"    },   // 37 LD A,SLL (IX+d)
+    { 2, 2, "rw"    },   // 38 LD B,SRL (IX+d)
+    { 2, 2, "rw"    },   // 39 LD C,SRL (IX+d)
+    { 2, 2, "rw"    },   // 3A LD D,SRL (IX+d)
+    { 2, 2, "rw"    },   // 3B LD E,SRL (IX+d)
+    { 2, 2, "rw"    },   // 3C LD H,SRL (IX+d)
+    { 2, 2, "rw"    },   // 3D LD L,SRL (IX+d)
+    { 2, 2, "rw"    },   // 3E SRL (IX+d)
+    { 2, 2, "rw"    },   // 3F LD A,SRL (IX+d)
+    { 2, 2, "r"     },   // 40 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 41 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 42 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 43 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 44 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 45 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 46 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 47 BIT 0,(IX+d)
+    { 2, 2, "r"     },   // 48 BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 49 BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 4A BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 4B BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 4C BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 4D BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 4E BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 4F BIT 1,(IX+d)
+    { 2, 2, "r"     },   // 50 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 51 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 52 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 53 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 54 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 55 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 56 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 57 BIT 2,(IX+d)
+    { 2, 2, "r"     },   // 58 BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 59 BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 5A BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 5B BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 5C BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 5D BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 5E BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 5F BIT 3,(IX+d)
+    { 2, 2, "r"     },   // 60 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 61 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 62 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 63 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 64 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 65 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 66 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 67 BIT 4,(IX+d)
+    { 2, 2, "r"     },   // 68 BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 69 BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 6A BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 6B BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 6C BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 6D BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 6E BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 6F BIT 5,(IX+d)
+    { 2, 2, "r"     },   // 70 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 71 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 72 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 73 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 74 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 75 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 76 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 77 BIT 6,(IX+d)
+    { 2, 2, "r"     },   // 78 BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 79 BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 7A BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 7B BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 7C BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 7D BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 7E BIT 7,(IX+d)
+    { 2, 2, "r"     },   // 7F BIT 7,(IX+d)
+    { 2, 2, "rw"    },   // 80 LD B,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 81 LD C,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 82 LD D,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 83 LD E,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 84 LD H,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 85 LD L,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 86 RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 87 LD A,RES 0,(IX+d)
+    { 2, 2, "rw"    },   // 88 LD B,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 89 LD C,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 8A LD D,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 8B LD E,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 8C LD H,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 8D LD L,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 8E RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 8F LD A,RES 1,(IX+d)
+    { 2, 2, "rw"    },   // 90 LD B,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 91 LD C,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 92 LD D,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 93 LD E,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 94 LD H,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 95 LD L,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 96 RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 97 LD A,RES 2,(IX+d)
+    { 2, 2, "rw"    },   // 98 LD B,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 99 LD C,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 9A LD D,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 9B LD E,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 9C LD H,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 9D LD L,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 9E RES 3,(IX+d)
+    { 2, 2, "rw"    },   // 9F LD A,RES 3,(IX+d)
+    { 2, 2, "rw"    },   // A0 LD B,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A1 LD C,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A2 LD D,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A3 LD E,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A4 LD H,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A5 LD L,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A6 RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A7 LD A,RES 4,(IX+d)
+    { 2, 2, "rw"    },   // A8 LD B,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // A9 LD C,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // AA LD D,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // AB LD E,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // AC LD H,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // AD LD L,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // AE RES 5,(IX+d)
+    { 2, 2, "rw"    },   // AF LD A,RES 5,(IX+d)
+    { 2, 2, "rw"    },   // B0 LD B,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B1 LD C,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B2 LD D,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B3 LD E,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B4 LD H,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B5 LD L,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B6 RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B7 LD A,RES 6,(IX+d)
+    { 2, 2, "rw"    },   // B8 LD B,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // B9 LD C,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // BA LD D,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // BB LD E,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // BC LD H,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // BD LD L,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // BE RES 7,(IX+d)
+    { 2, 2, "rw"    },   // BF LD A,RES 7,(IX+d)
+    { 2, 2, "rw"    },   // C0 LD B,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C1 LD C,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C2 LD D,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C3 LD E,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C4 LD H,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C5 LD L,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C6 SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C7 LD A,SET 0,(IX+d)
+    { 2, 2, "rw"    },   // C8 LD B,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // C9 LD C,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // CA LD D,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // CB LD E,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // CC LD H,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // CD LD L,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // CE SET 1,(IX+d)
+    { 2, 2, "rw"    },   // CF LD A,SET 1,(IX+d)
+    { 2, 2, "rw"    },   // D0 LD B,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D1 LD C,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D2 LD D,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D3 LD E,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D4 LD H,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D5 LD L,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D6 SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D7 LD A,SET 2,(IX+d)
+    { 2, 2, "rw"    },   // D8 LD B,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // D9 LD C,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // DA LD D,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // DB LD E,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // DC LD H,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // DD LD L,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // DE SET 3,(IX+d)
+    { 2, 2, "rw"    },   // DF LD A,SET 3,(IX+d)
+    { 2, 2, "rw"    },   // E0 LD B,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E1 LD C,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E2 LD D,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E3 LD E,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E4 LD H,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E5 LD L,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E6 SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E7 LD A,SET 4,(IX+d)
+    { 2, 2, "rw"    },   // E8 LD B,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // E9 LD C,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // EA LD D,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // EB LD E,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // EC LD H,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // ED LD L,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // EE SET 5,(IX+d)
+    { 2, 2, "rw"    },   // EF LD A,SET 5,(IX+d)
+    { 2, 2, "rw"    },   // F0 LD B,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F1 LD C,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F2 LD D,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F3 LD E,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F4 LD H,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F5 LD L,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F6 SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F7 LD A,SET 6,(IX+d)
+    { 2, 2, "rw"    },   // F8 LD B,SET 7,(IX+d)
+    { 2, 2, "rw"    },   // F9 LD C,SET 7,(IX+d)
+    { 2, 2, "rw"    },   // FA LD D,SET 7,(IX+d)
+    { 2, 2, "rw"    },   // FB LD E,SET 7,(IX+d)
+    { 2, 2, "rw"    },   // FC LD H,SET 7,(IX+d)
+    { 2, 2, "rw"    },   // FD LD L,SET 7,(IX+d)
+    { 2, 2, "rw"    },   // FE SET 7,(IX+d)
+    { 2, 2, "rw"    },   // FF LD A,SET 7,(IX+d)
+};
+
+static const Z80CycleTableEntry z80CycleTable_FDCB[256] = {
+    { 2, 2, "rw"    },   // 00 LD B,RLC (IY+d)
+    { 2, 2, "rw"    },   // 01 LD C,RLC (IY+d)
+    { 2, 2, "rw"    },   // 02 LD D,RLC (IY+d)
+    { 2, 2, "rw"    },   // 03 LD E,RLC (IY+d)
+    { 2, 2, "rw"    },   // 04 LD H,RLC (IY+d)
+    { 2, 2, "rw"    },   // 05 LD L,RLC (IY+d)
+    { 2, 2, "rw"    },   // 06 RLC (IY+d)
+    { 2, 2, "rw"    },   // 07 LD A,RLC (IY+d)
+    { 2, 2, "rw"    },   // 08 LD B,RRC (IY+d)
+    { 2, 2, "rw"    },   // 09 LD C,RRC (IY+d)
+    { 2, 2, "rw"    },   // 0A LD D,RRC (IY+d)
+    { 2, 2, "rw"    },   // 0B LD E,RRC (IY+d)
+    { 2, 2, "rw"    },   // 0C LD H,RRC (IY+d)
+    { 2, 2, "rw"    },   // 0D LD L,RRC (IY+d)
+    { 2, 2, "rw"    },   // 0E RRC (IY+d)
+    { 2, 2, "rw"    },   // 0F LD A,RRC (IY+d)
+    { 2, 2, "rw"    },   // 10 LD B,RL (IY+d)
+    { 2, 2, "rw"    },   // 11 LD C,RL (IY+d)
+    { 2, 2, "rw"    },   // 12 LD D,RL (IY+d)
+    { 2, 2, "rw"    },   // 13 LD E,RL (IY+d)
+    { 2, 2, "rw"    },   // 14 LD H,RL (IY+d)
+    { 2, 2, "rw"    },   // 15 LD L,RL (IY+d)
+    { 2, 2, "rw"    },   // 16 RL (IY+d)
+    { 2, 2, "rw"    },   // 17 LD A,RL (IY+d)
+    { 2, 2, "rw"    },   // 18 LD B,RR (IY+d)
+    { 2, 2, "rw"    },   // 19 LD C,RR (IY+d)
+    { 2, 2, "rw"    },   // 1A LD D,RR (IY+d)
+    { 2, 2, "rw"    },   // 1B LD E,RR (IY+d)
+    { 2, 2, "rw"    },   // 1C LD H,RR (IY+d)
+    { 2, 2, "rw"    },   // 1D LD L,RR (IY+d)
+    { 2, 2, "rw"    },   // 1E RR (IY+d)
+    { 2, 2, "rw"    },   // 1F LD A,RR (IY+d)
+    { 2, 2, "rw"    },   // 20 LD B,SLA (IY+d)
+    { 2, 2, "rw"    },   // 21 LD C,SLA (IY+d)
+    { 2, 2, "rw"    },   // 22 LD D,SLA (IY+d)
+    { 2, 2, "rw"    },   // 23 LD E,SLA (IY+d)
+    { 2, 2, "rw"    },   // 24 LD H,SLA (IY+d)
+    { 2, 2, "rw"    },   // 25 LD L,SLA (IY+d)
+    { 2, 2, "rw"    },   // 26 SLA (IY+d)
+    { 2, 2, "rw"    },   // 27 LD A,SLA (IY+d)
+    { 2, 2, "rw"    },   // 28 LD B,SRA (IY+d)
+    { 2, 2, "rw"    },   // 29 LD C,SRA (IY+d)
+    { 2, 2, "rw"    },   // 2A LD D,SRA (IY+d)
+    { 2, 2, "rw"    },   // 2B LD E,SRA (IY+d)
+    { 2, 2, "rw"    },   // 2C LD H,SRA (IY+d)
+    { 2, 2, "rw"    },   // 2D LD L,SRA (IY+d)
+    { 2, 2, "rw"    },   // 2E SRA (IY+d)
+    { 2, 2, "rw"    },   // 2F LD A,SRA (IY+d)
+    { 2, 2, "rw"    },   // 30 LD B,SLL (IY+d)
+    { 2, 2, "rw"    },   // 31 LD C,SLL (IY+d)
+    { 2, 2, "rw"    },   // 32 LD D,SLL (IY+d)
+    { 2, 2, "rw"    },   // 33 LD E,SLL (IY+d)
+    { 2, 2, "rw"    },   // 34 LD H,SLL (IY+d)
+    { 2, 2, "rw"    },   // 35 LD L,SLL (IY+d)
+    { 2, 2, "rw"    },   // 36 SLL (IY+d)
+    { 2, 2, "rw"    },   // 37 LD A,SLL (IY+d)
+    { 2, 2, "rw"    },   // 38 LD B,SRL (IY+d)
+    { 2, 2, "rw"    },   // 39 LD C,SRL (IY+d)
+    { 2, 2, "rw"    },   // 3A LD D,SRL (IY+d)
+    { 2, 2, "rw"    },   // 3B LD E,SRL (IY+d)
+    { 2, 2, "rw"    },   // 3C LD H,SRL (IY+d)
+    { 2, 2, "rw"    },   // 3D LD L,SRL (IY+d)
+    { 2, 2, "rw"    },   // 3E SRL (IY+d)
+    { 2, 2, "rw"    },   // 3F LD A,SRL (IY+d)
+    { 2, 2, "r"     },   // 40 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 41 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 42 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 43 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 44 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 45 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 46 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 47 BIT 0,(IY+d)
+    { 2, 2, "r"     },   // 48 BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 49 BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 4A BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 4B BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 4C BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 4D BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 4E BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 4F BIT 1,(IY+d)
+    { 2, 2, "r"     },   // 50 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 51 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 52 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 53 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 54 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 55 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 56 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 57 BIT 2,(IY+d)
+    { 2, 2, "r"     },   // 58 BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 59 BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 5A BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 5B BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 5C BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 5D BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 5E BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 5F BIT 3,(IY+d)
+    { 2, 2, "r"     },   // 60 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 61 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 62 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 63 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 64 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 65 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 66 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 67 BIT 4,(IY+d)
+    { 2, 2, "r"     },   // 68 BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 69 BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 6A BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 6B BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 6C BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 6D BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 6E BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 6F BIT 5,(IY+d)
+    { 2, 2, "r"     },   // 70 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 71 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 72 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 73 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 74 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 75 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 76 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 77 BIT 6,(IY+d)
+    { 2, 2, "r"     },   // 78 BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 79 BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 7A BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 7B BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 7C BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 7D BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 7E BIT 7,(IY+d)
+    { 2, 2, "r"     },   // 7F BIT 7,(IY+d)
+    { 2, 2, "rw"    },   // 80 LD B,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 81 LD C,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 82 LD D,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 83 LD E,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 84 LD H,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 85 LD L,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 86 RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 87 LD A,RES 0,(IY+d)
+    { 2, 2, "rw"    },   // 88 LD B,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 89 LD C,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 8A LD D,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 8B LD E,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 8C LD H,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 8D LD L,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 8E RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 8F LD A,RES 1,(IY+d)
+    { 2, 2, "rw"    },   // 90 LD B,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 91 LD C,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 92 LD D,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 93 LD E,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 94 LD H,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 95 LD L,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 96 RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 97 LD A,RES 2,(IY+d)
+    { 2, 2, "rw"    },   // 98 LD B,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 99 LD C,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 9A LD D,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 9B LD E,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 9C LD H,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 9D LD L,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 9E RES 3,(IY+d)
+    { 2, 2, "rw"    },   // 9F LD A,RES 3,(IY+d)
+    { 2, 2, "rw"    },   // A0 LD B,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A1 LD C,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A2 LD D,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A3 LD E,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A4 LD H,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A5 LD L,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A6 RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A7 LD A,RES 4,(IY+d)
+    { 2, 2, "rw"    },   // A8 LD B,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // A9 LD C,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // AA LD D,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // AB LD E,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // AC LD H,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // AD LD L,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // AE RES 5,(IY+d)
+    { 2, 2, "rw"    },   // AF LD A,RES 5,(IY+d)
+    { 2, 2, "rw"    },   // B0 LD B,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B1 LD C,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B2 LD D,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B3 LD E,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B4 LD H,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B5 LD L,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B6 RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B7 LD A,RES 6,(IY+d)
+    { 2, 2, "rw"    },   // B8 LD B,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // B9 LD C,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // BA LD D,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // BB LD E,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // BC LD H,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // BD LD L,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // BE RES 7,(IY+d)
+    { 2, 2, "rw"    },   // BF LD A,RES 7,(IY+d)
+    { 2, 2, "rw"    },   // C0 LD B,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C1 LD C,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C2 LD D,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C3 LD E,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C4 LD H,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C5 LD L,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C6 SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C7 LD A,SET 0,(IY+d)
+    { 2, 2, "rw"    },   // C8 LD B,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // C9 LD C,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // CA LD D,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // CB LD E,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // CC LD H,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // CD LD L,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // CE SET 1,(IY+d)
+    { 2, 2, "rw"    },   // CF LD A,SET 1,(IY+d)
+    { 2, 2, "rw"    },   // D0 LD B,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D1 LD C,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D2 LD D,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D3 LD E,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D4 LD H,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D5 LD L,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D6 SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D7 LD A,SET 2,(IY+d)
+    { 2, 2, "rw"    },   // D8 LD B,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // D9 LD C,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // DA LD D,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // DB LD E,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // DC LD H,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // DD LD L,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // DE SET 3,(IY+d)
+    { 2, 2, "rw"    },   // DF LD A,SET 3,(IY+d)
+    { 2, 2, "rw"    },   // E0 LD B,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E1 LD C,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E2 LD D,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E3 LD E,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E4 LD H,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E5 LD L,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E6 SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E7 LD A,SET 4,(IY+d)
+    { 2, 2, "rw"    },   // E8 LD B,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // E9 LD C,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // EA LD D,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // EB LD E,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // EC LD H,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // ED LD L,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // EE SET 5,(IY+d)
+    { 2, 2, "rw"    },   // EF LD A,SET 5,(IY+d)
+    { 2, 2, "rw"    },   // F0 LD B,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F1 LD C,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F2 LD D,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F3 LD E,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F4 LD H,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F5 LD L,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F6 SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F7 LD A,SET 6,(IY+d)
+    { 2, 2, "rw"    },   // F8 LD B,SET 7,(IY+d)
+    { 2, 2, "rw"    },   // F9 LD C,SET 7,(IY+d)
+    { 2, 2, "rw"    },   // FA LD D,SET 7,(IY+d)
+    { 2, 2, "rw"    },   // FB LD E,SET 7,(IY+d)
+    { 2, 2, "rw"    },   // FC LD H,SET 7,(IY+d)
+    { 2, 2, "rw"    },   // FD LD L,SET 7,(IY+d)
+    { 2, 2, "rw"    },   // FE SET 7,(IY+d)
+    { 2, 2, "rw"    },   // FF LD A,SET 7,(IY+d)
+};
+
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# Bus Raider
+# Rob Dobson 2019
+#
+# Generates ../../Z80CycleTable.h from opcodes.lst
+#
+# Each opcode gets the number of operand bytes that follow its opcode fetches and a pattern giving
+# the order of the remaining bus cycles on a real Z80:
+#   r - memory read        w - memory write
+#   x - memory write made after all the others (EX (SP),rr writes the high byte first)
+#   i - IO read            o - IO write
+# Conditional instructions list the cycles made when the condition is met
+
+import re
+import sys
+
+TABLES = ["MAIN", "CB", "ED", "DD", "FD", "DDCB", "FDCB"]
+
+MEM = r"\((HL|IX\+d|IY\+d)\)"
+REG16 = r"(BC|DE|HL|SP|IX|IY)"
+SHIFT_OPS = r"(RLC|RRC|RL|RR|SLA|SRA|SLL|SRL|SET|RES)"
+
+# Rules are tried in order - the first match gives the pattern
+RULES = [
+    (r"^PUSH ", "ww"),
+    (r"^POP ", "rr"),
+    (r"^(CALL|RST) ", "ww"),
+    (r"^RET", "rr"),
+    (r"^EX \(SP\),", "rrxx"),
+    (r"^(LDI|LDD|LDIR|LDDR)$", "rw"),
+    (r"^(CPI|CPD|CPIR|CPDR)$", "r"),
+    (r"^(INI|IND|INIR|INDR)$", "iw"),
+    (r"^(OUTI|OUTD|OTIR|OTDR)$", "ro"),
+    (r"^(RLD|RRD)$", "rw"),
+    (r"^IN ", "i"),
+    (r"^OUT ", "o"),
+    (r"^(JP|JR|DJNZ) ", ""),
+    (r"^LD " + REG16 + r",\(nn\)$", "rr"),
+    (r"^LD \(nn\)," + REG16 + "$", "ww"),
+    (r"^LD A,\((BC|DE|nn)\)$", "r"),
+    (r"^LD \((BC|DE|nn)\),A$", "w"),
+    (r"^LD " + MEM + ",", "w"),
+    (r"^LD \w+," + SHIFT_OPS + " ", "rw"),
+    (r"^(INC|DEC|" + SHIFT_OPS[1:-1] + r") (\d,)?" + MEM + "$", "rw"),
+    (r"^BIT \d," + MEM + "$", "r"),
+    (r"" + MEM, "r"),
+]
+
+def tableAndOpcode(hexStr, tokens):
+    if len(hexStr) == 2:
+        return "MAIN", int(hexStr, 16)
+    prefix = hexStr[:2]
+    if hexStr in ("DDCB", "FDCB"):
+        return hexStr, int(tokens[-1], 16)
+    return prefix, int(hexStr[2:], 16)
+
+def numOperands(table, tokens):
+    count = 0
+    for tok in tokens:
+        if tok in ("d", "e", "n"):
+            count += 1
+        elif tok == "nn":
+            count += 2
+    # The op byte of DDCB/FDCB comes after the displacement so it's read like an operand
+    if table in ("DDCB", "FDCB"):
+        count += 1
+    return count
+
+def numFetches(table):
+    return 1 if table == "MAIN" else 2
+
+def pattern(mnemonic):
+    for rule, pat in RULES:
+        if re.search(rule, mnemonic):
+            return pat
+    return ""
+
+def main():
+    srcFile = sys.argv[1] if len(sys.argv) > 1 else "opcodes.lst"
+    destFile = sys.argv[2] if len(sys.argv) > 2 else "../../Z80CycleTable.h"
+    tables = {name: [None] * 256 for name in TABLES}
+    with open(srcFile) as f:
+        for line in f:
+            line = line.rstrip()
+            if not line:
+                continue
+            parts = re.split(r"  +", line, maxsplit=1)
+            tokens = parts[0].split()
+            mnemonic = parts[1].strip()
+            table, opcode = tableAndOpcode(tokens[0], tokens[1:])
+            entry = (numOperands(table, tokens[1:]), pattern(mnemonic), mnemonic)
+            prev = tables[table][opcode]
+            if prev and prev[:2] != entry[:2]:
+                sys.exit("Inconsistent entries for %s %02X: %s / %s" % (table, opcode, prev[2], mnemonic))
+            if not prev:
+                tables[table][opcode] = entry
+
+    with open(destFile, "w") as out:
+        out.write("// Bus Raider\n")
+        out.write("// Rob Dobson 2019\n")
+        out.write("// Generated by libz80/codegen/mkcycles.py from opcodes.lst - do not edit\n\n")
+        out.write("#pragma once\n\n")
+        out.write('#include "Z80CycleModel.h"\n\n')
+        for name in TABLES:
+            out.write("static const Z80CycleTableEntry z80CycleTable_%s[256] = {\n" % name)
+            for opcode, entry in enumerate(tables[name]):
+                if entry:
+                    out.write("    { %d, %d, %-7s },   // %02X %s\n" % (numFetches(name), entry[0],
+                                '"' + entry[1] + '"', opcode, entry[2]))
+                else:
+                    out.write("    { %d, 0, NULL    },   // %02X\n" % (numFetches(name), opcode))
+            out.write("};\n\n")
+
+if __name__ == "__main__":
+    main()
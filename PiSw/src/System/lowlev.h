@@ -58,6 +58,23 @@ extern void disable_mmu_and_cache();
                                   :                                   \
                                   : [zero] "r"(0))
 
+// Cycle counter - ARM1176 performance monitor control and cycle count registers
+// (enable also resets the count and the counter is not divided)
+#ifdef BR_HOST_SIM
+extern void lowlev_cycleCounterEnable();
+extern uint32_t lowlev_cycleCounterRead();
+#else
+#define lowlev_cycleCounterEnable() asm volatile("mcr p15, #0, %[val], c15, c12, #0" \
+                           :                                   \
+                           : [val] "r"(5))
+static inline uint32_t lowlev_cycleCounterRead()
+{
+    uint32_t val;
+    asm volatile("mrc p15, #0, %[val], c15, c12, #1" : [val] "=r"(val));
+    return val;
+}
+#endif
+
 #define lowlev_mem_p2v(X) (X)
 #define lowlev_mem_v2p(X) (X)
 #define lowlev_mem_2uncached(X) ((((unsigned int)X) & 0x0FFFFFFF) | 0x40000000)
@@ -12,8 +12,17 @@
 extern "C" {
 #endif
 
+#ifdef BR_HOST_SIM
+// Host simulation build (see PiSw/hostsim) - peripheral registers are
+// provided by a simulated register file rather than memory mapped IO
+extern uint32_t hostSimRD32(uint32_t addr);
+extern void hostSimWR32(uint32_t addr, uint32_t val);
+#define WR32(addr, val) hostSimWR32((addr), (val))
+#define RD32(addr) hostSimRD32(addr)
+#else
 #define WR32(addr, val) (*(volatile unsigned *)(addr)) = (val)
 #define RD32(addr) (*(volatile unsigned *)(addr))
+#endif
 
 extern uint32_t micros();
 extern uint32_t millis();
@@ -0,0 +1,391 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "BreakpointCondition.h"
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "../System/lowlib.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Registers (longer names before their prefixes so AF' is matched before AF and IXH before IX)
+enum COND_REG
+{
+    COND_REG_AFDASH, COND_REG_BCDASH, COND_REG_DEDASH, COND_REG_HLDASH,
+    COND_REG_IXH, COND_REG_IXL, COND_REG_IYH, COND_REG_IYL,
+    COND_REG_AF, COND_REG_BC, COND_REG_DE, COND_REG_HL, COND_REG_IX, COND_REG_IY, COND_REG_SP, COND_REG_PC,
+    COND_REG_A, COND_REG_F, COND_REG_B, COND_REG_C, COND_REG_D, COND_REG_E, COND_REG_H, COND_REG_L,
+    COND_REG_I, COND_REG_R,
+    COND_REG_COUNT
+};
+static const char* _condRegNames[COND_REG_COUNT] = {
+    "AF'", "BC'", "DE'", "HL'",
+    "IXH", "IXL", "IYH", "IYL",
+    "AF", "BC", "DE", "HL", "IX", "IY", "SP", "PC",
+    "A", "F", "B", "C", "D", "E", "H", "L",
+    "I", "R"
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compiler
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Recursive descent over the precedence levels - only used when the condition is set
+class BreakpointCondCompiler
+{
+public:
+    BreakpointCondCompiler(const char* pExpr, uint8_t* pCode, int maxCodeLen, int maxDepth)
+    {
+        _pExpr = pExpr;
+        _pCode = pCode;
+        _maxCodeLen = maxCodeLen;
+        _maxDepth = maxDepth;
+        _codeLen = 0;
+        _depth = 0;
+        _ok = true;
+    }
+
+    int compile()
+    {
+        parseLevel(0);
+        skipSpaces();
+        if (*_pExpr != 0)
+            _ok = false;
+        return _ok ? _codeLen : 0;
+    }
+
+    // Binary operators by precedence level
+    struct BinaryOp
+    {
+        const char* pToken;
+        BreakpointCondition::COND_OP opcode;
+    };
+    static const int NUM_LEVELS = 8;
+    static const int MAX_OPS_PER_LEVEL = 4;
+    static const BinaryOp _binaryOps[NUM_LEVELS][MAX_OPS_PER_LEVEL];
+
+private:
+    const char* _pExpr;
+    uint8_t* _pCode;
+    int _maxCodeLen;
+    int _maxDepth;
+    int _codeLen;
+    int _depth;
+    bool _ok;
+
+    void skipSpaces()
+    {
+        while ((*_pExpr == ' ') || (*_pExpr == '\t'))
+            _pExpr++;
+    }
+
+    static bool isIdentChar(char ch)
+    {
+        return isalnum((unsigned char)ch) || (ch == '_') || (ch == '\'');
+    }
+
+    // Match a token (case-insensitive) - word tokens must not run into an identifier and
+    // single character operators must not be the start of a longer one
+    bool matchToken(const char* pToken)
+    {
+        skipSpaces();
+        int len = strlen(pToken);
+        if (strncasecmp(_pExpr, pToken, len) != 0)
+            return false;
+        char next = _pExpr[len];
+        if (isalpha((unsigned char)pToken[len-1]) && isIdentChar(next))
+            return false;
+        if ((len == 1) && (strchr("|&<>=", pToken[0]) != NULL) && (strchr("|&<>=", next) != NULL))
+            return false;
+        _pExpr += len;
+        return true;
+    }
+
+    void emit(int byteVal, int depthChange)
+    {
+        if (_codeLen >= _maxCodeLen)
+        {
+            _ok = false;
+            return;
+        }
+        _pCode[_codeLen++] = byteVal;
+        _depth += depthChange;
+        if (_depth > _maxDepth)
+            _ok = false;
+    }
+
+    void parseLevel(int level)
+    {
+        if (!_ok)
+            return;
+        if (level >= NUM_LEVELS)
+        {
+            parseUnary();
+            return;
+        }
+        parseLevel(level + 1);
+        while (_ok)
+        {
+            const BinaryOp* pOp = NULL;
+            for (int i = 0; i < MAX_OPS_PER_LEVEL; i++)
+            {
+                const BinaryOp& op = _binaryOps[level][i];
+                if (op.pToken && matchToken(op.pToken))
+                {
+                    pOp = &op;
+                    break;
+                }
+            }
+            if (!pOp)
+                break;
+            parseLevel(level + 1);
+            emit(pOp->opcode, -1);
+        }
+    }
+
+    void parseUnary()
+    {
+        if (matchToken("!") || matchToken("not"))
+        {
+            parseUnary();
+            emit(BreakpointCondition::COND_OP_NOT, 0);
+        }
+        else if (matchToken("~"))
+        {
+            parseUnary();
+            emit(BreakpointCondition::COND_OP_INV, 0);
+        }
+        else if (matchToken("-"))
+        {
+            parseUnary();
+            emit(BreakpointCondition::COND_OP_NEG, 0);
+        }
+        else
+        {
+            parsePrimary();
+        }
+    }
+
+    void parseMemRead(int opcode)
+    {
+        if (!matchToken("("))
+        {
+            _ok = false;
+            return;
+        }
+        parseLevel(0);
+        if (!matchToken(")"))
+            _ok = false;
+        emit(opcode, 0);
+    }
+
+    void parsePrimary()
+    {
+        skipSpaces();
+
+        // Memory reads and grouping
+        if (matchToken("b@") || matchToken("peek"))
+            return parseMemRead(BreakpointCondition::COND_OP_READ_BYTE);
+        if (matchToken("w@") || matchToken("peekw"))
+            return parseMemRead(BreakpointCondition::COND_OP_READ_WORD);
+        if (matchToken("("))
+        {
+            parseLevel(0);
+            if (!matchToken(")"))
+                _ok = false;
+            return;
+        }
+
+        // Hit count
+        if (matchToken("hits"))
+        {
+            emit(BreakpointCondition::COND_OP_PUSH_HITS, 1);
+            return;
+        }
+
+        // Numbers
+        if (isdigit((unsigned char)*_pExpr) || (*_pExpr == '$'))
+        {
+            const char* pNum = _pExpr;
+            int base = 10;
+            if (*pNum == '$')
+            {
+                pNum++;
+                base = 16;
+            }
+            else if ((pNum[0] == '0') && ((pNum[1] == 'x') || (pNum[1] == 'X')))
+            {
+                pNum += 2;
+                base = 16;
+            }
+            else
+            {
+                // Trailing h means hex
+                const char* pEnd = pNum;
+                while (isxdigit((unsigned char)*pEnd))
+                    pEnd++;
+                if ((*pEnd == 'h') || (*pEnd == 'H'))
+                    base = 16;
+            }
+            char* pEnd = NULL;
+            unsigned long val = strtoul(pNum, &pEnd, base);
+            if ((pEnd == pNum) || (val > 0xffff))
+            {
+                _ok = false;
+                return;
+            }
+            if ((base == 16) && ((*pEnd == 'h') || (*pEnd == 'H')))
+                pEnd++;
+            if (isIdentChar(*pEnd))
+            {
+                _ok = false;
+                return;
+            }
+            _pExpr = pEnd;
+            emit(BreakpointCondition::COND_OP_PUSH_CONST, 1);
+            emit(val & 0xff, 0);
+            emit((val >> 8) & 0xff, 0);
+            return;
+        }
+
+        // Registers
+        for (int regId = 0; regId < COND_REG_COUNT; regId++)
+        {
+            if (matchToken(_condRegNames[regId]))
+            {
+                emit(BreakpointCondition::COND_OP_PUSH_REG, 1);
+                emit(regId, 0);
+                return;
+            }
+        }
+        _ok = false;
+    }
+};
+
+// Unused entries have a NULL token
+const BreakpointCondCompiler::BinaryOp BreakpointCondCompiler::_binaryOps[NUM_LEVELS][MAX_OPS_PER_LEVEL] = {
+    { { "||", BreakpointCondition::COND_OP_OR }, { "or", BreakpointCondition::COND_OP_OR } },
+    { { "&&", BreakpointCondition::COND_OP_AND }, { "and", BreakpointCondition::COND_OP_AND } },
+    { { "|", BreakpointCondition::COND_OP_BIT_OR } },
+    { { "^", BreakpointCondition::COND_OP_BIT_XOR }, { "xor", BreakpointCondition::COND_OP_BIT_XOR } },
+    { { "&", BreakpointCondition::COND_OP_BIT_AND } },
+    { { "==", BreakpointCondition::COND_OP_EQ }, { "=", BreakpointCondition::COND_OP_EQ }, { "!=", BreakpointCondition::COND_OP_NE }, { "<>", BreakpointCondition::COND_OP_NE } },
+    { { "<=", BreakpointCondition::COND_OP_LE }, { ">=", BreakpointCondition::COND_OP_GE }, { "<", BreakpointCondition::COND_OP_LT }, { ">", BreakpointCondition::COND_OP_GT } },
+    { { "+", BreakpointCondition::COND_OP_ADD }, { "-", BreakpointCondition::COND_OP_SUB } }
+};
+
+bool BreakpointCondition::compile(const char* pExpr)
+{
+    clear();
+    if (!pExpr)
+        return true;
+    BreakpointCondCompiler compiler(pExpr, _code, MAX_CODE_LEN, MAX_STACK_DEPTH);
+    int codeLen = compiler.compile();
+    if (codeLen == 0)
+    {
+        // Empty expression is no condition
+        while ((*pExpr == ' ') || (*pExpr == '\t'))
+            pExpr++;
+        return *pExpr == 0;
+    }
+    _codeLen = codeLen;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Evaluate
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+uint32_t BreakpointCondition::getReg(const Z80Registers& regs, int regId)
+{
+    switch (regId)
+    {
+        case COND_REG_AFDASH: return regs.AFDASH & 0xffff;
+        case COND_REG_BCDASH: return regs.BCDASH & 0xffff;
+        case COND_REG_DEDASH: return regs.DEDASH & 0xffff;
+        case COND_REG_HLDASH: return regs.HLDASH & 0xffff;
+        case COND_REG_IXH: return (regs.IX >> 8) & 0xff;
+        case COND_REG_IXL: return regs.IX & 0xff;
+        case COND_REG_IYH: return (regs.IY >> 8) & 0xff;
+        case COND_REG_IYL: return regs.IY & 0xff;
+        case COND_REG_AF: return regs.AF & 0xffff;
+        case COND_REG_BC: return regs.BC & 0xffff;
+        case COND_REG_DE: return regs.DE & 0xffff;
+        case COND_REG_HL: return regs.HL & 0xffff;
+        case COND_REG_IX: return regs.IX & 0xffff;
+        case COND_REG_IY: return regs.IY & 0xffff;
+        case COND_REG_SP: return regs.SP & 0xffff;
+        case COND_REG_PC: return regs.PC & 0xffff;
+        case COND_REG_A: return (regs.AF >> 8) & 0xff;
+        case COND_REG_F: return regs.AF & 0xff;
+        case COND_REG_B: return (regs.BC >> 8) & 0xff;
+        case COND_REG_C: return regs.BC & 0xff;
+        case COND_REG_D: return (regs.DE >> 8) & 0xff;
+        case COND_REG_E: return regs.DE & 0xff;
+        case COND_REG_H: return (regs.HL >> 8) & 0xff;
+        case COND_REG_L: return regs.HL & 0xff;
+        case COND_REG_I: return regs.I & 0xff;
+        case COND_REG_R: return regs.R & 0xff;
+    }
+    return 0;
+}
+
+uint32_t BreakpointCondition::evaluateValue(const Z80Registers& regs, const uint8_t* pMemory, uint32_t hitCount) const
+{
+    if (_codeLen == 0)
+        return 0;
+
+    // Stack depth and operand counts were checked when compiling
+    uint32_t stack[MAX_STACK_DEPTH];
+    int sp = 0;
+    for (int pc = 0; pc < _codeLen; pc++)
+    {
+        uint32_t rhs = 0;
+        switch (_code[pc])
+        {
+            case COND_OP_PUSH_CONST:
+                stack[sp++] = _code[pc+1] | (_code[pc+2] << 8);
+                pc += 2;
+                continue;
+            case COND_OP_PUSH_REG:
+                stack[sp++] = getReg(regs, _code[++pc]);
+                continue;
+            case COND_OP_PUSH_HITS:
+                stack[sp++] = hitCount;
+                continue;
+            case COND_OP_READ_BYTE:
+                stack[sp-1] = pMemory ? pMemory[stack[sp-1] & 0xffff] : 0xff;
+                continue;
+            case COND_OP_READ_WORD:
+                stack[sp-1] = pMemory ? (pMemory[stack[sp-1] & 0xffff] | (pMemory[(stack[sp-1] + 1) & 0xffff] << 8)) : 0xffff;
+                continue;
+            case COND_OP_NOT: stack[sp-1] = !stack[sp-1]; continue;
+            case COND_OP_INV: stack[sp-1] = ~stack[sp-1] & 0xffff; continue;
+            case COND_OP_NEG: stack[sp-1] = -stack[sp-1] & 0xffff; continue;
+        }
+
+        // Binary operators
+        rhs = stack[--sp];
+        uint32_t& lhs = stack[sp-1];
+        switch (_code[pc])
+        {
+            case COND_OP_OR: lhs = lhs || rhs; break;
+            case COND_OP_AND: lhs = lhs && rhs; break;
+            case COND_OP_BIT_OR: lhs = lhs | rhs; break;
+            case COND_OP_BIT_XOR: lhs = lhs ^ rhs; break;
+            case COND_OP_BIT_AND: lhs = lhs & rhs; break;
+            case COND_OP_EQ: lhs = lhs == rhs; break;
+            case COND_OP_NE: lhs = lhs != rhs; break;
+            case COND_OP_LT: lhs = lhs < rhs; break;
+            case COND_OP_LE: lhs = lhs <= rhs; break;
+            case COND_OP_GT: lhs = lhs > rhs; break;
+            case COND_OP_GE: lhs = lhs >= rhs; break;
+            case COND_OP_ADD: lhs = (lhs + rhs) & 0xffff; break;
+            case COND_OP_SUB: lhs = (lhs - rhs) & 0xffff; break;
+        }
+    }
+    return (sp > 0) ? stack[sp-1] : 0;
+}
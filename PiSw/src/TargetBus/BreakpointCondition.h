@@ -0,0 +1,96 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "TargetRegisters.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Breakpoint condition
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// A condition such as "HL==4000h && b@(IX+3)==0xff" or "hits>=500" is compiled when it is set into
+// a stack bytecode with no branches. Evaluation is a single pass over at most MAX_CODE_LEN bytes
+// with a stack of MAX_STACK_DEPTH (checked when compiling) so it takes bounded time and doesn't allocate.
+//
+// Operands:
+//   numbers up to 0xffff - decimal, 0x1234, $1234 or 1234h (hex with the h suffix must start with a digit)
+//   registers - A F B C D E H L I R IXH IXL IYH IYL AF BC DE HL IX IY SP PC AF' BC' DE' HL'
+//   hits - number of times the breakpoint address has been reached (including this one)
+//   b@(expr) or peek(expr) - byte of memory, w@(expr) or peekw(expr) - little-endian word
+// Operators (lowest precedence first, C-style or ZEsarUX-style):
+//   || or, && and, |, ^, &, == = != <>, < <= > >=, + -, unary ! not ~ -
+
+class BreakpointCondition
+{
+public:
+    BreakpointCondition()
+    {
+        clear();
+    }
+    void clear()
+    {
+        _codeLen = 0;
+    }
+
+    // Compile - returns false (and clears the condition) if the expression is invalid
+    bool compile(const char* pExpr);
+
+    // Evaluate - an empty condition is always true, pMemory is the 64K target memory
+    // image (reads give 0xff if NULL)
+    bool evaluate(const Z80Registers& regs, const uint8_t* pMemory, uint32_t hitCount) const
+    {
+        return (_codeLen == 0) || (evaluateValue(regs, pMemory, hitCount) != 0);
+    }
+
+    // Evaluate as a value (e.g. an address) - an empty expression gives 0
+    uint32_t evaluateValue(const Z80Registers& regs, const uint8_t* pMemory, uint32_t hitCount) const;
+
+    bool isSet() const
+    {
+        return _codeLen != 0;
+    }
+
+    // Limits
+    static const int MAX_CODE_LEN = 48;
+    static const int MAX_STACK_DEPTH = 12;
+
+private:
+    friend class BreakpointCondCompiler;
+
+    // Opcodes - PUSH_CONST is followed by a 16-bit little-endian value and PUSH_REG by a register id
+    enum COND_OP
+    {
+        COND_OP_PUSH_CONST,
+        COND_OP_PUSH_REG,
+        COND_OP_PUSH_HITS,
+        COND_OP_READ_BYTE,
+        COND_OP_READ_WORD,
+        COND_OP_NOT,
+        COND_OP_INV,
+        COND_OP_NEG,
+        COND_OP_OR,
+        COND_OP_AND,
+        COND_OP_BIT_OR,
+        COND_OP_BIT_XOR,
+        COND_OP_BIT_AND,
+        COND_OP_EQ,
+        COND_OP_NE,
+        COND_OP_LT,
+        COND_OP_LE,
+        COND_OP_GT,
+        COND_OP_GE,
+        COND_OP_ADD,
+        COND_OP_SUB
+    };
+
+    // Bytecode
+    uint8_t _codeLen;
+    uint8_t _code[MAX_CODE_LEN];
+
+    // Register read
+    static uint32_t getReg(const Z80Registers& regs, int regId);
+};
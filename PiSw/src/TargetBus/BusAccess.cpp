@@ -30,6 +30,14 @@ int BusAccess::_hwVersionNumber = HW_VERSION_DEFAULT;
 BusSocketInfo BusAccess::_busSockets[MAX_BUS_SOCKETS];
 int BusAccess::_busSocketCount = 0;
 
+// Bus socket dispatch lists by bus cycle type
+BusAccess::BusSocketDispatch BusAccess::_busSocketDispatch[BUS_CYCLE_TYPE_COUNT][MAX_BUS_SOCKETS];
+int BusAccess::_busSocketDispatchCount[BUS_CYCLE_TYPE_COUNT];
+
+// IO port handlers by low byte of port address
+BusAccess::BusIOPortHandler BusAccess::_ioPortHandlers[NUM_IO_PORTS][MAX_HANDLERS_PER_IO_PORT];
+volatile int BusAccess::_ioPortHandlerCount[NUM_IO_PORTS];
+
 // Bus service enabled - can be disabled to allow external API to completely control bus
 bool BusAccess::_busServiceEnabled = true;
 
@@ -43,6 +51,7 @@ bool volatile BusAccess::_waitAsserted = false;
 // Rate at which wait is released when free-cycling
 volatile uint32_t BusAccess::_waitCycleLengthUs = 1;
 volatile uint32_t BusAccess::_waitAssertedStartUs = 0;
+volatile uint32_t BusAccess::_waitAssertedStartCycles = 0;
 
 // Held in wait state
 volatile bool BusAccess::_waitHold = false;
@@ -54,6 +63,7 @@ volatile bool BusAccess::_waitSuspendBusDetailOneCycle = false;
 volatile int BusAccess::_busActionSocket = 0;
 volatile BR_BUS_ACTION BusAccess::_busActionType = BR_BUS_ACTION_NONE;
 volatile uint32_t BusAccess::_busActionInProgressStartUs = 0;
+volatile uint32_t BusAccess::_busMasterRequestUs[MAX_BUS_SOCKETS];
 volatile uint32_t BusAccess::_busActionAssertedStartUs = 0;
 volatile uint32_t BusAccess::_busActionAssertedMaxUs = 0;
 volatile BusAccess::BUS_ACTION_STATE BusAccess::_busActionState = BUS_ACTION_STATE_NONE;
@@ -82,6 +92,9 @@ void BusAccess::init()
     clockSetup();
     clockSetFreqHz(1000000);
     clockEnable(true);
+
+    // Cycle counter used for latency stats
+    lowlev_cycleCounterEnable();
     
     // Pins that are not setup here as outputs will be inputs
     // This includes the "bus" used for address-low/high and data (referred to as the PIB)
@@ -222,6 +235,9 @@ void BusAccess::waitSetCycleUs(uint32_t cycleUs)
 void BusAccess::waitRelease()
 {
     // LogWrite("BusAccess", LOG_DEBUG, "waitRelease");
+    // Time wait was held
+    if (_waitAsserted)
+        _statusInfo.waitHist.add(lowlev_cycleCounterRead() - _waitAssertedStartCycles);
     waitResetFlipFlops();
     // Handle release after a read
     waitHandleReadRelease();
@@ -300,8 +316,11 @@ void BusAccess::targetReqBus(int busSocket, BR_BUS_ACTION_REASON busMasterReason
         LogWrite("BA", LOG_DEBUG, "targetReqBus sock %d invalid count = %d", busSocket, _busSocketCount);
         return;
     }
-    _busSockets[busSocket].busMasterRequest = true;
+    // Time of request (kept from the first request if one is already queued)
+    if (!_busSockets[busSocket].busMasterRequest)
+        _busMasterRequestUs[busSocket] = micros();
     _busSockets[busSocket].busMasterReason = busMasterReason;
+    _busSockets[busSocket].busMasterRequest = true;
 
     // Bus request can be handled immediately as the BUSRQ line is not part of the multiplexer (so is not affected by WAIT processing)
     busActionCheck();
@@ -384,14 +403,24 @@ void BusAccess::busActionCheck()
     if (_busActionState != BUS_ACTION_STATE_NONE)
         return;
 
-    // See if anything to do
+    // Find the highest priority action pending on any socket - RESET, NMI and IRQ are
+    // short so go ahead of BUSRQ - requests of the same type from other sockets are
+    // handled along with this one
+    static const BR_BUS_ACTION actionPriority[] = {
+        BR_BUS_ACTION_RESET, BR_BUS_ACTION_NMI, BR_BUS_ACTION_IRQ, BR_BUS_ACTION_BUSRQ
+    };
     int busSocket = -1;
-    for (int i = 0; i < _busSocketCount; i++)
+    BR_BUS_ACTION busActionType = BR_BUS_ACTION_NONE;
+    for (uint32_t prio = 0; (prio < sizeof(actionPriority) / sizeof(actionPriority[0])) && (busSocket < 0); prio++)
     {
-        if (_busSockets[i].enabled && (_busSockets[i].getType() != BR_BUS_ACTION_NONE))
+        for (int i = 0; i < _busSocketCount; i++)
         {
-            busSocket = i;
-            break;
+            if (_busSockets[i].enabled && _busSockets[i].isPending(actionPriority[prio]))
+            {
+                busSocket = i;
+                busActionType = actionPriority[prio];
+                break;
+            }
         }
     }
     if (busSocket < 0)
@@ -399,7 +428,7 @@ void BusAccess::busActionCheck()
 
     // Set this new action as in progress
     _busActionSocket = busSocket;
-    _busActionType = _busSockets[busSocket].getType();
+    _busActionType = busActionType;
     _busActionState = BUS_ACTION_STATE_PENDING;
     _busActionInProgressStartUs = micros();
 }
@@ -534,12 +563,8 @@ void BusAccess::busActionHandleActive()
             // Take control of bus
             controlTake();
 
-            // Clear the action now so that any new action raised by the callback
-            // such as a reset, etc can be asserted before BUSRQ is released
-            busActionClearFlags();
-
-            // Callback
-            busActionCallback(BR_BUS_ACTION_BUSRQ, _busSockets[_busActionSocket].busMasterReason);
+            // Callbacks for all sockets' requests while the bus is held
+            busActionBusRqCallbacks(BR_BUS_ACTION_BUSRQ);
 
             // Release bus
             controlRelease();
@@ -550,9 +575,8 @@ void BusAccess::busActionHandleActive()
             if (isTimeout(micros(), _busActionAssertedStartUs, _busActionAssertedMaxUs))
             {
                 // For bus requests a timeout means failure
-                busActionCallback(BR_BUS_ACTION_BUSRQ_FAIL, _busSockets[_busActionSocket].busMasterReason);
                 setSignal(BR_BUS_ACTION_BUSRQ, false);
-                busActionClearFlags();
+                busActionBusRqCallbacks(BR_BUS_ACTION_BUSRQ_FAIL);
             }
         }
 
@@ -584,6 +608,61 @@ void BusAccess::busActionClearFlags()
     _busActionState = BUS_ACTION_STATE_NONE;
 }
 
+// Bus requests from all sockets are merged into one bus grant (or failure) - each reason
+// requested is then reported once (in priority order) - queueing delay is only recorded
+// for a grant, failures are counted separately
+void BusAccess::busActionBusRqCallbacks(BR_BUS_ACTION busActionType)
+{
+    static const BR_BUS_ACTION_REASON reasonPriority[] = {
+        BR_BUS_ACTION_HW_ACTION, BR_BUS_ACTION_PROGRAMMING, BR_BUS_ACTION_MIRROR,
+        BR_BUS_ACTION_GENERAL, BR_BUS_ACTION_DISPLAY
+    };
+
+    // Gather requested reasons
+    uint32_t reasonMask = 0;
+    uint32_t nowUs = micros();
+    int numRequests = 0;
+    for (int i = 0; i < _busSocketCount; i++)
+    {
+        if (!_busSockets[i].enabled || !_busSockets[i].busMasterRequest)
+            continue;
+        int reason = _busSockets[i].busMasterReason;
+        reasonMask |= 1 << reason;
+        numRequests++;
+        if (reason >= BusAccessStatusInfo::NUM_BUSRQ_REASONS)
+            continue;
+        if (busActionType == BR_BUS_ACTION_BUSRQ_FAIL)
+        {
+            _statusInfo.busRqReasonFailCount[reason]++;
+            continue;
+        }
+        uint32_t delayUs = nowUs - _busMasterRequestUs[i];
+        _statusInfo.busRqReasonCount[reason]++;
+        _statusInfo.busRqReasonDelayAccumUs[reason] += delayUs;
+        if (_statusInfo.busRqReasonDelayMaxUs[reason] < delayUs)
+            _statusInfo.busRqReasonDelayMaxUs[reason] = delayUs;
+    }
+    if (busActionType == BR_BUS_ACTION_BUSRQ_FAIL)
+        _statusInfo.busrqFailCount++;
+    else if (numRequests > 1)
+        _statusInfo.busRqCoalesced += numRequests - 1;
+
+    // Programming callbacks are followed by mirror callbacks anyway
+    if (reasonMask & (1 << BR_BUS_ACTION_PROGRAMMING))
+        reasonMask &= ~(1 << BR_BUS_ACTION_MIRROR);
+
+    // Clear the action now so that any new action raised by the callbacks
+    // such as a reset, etc can be asserted before BUSRQ is released
+    busActionClearFlags();
+
+    // Callbacks
+    for (uint32_t i = 0; i < sizeof(reasonPriority) / sizeof(reasonPriority[0]); i++)
+    {
+        if (reasonMask & (1 << reasonPriority[i]))
+            busActionCallback(busActionType, reasonPriority[i]);
+    }
+}
+
 void BusAccess::busActionCallback(BR_BUS_ACTION busActionType, BR_BUS_ACTION_REASON reason)
 {
     for (int i = 0; i < _busSocketCount; i++)
@@ -651,6 +730,7 @@ void BusAccess::serviceWaitActivity()
         {
             // Record the time of the wait start
             _waitAssertedStartUs = micros();
+            _waitAssertedStartCycles = lowlev_cycleCounterRead();
             _waitAsserted = true;
 
             // Handle the wait
@@ -739,9 +819,19 @@ void BusAccess::waitHandleReadRelease()
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 void BusAccess::waitHandleNew()
+{
+    // Resolve the hardware version once per wait so the bus reads are specialised
+    if (_hwVersionNumber == 17)
+        waitHandleNewT<HW_VARIANT_V17>();
+    else
+        waitHandleNewT<HW_VARIANT_V20_BUILD>();
+}
+
+template<int HW> void BusAccess::waitHandleNewT()
 {
     // Time at start of ISR
     uint32_t isrStartUs = micros();
+    uint32_t isrStartCycles = lowlev_cycleCounterRead();
 
     uint32_t addr = 0;
     uint32_t dataBusVals = 0;
@@ -754,10 +844,11 @@ void BusAccess::waitHandleNew()
     }
 
     // Read control lines
-    uint32_t ctrlBusVals = controlBusRead();
+    uint32_t ctrlBusVals = controlBusReadT<HW>();
     
     // Check if bus detail is suspended for one cycle
-    if (_waitSuspendBusDetailOneCycle)
+    bool busDetailSuspended = _waitSuspendBusDetailOneCycle;
+    if (busDetailSuspended)
     {
             //         digitalWrite(BR_DEBUG_PI_SPI0_CE0, 1);
             // lowlev_cycleDelay(20);
@@ -773,22 +864,35 @@ void BusAccess::waitHandleNew()
             // pinMode(BR_MREQ_BAR, INPUT);
             // pinMode(BR_IORQ_BAR, INPUT);
 
-        addrAndDataBusRead(addr, dataBusVals);
+        addrAndDataBusReadT<HW>(addr, dataBusVals);
     }
 
-    // Send this to all bus sockets
+    // IO cycles go to the handlers registered for the port (the address isn't known
+    // if bus detail was suspended)
     uint32_t retVal = BR_MEM_ACCESS_RSLT_NOT_DECODED;
-    for (int sockIdx = 0; sockIdx < _busSocketCount; sockIdx++)
+    BUS_CYCLE_TYPE cycleType = busDetailSuspended ? BUS_CYCLE_OTHER : busCycleType(ctrlBusVals);
+    if ((cycleType == BUS_CYCLE_IORQ_RD) || (cycleType == BUS_CYCLE_IORQ_WR))
+    {
+        uint32_t cycleMask = (cycleType == BUS_CYCLE_IORQ_RD) ? BR_BUS_CYCLE_IORQ_RD_MASK : BR_BUS_CYCLE_IORQ_WR_MASK;
+        const BusIOPortHandler* pPortHandlers = _ioPortHandlers[addr & 0xff];
+        for (int hIdx = 0; hIdx < _ioPortHandlerCount[addr & 0xff]; hIdx++)
+        {
+            if ((pPortHandlers[hIdx].busCycleMask & cycleMask) && ((addr & pPortHandlers[hIdx].addrMask) == pPortHandlers[hIdx].addrMatch))
+                pPortHandlers[hIdx].pHandler(pPortHandlers[hIdx].pParam, addr, dataBusVals, ctrlBusVals, retVal);
+        }
+    }
+
+    // Send this to the bus sockets interested in this type of cycle - if bus detail
+    // was suspended the cycle type is unknown so send to all sockets
+    const BusSocketDispatch* pDispatch = _busSocketDispatch[cycleType];
+    for (int dispIdx = 0; dispIdx < _busSocketDispatchCount[cycleType]; dispIdx++)
     {
-        if (_busSockets[sockIdx].enabled && _busSockets[sockIdx].busAccessCallback)
+        // Address range check (unsigned wrap means addresses below the start fail)
+        if ((addr - pDispatch[dispIdx].addrRangeStart) < pDispatch[dispIdx].addrRangeLen)
         {
-            _busSockets[sockIdx].busAccessCallback(addr, dataBusVals, ctrlBusVals, retVal);
-            // TODO
-            // if (ctrlBusVals & BR_CTRL_BUS_IORQ_MASK)
-            //     LogWrite("BA", LOG_DEBUG, "%d IORQ %s from %04x %02x", sockIdx,
-            //             (ctrlBusVals & BR_CTRL_BUS_RD_MASK) ? "RD" : ((ctrlBusVals & BR_CTRL_BUS_WR_MASK) ? "WR" : "??"),
-            //             addr, 
-            //             (ctrlBusVals & BR_CTRL_BUS_WR_MASK) ? dataBusVals : retVal);
+            uint32_t sockStartCycles = lowlev_cycleCounterRead();
+            pDispatch[dispIdx].busAccessCallback(addr, dataBusVals, ctrlBusVals, retVal);
+            _statusInfo.sockHist[pDispatch[dispIdx].busSocket].add(lowlev_cycleCounterRead() - sockStartCycles);
         }
     }
 
@@ -876,7 +980,7 @@ void BusAccess::waitHandleNew()
         // Currently this looks like it might not be the case
         // if _waitSuspendBusDetailOneCycle
         if (_waitSuspendBusDetailOneCycle)
-            muxDataBusOutputEnable();
+            muxDataBusOutputEnableT<HW>();
 
 
         // Set data direction out on the data bus driver
@@ -924,6 +1028,7 @@ void BusAccess::waitHandleNew()
 
     // Elapsed and count
     uint32_t isrElapsedUs = micros() - isrStartUs;
+    _statusInfo.isrHist.add(lowlev_cycleCounterRead() - isrStartCycles);
     _statusInfo.isrCount++;
 
     // Stats
@@ -974,6 +1079,22 @@ const char* BusAccessStatusInfo::getJson()
     ee_sprintf(tmpResp, ",\"mreqRd\":%u,\"mreqWr\":%u,\"iorqRd\":%u,\"iorqWr\":%u,\"irqAck\":%u,\"isrBadBusrq\":%u,\"irqDuringBusAck\":%u,\"irqNoWait\":%u",
                 isrMREQRD, isrMREQWR, isrIORQRD, isrIORQWR, isrIRQACK, isrSpuriousBUSRQ, isrDuringBUSACK, isrWithoutWAIT);
     strlcat(_jsonBuf, tmpResp, MAX_JSON_LEN);
+    ee_sprintf(tmpResp, ",\"blockRdKBps\":%u,\"blockWrKBps\":%u", blockReadKBps, blockWriteKBps);
+    strlcat(_jsonBuf, tmpResp, MAX_JSON_LEN);
+    static const char* busRqReasonNames[NUM_BUSRQ_REASONS] = { "disp", "mirror", "prog", "hw", "gen" };
+    ee_sprintf(tmpResp, ",\"busRqCoalesced\":%u,\"busRqDelay\":{", busRqCoalesced);
+    strlcat(_jsonBuf, tmpResp, MAX_JSON_LEN);
+    for (int i = 0; i < NUM_BUSRQ_REASONS; i++)
+    {
+        ee_sprintf(tmpResp, "%s\"%s\":{\"n\":%u,\"avgUs\":%u,\"maxUs\":%u,\"fail\":%u}", (i == 0) ? "" : ",",
+                    busRqReasonNames[i], busRqReasonCount[i],
+                    (busRqReasonCount[i] == 0) ? 0 : busRqReasonDelayAccumUs[i] / busRqReasonCount[i],
+                    busRqReasonDelayMaxUs[i], busRqReasonFailCount[i]);
+        strlcat(_jsonBuf, tmpResp, MAX_JSON_LEN);
+    }
+    strlcat(_jsonBuf, "}", MAX_JSON_LEN);
+    strlcat(_jsonBuf, ",\"isrHist\":", MAX_JSON_LEN);
+    isrHist.getJson(_jsonBuf, MAX_JSON_LEN);
 
 #ifdef DEBUG_IORQ_PROCESSING
     ee_sprintf(_jsonBuf, "");
@@ -1002,3 +1123,41 @@ const char* BusAccessStatusInfo::getJson()
 
     return _jsonBuf;
 }
+
+char BusAccessStatusInfo::_latencyJsonBuf[MAX_LATENCY_JSON_LEN];
+const char* BusAccessStatusInfo::getLatencyJson()
+{
+    char tmpResp[100];
+    ee_sprintf(_latencyJsonBuf, "\"err\":\"ok\",\"buckets\":\"log2cycles\",\"wait\":");
+    waitHist.getJson(_latencyJsonBuf, MAX_LATENCY_JSON_LEN);
+    strlcat(_latencyJsonBuf, ",\"isr\":", MAX_LATENCY_JSON_LEN);
+    isrHist.getJson(_latencyJsonBuf, MAX_LATENCY_JSON_LEN);
+    strlcat(_latencyJsonBuf, ",\"sockets\":[", MAX_LATENCY_JSON_LEN);
+    bool firstSock = true;
+    for (int i = 0; i < BR_MAX_BUS_SOCKETS; i++)
+    {
+        // Only sockets which have been called
+        if (sockHist[i].total() == 0)
+            continue;
+        ee_sprintf(tmpResp, "%s{\"idx\":%d,\"name\":\"%s\",\"hist\":", firstSock ? "" : ",",
+                    i, sockNames[i] ? sockNames[i] : "");
+        strlcat(_latencyJsonBuf, tmpResp, MAX_LATENCY_JSON_LEN);
+        sockHist[i].getJson(_latencyJsonBuf, MAX_LATENCY_JSON_LEN);
+        strlcat(_latencyJsonBuf, "}", MAX_LATENCY_JSON_LEN);
+        firstSock = false;
+    }
+    strlcat(_latencyJsonBuf, "]", MAX_LATENCY_JSON_LEN);
+    return _latencyJsonBuf;
+}
+
+void BusLatencyHistogram::getJson(char* pBuf, int maxLen)
+{
+    char tmpResp[20];
+    strlcat(pBuf, "[", maxLen);
+    for (int i = 0; i < NUM_BUCKETS; i++)
+    {
+        ee_sprintf(tmpResp, (i == 0) ? "%u" : ",%u", counts[i]);
+        strlcat(pBuf, tmpResp, maxLen);
+    }
+    strlcat(pBuf, "]", maxLen);
+}
@@ -131,6 +131,19 @@
 // Clock frequency for debug
 #define BR_TARGET_DEBUG_CLOCK_HZ 500000
 
+// Max bus sockets
+#define BR_MAX_BUS_SOCKETS 10
+
+// Bus cycle types a bus socket can register interest in
+// MREQ_RD includes opcode fetches whereas M1 selects only opcode fetches
+#define BR_BUS_CYCLE_ALL 0
+#define BR_BUS_CYCLE_MREQ_RD_MASK (1 << 0)
+#define BR_BUS_CYCLE_MREQ_WR_MASK (1 << 1)
+#define BR_BUS_CYCLE_IORQ_RD_MASK (1 << 2)
+#define BR_BUS_CYCLE_IORQ_WR_MASK (1 << 3)
+#define BR_BUS_CYCLE_M1_MASK (1 << 4)
+#define BR_BUS_CYCLE_IRQ_ACK_MASK (1 << 5)
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Callback types
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -138,6 +151,7 @@
 // Callback types
 typedef void BusAccessCBFnType(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& curRetVal);
 typedef void BusActionCBFnType(BR_BUS_ACTION actionType, BR_BUS_ACTION_REASON reason);
+typedef void BusIOPortCBFnType(void* pParam, uint32_t addr, uint32_t data, uint32_t flags, uint32_t& curRetVal);
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Bus Socket Info - this is used to plug-in to the BusAccess layer
@@ -172,6 +186,29 @@ public:
     // Bus hold in wait
     volatile bool holdInWaitReq;
 
+    // Bus cycles passed to busAccessCallback - mask of BR_BUS_CYCLE_XXX (BR_BUS_CYCLE_ALL if not set)
+    // and optional address range (a length of 0 means all addresses)
+    uint32_t busCycleMask;
+    uint32_t addrRangeStart;
+    uint32_t addrRangeLen;
+
+    // Name (used in latency stats)
+    const char* pName;
+
+    // Check if a bus action is pending
+    bool isPending(BR_BUS_ACTION type)
+    {
+        if (type == BR_BUS_ACTION_BUSRQ)
+            return busMasterRequest;
+        if (type == BR_BUS_ACTION_RESET)
+            return resetPending;
+        if (type == BR_BUS_ACTION_NMI)
+            return nmiPending;
+        if (type == BR_BUS_ACTION_IRQ)
+            return irqPending;
+        return false;
+    }
+
     // Get type of bus action
     BR_BUS_ACTION getType()
     {
@@ -222,6 +259,63 @@ public:
     }
 };
 
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bus transfer segment - used for scatter-gather access under a single bus request
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class BusXfer
+{
+public:
+    // Target address (or IO port)
+    uint32_t addr;
+
+    // Data - only read from for writes
+    uint8_t* pData;
+    uint32_t len;
+
+    // Type of access
+    bool write;
+    bool iorq;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Latency histogram - log2 buckets of cycle counter ticks
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class BusLatencyHistogram
+{
+public:
+    // Bucket N holds values with N significant bits (2^(N-1) to 2^N-1) and the last
+    // bucket also holds all larger values
+    static const int NUM_BUCKETS = 24;
+    uint32_t counts[NUM_BUCKETS];
+
+    void clear()
+    {
+        for (int i = 0; i < NUM_BUCKETS; i++)
+            counts[i] = 0;
+    }
+
+    void add(uint32_t val)
+    {
+        int bucket = (val == 0) ? 0 : 32 - __builtin_clz(val);
+        if (bucket >= NUM_BUCKETS)
+            bucket = NUM_BUCKETS - 1;
+        counts[bucket]++;
+    }
+
+    uint32_t total()
+    {
+        uint32_t tot = 0;
+        for (int i = 0; i < NUM_BUCKETS; i++)
+            tot += counts[i];
+        return tot;
+    }
+
+    // Append as JSON array
+    void getJson(char* pBuf, int maxLen);
+};
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Status Info
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -249,12 +343,29 @@ public:
         clrAvgNs = 0;
         clrMaxUs = 0;
         busrqFailCount = 0;
+        blockReadKBps = 0;
+        blockWriteKBps = 0;
+        busRqCoalesced = 0;
+        for (int i = 0; i < NUM_BUSRQ_REASONS; i++)
+        {
+            busRqReasonCount[i] = 0;
+            busRqReasonDelayAccumUs[i] = 0;
+            busRqReasonDelayMaxUs[i] = 0;
+            busRqReasonFailCount[i] = 0;
+        }
         busActionFailedDueToWait = 0;
         isrMREQRD = 0;
         isrMREQWR = 0;
         isrIORQRD = 0;
         isrIORQWR = 0;
         isrIRQACK = 0;
+        waitHist.clear();
+        isrHist.clear();
+        for (int i = 0; i < BR_MAX_BUS_SOCKETS; i++)
+        {
+            sockHist[i].clear();
+            sockNames[i] = NULL;
+        }
 #ifdef DEBUG_IORQ_PROCESSING
         _debugIORQNum = 0;
         _debugIORQClrMicros = 0;
@@ -265,10 +376,15 @@ public:
 #endif
     }
 
-    static const int MAX_JSON_LEN = 30 * 20;
+    static const int MAX_JSON_LEN = 30 * 40;
     static char _jsonBuf[MAX_JSON_LEN];
     const char* getJson();
 
+    // Latency histograms for wait and each bus socket
+    static const int MAX_LATENCY_JSON_LEN = 4000;
+    static char _latencyJsonBuf[MAX_LATENCY_JSON_LEN];
+    const char* getLatencyJson();
+
     // Overall ISR
     uint32_t isrCount;
 
@@ -288,6 +404,13 @@ public:
     uint32_t isrIORQWR;
     uint32_t isrIRQACK;
 
+    // Latency histograms (cycle counter ticks) of the time wait is held (assert to release),
+    // the wait handler and each socket callback
+    BusLatencyHistogram waitHist;
+    BusLatencyHistogram isrHist;
+    BusLatencyHistogram sockHist[BR_MAX_BUS_SOCKETS];
+    const char* sockNames[BR_MAX_BUS_SOCKETS];
+
     // Clear pulse edge width
     uint32_t clrAccumUs;
     int clrAvgingCount;
@@ -297,6 +420,19 @@ public:
     // BUSRQ
     uint32_t busrqFailCount;
 
+    // Bus requests - number merged into another socket's bus grant, the delay from
+    // request to grant for each reason and the number of requests that timed out
+    static const int NUM_BUSRQ_REASONS = BR_BUS_ACTION_GENERAL + 1;
+    uint32_t busRqCoalesced;
+    uint32_t busRqReasonCount[NUM_BUSRQ_REASONS];
+    uint32_t busRqReasonDelayAccumUs[NUM_BUSRQ_REASONS];
+    uint32_t busRqReasonDelayMaxUs[NUM_BUSRQ_REASONS];
+    uint32_t busRqReasonFailCount[NUM_BUSRQ_REASONS];
+
+    // Block transfer rate of most recent burst transfers
+    uint32_t blockReadKBps;
+    uint32_t blockWriteKBps;
+
     // Bus actions
     uint32_t busActionFailedDueToWait;
 
@@ -352,6 +488,13 @@ public:
     static void busSocketEnable(int busSocket, bool enable);
     static bool busSocketIsEnabled(int busSocket);
 
+    // IO port handlers - called for IORQ read/write cycles (as selected by busCycleMask) when
+    // (addr & addrMask) == addrMatch - the low byte selects entries in a 256 entry table indexed
+    // by port and any high address bits (e.g. for full 16-bit decoding) are checked on each call
+    static bool ioPortHandlerAdd(uint32_t addrMask, uint32_t addrMatch, uint32_t busCycleMask,
+                BusIOPortCBFnType* pHandler, void* pParam);
+    static void ioPortHandlerRemove(BusIOPortCBFnType* pHandler, void* pParam);
+
     // Wait state enablement
     static void waitOnMemory(int busSocket, bool isOn);
     static void waitOnIO(int busSocket, bool isOn);
@@ -373,6 +516,11 @@ public:
     // Read and write blocks
     static BR_RETURN_TYPE blockWrite(uint32_t addr, const uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq);
     static BR_RETURN_TYPE blockRead(uint32_t addr, uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq);
+    static BR_RETURN_TYPE blockAccessVector(const BusXfer* pXfers, int numXfers, bool busRqAndRelease,
+                    BR_RETURN_TYPE* pXferResults = NULL);
+
+    // Block transfers at least this long use the burst engine
+    static const uint32_t MIN_LEN_FOR_BLOCK_BURST = 16;
 
     // Wait hold and release
     static void waitRelease();
@@ -463,10 +611,46 @@ private:
     static int _hwVersionNumber;
     
     // Bus Sockets
-    static const int MAX_BUS_SOCKETS = 10;
+    static const int MAX_BUS_SOCKETS = BR_MAX_BUS_SOCKETS;
     static BusSocketInfo _busSockets[MAX_BUS_SOCKETS];
     static int _busSocketCount;
 
+    // Bus socket dispatch lists - one per bus cycle type - rebuilt when sockets are added/enabled
+    enum BUS_CYCLE_TYPE
+    {
+        BUS_CYCLE_MREQ_RD,
+        BUS_CYCLE_MREQ_WR,
+        BUS_CYCLE_IORQ_RD,
+        BUS_CYCLE_IORQ_WR,
+        BUS_CYCLE_M1,
+        BUS_CYCLE_IRQ_ACK,
+        BUS_CYCLE_OTHER,
+        BUS_CYCLE_TYPE_COUNT
+    };
+    struct BusSocketDispatch
+    {
+        BusAccessCBFnType* busAccessCallback;
+        int busSocket;
+        uint32_t addrRangeStart;
+        uint32_t addrRangeLen;
+    };
+    static BusSocketDispatch _busSocketDispatch[BUS_CYCLE_TYPE_COUNT][MAX_BUS_SOCKETS];
+    static int _busSocketDispatchCount[BUS_CYCLE_TYPE_COUNT];
+
+    // IO port handler table - indexed by low byte of port address
+    static const int NUM_IO_PORTS = 256;
+    static const int MAX_HANDLERS_PER_IO_PORT = 4;
+    struct BusIOPortHandler
+    {
+        BusIOPortCBFnType* pHandler;
+        void* pParam;
+        uint32_t addrMask;
+        uint32_t addrMatch;
+        uint32_t busCycleMask;
+    };
+    static BusIOPortHandler _ioPortHandlers[NUM_IO_PORTS][MAX_HANDLERS_PER_IO_PORT];
+    static volatile int _ioPortHandlerCount[NUM_IO_PORTS];
+
     // Bus service active
     static bool _busServiceEnabled;
 
@@ -486,6 +670,7 @@ private:
     // Rate at which wait is released when free-cycling
     static volatile uint32_t _waitCycleLengthUs;
     static volatile uint32_t _waitAssertedStartUs;
+    static volatile uint32_t _waitAssertedStartCycles;
 
     // Hold in wait state
     static volatile bool _waitHold;
@@ -497,6 +682,7 @@ private:
     static volatile int _busActionSocket;
     static volatile BR_BUS_ACTION _busActionType;
     static volatile uint32_t _busActionInProgressStartUs;
+    static volatile uint32_t _busMasterRequestUs[MAX_BUS_SOCKETS];
     static volatile uint32_t _busActionAssertedStartUs;
     static volatile uint32_t _busActionAssertedMaxUs;
     static volatile bool _busActionSyncWithWait;
@@ -524,11 +710,37 @@ private:
     static BusAccessStatusInfo _statusInfo; 
 
 private:
+    // Bus socket dispatch
+    static void busSocketDispatchUpdate();
+    static inline BUS_CYCLE_TYPE busCycleType(uint32_t ctrlBusVals)
+    {
+        if (ctrlBusVals & BR_CTRL_BUS_MREQ_MASK)
+        {
+            if (ctrlBusVals & BR_CTRL_BUS_M1_MASK)
+                return BUS_CYCLE_M1;
+            if (ctrlBusVals & BR_CTRL_BUS_RD_MASK)
+                return BUS_CYCLE_MREQ_RD;
+            if (ctrlBusVals & BR_CTRL_BUS_WR_MASK)
+                return BUS_CYCLE_MREQ_WR;
+        }
+        else if (ctrlBusVals & BR_CTRL_BUS_IORQ_MASK)
+        {
+            if (ctrlBusVals & BR_CTRL_BUS_M1_MASK)
+                return BUS_CYCLE_IRQ_ACK;
+            if (ctrlBusVals & BR_CTRL_BUS_RD_MASK)
+                return BUS_CYCLE_IORQ_RD;
+            if (ctrlBusVals & BR_CTRL_BUS_WR_MASK)
+                return BUS_CYCLE_IORQ_WR;
+        }
+        return BUS_CYCLE_OTHER;
+    }
+
     // Bus actions
     static void busActionCheck();
     static bool busActionHandleStart();
     static void busActionHandleActive();
     static void busActionClearFlags();
+    static void busActionBusRqCallbacks(BR_BUS_ACTION busActionType);
     static void busActionCallback(BR_BUS_ACTION busActionType, BR_BUS_ACTION_REASON reason);
     static bool busAccessHandleIrqAck();
 
@@ -537,10 +749,16 @@ private:
     static void addrLowInc();
     static void addrHighSet(uint32_t highAddrByte);
     static void addrSet(unsigned int addr);
+    template<int HW> static void addrLowSetT(uint32_t lowAddrByte);
+    template<int HW> static void addrLowIncT();
+    template<int HW> static void addrHighSetT(uint32_t highAddrByte);
+    template<int HW> static void addrSetT(unsigned int addr);
 
     // Control bus read
     static uint32_t controlBusRead();
     static void addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals);
+    template<int HW> static uint32_t controlBusReadT();
+    template<int HW> static void addrAndDataBusReadT(uint32_t& addr, uint32_t& dataBusVals);
 
     // Control the PIB (bus used to transfer data to/from Pi)
     static inline void pibSetOut()
@@ -587,19 +805,29 @@ private:
     static void setPinOut(int pinNumber, bool val);
     static void setPinIn(int pinNumber);
 
+    // Hardware variants - the low-level bus primitives are templated on these so that the
+    // hardware version is checked once per block transfer or wait rather than on every access
+    static const int HW_VARIANT_V17 = 0;
+    static const int HW_VARIANT_V20 = 1;
+    static const int HW_VARIANT_V20_MUX_EN = 2;
+#ifdef V2_PROTO_USING_MUX_EN
+    static const int HW_VARIANT_V20_BUILD = HW_VARIANT_V20_MUX_EN;
+#else
+    static const int HW_VARIANT_V20_BUILD = HW_VARIANT_V20;
+#endif
+
     // Set the MUX
-    static inline void muxSet(int muxVal)
+    template<int HW> static inline void muxSetT(int muxVal)
     {
-        if (_hwVersionNumber == 17)
+        if (HW == HW_VARIANT_V17)
         {
             // Clear first as this is a safe setting - sets HADDR_SER low
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             // Now set bits required
             WR32(ARM_GPIO_GPSET0, muxVal << BR_MUX_LOW_BIT_POS);
         }
-        else
+        else if (HW == HW_VARIANT_V20_MUX_EN)
         {
-#ifdef V2_PROTO_USING_MUX_EN
             // Disable mux initially
             WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
             // Clear all the mux bits
@@ -608,41 +836,42 @@ private:
             WR32(ARM_GPIO_GPSET0, muxVal << BR_MUX_LOW_BIT_POS);
             // Enable the mux
             WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
-#else
+        }
+        else
+        {
             // Clear first
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             // Now set bits required
             WR32(ARM_GPIO_GPSET0, muxVal << BR_MUX_LOW_BIT_POS);
-#endif
         }
     }
 
     // Clear the MUX
-    static inline void muxClear()
+    template<int HW> static inline void muxClearT()
     {
-        if (_hwVersionNumber == 17)
+        if (HW == HW_VARIANT_V17)
         {
             // Clear to a safe setting - sets HADDR_SER low
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         }
-        else
+        else if (HW == HW_VARIANT_V20_MUX_EN)
         {
-#ifdef V2_PROTO_USING_MUX_EN
             // Disable the mux
             WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
             // Clear to a safe setting - sets LADDR_CK low
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
-#else
+        }
+        else
+        {
             // Clear to a safe setting - sets LADDR_CK low
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
-#endif
         }
     }
 
     // Mux set data bus driver output enable
-    static inline void muxDataBusOutputEnable()
+    template<int HW> static inline void muxDataBusOutputEnableT()
     {
-        if (_hwVersionNumber == 17)
+        if (HW == HW_VARIANT_V17)
         {
             // Clear first as this is a safe setting - sets HADDR_SER low
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
@@ -653,9 +882,8 @@ private:
             // Clear again
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         }
-        else
+        else if (HW == HW_VARIANT_V20_MUX_EN)
         {
-#ifdef V2_PROTO_USING_MUX_EN
             // Clear then set the output enable
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             WR32(ARM_GPIO_GPSET0, BR_MUX_DATA_OE_BAR_LOW << BR_MUX_LOW_BIT_POS);
@@ -663,20 +891,21 @@ private:
             WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_OUT_FF_SET);
             WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
-#else
+        }
+        else
+        {
             // Clear then set the output enable
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             WR32(ARM_GPIO_GPSET0, BR_MUX_DATA_OE_BAR_LOW << BR_MUX_LOW_BIT_POS);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_OUT_FF_SET);
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);       
-#endif
         }
     }
 
     // Mux clear low address
-    static inline void muxClearLowAddr()
+    template<int HW> static inline void muxClearLowAddrT()
     {
-        if (_hwVersionNumber == 17)
+        if (HW == HW_VARIANT_V17)
         {
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             WR32(ARM_GPIO_GPSET0, BR_MUX_LADDR_CLR_BAR_LOW << BR_MUX_LOW_BIT_POS);
@@ -685,9 +914,8 @@ private:
             // Clear again
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         }
-        else
+        else if (HW == HW_VARIANT_V20_MUX_EN)
         {
-#ifdef V2_PROTO_USING_MUX_EN
             // Clear then set the low address clear line
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             WR32(ARM_GPIO_GPSET0, BR_MUX_LADDR_CLR_BAR_LOW << BR_MUX_LOW_BIT_POS);
@@ -695,15 +923,45 @@ private:
             WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_CLEAR_LOW_ADDR);
             WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
-#else
+        }
+        else
+        {
             // Clear then set the low address clear line
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             WR32(ARM_GPIO_GPSET0, BR_MUX_LADDR_CLR_BAR_LOW << BR_MUX_LOW_BIT_POS);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_CLEAR_LOW_ADDR);
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
-#endif
         }
-        
+    }
+
+    // Runtime dispatch of the above for code outside the tight loops
+    static inline void muxSet(int muxVal)
+    {
+        if (_hwVersionNumber == 17)
+            muxSetT<HW_VARIANT_V17>(muxVal);
+        else
+            muxSetT<HW_VARIANT_V20_BUILD>(muxVal);
+    }
+    static inline void muxClear()
+    {
+        if (_hwVersionNumber == 17)
+            muxClearT<HW_VARIANT_V17>();
+        else
+            muxClearT<HW_VARIANT_V20_BUILD>();
+    }
+    static inline void muxDataBusOutputEnable()
+    {
+        if (_hwVersionNumber == 17)
+            muxDataBusOutputEnableT<HW_VARIANT_V17>();
+        else
+            muxDataBusOutputEnableT<HW_VARIANT_V20_BUILD>();
+    }
+    static inline void muxClearLowAddr()
+    {
+        if (_hwVersionNumber == 17)
+            muxClearLowAddrT<HW_VARIANT_V17>();
+        else
+            muxClearLowAddrT<HW_VARIANT_V20_BUILD>();
     }
 
     // Set signal (RESET/IRQ/NMI)
@@ -714,6 +972,7 @@ private:
     static void waitResetFlipFlops(bool forceClear = false);
     static void waitClearDetected();
     static void waitHandleNew();
+    template<int HW> static void waitHandleNewT();
     static void waitEnablementUpdate();
     static void waitGenerationDisable();
     static void waitHandleReadRelease();
@@ -724,6 +983,19 @@ private:
     // Read and write bytes
     static void byteWrite(uint32_t byte, int iorq);
     static uint8_t byteRead(int iorq);
+    template<int HW> static void byteWriteT(uint32_t byte, int iorq);
+    template<int HW> static uint8_t byteReadT(int iorq);
+
+    // Block transfers specialised on hardware version
+    template<int HW> static BR_RETURN_TYPE blockWriteT(uint32_t addr, const uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq);
+    template<int HW> static BR_RETURN_TYPE blockReadT(uint32_t addr, uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq);
+
+    // Burst transfers (bus must be controlled and address set) - there are merged GPIO sequences for
+    // V1.7 and V2.0 with MUX_EN (V2_PROTO_USING_MUX_EN, the default build) only. A V2.0 build without
+    // MUX_EN runs the per-byte functions a page at a time so transfers are correct but no faster
+    template<int HW> static void blockWriteBurstT(uint32_t addr, const uint8_t* pData, uint32_t len, bool iorq);
+    template<int HW> static void blockReadBurstT(uint32_t addr, uint8_t* pData, uint32_t len, bool iorq);
+    static uint32_t blockXferKBps(uint32_t len, uint32_t elapsedUs);
 
 private:
     // Timeouts
@@ -35,8 +35,9 @@ int BusAccess::busSocketAdd(BusSocketInfo& busSocketInfo)
     _busSockets[_busSocketCount] = busSocketInfo;
     int tmpCount = _busSocketCount++;
 
-    // Update wait state generation
+    // Update dispatch lists and wait state generation
     // LogWrite("BusAccess", LOG_DEBUG, "busSocketAdd");
+    busSocketDispatchUpdate();
     waitEnablementUpdate();
 
     return tmpCount;
@@ -51,8 +52,9 @@ void BusAccess::busSocketEnable(int busSocket, bool enable)
     // Enable/disable
     _busSockets[busSocket].enabled = enable;
 
-    // Update wait state generation
+    // Update dispatch lists and wait state generation
     // LogWrite("BusAccess", LOG_DEBUG, "busSocketEnable");
+    busSocketDispatchUpdate();
     waitEnablementUpdate();
 }
 
@@ -64,6 +66,99 @@ bool BusAccess::busSocketIsEnabled(int busSocket)
     return _busSockets[busSocket].enabled;
 }
 
+// Rebuild the per-cycle-type lists of bus access callbacks so the wait handler only
+// calls sockets interested in the current cycle (socket order is preserved)
+void BusAccess::busSocketDispatchUpdate()
+{
+    static const uint32_t cycleTypeMasks[BUS_CYCLE_TYPE_COUNT] = {
+        BR_BUS_CYCLE_MREQ_RD_MASK,
+        BR_BUS_CYCLE_MREQ_WR_MASK,
+        BR_BUS_CYCLE_IORQ_RD_MASK,
+        BR_BUS_CYCLE_IORQ_WR_MASK,
+        BR_BUS_CYCLE_M1_MASK | BR_BUS_CYCLE_MREQ_RD_MASK,
+        BR_BUS_CYCLE_IRQ_ACK_MASK,
+        0xffffffff
+    };
+    for (int cycleType = 0; cycleType < BUS_CYCLE_TYPE_COUNT; cycleType++)
+    {
+        int dispCount = 0;
+        for (int i = 0; i < _busSocketCount; i++)
+        {
+            BusSocketInfo& sock = _busSockets[i];
+            if (!sock.enabled || !sock.busAccessCallback)
+                continue;
+            uint32_t sockMask = (sock.busCycleMask == BR_BUS_CYCLE_ALL) ? 0xffffffff : sock.busCycleMask;
+            if ((sockMask & cycleTypeMasks[cycleType]) == 0)
+                continue;
+            BusSocketDispatch& disp = _busSocketDispatch[cycleType][dispCount++];
+            disp.busAccessCallback = sock.busAccessCallback;
+            disp.busSocket = i;
+            // Address isn't known for other cycles so don't restrict them
+            bool allAddrs = (sock.addrRangeLen == 0) || (cycleType == BUS_CYCLE_OTHER);
+            disp.addrRangeStart = allAddrs ? 0 : sock.addrRangeStart;
+            disp.addrRangeLen = allAddrs ? 0xffffffff : sock.addrRangeLen;
+        }
+        _busSocketDispatchCount[cycleType] = dispCount;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// IO port handlers
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Add a handler to every port whose low byte matches - fails (leaving nothing added) if
+// any of those ports already has the maximum number of handlers
+bool BusAccess::ioPortHandlerAdd(uint32_t addrMask, uint32_t addrMatch, uint32_t busCycleMask,
+            BusIOPortCBFnType* pHandler, void* pParam)
+{
+    if (!pHandler)
+        return false;
+    addrMask &= 0xffff;
+    addrMatch &= addrMask;
+    if (busCycleMask == BR_BUS_CYCLE_ALL)
+        busCycleMask = BR_BUS_CYCLE_IORQ_RD_MASK | BR_BUS_CYCLE_IORQ_WR_MASK;
+
+    // Check space
+    for (int port = 0; port < NUM_IO_PORTS; port++)
+        if (((port & addrMask) == (addrMatch & 0xff)) && (_ioPortHandlerCount[port] >= MAX_HANDLERS_PER_IO_PORT))
+            return false;
+
+    // Add - the entry is filled in before the count is incremented as the wait ISR may be using it
+    for (int port = 0; port < NUM_IO_PORTS; port++)
+    {
+        if ((port & addrMask) != (addrMatch & 0xff))
+            continue;
+        BusIOPortHandler& handler = _ioPortHandlers[port][_ioPortHandlerCount[port]];
+        handler.pHandler = pHandler;
+        handler.pParam = pParam;
+        handler.addrMask = addrMask;
+        handler.addrMatch = addrMatch;
+        handler.busCycleMask = busCycleMask;
+        _ioPortHandlerCount[port]++;
+    }
+    return true;
+}
+
+// Remove all entries for a handler
+void BusAccess::ioPortHandlerRemove(BusIOPortCBFnType* pHandler, void* pParam)
+{
+    for (int port = 0; port < NUM_IO_PORTS; port++)
+    {
+        int destIdx = 0;
+        int count = _ioPortHandlerCount[port];
+        for (int srcIdx = 0; srcIdx < count; srcIdx++)
+        {
+            BusIOPortHandler& handler = _ioPortHandlers[port][srcIdx];
+            if ((handler.pHandler == pHandler) && (handler.pParam == pParam))
+                continue;
+            if (destIdx != srcIdx)
+                _ioPortHandlers[port][destIdx] = handler;
+            destIdx++;
+        }
+        _ioPortHandlerCount[port] = destIdx;
+    }
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Status
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -71,6 +166,8 @@ bool BusAccess::busSocketIsEnabled(int busSocket)
 void BusAccess::getStatus(BusAccessStatusInfo& statusInfo)
 {
     statusInfo = _statusInfo;
+    for (int i = 0; i < _busSocketCount; i++)
+        statusInfo.sockNames[i] = _busSockets[i].pName;
 }
 
 void BusAccess::clearStatus()
@@ -285,6 +382,13 @@ bool BusAccess::waitForBusAck(bool ack)
 
 // Control bus read
 uint32_t BusAccess::controlBusRead()
+{
+    if (_hwVersionNumber == 17)
+        return controlBusReadT<HW_VARIANT_V17>();
+    return controlBusReadT<HW_VARIANT_V20_BUILD>();
+}
+
+template<int HW> uint32_t BusAccess::controlBusReadT()
 {
     uint32_t startGetCtrlBusUs = micros();
     int loopCount = 0;
@@ -294,7 +398,7 @@ uint32_t BusAccess::controlBusRead()
         uint32_t busVals = RD32(ARM_GPIO_GPLEV0);
 
         // Handle slower M1 signal on V1.7 hardware
-        if (_hwVersionNumber == 17)
+        if (HW == HW_VARIANT_V17)
         {
             // Check if we're in a wait - in which case FF OE will be active
             // So we must set the data bus direction outward even if this causes a temporary
@@ -322,7 +426,7 @@ uint32_t BusAccess::controlBusRead()
                 (((busVals & BR_BUSACK_BAR_MASK) == 0) ? BR_CTRL_BUS_BUSACK_MASK : 0);
 
         // Handle slower M1 signal on V1.7 hardware
-        if (_hwVersionNumber == 17)
+        if (HW == HW_VARIANT_V17)
         {
             // Clear M1 in case set above
             ctrlBusVals = ctrlBusVals & (~BR_CTRL_BUS_M1_MASK);
@@ -378,6 +482,14 @@ uint32_t BusAccess::controlBusRead()
 void BusAccess::addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals)
 {
     if (_hwVersionNumber == 17)
+        addrAndDataBusReadT<HW_VARIANT_V17>(addr, dataBusVals);
+    else
+        addrAndDataBusReadT<HW_VARIANT_V20_BUILD>(addr, dataBusVals);
+}
+
+template<int HW> void BusAccess::addrAndDataBusReadT(uint32_t& addr, uint32_t& dataBusVals)
+{
+    if (HW == HW_VARIANT_V17)
     {
         // Set data bus driver direction outward - so it doesn't conflict with the PIB
         // if FF OE is set
@@ -388,7 +500,7 @@ void BusAccess::addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals)
     pibSetIn();
 
     // Enable the high address onto the PIB
-    muxSet(BR_MUX_HADDR_OE_BAR);
+    muxSetT<HW>(BR_MUX_HADDR_OE_BAR);
 
     // Delay to allow data to settle
     lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_READ);
@@ -397,7 +509,7 @@ void BusAccess::addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals)
     addr = (pibGetValue() & 0xff) << 8;
 
     // Enable the low address onto the PIB
-    muxSet(BR_MUX_LADDR_OE_BAR);
+    muxSetT<HW>(BR_MUX_LADDR_OE_BAR);
 
     // Delay to allow data to settle
     lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
@@ -406,7 +518,7 @@ void BusAccess::addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals)
     addr |= pibGetValue() & 0xff;
 
     // Clear the mux to deactivate output enables
-    muxClear();
+    muxClearT<HW>();
 
     // Delay to allow data to settle
     lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
@@ -426,7 +538,7 @@ void BusAccess::addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals)
     // Note that the outputs of the data bus buffer are enabled from this point until
     // a rising edge of IORQ or MREQ
     // This can cause a bus conflict if BR_DATA_DIR_IN is set low before this happens
-    muxDataBusOutputEnable();
+    muxDataBusOutputEnableT<HW>();
 
     // Delay to allow data to settle
     lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
@@ -435,18 +547,32 @@ void BusAccess::addrAndDataBusRead(uint32_t& addr, uint32_t& dataBusVals)
     dataBusVals = pibGetValue() & 0xff;
 }
 
+// The wait handler in BusAccess.cpp uses the specialised bus reads
+template uint32_t BusAccess::controlBusReadT<BusAccess::HW_VARIANT_V17>();
+template uint32_t BusAccess::controlBusReadT<BusAccess::HW_VARIANT_V20_BUILD>();
+template void BusAccess::addrAndDataBusReadT<BusAccess::HW_VARIANT_V17>(uint32_t& addr, uint32_t& dataBusVals);
+template void BusAccess::addrAndDataBusReadT<BusAccess::HW_VARIANT_V20_BUILD>(uint32_t& addr, uint32_t& dataBusVals);
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Address Bus Functions
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
 // Set low address value by clearing and counting
 void BusAccess::addrLowSet(uint32_t lowAddrByte)
+{
+    if (_hwVersionNumber == 17)
+        addrLowSetT<HW_VARIANT_V17>(lowAddrByte);
+    else
+        addrLowSetT<HW_VARIANT_V20_BUILD>(lowAddrByte);
+}
+
+template<int HW> void BusAccess::addrLowSetT(uint32_t lowAddrByte)
 {
     // Clear initially
-    muxClearLowAddr();
+    muxClearLowAddrT<HW>();
     // Clock the required value in - requires one more count than
     // expected as the output register is one clock pulse behind the counter
-    if (_hwVersionNumber == 17)
+    if (HW == HW_VARIANT_V17)
     {
         for (uint32_t i = 0; i < (lowAddrByte & 0xff) + 1; i++) {
             WR32(ARM_GPIO_GPSET0, BR_V17_LADDR_CK_MASK);
@@ -455,17 +581,22 @@ void BusAccess::addrLowSet(uint32_t lowAddrByte)
             lowlev_cycleDelay(CYCLES_DELAY_FOR_LOW_ADDR_SET);
         }
     }
-    else
+    else if (HW == HW_VARIANT_V20_MUX_EN)
     {
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         WR32(ARM_GPIO_GPSET0, BR_MUX_LADDR_CLK << BR_MUX_LOW_BIT_POS);
         for (uint32_t i = 0; i < (lowAddrByte & 0xff) + 1; i++) {
-#ifdef V2_PROTO_USING_MUX_EN
             WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
             WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
-#else
+        }
+    }
+    else
+    {
+        WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
+        WR32(ARM_GPIO_GPSET0, BR_MUX_LADDR_CLK << BR_MUX_LOW_BIT_POS);
+        for (uint32_t i = 0; i < (lowAddrByte & 0xff) + 1; i++) {
             // This clears the OE FFbut is used as a safe way
             // to cycle the low address clock
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
@@ -473,7 +604,6 @@ void BusAccess::addrLowSet(uint32_t lowAddrByte)
             lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
             WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
             lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
-#endif
         }
     }
 }
@@ -482,21 +612,30 @@ void BusAccess::addrLowSet(uint32_t lowAddrByte)
 void BusAccess::addrLowInc()
 {
     if (_hwVersionNumber == 17)
+        addrLowIncT<HW_VARIANT_V17>();
+    else
+        addrLowIncT<HW_VARIANT_V20_BUILD>();
+}
+
+template<int HW> void BusAccess::addrLowIncT()
+{
+    if (HW == HW_VARIANT_V17)
     {
         WR32(ARM_GPIO_GPSET0, BR_V17_LADDR_CK_MASK);
         lowlev_cycleDelay(CYCLES_DELAY_FOR_LOW_ADDR_SET);
         WR32(ARM_GPIO_GPCLR0, BR_V17_LADDR_CK_MASK);
         lowlev_cycleDelay(CYCLES_DELAY_FOR_LOW_ADDR_SET);
     }
-    else
+    else if (HW == HW_VARIANT_V20_MUX_EN)
     {
-#ifdef V2_PROTO_USING_MUX_EN
         // This sets the low address clock low as it is MUX0
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
         lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
         WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
-#else
+    }
+    else
+    {
         // This clears the OE FF but is used as a safe way
         // to cycle the low address clock
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
@@ -504,7 +643,6 @@ void BusAccess::addrLowInc()
         lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
-#endif
     }
 }
 
@@ -512,57 +650,60 @@ void BusAccess::addrLowInc()
 void BusAccess::addrHighSet(uint32_t highAddrByte)
 {
     if (_hwVersionNumber == 17)
-    {
-        // Shift the value into the register
-        // Takes one more shift than expected as output reg is one pulse behind shift
-        for (uint32_t i = 0; i < 9; i++) {
-            // Set or clear serial pin to shift register
+        addrHighSetT<HW_VARIANT_V17>(highAddrByte);
+    else
+        addrHighSetT<HW_VARIANT_V20_BUILD>(highAddrByte);
+}
+
+template<int HW> void BusAccess::addrHighSetT(uint32_t highAddrByte)
+{
+    // Shift the value into the register
+    // Takes one more shift than expected as output reg is one pulse behind shift
+    for (uint32_t i = 0; i < 9; i++) {
+        // Set or clear serial pin to shift register
+        if (HW == HW_VARIANT_V17)
+        {
             if (highAddrByte & 0x80)
-                muxSet(BR_V17_MUX_HADDR_SER_HIGH);
+                muxSetT<HW>(BR_V17_MUX_HADDR_SER_HIGH);
             else
-                muxSet(BR_V17_MUX_HADDR_SER_LOW);
-            // Delay to allow settling
-            lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
-            // Shift the address value for next bit
-            highAddrByte = highAddrByte << 1;
-            // Clock the bit
-            WR32(ARM_GPIO_GPSET0, 1 << BR_HADDR_CK);
-            lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
-            WR32(ARM_GPIO_GPCLR0, 1 << BR_HADDR_CK);
+                muxSetT<HW>(BR_V17_MUX_HADDR_SER_LOW);
         }
-    }
-    else
-    {
-        // Shift the value into the register
-        // Takes one more shift than expected as output reg is one pulse behind shift
-        for (uint32_t i = 0; i < 9; i++) {
-            // Set or clear serial pin to shift register
+        else
+        {
             if (highAddrByte & 0x80)
-                muxClear();
+                muxClearT<HW>();
             else
                 // Mux low address clear doubles as high address serial in 
-                muxSet(BR_MUX_LADDR_CLR_BAR_LOW);
-            // Delay to allow settling
-            lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
-            // Shift the address value for next bit
-            highAddrByte = highAddrByte << 1;
-            // Clock the bit
-            WR32(ARM_GPIO_GPSET0, 1 << BR_HADDR_CK);
-            lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
-            WR32(ARM_GPIO_GPCLR0, 1 << BR_HADDR_CK);
+                muxSetT<HW>(BR_MUX_LADDR_CLR_BAR_LOW);
         }
+        // Delay to allow settling
+        lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
+        // Shift the address value for next bit
+        highAddrByte = highAddrByte << 1;
+        // Clock the bit
+        WR32(ARM_GPIO_GPSET0, 1 << BR_HADDR_CK);
+        lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
+        WR32(ARM_GPIO_GPCLR0, 1 << BR_HADDR_CK);
     }
 
     // Clear multiplexer
     lowlev_cycleDelay(CYCLES_DELAY_FOR_HIGH_ADDR_SET);
-    muxClear();
+    muxClearT<HW>();
 }
 
 // Set the full address
 void BusAccess::addrSet(unsigned int addr)
 {
-    addrHighSet(addr >> 8);
-    addrLowSet(addr & 0xff);
+    if (_hwVersionNumber == 17)
+        addrSetT<HW_VARIANT_V17>(addr);
+    else
+        addrSetT<HW_VARIANT_V20_BUILD>(addr);
+}
+
+template<int HW> void BusAccess::addrSetT(unsigned int addr)
+{
+    addrHighSetT<HW>(addr >> 8);
+    addrLowSetT<HW>(addr & 0xff);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -575,6 +716,14 @@ void BusAccess::addrSet(unsigned int addr)
 // - address bus is already set and output enabled to host bus
 // - PIB is already set to output
 void BusAccess::byteWrite(uint32_t data, int iorq)
+{
+    if (_hwVersionNumber == 17)
+        byteWriteT<HW_VARIANT_V17>(data, iorq);
+    else
+        byteWriteT<HW_VARIANT_V20_BUILD>(data, iorq);
+}
+
+template<int HW> void BusAccess::byteWriteT(uint32_t data, int iorq)
 {
     // Set the data onto the PIB
     pibSetValue(data);
@@ -583,34 +732,26 @@ void BusAccess::byteWrite(uint32_t data, int iorq)
     WR32(ARM_GPIO_GPCLR0, BR_DATA_DIR_IN_MASK | BR_MUX_CTRL_BIT_MASK | (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK));
     WR32(ARM_GPIO_GPSET0, BR_MUX_DATA_OE_BAR_LOW << BR_MUX_LOW_BIT_POS);
     // Write the data by setting WR_BAR active
-    if (_hwVersionNumber == 17)
-    {
-        WR32(ARM_GPIO_GPCLR0, BR_WR_BAR_MASK);
-    }
-    else
-    {
-#ifdef V2_PROTO_USING_MUX_EN
+    if (HW == HW_VARIANT_V20_MUX_EN)
         WR32(ARM_GPIO_GPCLR0, BR_WR_BAR_MASK | BR_MUX_EN_BAR_MASK);
-#else
+    else
         WR32(ARM_GPIO_GPCLR0, BR_WR_BAR_MASK);
-#endif
-    }
     // Target write delay
     lowlev_cycleDelay(CYCLES_DELAY_FOR_WRITE_TO_TARGET);
     // Deactivate and leave data direction set to inwards
-    if (_hwVersionNumber == 17)
+    if (HW == HW_VARIANT_V17)
     {
         WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK | (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_WR_BAR_MASK);
-        muxClear();
+        muxClearT<HW>();
     }
-    else
+    else if (HW == HW_VARIANT_V20_MUX_EN)
     {
-#ifdef V2_PROTO_USING_MUX_EN
         WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK | BR_MUX_EN_BAR_MASK | (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_WR_BAR_MASK);
-#else
+    }
+    else
+    {
         WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK | (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_WR_BAR_MASK);
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
-#endif
     }
 }
 
@@ -620,40 +761,51 @@ void BusAccess::byteWrite(uint32_t data, int iorq)
 // - address bus is already set and output enabled to host bus
 // - PIB is already set to input
 uint8_t BusAccess::byteRead(int iorq)
+{
+    if (_hwVersionNumber == 17)
+        return byteReadT<HW_VARIANT_V17>(iorq);
+    return byteReadT<HW_VARIANT_V20_BUILD>(iorq);
+}
+
+template<int HW> uint8_t BusAccess::byteReadT(int iorq)
 {
     // Enable data output onto PIB, MREQ_BAR and RD_BAR both active
     WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK | (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_RD_BAR_MASK);
     WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK | (BR_MUX_DATA_OE_BAR_LOW << BR_MUX_LOW_BIT_POS));
-    if (_hwVersionNumber != 17)
-    {
-#ifdef V2_PROTO_USING_MUX_EN
+    if (HW == HW_VARIANT_V20_MUX_EN)
         WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
-#endif
-    }
     // Delay to allow data to settle
     lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
     // Get the data
     uint8_t val = pibGetValue();
     // Deactivate leaving data-dir inwards
-    if (_hwVersionNumber == 17)
+    if (HW == HW_VARIANT_V17)
     {
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
         WR32(ARM_GPIO_GPSET0, (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_RD_BAR_MASK);
     }
-    else
+    else if (HW == HW_VARIANT_V20_MUX_EN)
     {
-#ifdef V2_PROTO_USING_MUX_EN
         WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK | (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_RD_BAR_MASK);
-#else
+    }
+    else
+    {
         WR32(ARM_GPIO_GPSET0, (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_RD_BAR_MASK);
         WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
-#endif
     }
     return val;
 }
 
 // Write a consecutive block of memory to host
 BR_RETURN_TYPE BusAccess::blockWrite(uint32_t addr, const uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq)
+{
+    // Hardware version is resolved once for the whole block
+    if (_hwVersionNumber == 17)
+        return blockWriteT<HW_VARIANT_V17>(addr, pData, len, busRqAndRelease, iorq);
+    return blockWriteT<HW_VARIANT_V20_BUILD>(addr, pData, len, busRqAndRelease, iorq);
+}
+
+template<int HW> BR_RETURN_TYPE BusAccess::blockWriteT(uint32_t addr, const uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq)
 {
     // Check if we need to request bus
     if (busRqAndRelease) {
@@ -667,28 +819,38 @@ BR_RETURN_TYPE BusAccess::blockWrite(uint32_t addr, const uint8_t* pData, uint32
     pibSetIn();
 
     // Set the address to initial value
-    addrSet(addr);
+    addrSetT<HW>(addr);
 
     // Set the PIB to output
     pibSetOut();
 
-    // Iterate data
-    for (uint32_t i = 0; i < len; i++)
+    // Use burst engine for larger blocks
+    if (len >= MIN_LEN_FOR_BLOCK_BURST)
+    {
+        uint32_t burstStartUs = micros();
+        blockWriteBurstT<HW>(addr, pData, len, iorq);
+        _statusInfo.blockWriteKBps = blockXferKBps(len, micros() - burstStartUs);
+    }
+    else
     {
-        // Write byte
-        byteWrite(*pData, iorq);
+        // Iterate data
+        for (uint32_t i = 0; i < len; i++)
+        {
+            // Write byte
+            byteWriteT<HW>(*pData, iorq);
 
-        // Increment the lower address counter
-        addrLowInc();
+            // Increment the lower address counter
+            addrLowIncT<HW>();
 
-        // Increment addresses
-        pData++;
-        addr++;
+            // Increment addresses
+            pData++;
+            addr++;
 
-        // Check if we've rolled over the lowest 8 bits
-        if ((addr & 0xff) == 0) {
-            // Set the address again
-            addrSet(addr);
+            // Check if we've rolled over the lowest 8 bits
+            if ((addr & 0xff) == 0) {
+                // Set the address again
+                addrSetT<HW>(addr);
+            }
         }
     }
 
@@ -707,6 +869,14 @@ BR_RETURN_TYPE BusAccess::blockWrite(uint32_t addr, const uint8_t* pData, uint32
 // Assumes:
 // - control of host bus has been requested and acknowledged
 BR_RETURN_TYPE BusAccess::blockRead(uint32_t addr, uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq)
+{
+    // Hardware version is resolved once for the whole block
+    if (_hwVersionNumber == 17)
+        return blockReadT<HW_VARIANT_V17>(addr, pData, len, busRqAndRelease, iorq);
+    return blockReadT<HW_VARIANT_V20_BUILD>(addr, pData, len, busRqAndRelease, iorq);
+}
+
+template<int HW> BR_RETURN_TYPE BusAccess::blockReadT(uint32_t addr, uint8_t* pData, uint32_t len, bool busRqAndRelease, bool iorq)
 {
     // Check if we need to request bus
     if (busRqAndRelease) {
@@ -723,43 +893,53 @@ BR_RETURN_TYPE BusAccess::blockRead(uint32_t addr, uint8_t* pData, uint32_t len,
     WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK);
 
     // Set the address to initial value
-    addrSet(addr);
-
-    // Calculate bit patterns outside loop
-    uint32_t reqLinePlusRead = (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | (1 << BR_RD_BAR);
+    addrSetT<HW>(addr);
 
-    // Iterate data
-    for (uint32_t i = 0; i < len; i++)
+    // Use burst engine for larger blocks
+    if (len >= MIN_LEN_FOR_BLOCK_BURST)
+    {
+        uint32_t burstStartUs = micros();
+        blockReadBurstT<HW>(addr, pData, len, iorq);
+        _statusInfo.blockReadKBps = blockXferKBps(len, micros() - burstStartUs);
+    }
+    else
     {
+        // Calculate bit patterns outside loop
+        uint32_t reqLinePlusRead = (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | (1 << BR_RD_BAR);
 
-        // Enable data bus driver output - must be done each time round the loop as it is
-        // cleared by IORQ or MREQ rising edge
-        muxDataBusOutputEnable();
+        // Iterate data
+        for (uint32_t i = 0; i < len; i++)
+        {
 
-        // IORQ_BAR / MREQ_BAR and RD_BAR both active
-        WR32(ARM_GPIO_GPCLR0, reqLinePlusRead);
-        
-        // Delay to allow data bus to settle
-        lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
-        
-        // Get the data
-        *pData = pibGetValue();
+            // Enable data bus driver output - must be done each time round the loop as it is
+            // cleared by IORQ or MREQ rising edge
+            muxDataBusOutputEnableT<HW>();
+
+            // IORQ_BAR / MREQ_BAR and RD_BAR both active
+            WR32(ARM_GPIO_GPCLR0, reqLinePlusRead);
+            
+            // Delay to allow data bus to settle
+            lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
+            
+            // Get the data
+            *pData = pibGetValue();
 
-        // Deactivate IORQ/MREQ and RD and clock the low address
-        WR32(ARM_GPIO_GPSET0, reqLinePlusRead);
+            // Deactivate IORQ/MREQ and RD and clock the low address
+            WR32(ARM_GPIO_GPSET0, reqLinePlusRead);
 
-        // Inc low address
-        addrLowInc();
+            // Inc low address
+            addrLowIncT<HW>();
 
-        // Increment addresses
-        pData++;
-        addr++;
+            // Increment addresses
+            pData++;
+            addr++;
 
-        // Check if we've rolled over the lowest 8 bits
-        if ((addr & 0xff) == 0) {
+            // Check if we've rolled over the lowest 8 bits
+            if ((addr & 0xff) == 0) {
 
-            // Set the address again
-            addrSet(addr);
+                // Set the address again
+                addrSetT<HW>(addr);
+            }
         }
     }
 
@@ -771,6 +951,218 @@ BR_RETURN_TYPE BusAccess::blockRead(uint32_t addr, uint8_t* pData, uint32_t len,
     return BR_OK;
 }
 
+// Run a list of read/write segments back to back under a single bus request
+// The result of each segment is optionally returned in pXferResults (which must have numXfers entries)
+// and the return value is the first failure (or BR_OK)
+BR_RETURN_TYPE BusAccess::blockAccessVector(const BusXfer* pXfers, int numXfers, bool busRqAndRelease,
+                BR_RETURN_TYPE* pXferResults)
+{
+    // Check if we need to request bus
+    if (busRqAndRelease) {
+        // Request bus and take control after ack
+        BR_RETURN_TYPE ret = controlRequestAndTake();
+        if (ret != BR_OK)
+        {
+            if (pXferResults)
+                for (int i = 0; i < numXfers; i++)
+                    pXferResults[i] = ret;
+            return ret;
+        }
+    }
+
+    // Segments
+    BR_RETURN_TYPE retVal = BR_OK;
+    for (int i = 0; i < numXfers; i++)
+    {
+        const BusXfer& xfer = pXfers[i];
+        BR_RETURN_TYPE xferRslt = BR_OK;
+        if (xfer.len > 0)
+        {
+            if (xfer.write)
+                xferRslt = blockWrite(xfer.addr, xfer.pData, xfer.len, false, xfer.iorq);
+            else
+                xferRslt = blockRead(xfer.addr, xfer.pData, xfer.len, false, xfer.iorq);
+        }
+        if (pXferResults)
+            pXferResults[i] = xferRslt;
+        if ((xferRslt != BR_OK) && (retVal == BR_OK))
+            retVal = xferRslt;
+    }
+
+    // Check if we need to release bus
+    if (busRqAndRelease) {
+        // release bus
+        controlRelease();
+    }
+    return retVal;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Burst transfers
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The per-byte functions above leave the mux in a safe state and re-establish it on every call. In a
+// burst the state left by one byte is known so the mux clear, data output enable, bus cycle and low
+// address clock are merged into fewer GPIO writes. The low address counter wraps at the end of each
+// 256 byte page so only the high address shift register is reloaded at that point.
+// Assumes:
+// - control of host bus has been requested and acknowledged
+// - address has been set to addr (and mux is clear)
+// - PIB is set to output (for write) or input (for read)
+
+template<int HW> void BusAccess::blockWriteBurstT(uint32_t addr, const uint8_t* pData, uint32_t len, bool iorq)
+{
+    const uint32_t reqLine = iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK;
+    const uint32_t muxDataOE = BR_MUX_DATA_OE_BAR_LOW << BR_MUX_LOW_BIT_POS;
+    uint32_t endAddr = addr + len;
+    while (addr < endAddr)
+    {
+        // Bytes remaining in this page
+        uint32_t pageLen = 0x100 - (addr & 0xff);
+        if (pageLen > endAddr - addr)
+            pageLen = endAddr - addr;
+
+        if (HW == HW_VARIANT_V17)
+        {
+#pragma GCC unroll 4
+            for (uint32_t i = 0; i < pageLen; i++)
+            {
+                // Set and clear words for the data
+                uint32_t dataSet = ((uint32_t)pData[i]) << BR_DATA_BUS;
+                uint32_t dataClr = ((~(uint32_t)pData[i]) & 0xff) << BR_DATA_BUS;
+                // Data onto PIB and data bus output enable, then direction out and MREQ/IORQ active
+                WR32(ARM_GPIO_GPSET0, dataSet | muxDataOE);
+                WR32(ARM_GPIO_GPCLR0, dataClr | BR_DATA_DIR_IN_MASK | reqLine);
+                // Write
+                WR32(ARM_GPIO_GPCLR0, BR_WR_BAR_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_WRITE_TO_TARGET);
+                WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK | reqLine | BR_WR_BAR_MASK);
+                // Clear mux and clock the low address
+                WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK);
+                WR32(ARM_GPIO_GPSET0, BR_V17_LADDR_CK_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_LOW_ADDR_SET);
+                WR32(ARM_GPIO_GPCLR0, BR_V17_LADDR_CK_MASK);
+            }
+        }
+        else if (HW == HW_VARIANT_V20_MUX_EN)
+        {
+#pragma GCC unroll 4
+            for (uint32_t i = 0; i < pageLen; i++)
+            {
+                // Set and clear words for the data
+                uint32_t dataSet = ((uint32_t)pData[i]) << BR_DATA_BUS;
+                uint32_t dataClr = ((~(uint32_t)pData[i]) & 0xff) << BR_DATA_BUS;
+                // Data onto PIB and mux to data output enable (mux is disabled), then direction out and MREQ/IORQ active
+                WR32(ARM_GPIO_GPSET0, dataSet | muxDataOE);
+                WR32(ARM_GPIO_GPCLR0, dataClr | BR_DATA_DIR_IN_MASK | reqLine);
+                // Write and enable mux to set data output enable
+                WR32(ARM_GPIO_GPCLR0, BR_WR_BAR_MASK | BR_MUX_EN_BAR_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_WRITE_TO_TARGET);
+                WR32(ARM_GPIO_GPSET0, BR_DATA_DIR_IN_MASK | BR_MUX_EN_BAR_MASK | reqLine | BR_WR_BAR_MASK);
+                // Clock the low address by pulsing mux enable with mux clear
+                WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK | BR_MUX_EN_BAR_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
+                WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
+            }
+        }
+        else
+        {
+            // V2.0 without MUX_EN - per-byte fallback
+            for (uint32_t i = 0; i < pageLen; i++)
+            {
+                byteWriteT<HW>(pData[i], iorq);
+                addrLowIncT<HW>();
+            }
+        }
+
+        // Next page - setting the high address uses the low address clear line
+        // so the low address counter is reset to 0 as well
+        pData += pageLen;
+        addr += pageLen;
+        if (addr < endAddr)
+            addrSetT<HW>(addr);
+    }
+}
+
+template<int HW> void BusAccess::blockReadBurstT(uint32_t addr, uint8_t* pData, uint32_t len, bool iorq)
+{
+    const uint32_t reqLinePlusRead = (iorq ? BR_IORQ_BAR_MASK : BR_MREQ_BAR_MASK) | BR_RD_BAR_MASK;
+    const uint32_t muxDataOE = BR_MUX_DATA_OE_BAR_LOW << BR_MUX_LOW_BIT_POS;
+    uint32_t endAddr = addr + len;
+    while (addr < endAddr)
+    {
+        // Bytes remaining in this page
+        uint32_t pageLen = 0x100 - (addr & 0xff);
+        if (pageLen > endAddr - addr)
+            pageLen = endAddr - addr;
+
+        if (HW == HW_VARIANT_V17)
+        {
+#pragma GCC unroll 4
+            for (uint32_t i = 0; i < pageLen; i++)
+            {
+                // Data bus output enable (cleared by MREQ/IORQ rising edge)
+                WR32(ARM_GPIO_GPSET0, muxDataOE);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_OUT_FF_SET);
+                // Mux clear and MREQ/IORQ and RD active
+                WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK | reqLinePlusRead);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
+                pData[i] = pibGetValue();
+                WR32(ARM_GPIO_GPSET0, reqLinePlusRead);
+                // Clock the low address - the low period is covered by the next read
+                WR32(ARM_GPIO_GPSET0, BR_V17_LADDR_CK_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_LOW_ADDR_SET);
+                WR32(ARM_GPIO_GPCLR0, BR_V17_LADDR_CK_MASK);
+            }
+        }
+        else if (HW == HW_VARIANT_V20_MUX_EN)
+        {
+#pragma GCC unroll 4
+            for (uint32_t i = 0; i < pageLen; i++)
+            {
+                // Data bus output enable (cleared by MREQ/IORQ rising edge) by pulsing mux enable
+                WR32(ARM_GPIO_GPSET0, muxDataOE);
+                WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_OUT_FF_SET);
+                WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
+                // Mux clear and MREQ/IORQ and RD active
+                WR32(ARM_GPIO_GPCLR0, BR_MUX_CTRL_BIT_MASK | reqLinePlusRead);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_READ_FROM_PIB);
+                pData[i] = pibGetValue();
+                WR32(ARM_GPIO_GPSET0, reqLinePlusRead);
+                // Clock the low address by pulsing mux enable with mux clear
+                WR32(ARM_GPIO_GPCLR0, BR_MUX_EN_BAR_MASK);
+                lowlev_cycleDelay(CYCLES_DELAY_FOR_CLOCK_LOW_ADDR);
+                WR32(ARM_GPIO_GPSET0, BR_MUX_EN_BAR_MASK);
+            }
+        }
+        else
+        {
+            // V2.0 without MUX_EN - per-byte fallback
+            for (uint32_t i = 0; i < pageLen; i++)
+            {
+                pData[i] = byteReadT<HW>(iorq);
+                addrLowIncT<HW>();
+            }
+        }
+
+        // Next page - setting the high address uses the low address clear line
+        // so the low address counter is reset to 0 as well
+        pData += pageLen;
+        addr += pageLen;
+        if (addr < endAddr)
+            addrSetT<HW>(addr);
+    }
+}
+
+// Transfer rate in KBytes per second (1000000/1024 ~= 977)
+uint32_t BusAccess::blockXferKBps(uint32_t len, uint32_t elapsedUs)
+{
+    if (elapsedUs == 0)
+        elapsedUs = 1;
+    return len * 977 / elapsedUs;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Clock Generator
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
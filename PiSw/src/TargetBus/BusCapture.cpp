@@ -0,0 +1,369 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "BusCapture.h"
+#include "../System/PiWiring.h"
+#include "../System/lowlib.h"
+#include "../System/lowlev.h"
+#include "../System/ee_sprintf.h"
+#include "../System/logging.h"
+#include "../System/rdutils.h"
+#include <stdlib.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char FromBusCapture[] = "BusCapture";
+
+// Sockets
+int BusCapture::_busSocketId = -1;
+int BusCapture::_commsSocketId = -1;
+
+// Comms socket
+CommsSocketInfo BusCapture::_commsSocketInfo =
+{
+    true,
+    BusCapture::handleRxMsg,
+    NULL,
+    NULL
+};
+
+// Bus socket
+BusSocketInfo BusCapture::_busSocketInfo =
+{
+    false,
+    BusCapture::handleWaitInterruptStatic,
+    NULL,
+    false,
+    false,
+    // Reset
+    false,
+    0,
+    // NMI
+    false,
+    0,
+    // IRQ
+    false,
+    0,
+    false,
+    BR_BUS_ACTION_GENERAL,
+    false,
+    // All bus cycles and addresses
+    BR_BUS_CYCLE_ALL,
+    0,
+    0,
+    "BusCapture"
+};
+
+// Ring of records
+BusCaptureRec BusCapture::_captureRing[CAPTURE_RING_LEN];
+RingBufferPosn BusCapture::_captureRingPosn(CAPTURE_RING_LEN);
+
+// State and trigger
+volatile BusCapture::CAPTURE_STATE BusCapture::_captureState = CAPTURE_STATE_IDLE;
+BusCaptureTrigger BusCapture::_trigger;
+volatile uint32_t BusCapture::_postRemaining = 0;
+uint32_t BusCapture::_lastTicks = 0;
+uint32_t BusCapture::_ticksPerUs = 1;
+
+// Hold
+bool BusCapture::_holdWhenFull = false;
+volatile bool BusCapture::_isHoldingTarget = false;
+
+// Stats
+volatile uint32_t BusCapture::_recordCount = 0;
+volatile uint32_t BusCapture::_overflowCount = 0;
+volatile uint32_t BusCapture::_trigRecIdx = TRIG_REC_IDX_NONE;
+uint32_t BusCapture::_recsSent = 0;
+uint32_t BusCapture::_frameSeq = 0;
+bool BusCapture::_endSent = false;
+uint32_t BusCapture::_lastFrameMs = 0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Init
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BusCapture::init()
+{
+    // Connect to the comms socket
+    if (_commsSocketId < 0)
+        _commsSocketId = CommandHandler::commsSocketAdd(_commsSocketInfo);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Handle CommandInterface message
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Get a numeric argument (decimal or 0x hex) from the command JSON
+static uint32_t captureGetArg(const char* pCmdJson, const char* argName, uint32_t defaultVal)
+{
+    static const int MAX_ARG_STR_LEN = 20;
+    char argStr[MAX_ARG_STR_LEN+1];
+    if (!jsonGetValueForKey(argName, pCmdJson, argStr, MAX_ARG_STR_LEN) || (strlen(argStr) == 0))
+        return defaultVal;
+    return strtoul(argStr, NULL, 0);
+}
+
+bool BusCapture::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t* pParams, [[maybe_unused]]int paramsLen,
+                char* pRespJson, int maxRespLen)
+{
+    // Get the command string from JSON
+    static const int MAX_CMD_NAME_STR = 50;
+    char cmdName[MAX_CMD_NAME_STR+1];
+    if (!jsonGetValueForKey("cmdName", pCmdJson, cmdName, MAX_CMD_NAME_STR))
+        return false;
+
+    if (strcasecmp(cmdName, "captureStart") == 0)
+    {
+        // Trigger is enabled if there is anything to match
+        BusCaptureTrigger trigger;
+        trigger.addr = captureGetArg(pCmdJson, "trigAddr", 0);
+        trigger.addrMask = captureGetArg(pCmdJson, "trigAddrMask", 0);
+        trigger.flags = captureGetArg(pCmdJson, "trigFlags", 0);
+        trigger.flagsMask = captureGetArg(pCmdJson, "trigFlagsMask", 0);
+        trigger.enabled = (trigger.addrMask != 0) || (trigger.flagsMask != 0);
+        trigger.preCount = captureGetArg(pCmdJson, "pre", 0);
+        trigger.postCount = captureGetArg(pCmdJson, "post", 0);
+        bool holdWhenFull = captureGetArg(pCmdJson, "hold", 0) != 0;
+        bool waitOnMem = captureGetArg(pCmdJson, "mem", 1) != 0;
+        bool waitOnIO = captureGetArg(pCmdJson, "io", 1) != 0;
+        start(trigger, holdWhenFull, waitOnMem, waitOnIO);
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "captureStop") == 0)
+    {
+        stop();
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "captureStatus") == 0)
+    {
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Start/Stop
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BusCapture::start(BusCaptureTrigger& trigger, bool holdWhenFull, bool waitOnMem, bool waitOnIO)
+{
+    // Stop recording while setting up
+    _captureState = CAPTURE_STATE_IDLE;
+    busSocketDetach();
+    _captureRingPosn.clear();
+
+    // Settings - pre-trigger records must leave room for the trigger and some post-trigger records
+    _trigger = trigger;
+    if (_trigger.preCount > CAPTURE_RING_LEN - MIN_SPACES_IN_RING)
+        _trigger.preCount = CAPTURE_RING_LEN - MIN_SPACES_IN_RING;
+    _holdWhenFull = holdWhenFull;
+    _postRemaining = _trigger.enabled ? 0 : _trigger.postCount;
+
+    // Stats
+    _recordCount = 0;
+    _overflowCount = 0;
+    _trigRecIdx = TRIG_REC_IDX_NONE;
+    _recsSent = 0;
+    _frameSeq = 0;
+    _endSent = false;
+    _lastFrameMs = millis();
+
+    // Calibrate cycle counter so the decoder can convert to time
+    static const uint32_t TICKS_CALIBRATION_US = 1000;
+    uint32_t calStartTicks = lowlev_cycleCounterRead();
+    microsDelay(TICKS_CALIBRATION_US);
+    _ticksPerUs = (lowlev_cycleCounterRead() - calStartTicks) / TICKS_CALIBRATION_US;
+    if (_ticksPerUs == 0)
+        _ticksPerUs = 1;
+    _lastTicks = lowlev_cycleCounterRead();
+
+    // Start recording
+    _captureState = _trigger.enabled ? CAPTURE_STATE_ARMED : CAPTURE_STATE_TRIGGERED;
+    if (_busSocketId < 0)
+        _busSocketId = BusAccess::busSocketAdd(_busSocketInfo);
+    BusAccess::waitOnMemory(_busSocketId, waitOnMem);
+    BusAccess::waitOnIO(_busSocketId, waitOnIO);
+    BusAccess::busSocketEnable(_busSocketId, true);
+    LogWrite(FromBusCapture, LOG_DEBUG, "Start trigger %d addr %04x/%04x flags %02x/%02x pre %u post %u ticksPerUs %u",
+                _trigger.enabled, _trigger.addr, _trigger.addrMask, _trigger.flags, _trigger.flagsMask,
+                _trigger.preCount, _trigger.postCount, _ticksPerUs);
+}
+
+void BusCapture::stop()
+{
+    // Records already captured are still streamed
+    if ((_captureState == CAPTURE_STATE_ARMED) || (_captureState == CAPTURE_STATE_TRIGGERED))
+        _captureState = CAPTURE_STATE_COMPLETE;
+    busSocketDetach();
+}
+
+void BusCapture::busSocketDetach()
+{
+    if (_busSocketId < 0)
+        return;
+    BusAccess::waitOnMemory(_busSocketId, false);
+    BusAccess::waitOnIO(_busSocketId, false);
+    if (_isHoldingTarget)
+    {
+        _isHoldingTarget = false;
+        BusAccess::waitHold(_busSocketId, false);
+        BusAccess::waitRelease();
+    }
+    BusAccess::busSocketEnable(_busSocketId, false);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BusCapture::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    static const char* stateNames[] = { "idle", "armed", "triggered", "complete" };
+    char tmpResp[200];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"state\":\"%s\",\"recs\":%u,\"ovf\":%u,\"sent\":%u,\"trig\":%d,\"tpu\":%u,\"ringLen\":%d",
+                stateNames[_captureState], _recordCount, _overflowCount, _recsSent,
+                (_trigRecIdx == TRIG_REC_IDX_NONE) ? -1 : (int)_trigRecIdx, _ticksPerUs, CAPTURE_RING_LEN);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Wait interrupt handler
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BusCapture::handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+        uint32_t flags, uint32_t& retVal)
+{
+    CAPTURE_STATE captureState = _captureState;
+    if ((captureState != CAPTURE_STATE_ARMED) && (captureState != CAPTURE_STATE_TRIGGERED))
+        return;
+
+    // Time since last cycle
+    uint32_t ticksNow = lowlev_cycleCounterRead();
+    uint32_t deltaTicks = ticksNow - _lastTicks;
+    _lastTicks = ticksNow;
+
+    // Data is what a bus socket placed on the bus if the cycle was decoded
+    bool decoded = (retVal & BR_MEM_ACCESS_RSLT_NOT_DECODED) == 0;
+    uint8_t recFlags = (flags & BR_CAPTURE_FLAG_CTRL_MASK) | (decoded ? BR_CAPTURE_FLAG_DECODED : 0);
+    uint8_t recData = (decoded && !(flags & BR_CTRL_BUS_WR_MASK)) ? (retVal & 0xff) : (data & 0xff);
+
+    // Pre-trigger only the most recent records are kept
+    if (captureState == CAPTURE_STATE_ARMED)
+    {
+        if (_trigger.matches(addr, flags))
+        {
+            _captureState = CAPTURE_STATE_TRIGGERED;
+            _postRemaining = _trigger.postCount;
+            _trigRecIdx = _captureRingPosn.count();
+            recFlags |= BR_CAPTURE_FLAG_TRIGGER;
+        }
+        else
+        {
+            if (_trigger.preCount == 0)
+                return;
+            if ((_captureRingPosn.count() >= _trigger.preCount) || !_captureRingPosn.canPut())
+            {
+                _captureRingPosn.hasGot();
+                _recordCount--;
+            }
+        }
+    }
+
+    // Record
+    if (!_captureRingPosn.canPut())
+    {
+        _overflowCount++;
+    }
+    else
+    {
+        BusCaptureRec& rec = _captureRing[_captureRingPosn.posToPut()];
+        rec.deltaTicks = deltaTicks;
+        rec.addr = addr;
+        rec.data = recData;
+        rec.flags = recFlags;
+        _captureRingPosn.hasPut();
+        _recordCount++;
+
+        // Hold the target rather than overflow
+        if (_holdWhenFull && (_captureRingPosn.size() - _captureRingPosn.count() < MIN_SPACES_IN_RING))
+        {
+            _isHoldingTarget = true;
+            BusAccess::waitHold(_busSocketId, true);
+        }
+    }
+
+    // Post-trigger count
+    if ((_captureState == CAPTURE_STATE_TRIGGERED) && ((recFlags & BR_CAPTURE_FLAG_TRIGGER) == 0) && (_postRemaining > 0))
+    {
+        _postRemaining--;
+        if (_postRemaining == 0)
+            _captureState = CAPTURE_STATE_COMPLETE;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Service - stream records once triggered
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void BusCapture::service()
+{
+    CAPTURE_STATE captureState = _captureState;
+    if (((captureState != CAPTURE_STATE_TRIGGERED) && (captureState != CAPTURE_STATE_COMPLETE)) || _endSent)
+        return;
+
+    // Stop servicing bus cycles once complete
+    if ((captureState == CAPTURE_STATE_COMPLETE) && (_busSocketId >= 0) && BusAccess::busSocketIsEnabled(_busSocketId))
+        busSocketDetach();
+
+    // Send full frames, anything left at the end or after a while
+    uint32_t recsWaiting = _captureRingPosn.count();
+    bool sendNow = (recsWaiting >= MAX_RECS_PER_FRAME) || (captureState == CAPTURE_STATE_COMPLETE) ||
+                ((recsWaiting > 0) && isTimeout(millis(), _lastFrameMs, MAX_MS_BETWEEN_FRAMES));
+    if (!sendNow || (CommandHandler::getTxAvailable() < MIN_TX_AVAILABLE_FOR_CAPTURE_FRAME))
+        return;
+    sendFrame();
+
+    // No longer hold
+    if (_isHoldingTarget && (_captureRingPosn.size() - _captureRingPosn.count() > MIN_SPACES_IN_RING + MAX_RECS_PER_FRAME))
+    {
+        _isHoldingTarget = false;
+        BusAccess::waitHold(_busSocketId, false);
+        BusAccess::waitRelease();
+    }
+}
+
+void BusCapture::sendFrame()
+{
+    // Records
+    BusCaptureRec recs[MAX_RECS_PER_FRAME];
+    uint32_t recCount = 0;
+    while ((recCount < MAX_RECS_PER_FRAME) && _captureRingPosn.canGet())
+    {
+        recs[recCount++] = _captureRing[_captureRingPosn.posToGet()];
+        _captureRingPosn.hasGot();
+    }
+
+    // End of capture when complete and drained
+    bool isEnd = (_captureState == CAPTURE_STATE_COMPLETE) && !_captureRingPosn.canGet();
+
+    // Header gives the index of the first record, the index of the trigger record and ticks per microsecond
+    char headerJson[200];
+    ee_sprintf(headerJson, "\"seq\":%u,\"first\":%u,\"trig\":%d,\"tpu\":%u,\"ovf\":%u,\"end\":%d",
+                _frameSeq, _recsSent, (_trigRecIdx == TRIG_REC_IDX_NONE) ? -1 : (int)_trigRecIdx,
+                _ticksPerUs, _overflowCount, isEnd ? 1 : 0);
+    CommandHandler::sendWithJSON("captureData", headerJson, 0, (const uint8_t*)recs, recCount * sizeof(BusCaptureRec));
+    _frameSeq++;
+    _recsSent += recCount;
+    _lastFrameMs = millis();
+    if (isEnd)
+    {
+        _endSent = true;
+        LogWrite(FromBusCapture, LOG_DEBUG, "Complete recs %u overflows %u", _recsSent, _overflowCount);
+    }
+}
@@ -0,0 +1,147 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../System/RingBufferPosn.h"
+#include "../CommandInterface/CommandHandler.h"
+#include "BusAccess.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bus capture - logic analyser style recording of every serviced bus cycle
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Record flags (bits 0..5 are the BR_CTRL_BUS_XXX_MASK bits RD, WR, MREQ, IORQ, M1, WAIT)
+#define BR_CAPTURE_FLAG_CTRL_MASK 0x3f
+#define BR_CAPTURE_FLAG_TRIGGER 0x40
+#define BR_CAPTURE_FLAG_DECODED 0x80
+
+// Record as stored and streamed (little-endian)
+#pragma pack(push, 1)
+struct BusCaptureRec
+{
+    // Cycle counter ticks since previous record
+    uint32_t deltaTicks;
+    uint16_t addr;
+    // Data on the bus (data supplied by a bus socket if decoded)
+    uint8_t data;
+    uint8_t flags;
+};
+#pragma pack(pop)
+
+// Trigger
+class BusCaptureTrigger
+{
+public:
+    BusCaptureTrigger()
+    {
+        clear();
+    }
+    void clear()
+    {
+        enabled = false;
+        addr = 0;
+        addrMask = 0;
+        flags = 0;
+        flagsMask = 0;
+        preCount = 0;
+        postCount = 0;
+    }
+    bool matches(uint32_t cycleAddr, uint32_t cycleFlags)
+    {
+        return (((cycleAddr ^ addr) & addrMask) == 0) && (((cycleFlags ^ flags) & flagsMask) == 0);
+    }
+    bool enabled;
+    uint32_t addr;
+    uint32_t addrMask;
+    uint32_t flags;
+    uint32_t flagsMask;
+    // Records kept before the trigger and recorded after it (0 = until stopped)
+    uint32_t preCount;
+    uint32_t postCount;
+};
+
+class BusCapture
+{
+public:
+    static void init();
+    static void service();
+
+    // Control
+    static void start(BusCaptureTrigger& trigger, bool holdWhenFull, bool waitOnMem, bool waitOnIO);
+    static void stop();
+
+    // Status
+    static void getStatusJson(char* pRespJson, int maxRespLen);
+
+    enum CAPTURE_STATE
+    {
+        CAPTURE_STATE_IDLE,
+        CAPTURE_STATE_ARMED,
+        CAPTURE_STATE_TRIGGERED,
+        CAPTURE_STATE_COMPLETE
+    };
+    static CAPTURE_STATE getState()
+    {
+        return _captureState;
+    }
+
+    // Size of capture ring
+    static const int CAPTURE_RING_LEN = 32768;
+
+private:
+    // Bus socket we're attached to and setup info
+    static int _busSocketId;
+    static BusSocketInfo _busSocketInfo;
+
+    // Comms socket we're attached to and setup info
+    static int _commsSocketId;
+    static CommsSocketInfo _commsSocketInfo;
+
+    // Handle messages (telling us to start/stop)
+    static bool handleRxMsg(const char* pCmdJson, const uint8_t* pParams, int paramsLen,
+                    char* pRespJson, int maxRespLen);
+
+    // Wait interrupt handler
+    static void handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+            uint32_t flags, uint32_t& retVal);
+
+    // Send a frame of records (or the end of capture)
+    static void sendFrame();
+
+    // Stop servicing bus cycles
+    static void busSocketDetach();
+
+    // Ring of records
+    static BusCaptureRec _captureRing[CAPTURE_RING_LEN];
+    static RingBufferPosn _captureRingPosn;
+
+    // State and trigger
+    static volatile CAPTURE_STATE _captureState;
+    static BusCaptureTrigger _trigger;
+    static volatile uint32_t _postRemaining;
+    static uint32_t _lastTicks;
+    static uint32_t _ticksPerUs;
+
+    // Hold target when ring is nearly full rather than dropping records
+    static bool _holdWhenFull;
+    static volatile bool _isHoldingTarget;
+    static const int MIN_SPACES_IN_RING = 50;
+
+    // Stats
+    static volatile uint32_t _recordCount;
+    static volatile uint32_t _overflowCount;
+    static volatile uint32_t _trigRecIdx;
+    static uint32_t _recsSent;
+    static uint32_t _frameSeq;
+    static bool _endSent;
+    static uint32_t _lastFrameMs;
+
+    // Streaming
+    static const int MAX_RECS_PER_FRAME = 1000;
+    static const int MIN_TX_AVAILABLE_FOR_CAPTURE_FRAME = 12000;
+    static const int MAX_MS_BETWEEN_FRAMES = 100;
+    static const uint32_t TRIG_REC_IDX_NONE = 0xffffffff;
+};
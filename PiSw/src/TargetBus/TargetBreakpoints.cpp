@@ -23,14 +23,26 @@ void TargetBreakpoints::clear()
     for (int i = 0; i < MAX_BREAKPOINTS; i++)
     {
         _breakpoints[i].enabled = false;
-        _fastBreakpoints[i].enabled = false;
-        ee_sprintf(_fastBreakpoints[i].hitMessage, "FB%02d", i);
+        _breakpoints[i].pcValue = 0;
+        _breakpoints[i].condition.clear();
+        _breakpoints[i].hitCount = 0;
+        _breakpoints[i].tracepoint = false;
+        _breakpoints[i].traceMemAddr.clear();
+        _breakpoints[i].traceMemLen = 0;
     }
+    for (int i = 0; i < BITMAP_WORDS; i++)
+    {
+        _breakpointBitmap[i] = 0;
+        _fastBreakpointBitmap[i] = 0;
+    }
+    for (uint32_t addr = 0; addr < STD_TARGET_MEMORY_LEN; addr++)
+        _breakpointAddrSlot[addr] = ADDR_SLOT_NONE;
     _breakpointNumEnabled = 0;
     _breakpointsEnabled = true;
     _breakpointHitIndex = 0;
     _fastBreakpointsNumEnabled = 0;
-    _fastBreakpointHitIdx = 0;
+    _fastBreakpointHitAddr = 0;
+    _fastBreakpointHit = false;
 }
 
 
@@ -42,13 +54,11 @@ void TargetBreakpoints::enableBreakpoint(int idx, bool enabled)
 {
     if ((idx < 0) || (idx >= MAX_BREAKPOINTS))
         return;
+    if (_breakpoints[idx].enabled == enabled)
+        return;
     _breakpoints[idx].enabled = enabled;
-    _breakpointNumEnabled = 0;
-    int numBreakpointsEnabled = 0;
-    for (int i = 0; i < MAX_BREAKPOINTS; i++)
-        if (_breakpoints[i].enabled)
-            _breakpointIdxsToCheck[numBreakpointsEnabled++] = i;
-    _breakpointNumEnabled = numBreakpointsEnabled;
+    _breakpointNumEnabled += enabled ? 1 : -1;
+    updateAddrSlot(_breakpoints[idx].pcValue);
 }
 
 void TargetBreakpoints::setBreakpointMessage(int idx, const char* hitMessage)
@@ -63,60 +73,111 @@ void TargetBreakpoints::setBreakpointPCAddr(int idx, uint32_t pcVal)
 {
     if ((idx < 0) || (idx >= MAX_BREAKPOINTS))
         return;
-    _breakpoints[idx].pcValue = pcVal;
+    uint32_t prevPCVal = _breakpoints[idx].pcValue;
+    _breakpoints[idx].pcValue = pcVal & (STD_TARGET_MEMORY_LEN - 1);
+    _breakpoints[idx].hitCount = 0;
+    if (_breakpoints[idx].enabled)
+    {
+        updateAddrSlot(prevPCVal);
+        updateAddrSlot(_breakpoints[idx].pcValue);
+    }
+}
+
+bool TargetBreakpoints::setBreakpointCondition(int idx, const char* condition)
+{
+    if ((idx < 0) || (idx >= MAX_BREAKPOINTS))
+        return false;
+    _breakpoints[idx].hitCount = 0;
+    return _breakpoints[idx].condition.compile(condition);
+}
+
+bool TargetBreakpoints::setBreakpointTrace(int idx, bool tracepoint, const char* memAddrExpr, uint32_t memLen)
+{
+    if ((idx < 0) || (idx >= MAX_BREAKPOINTS))
+        return false;
+    _breakpoints[idx].tracepoint = tracepoint;
+    _breakpoints[idx].traceMemLen = memLen;
+    return _breakpoints[idx].traceMemAddr.compile(memAddrExpr);
+}
+
+// Set the slot and bitmap bit for an address from the enabled breakpoints
+void TargetBreakpoints::updateAddrSlot(uint32_t addr)
+{
+    uint16_t slot = ADDR_SLOT_NONE;
+    for (int i = 0; i < MAX_BREAKPOINTS; i++)
+    {
+        if (_breakpoints[i].enabled && (_breakpoints[i].pcValue == addr))
+        {
+            slot = i;
+            break;
+        }
+    }
+
+    // Slot is valid before the bit is set as this is checked in the wait ISR
+    uint32_t bitMask = 1 << (addr & 0x1f);
+    if (slot == ADDR_SLOT_NONE)
+    {
+        _breakpointBitmap[addr >> 5] &= ~bitMask;
+        _breakpointAddrSlot[addr] = slot;
+    }
+    else
+    {
+        _breakpointAddrSlot[addr] = slot;
+        _breakpointBitmap[addr >> 5] |= bitMask;
+    }
 }
 
-bool TargetBreakpoints::checkForBreak([[maybe_unused]] uint32_t addr, [[maybe_unused]] uint32_t data, 
+bool TargetBreakpoints::checkForBreak(uint32_t addr, [[maybe_unused]] uint32_t data, 
         uint32_t flags, [[maybe_unused]] uint32_t& retVal)
 {
     // LogWrite(FromTargetBreakpoints, LOG_DEBUG, "checkForBreak %04x, fast %d", 
     //         addr, _fastBreakpointsNumEnabled);
-    // See if fast-breakpoints enabled and M1 cycle
-    if ((_fastBreakpointsNumEnabled > 0) && (flags & BR_CTRL_BUS_M1_MASK) && (flags & BR_CTRL_BUS_RD_MASK))
+    // Only M1 cycles
+    if (!((flags & BR_CTRL_BUS_M1_MASK) && (flags & BR_CTRL_BUS_RD_MASK)))
+        return false;
+    addr &= (STD_TARGET_MEMORY_LEN - 1);
+    uint32_t bitMask = 1 << (addr & 0x1f);
+
+    // Fast breakpoints
+    if (_fastBreakpointBitmap[addr >> 5] & bitMask)
     {
-        // Check breakpoints
-        for (int i = 0; i < _fastBreakpointsNumEnabled; i++)
-        {
-            if (_fastBreakpoints[i].enabled && (_fastBreakpoints[i].pcValue == addr))
-            {
-                _fastBreakpointHitIdx = i;
-                return true;
-            }
-        }
+        _fastBreakpointHitAddr = addr;
+        _fastBreakpointHit = true;
+        return true;
     }
-    // See if breakpoints enabled and M1 cycle
-    if (_breakpointsEnabled && (_breakpointNumEnabled > 0) && (flags & BR_CTRL_BUS_M1_MASK) && (flags & BR_CTRL_BUS_RD_MASK))
+
+    // Breakpoints
+    if (_breakpointsEnabled && (_breakpointBitmap[addr >> 5] & bitMask))
     {
-        // Check breakpoints
-        for (int i = 0; i < _breakpointNumEnabled; i++)
-        {
-            int bpIdx = _breakpointIdxsToCheck[i];
-            if (_breakpoints[bpIdx].pcValue == addr)
-            {
-                _breakpointHitIndex = bpIdx;
-                return true;
-            }
-        }
+        _breakpointHitIndex = _breakpointAddrSlot[addr];
+        _breakpoints[_breakpointHitIndex].hitCount++;
+        _fastBreakpointHit = false;
+        return true;
     }
     return false;
 }
 
 void TargetBreakpoints::setFastBreakpoint(uint32_t addr, bool en)
 {
-    // Check for change to existing
-    for (int i = 0; i < _fastBreakpointsNumEnabled; i++)
+    // LogWrite(FromTargetBreakpoints, LOG_DEBUG, "Fast breakpoint addr %04x now %d", addr, en);
+    addr &= (STD_TARGET_MEMORY_LEN - 1);
+    uint32_t bitMask = 1 << (addr & 0x1f);
+    bool isSet = (_fastBreakpointBitmap[addr >> 5] & bitMask) != 0;
+    if (en && !isSet)
     {
-        if (_fastBreakpoints[i].pcValue == addr)
-        {
-            // LogWrite(FromTargetBreakpoints, LOG_DEBUG, "Fast breakpoint addr %04x now %d", addr, en);
-            _fastBreakpoints[i].enabled = en;
-            return;
-        }
+        _fastBreakpointBitmap[addr >> 5] |= bitMask;
+        _fastBreakpointsNumEnabled++;
     }
-    if (en && (_fastBreakpointsNumEnabled < MAX_BREAKPOINTS))
+    else if (!en && isSet)
     {
-        _fastBreakpoints[_fastBreakpointsNumEnabled].enabled = true;
-        _fastBreakpoints[_fastBreakpointsNumEnabled].pcValue = addr;
-        _fastBreakpointsNumEnabled++;
+        _fastBreakpointBitmap[addr >> 5] &= ~bitMask;
+        _fastBreakpointsNumEnabled--;
     }
 }
+
+void TargetBreakpoints::clearFastBreakpoints()
+{
+    for (int i = 0; i < BITMAP_WORDS; i++)
+        _fastBreakpointBitmap[i] = 0;
+    _fastBreakpointsNumEnabled = 0;
+}
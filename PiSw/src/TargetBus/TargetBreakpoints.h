@@ -7,6 +7,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "TargetCPU.h"
+#include "BreakpointCondition.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Defs
@@ -19,12 +20,21 @@ public:
     bool enabled;
     char hitMessage[MAX_HIT_MSG_LEN];
     uint32_t pcValue;
+    BreakpointCondition condition;
+    uint32_t hitCount;
+    // Tracepoint - record registers (and memory bytes at an address expression) then carry on
+    bool tracepoint;
+    BreakpointCondition traceMemAddr;
+    uint32_t traceMemLen;
 
     SimpleBreakpoint()
     {
         enabled = false;
         hitMessage[0] = 0;
         pcValue = 0;
+        hitCount = 0;
+        tracepoint = false;
+        traceMemLen = 0;
     }
 };
 
@@ -43,30 +53,75 @@ public:
     void enableBreakpoint(int idx, bool enabled);
     void setBreakpointMessage(int idx, const char* hitMessage);
     void setBreakpointPCAddr(int idx, uint32_t pcVal);
+    bool setBreakpointCondition(int idx, const char* condition);
+    bool setBreakpointTrace(int idx, bool tracepoint, const char* memAddrExpr, uint32_t memLen);
     bool checkForBreak(uint32_t addr, uint32_t data, uint32_t flags, uint32_t& retVal);
     int getNumEnabled()
     {
         return _breakpointNumEnabled;
     }
+    int getHitIndex()
+    {
+        return _breakpointHitIndex;
+    }
+    uint32_t getFastHitAddr()
+    {
+        return _fastBreakpointHitAddr;
+    }
+
+    // Conditions and tracepoints are handled once the registers have been grabbed after a hit (the
+    // hit count, condition and trace settings are those of the lowest numbered enabled breakpoint
+    // at the address)
+    bool isHitDeferred()
+    {
+        SimpleBreakpoint& bp = _breakpoints[_breakpointHitIndex];
+        return !_fastBreakpointHit && (bp.condition.isSet() || bp.tracepoint);
+    }
+    bool isHitTracepoint()
+    {
+        return !_fastBreakpointHit && _breakpoints[_breakpointHitIndex].tracepoint;
+    }
+    uint32_t getHitTraceMemAddr(const Z80Registers& regs, const uint8_t* pMemory)
+    {
+        SimpleBreakpoint& bp = _breakpoints[_breakpointHitIndex];
+        return bp.traceMemAddr.evaluateValue(regs, pMemory, bp.hitCount) & 0xffff;
+    }
+    uint32_t getHitTraceMemLen()
+    {
+        return _breakpoints[_breakpointHitIndex].traceMemLen;
+    }
+    bool isHitConditionMet(const Z80Registers& regs, const uint8_t* pMemory)
+    {
+        SimpleBreakpoint& bp = _breakpoints[_breakpointHitIndex];
+        return _fastBreakpointHit || bp.condition.evaluate(regs, pMemory, bp.hitCount);
+    }
     int isEnabled()
     {
         return _breakpointsEnabled;
     }
     void setFastBreakpoint(uint32_t addr, bool en);
-    void clearFastBreakpoints()
-    {
-        _fastBreakpointsNumEnabled = 0;
-    }
+    void clearFastBreakpoints();
+
+    // Limit on numbered breakpoints
+    static const int MAX_BREAKPOINTS = 2000;
 
 private:
     void clear();
+    void updateAddrSlot(uint32_t addr);
     bool _breakpointsEnabled;
     int _breakpointNumEnabled;
-    static const int MAX_BREAKPOINTS = 100;
     SimpleBreakpoint _breakpoints[MAX_BREAKPOINTS];
-    int _breakpointIdxsToCheck[MAX_BREAKPOINTS];
     int _breakpointHitIndex;
     int _fastBreakpointsNumEnabled;
-    SimpleBreakpoint _fastBreakpoints[MAX_BREAKPOINTS];
-    int _fastBreakpointHitIdx;
+    uint32_t _fastBreakpointHitAddr;
+    bool _fastBreakpointHit;
+
+    // Bitmaps indexed by PC of enabled breakpoints and fast breakpoints so the M1 check
+    // takes the same time however many are set - the slot map gives the lowest numbered
+    // enabled breakpoint at an address
+    static const int BITMAP_WORDS = STD_TARGET_MEMORY_LEN / 32;
+    static const uint16_t ADDR_SLOT_NONE = 0xffff;
+    uint32_t _breakpointBitmap[BITMAP_WORDS];
+    uint32_t _fastBreakpointBitmap[BITMAP_WORDS];
+    uint16_t _breakpointAddrSlot[STD_TARGET_MEMORY_LEN];
 };
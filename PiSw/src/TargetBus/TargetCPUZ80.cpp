@@ -23,79 +23,133 @@ void TargetCPUZ80::store16BitVal(uint8_t arry[], int offset, uint16_t val)
 // Handle register setting when injecting opcodes
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-int TargetCPUZ80::getInjectToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen)
+// Only the registers in regsMask are reloaded - the others are assumed to still hold the values
+// grabbed (the register get sequence restores everything it uses). R is always set as every
+// injected opcode fetch increments it and A is always reloaded after being used to set R and I.
+// With all registers in the mask this is the full ~55 byte sequence and with none it is ~10 bytes.
+int TargetCPUZ80::getInjectToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen, uint32_t regsMask)
 {
-    // Instructions to set register values
-    static uint8_t regSetInstructions[] = 
+    uint8_t code[MAX_INJECT_SET_REGS_LEN];
+    int pos = 0;
+
+    // nop - in case previous instruction was prefixed
+    code[pos++] = 0x00;
+
+    // ld ix, xxxx and ld iy, xxxx
+    if (regsMask & Z80Registers::REG_MASK_IX)
     {
-        0x00,                       // nop - in case previous instruction was prefixed
-        0xdd, 0x21, 0x00, 0x00,     // ld ix, xxxx
-        0xfd, 0x21, 0x00, 0x00,     // ld iy, xxxx
-        0x21, 0x00, 0x00,           // ld hl, xxxx
-        0x11, 0x00, 0x00,           // ld de, xxxx
-        0x01, 0x00, 0x00,           // ld bc, xxxx
-        0xd9,                       // exx
-        0x21, 0x00, 0x00,           // ld hl, xxxx
-        0x11, 0x00, 0x00,           // ld de, xxxx
-        0x01, 0x00, 0x00,           // ld bc, xxxx
-        0xf1, 0x00, 0x00,           // pop af + two bytes that are read as if from stack
-        0x08,                       // ex af,af'
-        0xf1, 0x00, 0x00,           // pop af + two bytes that are read as if from stack
-        0x31, 0x00, 0x00,           // ld sp, xxxx
-        0x3e, 0x00,                 // ld a, xx
-        0xed, 0x47,                 // ld i, a
-        0x3e, 0x00,                 // ld a, xx
-        0xed, 0x4f,                 // ld r, a
-        0x3e, 0x00,                 // ld a, xx
-        0xed, 0x46,                 // im 0
-        0xfb,                       // ei
-        0xc3, 0x00, 0x00            // jp xxxx
-    };
-    const int RegisterIXUpdatePos = 3;
-    const int RegisterIYUpdatePos = 7;
-    const int RegisterHLDASHUpdatePos = 10;
-    const int RegisterDEDASHUpdatePos = 13;
-    const int RegisterBCDASHUpdatePos = 16;
-    const int RegisterHLUpdatePos = 20;
-    const int RegisterDEUpdatePos = 23;
-    const int RegisterBCUpdatePos = 26;
-    const int RegisterAFDASHUpdatePos = 29;
-    const int RegisterAFUpdatePos = 33;
-    const int RegisterSPUpdatePos = 36;
-    const int RegisterIUpdatePos = 39;
-    const int RegisterRUpdatePos = 43;
-    const int RegisterAUpdatePos = 47;
-    const int RegisterIMUpdatePos = 49;
-    const int RegisterINTENUpdatePos = 50;
-    const int RegisterPCUpdatePos = 52;
+        code[pos++] = 0xdd;
+        pos = storeLd16(code, pos, 0x21, regs.IX);
+    }
+    if (regsMask & Z80Registers::REG_MASK_IY)
+    {
+        code[pos++] = 0xfd;
+        pos = storeLd16(code, pos, 0x21, regs.IY);
+    }
 
-    // Fill in the register values
-    store16BitVal(regSetInstructions, RegisterIXUpdatePos, regs.IX);
-    store16BitVal(regSetInstructions, RegisterIYUpdatePos, regs.IY);
-    store16BitVal(regSetInstructions, RegisterHLDASHUpdatePos, regs.HLDASH);
-    store16BitVal(regSetInstructions, RegisterDEDASHUpdatePos, regs.DEDASH);
-    store16BitVal(regSetInstructions, RegisterBCDASHUpdatePos, regs.BCDASH);
-    store16BitVal(regSetInstructions, RegisterSPUpdatePos, regs.SP);
-    store16BitVal(regSetInstructions, RegisterHLUpdatePos, regs.HL);
-    store16BitVal(regSetInstructions, RegisterDEUpdatePos, regs.DE);
-    store16BitVal(regSetInstructions, RegisterBCUpdatePos, regs.BC);
-    store16BitVal(regSetInstructions, RegisterAFDASHUpdatePos, regs.AFDASH);
-    store16BitVal(regSetInstructions, RegisterAFUpdatePos, regs.AF);
-    regSetInstructions[RegisterIUpdatePos] = regs.I;
-    regSetInstructions[RegisterRUpdatePos] = (regs.R + 256 - 5) % 256;
-    regSetInstructions[RegisterAUpdatePos] = regs.AF >> 8;
-    regSetInstructions[RegisterIMUpdatePos] = (regs.INTMODE == 0) ? 0x46 : ((regs.INTMODE == 1) ? 0x56 : 0x5e);
-    regSetInstructions[RegisterINTENUpdatePos] = (regs.INTENABLED == 0) ? 0xf3 : 0xfb;
-    store16BitVal(regSetInstructions, RegisterPCUpdatePos, regs.PC);
+    // Alternate and main register pairs - if all are being set then the alternate values are loaded
+    // into the main set and swapped over, otherwise the alternate set is swapped in and out
+    const uint32_t mainPairsMask = Z80Registers::REG_MASK_HL | Z80Registers::REG_MASK_DE | Z80Registers::REG_MASK_BC;
+    const uint32_t altPairsMask = Z80Registers::REG_MASK_HLDASH | Z80Registers::REG_MASK_DEDASH | Z80Registers::REG_MASK_BCDASH;
+    if ((regsMask & (mainPairsMask | altPairsMask)) == (mainPairsMask | altPairsMask))
+    {
+        pos = storeLd16(code, pos, 0x21, regs.HLDASH);
+        pos = storeLd16(code, pos, 0x11, regs.DEDASH);
+        pos = storeLd16(code, pos, 0x01, regs.BCDASH);
+        code[pos++] = 0xd9;                                 // exx
+    }
+    else if (regsMask & altPairsMask)
+    {
+        code[pos++] = 0xd9;                                 // exx
+        if (regsMask & Z80Registers::REG_MASK_HLDASH)
+            pos = storeLd16(code, pos, 0x21, regs.HLDASH);
+        if (regsMask & Z80Registers::REG_MASK_DEDASH)
+            pos = storeLd16(code, pos, 0x11, regs.DEDASH);
+        if (regsMask & Z80Registers::REG_MASK_BCDASH)
+            pos = storeLd16(code, pos, 0x01, regs.BCDASH);
+        code[pos++] = 0xd9;                                 // exx
+    }
+    if (regsMask & Z80Registers::REG_MASK_HL)
+        pos = storeLd16(code, pos, 0x21, regs.HL);
+    if (regsMask & Z80Registers::REG_MASK_DE)
+        pos = storeLd16(code, pos, 0x11, regs.DE);
+    if (regsMask & Z80Registers::REG_MASK_BC)
+        pos = storeLd16(code, pos, 0x01, regs.BC);
 
-    if (codeMaxlen >= sizeof(regSetInstructions))
+    // pop af + two bytes that are read as if from stack - the ex af,af' leaves the alternate
+    // value in AF so AF is always set after AF'
+    bool stackUsed = false;
+    if (regsMask & Z80Registers::REG_MASK_AFDASH)
     {
-        memcopyfast(pCodeBuffer, regSetInstructions, codeMaxlen);
-        return sizeof(regSetInstructions);
+        pos = storeLd16(code, pos, 0xf1, regs.AFDASH);
+        code[pos++] = 0x08;                                 // ex af,af'
+        regsMask |= Z80Registers::REG_MASK_AF;
+        stackUsed = true;
+    }
+    if (regsMask & Z80Registers::REG_MASK_AF)
+    {
+        pos = storeLd16(code, pos, 0xf1, regs.AF);
+        stackUsed = true;
+    }
+
+    // ld sp, xxxx - also needed if pop has moved it
+    if (stackUsed || (regsMask & Z80Registers::REG_MASK_SP))
+        pos = storeLd16(code, pos, 0x31, regs.SP);
+
+    // ld a, xx and ld i, a
+    if (regsMask & Z80Registers::REG_MASK_I)
+    {
+        code[pos++] = 0x3e;
+        code[pos++] = regs.I;
+        code[pos++] = 0xed;
+        code[pos++] = 0x47;
+    }
+
+    // ld a, xx and ld r, a - the value is reduced by the number of opcode fetches that follow (ld a, im,
+    // ei/di and jp) and only the lower 7 bits of R are incremented
+    int opcodeFetchesAfterR = 2;
+    if (regsMask & Z80Registers::REG_MASK_INTMODE)
+        opcodeFetchesAfterR += 2;
+    if (regsMask & Z80Registers::REG_MASK_INTENABLED)
+        opcodeFetchesAfterR += 1;
+    code[pos++] = 0x3e;
+    code[pos++] = (regs.R & 0x80) | ((regs.R - opcodeFetchesAfterR) & 0x7f);
+    code[pos++] = 0xed;
+    code[pos++] = 0x4f;
+
+    // ld a, xx
+    code[pos++] = 0x3e;
+    code[pos++] = regs.AF >> 8;
+
+    // im 0/1/2
+    if (regsMask & Z80Registers::REG_MASK_INTMODE)
+    {
+        code[pos++] = 0xed;
+        code[pos++] = (regs.INTMODE == 0) ? 0x46 : ((regs.INTMODE == 1) ? 0x56 : 0x5e);
+    }
+
+    // di or ei
+    if (regsMask & Z80Registers::REG_MASK_INTENABLED)
+        code[pos++] = (regs.INTENABLED == 0) ? 0xf3 : 0xfb;
+
+    // jp xxxx
+    pos = storeLd16(code, pos, 0xc3, regs.PC);
+
+    if ((int)codeMaxlen >= pos)
+    {
+        memcopyfast(pCodeBuffer, code, pos);
+        return pos;
     }
     return 0;
 }
 
+int TargetCPUZ80::storeLd16(uint8_t arry[], int offset, uint8_t opcode, uint16_t val)
+{
+    arry[offset] = opcode;
+    store16BitVal(arry, offset+1, val);
+    return offset + 3;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Handle snippet to set regs
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -14,8 +14,16 @@ class TargetCPUZ80
 {
 public:
 
-    static int getInjectToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen);
+    // Instructions to inject to set the registers in regsMask (see Z80Registers::REG_MASK_...)
+    static int getInjectToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen,
+                uint32_t regsMask = Z80Registers::REG_MASK_ALL);
     static int getSnippetToSetRegs(uint32_t codeLocation, Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen);
     static void store16BitVal(uint8_t arry[], int offset, uint16_t val);
 
+    // Max length of injected code to set registers
+    static const int MAX_INJECT_SET_REGS_LEN = 64;
+
+private:
+    static int storeLd16(uint8_t arry[], int offset, uint8_t opcode, uint16_t val);
+
 };
@@ -0,0 +1,170 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetCallStack.h"
+#include "../System/lowlib.h"
+#include "../System/ee_sprintf.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TargetCallStack::TargetCallStack()
+{
+    clear();
+}
+
+void TargetCallStack::clear()
+{
+    _topIdx = 0;
+    _depth = 0;
+    _instrAddr = 0;
+    _instrKind = INSTR_KIND_OTHER;
+    _prefixByte = 0;
+    _firstPairDone = false;
+    _lastWriteValid = false;
+    _lastWriteAddr = 0;
+    _lastWriteData = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bus cycles
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetCallStack::handleBusCycle(uint32_t addr, uint32_t data, uint32_t flags)
+{
+    if (flags & BR_CTRL_BUS_M1_MASK)
+    {
+        // Interrupt acknowledge - the next stack write pair is the interrupt
+        if (flags & BR_CTRL_BUS_IORQ_MASK)
+        {
+            _instrKind = INSTR_KIND_OTHER;
+            _firstPairDone = true;
+            _lastWriteValid = false;
+            return;
+        }
+
+        // Opcode fetch
+        uint32_t prefixByte = _prefixByte;
+        _prefixByte = 0;
+        if (prefixByte == 0xcb)
+        {
+            // Second byte of a CB instruction
+            return;
+        }
+        else if (prefixByte == 0xed)
+        {
+            // Second byte of an ED instruction - RETN and RETI (and their duplicates)
+            _instrKind = ((data & 0xc7) == 0x45) ? INSTR_KIND_RET : INSTR_KIND_OTHER;
+            return;
+        }
+        else if ((prefixByte == 0xdd) || (prefixByte == 0xfd))
+        {
+            // Opcode following an index prefix - DD CB d op has no more opcode fetches
+            if ((data == 0xdd) || (data == 0xfd))
+                _prefixByte = data;
+            else if (data != 0xcb)
+                _instrKind = getInstrKind(data);
+            return;
+        }
+
+        // Start of a new instruction
+        _instrAddr = addr;
+        _firstPairDone = false;
+        _lastWriteValid = false;
+        _instrKind = getInstrKind(data);
+        if ((data == 0xcb) || (data == 0xed) || (data == 0xdd) || (data == 0xfd))
+            _prefixByte = data;
+    }
+    else if (flags & BR_CTRL_BUS_WR_MASK)
+    {
+        // Check for a pair of writes to descending addresses (high byte first)
+        if (_lastWriteValid && (addr == ((_lastWriteAddr - 1) & 0xffff)))
+        {
+            uint32_t pushedVal = (_lastWriteData << 8) | (data & 0xff);
+            if (!_firstPairDone && (_instrKind == INSTR_KIND_CALL))
+                push(pushedVal, addr, CALL_STACK_FRAME_CALL);
+            else if (_firstPairDone || (_instrKind != INSTR_KIND_PUSH))
+                push(pushedVal, addr, CALL_STACK_FRAME_INT);
+            _instrKind = INSTR_KIND_OTHER;
+            _firstPairDone = true;
+            _lastWriteValid = false;
+            return;
+        }
+        _lastWriteValid = true;
+        _lastWriteAddr = addr;
+        _lastWriteData = data & 0xff;
+    }
+    else if (flags & BR_CTRL_BUS_RD_MASK)
+    {
+        // First read of a return is the low byte of the return address at SP
+        if (_instrKind == INSTR_KIND_RET)
+        {
+            while ((_depth > 0) && (_frames[_topIdx].sp <= addr))
+            {
+                _topIdx = (_topIdx + MAX_DEPTH - 1) % MAX_DEPTH;
+                _depth--;
+            }
+            _instrKind = INSTR_KIND_OTHER;
+        }
+    }
+}
+
+TargetCallStack::INSTR_KIND TargetCallStack::getInstrKind(uint32_t opcode)
+{
+    // CALL nn, CALL cc,nn and RST n
+    if ((opcode == 0xcd) || ((opcode & 0xc7) == 0xc4) || ((opcode & 0xc7) == 0xc7))
+        return INSTR_KIND_CALL;
+    // RET and RET cc
+    if ((opcode == 0xc9) || ((opcode & 0xc7) == 0xc0))
+        return INSTR_KIND_RET;
+    // PUSH rr and EX (SP),rr
+    if (((opcode & 0xcf) == 0xc5) || (opcode == 0xe3))
+        return INSTR_KIND_PUSH;
+    return INSTR_KIND_OTHER;
+}
+
+void TargetCallStack::push(uint32_t retAddr, uint32_t sp, uint32_t frameType)
+{
+    _topIdx = (_topIdx + 1) % MAX_DEPTH;
+    CallStackFrame& frame = _frames[_topIdx];
+    frame.retAddr = retAddr;
+    frame.sp = sp;
+    frame.callAddr = (frameType == CALL_STACK_FRAME_CALL) ? _instrAddr : retAddr;
+    frame.frameType = frameType;
+    if (_depth < MAX_DEPTH)
+        _depth++;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Frames
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TargetCallStack::getFrame(uint32_t idx, CallStackFrame& frame)
+{
+    if (idx >= _depth)
+        return false;
+    frame = _frames[(_topIdx + MAX_DEPTH - idx) % MAX_DEPTH];
+    return true;
+}
+
+// Frames innermost first as [retAddr,sp,callAddr,isInt]
+void TargetCallStack::getJson(char* pRespJson, int maxRespLen)
+{
+    char tmpResp[50];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"depth\":%u,\"frames\":[", _depth);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+    int curLen = strlen(pRespJson);
+    CallStackFrame frame;
+    for (uint32_t i = 0; getFrame(i, frame); i++)
+    {
+        ee_sprintf(tmpResp, "%s[%u,%u,%u,%d]", (i == 0) ? "" : ",", frame.retAddr, frame.sp, frame.callAddr,
+                    (frame.frameType == CALL_STACK_FRAME_INT) ? 1 : 0);
+        int recLen = strlen(tmpResp);
+        if (curLen + recLen + 2 > maxRespLen)
+            break;
+        strlcat(pRespJson, tmpResp, maxRespLen);
+        curLen += recLen;
+    }
+    strlcat(pRespJson, "]", maxRespLen);
+}
@@ -0,0 +1,88 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "TargetCPU.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shadow call stack
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Built from the bus cycles of the running target rather than by reading the stack so it knows
+// which stack entries are return addresses.
+// - a CALL (taken) or RST is seen as the opcode fetch followed by a pair of writes to descending
+//   addresses (return address high then low byte) - the frame records the return address and the
+//   address of the low byte (the SP after the call)
+// - any other descending pair of writes in an instruction that isn't a PUSH or EX (SP) (or a second
+//   pair after one) is the processor pushing PC for an interrupt or NMI
+// - RET, RET cc (taken), RETI and RETN are seen as the opcode fetch followed by a read - frames at
+//   or below the address read are popped so frames abandoned by stack manipulation are discarded too
+
+enum CALL_STACK_FRAME_TYPE
+{
+    CALL_STACK_FRAME_CALL,
+    CALL_STACK_FRAME_INT
+};
+
+struct CallStackFrame
+{
+    uint16_t retAddr;
+    uint16_t sp;
+    uint16_t callAddr;
+    uint8_t frameType;
+};
+
+class TargetCallStack
+{
+public:
+    TargetCallStack();
+
+    void clear();
+
+    // Handle a bus cycle of the target (not injected ones)
+    void handleBusCycle(uint32_t addr, uint32_t data, uint32_t flags);
+
+    // Depth and frames (0 is the innermost)
+    uint32_t getDepth()
+    {
+        return _depth;
+    }
+    bool getFrame(uint32_t idx, CallStackFrame& frame);
+    void getJson(char* pRespJson, int maxRespLen);
+
+    // Limits
+    static const int MAX_DEPTH = 256;
+    static const uint32_t DEPTH_ANY = 0xffffffff;
+
+private:
+    // Kind of instruction being executed
+    enum INSTR_KIND
+    {
+        INSTR_KIND_OTHER,
+        INSTR_KIND_CALL,
+        INSTR_KIND_RET,
+        INSTR_KIND_PUSH
+    };
+    static INSTR_KIND getInstrKind(uint32_t opcode);
+    void push(uint32_t retAddr, uint32_t sp, uint32_t frameType);
+
+    // Frames - when full the oldest are overwritten
+    CallStackFrame _frames[MAX_DEPTH];
+    uint32_t _topIdx;
+    uint32_t _depth;
+
+    // Current instruction
+    uint32_t _instrAddr;
+    INSTR_KIND _instrKind;
+    uint32_t _prefixByte;
+
+    // Stack write pair detection
+    bool _firstPairDone;
+    bool _lastWriteValid;
+    uint32_t _lastWriteAddr;
+    uint32_t _lastWriteData;
+};
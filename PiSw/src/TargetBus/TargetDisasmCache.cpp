@@ -0,0 +1,65 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetDisasmCache.h"
+#include <string.h>
+#include "../System/lowlib.h"
+#include "../Disassembler/src/mdZ80.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TargetDisasmCache::TargetDisasmCache()
+{
+    clear();
+}
+
+void TargetDisasmCache::clear()
+{
+    // Length 0 is never a valid entry
+    for (int i = 0; i < NUM_ENTRIES; i++)
+        _entries[i].instrLen = 0;
+    _uncachedText[0] = 0;
+    _hits = 0;
+    _misses = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassemble
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int TargetDisasmCache::disassemble(const uint8_t* pMemory, uint32_t addr, const char*& pText)
+{
+    // Instruction bytes wrapped at the top of memory (the disassembler reads up to MAX_INSTR_LEN)
+    addr &= 0xffff;
+    uint8_t instrBytes[MAX_INSTR_LEN];
+    for (int i = 0; i < MAX_INSTR_LEN; i++)
+        instrBytes[i] = pMemory[(addr + i) & 0xffff];
+
+    // Check entry is for this address and the bytes haven't changed
+    DisasmCacheEntry& entry = _entries[addr % NUM_ENTRIES];
+    if ((entry.instrLen != 0) && (entry.addr == addr) && (memcmp(entry.bytes, instrBytes, entry.instrLen) == 0))
+    {
+        _hits++;
+        pText = entry.text;
+        return entry.instrLen;
+    }
+
+    // Decode
+    _misses++;
+    int instrLen = disasmZ80(instrBytes, addr, 0, _uncachedText, INTEL, false, true);
+    pText = _uncachedText;
+    if ((instrLen <= 0) || (instrLen > MAX_INSTR_LEN) || (strlen(_uncachedText) >= (size_t)MAX_TEXT_LEN))
+    {
+        entry.instrLen = 0;
+        return instrLen;
+    }
+
+    // Store
+    entry.addr = addr;
+    entry.instrLen = instrLen;
+    memcpy(entry.bytes, instrBytes, instrLen);
+    strlcpy(entry.text, _uncachedText, MAX_TEXT_LEN);
+    return instrLen;
+}
@@ -0,0 +1,62 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Disassembly cache
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Direct mapped on the instruction address. Each entry holds the instruction bytes it was decoded
+// from so it is checked against memory on every lookup - a write to the instruction (by the target,
+// a debugger or a step back) makes the entry stale and it is decoded again.
+// Text is as disasmZ80() gives in INTEL format with the ZEsarUX layout (as used by DeZog).
+
+class TargetDisasmCache
+{
+public:
+    TargetDisasmCache();
+
+    void clear();
+
+    // Disassemble the instruction at addr in the 64K memory image - returns the instruction length
+    // and the text (valid until the next call)
+    int disassemble(const uint8_t* pMemory, uint32_t addr, const char*& pText);
+
+    // Stats
+    uint32_t getHits()
+    {
+        return _hits;
+    }
+    uint32_t getMisses()
+    {
+        return _misses;
+    }
+
+    // Limits
+    static const int NUM_ENTRIES = 1024;
+    static const int MAX_INSTR_LEN = 4;
+    static const int MAX_TEXT_LEN = 64;
+    static const int MAX_DISASSEMBLY_LEN = 300;
+
+private:
+    struct DisasmCacheEntry
+    {
+        uint16_t addr;
+        uint8_t instrLen;
+        uint8_t bytes[MAX_INSTR_LEN];
+        char text[MAX_TEXT_LEN];
+    };
+    DisasmCacheEntry _entries[NUM_ENTRIES];
+
+    // Text too long to cache
+    char _uncachedText[MAX_DISASSEMBLY_LEN];
+
+    // Stats
+    uint32_t _hits;
+    uint32_t _misses;
+};
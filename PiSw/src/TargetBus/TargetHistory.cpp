@@ -0,0 +1,348 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetHistory.h"
+#include "TargetTracker.h"
+#include "TargetMemChanges.h"
+#include "../Hardware/HwManager.h"
+#include "../System/lowlib.h"
+#include "../System/ee_sprintf.h"
+#include "../System/logging.h"
+#include "../System/rdutils.h"
+#include <stdlib.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char FromTargetHistory[] = "TargetHistory";
+
+// Sockets
+int TargetHistory::_busSocketId = -1;
+int TargetHistory::_commsSocketId = -1;
+
+// Comms socket
+CommsSocketInfo TargetHistory::_commsSocketInfo =
+{
+    true,
+    TargetHistory::handleRxMsg,
+    NULL,
+    NULL
+};
+
+// Bus socket
+BusSocketInfo TargetHistory::_busSocketInfo =
+{
+    false,
+    TargetHistory::handleWaitInterruptStatic,
+    NULL,
+    false,
+    false,
+    // Reset
+    false,
+    0,
+    // NMI
+    false,
+    0,
+    // IRQ
+    false,
+    0,
+    false,
+    BR_BUS_ACTION_GENERAL,
+    false,
+    // Opcode fetches and memory writes
+    BR_BUS_CYCLE_M1_MASK | BR_BUS_CYCLE_MREQ_WR_MASK,
+    0,
+    0,
+    "TargetHistory"
+};
+
+// Log ring
+HistoryRec TargetHistory::_log[LOG_MAX_RECS];
+uint32_t TargetHistory::_logLen = DEFAULT_LOG_RECS;
+volatile uint32_t TargetHistory::_logHeadIdx = 0;
+volatile uint32_t TargetHistory::_logCount = 0;
+
+// Checkpoints
+TargetHistory::HistoryCheckpoint TargetHistory::_checkpoints[MAX_CHECKPOINTS];
+uint32_t TargetHistory::_numCheckpoints = DEFAULT_CHECKPOINTS;
+uint32_t TargetHistory::_nextCheckpoint = 0;
+uint32_t TargetHistory::_checkpointInterval = DEFAULT_CHECKPOINT_INTERVAL;
+volatile uint32_t TargetHistory::_instrsSinceCheckpoint = 0;
+
+// State
+volatile bool TargetHistory::_isRecording = false;
+uint8_t* TargetHistory::_pMirrorMemory = NULL;
+
+// Instruction tracking
+uint32_t TargetHistory::_prefixByte = 0;
+uint32_t TargetHistory::_lastInstrAddr = 0xffffffff;
+bool TargetHistory::_writeSinceInstr = false;
+
+// Stats
+volatile uint32_t TargetHistory::_instrCount = 0;
+volatile uint32_t TargetHistory::_writeCount = 0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Init
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Must be called before HwManager::init() so writes are seen before the mirror is updated
+void TargetHistory::init()
+{
+    // Connect to the bus socket (enabled when recording)
+    if (_busSocketId < 0)
+        _busSocketId = BusAccess::busSocketAdd(_busSocketInfo);
+
+    // Connect to the comms socket
+    if (_commsSocketId < 0)
+        _commsSocketId = CommandHandler::commsSocketAdd(_commsSocketInfo);
+}
+
+void TargetHistory::service()
+{
+    // Mirror memory may change with the hardware selected
+    if (_isRecording)
+        _pMirrorMemory = HwManager::getMirrorMemForAddr(0);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Handle CommandInterface message
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Get a numeric argument (decimal or 0x hex) from the command JSON
+static uint32_t historyGetArg(const char* pCmdJson, const char* argName, uint32_t defaultVal)
+{
+    static const int MAX_ARG_STR_LEN = 20;
+    char argStr[MAX_ARG_STR_LEN+1];
+    if (!jsonGetValueForKey(argName, pCmdJson, argStr, MAX_ARG_STR_LEN) || (strlen(argStr) == 0))
+        return defaultVal;
+    return strtoul(argStr, NULL, 0);
+}
+
+bool TargetHistory::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t* pParams, [[maybe_unused]]int paramsLen,
+                char* pRespJson, int maxRespLen)
+{
+    // Get the command string from JSON
+    static const int MAX_CMD_NAME_STR = 50;
+    char cmdName[MAX_CMD_NAME_STR+1];
+    if (!jsonGetValueForKey("cmdName", pCmdJson, cmdName, MAX_CMD_NAME_STR))
+        return false;
+
+    if (strcasecmp(cmdName, "historyStart") == 0)
+    {
+        start(historyGetArg(pCmdJson, "recs", DEFAULT_LOG_RECS),
+                historyGetArg(pCmdJson, "checkpoints", DEFAULT_CHECKPOINTS),
+                historyGetArg(pCmdJson, "interval", DEFAULT_CHECKPOINT_INTERVAL));
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "historyStop") == 0)
+    {
+        stop();
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "historyStatus") == 0)
+    {
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Start/Stop
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetHistory::start(uint32_t logLen, uint32_t numCheckpoints, uint32_t checkpointInterval)
+{
+    // Stop recording while setting up
+    _isRecording = false;
+
+    // Settings
+    _logLen = (logLen < 2) ? 2 : ((logLen > LOG_MAX_RECS) ? LOG_MAX_RECS : logLen);
+    _numCheckpoints = (numCheckpoints < 1) ? 1 : ((numCheckpoints > MAX_CHECKPOINTS) ? MAX_CHECKPOINTS : numCheckpoints);
+    _checkpointInterval = checkpointInterval;
+    clear();
+
+    // Start recording
+    _pMirrorMemory = HwManager::getMirrorMemForAddr(0);
+    _isRecording = true;
+    if (_busSocketId >= 0)
+    {
+        BusAccess::waitOnMemory(_busSocketId, true);
+        BusAccess::busSocketEnable(_busSocketId, true);
+    }
+    LogWrite(FromTargetHistory, LOG_DEBUG, "Start recs %u checkpoints %u interval %u",
+                _logLen, _numCheckpoints, _checkpointInterval);
+}
+
+void TargetHistory::stop()
+{
+    _isRecording = false;
+    if (_busSocketId >= 0)
+    {
+        BusAccess::waitOnMemory(_busSocketId, false);
+        BusAccess::busSocketEnable(_busSocketId, false);
+    }
+}
+
+void TargetHistory::clear()
+{
+    _logHeadIdx = 0;
+    _logCount = 0;
+    _nextCheckpoint = 0;
+    for (uint32_t i = 0; i < _numCheckpoints; i++)
+        _checkpoints[i].logIdx = 0xffffffff;
+    _instrsSinceCheckpoint = 0;
+    _prefixByte = 0;
+    _lastInstrAddr = 0xffffffff;
+    _writeSinceInstr = false;
+    _instrCount = 0;
+    _writeCount = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bus cycles
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetHistory::handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+            uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+{
+    // Injected cycles aren't the target's
+    if (TargetTracker::isInjecting())
+    {
+        _prefixByte = 0;
+        return;
+    }
+    handleBusCycle(addr, data, flags);
+}
+
+void TargetHistory::handleBusCycle(uint32_t addr, uint32_t data, uint32_t flags)
+{
+    if (!_isRecording)
+        return;
+
+    if (flags & BR_CTRL_BUS_M1_MASK)
+    {
+        // Interrupt acknowledge
+        if (flags & BR_CTRL_BUS_IORQ_MASK)
+            return;
+
+        // Opcode following a prefix - an index prefix may be followed by another
+        uint32_t prefixByte = _prefixByte;
+        _prefixByte = 0;
+        if (prefixByte != 0)
+        {
+            if (((prefixByte == 0xdd) || (prefixByte == 0xfd)) && ((data == 0xdd) || (data == 0xfd)))
+                _prefixByte = data;
+            return;
+        }
+
+        // Start of a new instruction
+        if ((data == 0xcb) || (data == 0xed) || (data == 0xdd) || (data == 0xfd))
+            _prefixByte = data;
+        if ((addr == _lastInstrAddr) && !_writeSinceInstr)
+            return;
+        addRec(addr, 0, HISTORY_REC_INSTR);
+        _lastInstrAddr = addr;
+        _writeSinceInstr = false;
+        _instrsSinceCheckpoint++;
+        _instrCount++;
+    }
+    else if ((flags & BR_CTRL_BUS_WR_MASK) && (flags & BR_CTRL_BUS_MREQ_MASK) && _pMirrorMemory)
+    {
+        // Previous value of the byte
+        addRec(addr, _pMirrorMemory[addr & 0xffff], HISTORY_REC_WRITE);
+        _writeSinceInstr = true;
+        _writeCount++;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Checkpoints
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetHistory::recordCheckpoint(const Z80Registers& regs)
+{
+    if (!_isRecording)
+        return;
+    HistoryCheckpoint& checkpoint = _checkpoints[_nextCheckpoint];
+    checkpoint.regs = regs;
+    checkpoint.logIdx = _logHeadIdx;
+    addRec(_nextCheckpoint, 0, HISTORY_REC_CHECKPOINT);
+    _nextCheckpoint++;
+    if (_nextCheckpoint >= _numCheckpoints)
+        _nextCheckpoint = 0;
+
+    // Registers are now known at this address
+    _lastInstrAddr = regs.PC;
+    _writeSinceInstr = false;
+    _instrsSinceCheckpoint = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Step back
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TargetHistory::rollBack(Z80Registers& regs)
+{
+    // Find the previous checkpoint with an instruction after it
+    uint32_t recIdx = _logHeadIdx;
+    uint32_t numRecs = 0;
+    bool instrSeen = false;
+    bool found = false;
+    while (numRecs < _logCount)
+    {
+        recIdx = prevIdx(recIdx);
+        HistoryRec& rec = _log[recIdx];
+        if (rec.recType == HISTORY_REC_INSTR)
+        {
+            instrSeen = true;
+        }
+        else if ((rec.recType == HISTORY_REC_CHECKPOINT) && instrSeen && (rec.addr < _numCheckpoints) &&
+                    (_checkpoints[rec.addr].logIdx == recIdx))
+        {
+            found = true;
+            break;
+        }
+        numRecs++;
+    }
+    if (!found)
+        return false;
+
+    // Undo writes (most recent first) and remove the records after the checkpoint
+    for (uint32_t i = 0; i < numRecs; i++)
+    {
+        _logHeadIdx = prevIdx(_logHeadIdx);
+        _logCount--;
+        HistoryRec& rec = _log[_logHeadIdx];
+        if (rec.recType == HISTORY_REC_WRITE)
+        {
+            HwManager::blockWrite(rec.addr, &rec.val, 1, false, false, true);
+            TargetMemChanges::handleMemWrite(rec.addr, &rec.val, 1);
+        }
+    }
+
+    // Checkpoint stays in the log so stepping back again goes further
+    regs = _checkpoints[_log[recIdx].addr].regs;
+    _lastInstrAddr = regs.PC;
+    _writeSinceInstr = false;
+    _prefixByte = 0;
+    _instrsSinceCheckpoint = 0;
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetHistory::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    char tmpResp[200];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"recording\":%d,\"recs\":%u,\"maxRecs\":%u,\"checkpoints\":%u,\"interval\":%u,\"instrs\":%u,\"writes\":%u",
+                _isRecording ? 1 : 0, _logCount, _logLen, _numCheckpoints, _checkpointInterval, _instrCount, _writeCount);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+}
@@ -0,0 +1,154 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../CommandInterface/CommandHandler.h"
+#include "BusAccess.h"
+#include "TargetRegisters.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Execution history - records enough of the target's bus cycles to step backwards
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// The log is a ring of 4 byte records:
+// - INSTR - the address of the first opcode fetch of each instruction
+// - WRITE - the address and previous value of each memory byte written (read from the mirror
+//   before HwManager updates it - so the bus socket must be added before HwManager's)
+// - CHECKPOINT - the index of a set of registers grabbed by the tracker
+// Stepping back undoes the writes logged after the previous checkpoint and returns its registers.
+// Storage is static and the active lengths are set when recording starts so the recording path
+// doesn't allocate and the memory used is bounded.
+
+enum HISTORY_REC_TYPE
+{
+    HISTORY_REC_INSTR,
+    HISTORY_REC_WRITE,
+    HISTORY_REC_CHECKPOINT
+};
+
+#pragma pack(push, 1)
+struct HistoryRec
+{
+    uint16_t addr;
+    uint8_t val;
+    uint8_t recType;
+};
+#pragma pack(pop)
+
+class TargetHistory
+{
+public:
+    static void init();
+    static void service();
+
+    // Control - lengths are clipped to the maximums, checkpointInterval is the number of instructions
+    // run before a register grab is requested (0 = only when the tracker grabs anyway)
+    static void start(uint32_t logLen, uint32_t numCheckpoints, uint32_t checkpointInterval);
+    static void stop();
+    static void clear();
+    static bool isRecording()
+    {
+        return _isRecording;
+    }
+    static uint32_t getNumRecs()
+    {
+        return _logCount;
+    }
+
+    // Handle a bus cycle - called from the bus socket
+    static void handleBusCycle(uint32_t addr, uint32_t data, uint32_t flags);
+
+    // Checkpoints - recorded by the tracker when registers have been grabbed or set
+    static void recordCheckpoint(const Z80Registers& regs);
+    static bool isCheckpointDue()
+    {
+        return _isRecording && (_checkpointInterval != 0) && (_instrsSinceCheckpoint >= _checkpointInterval);
+    }
+
+    // Undo the writes back to the previous checkpoint (at least one instruction back) and get
+    // its registers - returns false (with nothing changed) if there isn't one in the log
+    static bool rollBack(Z80Registers& regs);
+
+    // Status
+    static void getStatusJson(char* pRespJson, int maxRespLen);
+
+    // Limits
+    static const int LOG_MAX_RECS = 262144;
+    static const int MAX_CHECKPOINTS = 4096;
+    static const int DEFAULT_LOG_RECS = 65536;
+    static const int DEFAULT_CHECKPOINTS = 1024;
+    static const int DEFAULT_CHECKPOINT_INTERVAL = 1000;
+
+private:
+    // Bus socket we're attached to and setup info
+    static int _busSocketId;
+    static BusSocketInfo _busSocketInfo;
+
+    // Comms socket we're attached to and setup info
+    static int _commsSocketId;
+    static CommsSocketInfo _commsSocketInfo;
+
+    // Handle messages (telling us to start/stop)
+    static bool handleRxMsg(const char* pCmdJson, const uint8_t* pParams, int paramsLen,
+                    char* pRespJson, int maxRespLen);
+
+    // Wait interrupt handler
+    static void handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+            uint32_t flags, uint32_t& retVal);
+
+    // Add a record (overwriting the oldest when full)
+    static void addRec(uint32_t addr, uint32_t val, uint32_t recType)
+    {
+        HistoryRec& rec = _log[_logHeadIdx];
+        rec.addr = addr;
+        rec.val = val;
+        rec.recType = recType;
+        _logHeadIdx++;
+        if (_logHeadIdx >= _logLen)
+            _logHeadIdx = 0;
+        if (_logCount < _logLen)
+            _logCount++;
+    }
+    static uint32_t prevIdx(uint32_t idx)
+    {
+        return (idx == 0) ? _logLen - 1 : idx - 1;
+    }
+
+    // Log ring
+    static HistoryRec _log[LOG_MAX_RECS];
+    static uint32_t _logLen;
+    static volatile uint32_t _logHeadIdx;
+    static volatile uint32_t _logCount;
+
+    // Checkpoints - each records the log index of its CHECKPOINT record so one that has been
+    // reused can be detected
+    struct HistoryCheckpoint
+    {
+        Z80Registers regs;
+        uint32_t logIdx;
+    };
+    static HistoryCheckpoint _checkpoints[MAX_CHECKPOINTS];
+    static uint32_t _numCheckpoints;
+    static uint32_t _nextCheckpoint;
+    static uint32_t _checkpointInterval;
+    static volatile uint32_t _instrsSinceCheckpoint;
+
+    // State
+    static volatile bool _isRecording;
+    static uint8_t* _pMirrorMemory;
+
+    // Instruction tracking - opcode fetches following a prefix aren't new instructions and a
+    // fetch at the same address with no writes since the last INSTR or CHECKPOINT is a re-fetch
+    // after register injection
+    static uint32_t _prefixByte;
+    static uint32_t _lastInstrAddr;
+    static bool _writeSinceInstr;
+
+    // Stats
+    static volatile uint32_t _instrCount;
+    static volatile uint32_t _writeCount;
+};
@@ -0,0 +1,308 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetMemChanges.h"
+#include "TargetTracker.h"
+#include "../Hardware/HwManager.h"
+#include "../System/lowlib.h"
+#include "../System/ee_sprintf.h"
+#include "../System/logging.h"
+#include "../System/rdutils.h"
+#include <string.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char FromTargetMemChanges[] = "TargetMemChanges";
+
+// Sockets
+int TargetMemChanges::_busSocketId = -1;
+int TargetMemChanges::_commsSocketId = -1;
+
+// Comms socket
+CommsSocketInfo TargetMemChanges::_commsSocketInfo =
+{
+    true,
+    TargetMemChanges::handleRxMsg,
+    NULL,
+    NULL
+};
+
+// Bus socket
+BusSocketInfo TargetMemChanges::_busSocketInfo =
+{
+    false,
+    TargetMemChanges::handleWaitInterruptStatic,
+    NULL,
+    false,
+    false,
+    // Reset
+    false,
+    0,
+    // NMI
+    false,
+    0,
+    // IRQ
+    false,
+    0,
+    false,
+    BR_BUS_ACTION_GENERAL,
+    false,
+    // Memory writes
+    BR_BUS_CYCLE_MREQ_WR_MASK,
+    0,
+    0,
+    "TargetMemChanges"
+};
+
+// Memory
+uint8_t TargetMemChanges::_memImage[STD_TARGET_MEMORY_LEN];
+uint8_t TargetMemChanges::_memPushed[STD_TARGET_MEMORY_LEN];
+
+// Dirty pages
+volatile uint8_t TargetMemChanges::_pageDirty[NUM_PAGES];
+uint32_t TargetMemChanges::_nextPage = 0;
+
+// State
+volatile bool TargetMemChanges::_isSubscribed = false;
+
+// Stats
+volatile uint32_t TargetMemChanges::_writeCount = 0;
+uint32_t TargetMemChanges::_framesSent = 0;
+uint32_t TargetMemChanges::_pagesSent = 0;
+uint32_t TargetMemChanges::_bytesSent = 0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Init
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetMemChanges::init()
+{
+    // Connect to the bus socket (enabled when subscribed)
+    if (_busSocketId < 0)
+        _busSocketId = BusAccess::busSocketAdd(_busSocketInfo);
+
+    // Connect to the comms socket
+    if (_commsSocketId < 0)
+        _commsSocketId = CommandHandler::commsSocketAdd(_commsSocketInfo);
+}
+
+void TargetMemChanges::service()
+{
+    if (!_isSubscribed)
+        return;
+    sendFrame();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Handle CommandInterface message
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TargetMemChanges::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t* pParams, [[maybe_unused]]int paramsLen,
+                char* pRespJson, int maxRespLen)
+{
+    // Get the command string from JSON
+    static const int MAX_CMD_NAME_STR = 50;
+    char cmdName[MAX_CMD_NAME_STR+1];
+    if (!jsonGetValueForKey("cmdName", pCmdJson, cmdName, MAX_CMD_NAME_STR))
+        return false;
+
+    if (strcasecmp(cmdName, "memChangesSubscribe") == 0)
+    {
+        subscribe();
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "memChangesUnsubscribe") == 0)
+    {
+        unsubscribe();
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "memChangesStatus") == 0)
+    {
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Subscribe
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetMemChanges::subscribe()
+{
+    // Stop tracking while setting up
+    _isSubscribed = false;
+
+    // Start from the mirror memory (the debugger reads memory when it subscribes)
+    uint8_t* pMirrorMemory = HwManager::getMirrorMemForAddr(0);
+    if (pMirrorMemory)
+        memcpy(_memImage, pMirrorMemory, STD_TARGET_MEMORY_LEN);
+    else
+        memset(_memImage, 0, STD_TARGET_MEMORY_LEN);
+    memcpy(_memPushed, _memImage, STD_TARGET_MEMORY_LEN);
+    for (uint32_t i = 0; i < NUM_PAGES; i++)
+        _pageDirty[i] = 0;
+    _nextPage = 0;
+    _writeCount = 0;
+    _framesSent = 0;
+    _pagesSent = 0;
+    _bytesSent = 0;
+
+    // Start tracking
+    _isSubscribed = true;
+    if (_busSocketId >= 0)
+    {
+        BusAccess::waitOnMemory(_busSocketId, true);
+        BusAccess::busSocketEnable(_busSocketId, true);
+    }
+    LogWrite(FromTargetMemChanges, LOG_DEBUG, "Subscribed");
+}
+
+void TargetMemChanges::unsubscribe()
+{
+    _isSubscribed = false;
+    if (_busSocketId >= 0)
+    {
+        BusAccess::waitOnMemory(_busSocketId, false);
+        BusAccess::busSocketEnable(_busSocketId, false);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Bus cycles
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetMemChanges::handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+            uint32_t flags, [[maybe_unused]] uint32_t& retVal)
+{
+    // Injected cycles aren't the target's
+    if (TargetTracker::isInjecting())
+        return;
+    handleBusCycle(addr, data, flags);
+}
+
+void TargetMemChanges::handleBusCycle(uint32_t addr, uint32_t data, uint32_t flags)
+{
+    if (!_isSubscribed || !(flags & BR_CTRL_BUS_WR_MASK) || !(flags & BR_CTRL_BUS_MREQ_MASK))
+        return;
+    addr &= STD_TARGET_MEMORY_LEN - 1;
+    _memImage[addr] = data;
+    _pageDirty[addr / PAGE_LEN] = 1;
+    _writeCount++;
+}
+
+void TargetMemChanges::handleMemWrite(uint32_t addr, const uint8_t* pData, uint32_t len)
+{
+    if (!_isSubscribed)
+        return;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        uint32_t memAddr = (addr + i) & (STD_TARGET_MEMORY_LEN - 1);
+        _memImage[memAddr] = pData[i];
+        _pageDirty[memAddr / PAGE_LEN] = 1;
+    }
+    _writeCount += len;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Send changes
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TargetMemChanges::sendFrame()
+{
+    // Page records are no longer than this as ranges are separated by more than MAX_RANGE_GAP
+    static const uint32_t MAX_PAGE_REC_LEN = 2 + PAGE_LEN + 2 * (PAGE_LEN / 2);
+    if (!_isSubscribed || (CommandHandler::getTxAvailable() < MIN_TX_AVAILABLE_FOR_FRAME))
+        return false;
+
+    // Add dirty pages in turn
+    uint8_t frame[MAX_BYTES_PER_FRAME];
+    uint32_t frameLen = 0;
+    uint32_t numPages = 0;
+    for (uint32_t i = 0; (i < NUM_PAGES) && (frameLen + MAX_PAGE_REC_LEN <= MAX_BYTES_PER_FRAME); i++)
+    {
+        uint32_t page = _nextPage;
+        _nextPage = (_nextPage + 1) % NUM_PAGES;
+        if (!_pageDirty[page])
+            continue;
+
+        // Clear before comparing so a write during the comparison marks it again
+        _pageDirty[page] = 0;
+        uint32_t recLen = addPageRec(page, frame + frameLen);
+        if (recLen == 0)
+            continue;
+        frameLen += recLen;
+        numPages++;
+    }
+    if (numPages == 0)
+        return false;
+
+    // Send
+    char jsonResp[50];
+    ee_sprintf(jsonResp, "\"pages\":%u", numPages);
+    CommandHandler::sendWithJSON("memChanges", jsonResp, 0, frame, frameLen);
+    _framesSent++;
+    _pagesSent += numPages;
+    _bytesSent += frameLen;
+    return true;
+}
+
+uint32_t TargetMemChanges::addPageRec(uint32_t page, uint8_t* pRec)
+{
+    uint8_t* pImage = _memImage + page * PAGE_LEN;
+    uint8_t* pPushed = _memPushed + page * PAGE_LEN;
+    uint32_t recLen = 2;
+    uint32_t numRanges = 0;
+    uint32_t offset = 0;
+    while (offset < PAGE_LEN)
+    {
+        // Next changed byte
+        if (pImage[offset] == pPushed[offset])
+        {
+            offset++;
+            continue;
+        }
+
+        // Extend the range over changes separated by short gaps
+        uint32_t rangeStart = offset;
+        uint32_t rangeEnd = offset + 1;
+        for (uint32_t i = rangeEnd; (i < PAGE_LEN) && (i <= rangeEnd + MAX_RANGE_GAP); i++)
+            if (pImage[i] != pPushed[i])
+                rangeEnd = i + 1;
+
+        // Add range (values are copied from the image as pushed)
+        uint32_t rangeLen = rangeEnd - rangeStart;
+        pRec[recLen++] = rangeStart;
+        pRec[recLen++] = rangeLen - 1;
+        for (uint32_t i = rangeStart; i < rangeEnd; i++)
+        {
+            uint8_t val = pImage[i];
+            pRec[recLen++] = val;
+            pPushed[i] = val;
+        }
+        numRanges++;
+        offset = rangeEnd;
+    }
+    if (numRanges == 0)
+        return 0;
+    pRec[0] = page;
+    pRec[1] = numRanges;
+    return recLen;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetMemChanges::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    char tmpResp[200];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"subscribed\":%d,\"writes\":%u,\"frames\":%u,\"pages\":%u,\"bytes\":%u",
+                _isSubscribed ? 1 : 0, _writeCount, _framesSent, _pagesSent, _bytesSent);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+}
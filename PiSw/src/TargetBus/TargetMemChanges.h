@@ -0,0 +1,95 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "../CommandInterface/CommandHandler.h"
+#include "BusAccess.h"
+#include "TargetCPU.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Memory changes - pushes the bytes changed by target memory writes to a subscribed debugger
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Memory writes seen on the bus (or made by the debugger) update an image of target memory and mark
+// its 256 byte page dirty.
+// When there is space to send, dirty pages are compared with the memory last pushed and the changes
+// are sent in "memChanges" frames whose binary part is a sequence of page records:
+//   page(1) numRanges(1) then for each range - offset(1) len-1(1) bytes(len)
+// Ranges separated by only a couple of unchanged bytes are merged as a range costs 2 bytes.
+// The image starts as a copy of the mirror memory when subscribing.
+
+class TargetMemChanges
+{
+public:
+    static void init();
+    static void service();
+
+    // Control
+    static void subscribe();
+    static void unsubscribe();
+    static bool isSubscribed()
+    {
+        return _isSubscribed;
+    }
+
+    // Handle a bus cycle - called from the bus socket
+    static void handleBusCycle(uint32_t addr, uint32_t data, uint32_t flags);
+
+    // Handle memory written other than by the processor (debugger writes, stepping back)
+    static void handleMemWrite(uint32_t addr, const uint8_t* pData, uint32_t len);
+
+    // Send a frame of changes if any pages are dirty and there is space - returns false if not sent
+    static bool sendFrame();
+
+    // Status
+    static void getStatusJson(char* pRespJson, int maxRespLen);
+
+    // Limits
+    static const uint32_t PAGE_LEN = 256;
+    static const uint32_t NUM_PAGES = STD_TARGET_MEMORY_LEN / PAGE_LEN;
+    static const uint32_t MAX_RANGE_GAP = 2;
+    static const uint32_t MAX_BYTES_PER_FRAME = 8000;
+    static const uint32_t MIN_TX_AVAILABLE_FOR_FRAME = 12000;
+
+private:
+    // Bus socket we're attached to and setup info
+    static int _busSocketId;
+    static BusSocketInfo _busSocketInfo;
+
+    // Comms socket we're attached to and setup info
+    static int _commsSocketId;
+    static CommsSocketInfo _commsSocketInfo;
+
+    // Handle messages (telling us to subscribe/unsubscribe)
+    static bool handleRxMsg(const char* pCmdJson, const uint8_t* pParams, int paramsLen,
+                    char* pRespJson, int maxRespLen);
+
+    // Wait interrupt handler
+    static void handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+            uint32_t flags, uint32_t& retVal);
+
+    // Add a page record for the changes in a page - returns the record length (0 if unchanged)
+    static uint32_t addPageRec(uint32_t page, uint8_t* pRec);
+
+    // Memory image updated by bus writes and as last pushed
+    static uint8_t _memImage[STD_TARGET_MEMORY_LEN];
+    static uint8_t _memPushed[STD_TARGET_MEMORY_LEN];
+
+    // Dirty flags - a byte per page so setting one in the bus socket and clearing it in service
+    // don't interfere
+    static volatile uint8_t _pageDirty[NUM_PAGES];
+    static uint32_t _nextPage;
+
+    // State
+    static volatile bool _isSubscribed;
+
+    // Stats
+    static volatile uint32_t _writeCount;
+    static uint32_t _framesSent;
+    static uint32_t _pagesSent;
+    static uint32_t _bytesSent;
+};
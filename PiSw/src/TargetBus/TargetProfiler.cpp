@@ -0,0 +1,377 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetProfiler.h"
+#include "../Hardware/HwManager.h"
+#include "TargetTracker.h"
+#include "../System/ee_sprintf.h"
+#include "../System/logging.h"
+#include "../System/rdutils.h"
+#include <string.h>
+#include <stdlib.h>
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char FromTargetProfiler[] = "TargetProfiler";
+
+// Sockets
+int TargetProfiler::_busSocketId = -1;
+int TargetProfiler::_commsSocketId = -1;
+
+// Comms socket
+CommsSocketInfo TargetProfiler::_commsSocketInfo =
+{
+    true,
+    TargetProfiler::handleRxMsg,
+    NULL,
+    NULL
+};
+
+// Bus socket
+BusSocketInfo TargetProfiler::_busSocketInfo =
+{
+    false,
+    TargetProfiler::handleWaitInterruptStatic,
+    TargetProfiler::busActionCompleteStatic,
+    false,
+    false,
+    // Reset
+    false,
+    0,
+    // NMI
+    false,
+    0,
+    // IRQ
+    false,
+    0,
+    false,
+    BR_BUS_ACTION_GENERAL,
+    false,
+    // Opcode fetches only
+    BR_BUS_CYCLE_M1_MASK,
+    0,
+    0,
+    "TargetProfiler"
+};
+
+// Hit counts
+uint32_t TargetProfiler::_hits[NUM_ADDRS];
+volatile uint32_t TargetProfiler::_totalHits = 0;
+
+// Mode and state
+volatile TargetProfiler::PROFILER_MODE TargetProfiler::_mode = PROFILER_MODE_OFF;
+volatile bool TargetProfiler::_samplePending = false;
+volatile bool TargetProfiler::_sampleWaitsOn = false;
+uint32_t TargetProfiler::_prevFetchAddr = 0;
+bool TargetProfiler::_prevFetchWasPrefix = false;
+
+// Stats
+uint32_t TargetProfiler::_sampleReqs = 0;
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Init
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetProfiler::init()
+{
+    clear();
+
+    // Connect to the comms socket
+    if (_commsSocketId < 0)
+        _commsSocketId = CommandHandler::commsSocketAdd(_commsSocketInfo);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Handle CommandInterface message
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TargetProfiler::handleRxMsg(const char* pCmdJson, [[maybe_unused]]const uint8_t* pParams, [[maybe_unused]]int paramsLen,
+                char* pRespJson, int maxRespLen)
+{
+    // Get the command string from JSON
+    static const int MAX_CMD_NAME_STR = 50;
+    char cmdName[MAX_CMD_NAME_STR+1];
+    if (!jsonGetValueForKey("cmdName", pCmdJson, cmdName, MAX_CMD_NAME_STR))
+        return false;
+
+    if (strcasecmp(cmdName, "profStart") == 0)
+    {
+        char modeStr[MAX_CMD_NAME_STR+1];
+        bool sampled = jsonGetValueForKey("mode", pCmdJson, modeStr, MAX_CMD_NAME_STR) &&
+                    (strcasecmp(modeStr, "sampled") == 0);
+        start(sampled ? PROFILER_MODE_SAMPLED : PROFILER_MODE_COUNT);
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "profStop") == 0)
+    {
+        stop();
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "profClear") == 0)
+    {
+        clear();
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "profStatus") == 0)
+    {
+        getStatusJson(pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "profTop") == 0)
+    {
+        static const uint32_t DEFAULT_TOP_N = 16;
+        static const int MAX_ARG_STR_LEN = 20;
+        char argStr[MAX_ARG_STR_LEN+1];
+        uint32_t topN = DEFAULT_TOP_N;
+        if (jsonGetValueForKey("n", pCmdJson, argStr, MAX_ARG_STR_LEN) && (strlen(argStr) != 0))
+            topN = strtoul(argStr, NULL, 0);
+        getTopJson(topN, HwManager::getMirrorMemForAddr(0), pRespJson, maxRespLen);
+        return true;
+    }
+    else if (strcasecmp(cmdName, "profRanges") == 0)
+    {
+        static const int MAX_RANGES_STR_LEN = 400;
+        char rangesStr[MAX_RANGES_STR_LEN+1];
+        rangesStr[0] = 0;
+        jsonGetValueForKey("ranges", pCmdJson, rangesStr, MAX_RANGES_STR_LEN);
+        getRangesJson(rangesStr, HwManager::getMirrorMemForAddr(0), pRespJson, maxRespLen);
+        return true;
+    }
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Start/Stop/Clear
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetProfiler::start(PROFILER_MODE mode)
+{
+    // Counts carry on from any previous run until cleared
+    _samplePending = false;
+    _sampleWaitsOn = false;
+    _prevFetchWasPrefix = false;
+    _mode = mode;
+    if (_busSocketId < 0)
+        _busSocketId = BusAccess::busSocketAdd(_busSocketInfo);
+    BusAccess::waitOnMemory(_busSocketId, mode == PROFILER_MODE_COUNT);
+    BusAccess::busSocketEnable(_busSocketId, mode != PROFILER_MODE_OFF);
+    LogWrite(FromTargetProfiler, LOG_DEBUG, "Start mode %s", (mode == PROFILER_MODE_SAMPLED) ? "sampled" : "count");
+}
+
+void TargetProfiler::stop()
+{
+    _mode = PROFILER_MODE_OFF;
+    _samplePending = false;
+    _sampleWaitsOn = false;
+    if (_busSocketId < 0)
+        return;
+    BusAccess::waitOnMemory(_busSocketId, false);
+    BusAccess::busSocketEnable(_busSocketId, false);
+}
+
+void TargetProfiler::clear()
+{
+    memset(_hits, 0, sizeof(_hits));
+    _totalHits = 0;
+    _sampleReqs = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Wait interrupt handler
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetProfiler::handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+        [[maybe_unused]] uint32_t flags, uint32_t& retVal)
+{
+    addr &= 0xffff;
+    if (_mode == PROFILER_MODE_SAMPLED)
+    {
+        // Only the first fetch after a display refresh
+        if (!_samplePending)
+            return;
+        _samplePending = false;
+    }
+    else if (_mode == PROFILER_MODE_COUNT)
+    {
+        // Opcode is what a bus socket placed on the bus if the cycle was decoded - the fetch
+        // after a prefix is part of the same instruction
+        uint32_t opcode = ((retVal & BR_MEM_ACCESS_RSLT_NOT_DECODED) == 0) ? (retVal & 0xff) : (data & 0xff);
+        bool afterPrefix = _prevFetchWasPrefix && (addr == ((_prevFetchAddr + 1) & 0xffff));
+        _prevFetchAddr = addr;
+        _prevFetchWasPrefix = !afterPrefix &&
+                    ((opcode == 0xcb) || (opcode == 0xdd) || (opcode == 0xed) || (opcode == 0xfd));
+        if (afterPrefix)
+            return;
+    }
+    else
+    {
+        return;
+    }
+
+    // Count
+    if (_hits[addr] != 0xffffffff)
+        _hits[addr]++;
+    _totalHits++;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sampled mode - waits on memory from each display refresh until the next opcode fetch
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetProfiler::busActionCompleteStatic(BR_BUS_ACTION actionType, BR_BUS_ACTION_REASON reason)
+{
+    if ((_mode != PROFILER_MODE_SAMPLED) || (actionType != BR_BUS_ACTION_BUSRQ) || (reason != BR_BUS_ACTION_DISPLAY))
+        return;
+    _sampleReqs++;
+    _samplePending = true;
+    if (!_sampleWaitsOn)
+    {
+        _sampleWaitsOn = true;
+        BusAccess::waitOnMemory(_busSocketId, true);
+    }
+}
+
+void TargetProfiler::service()
+{
+    // Waits aren't needed once the sample is taken
+    if (_sampleWaitsOn && !_samplePending)
+    {
+        _sampleWaitsOn = false;
+        BusAccess::waitOnMemory(_busSocketId, false);
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reports
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetProfiler::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    static const char* modeNames[] = { "off", "count", "sampled" };
+    uint32_t addrsHit = 0;
+    for (uint32_t addr = 0; addr < NUM_ADDRS; addr++)
+        if (_hits[addr] != 0)
+            addrsHit++;
+    char tmpResp[200];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"mode\":\"%s\",\"total\":%u,\"addrsHit\":%u,\"sampleReqs\":%u",
+                modeNames[_mode], _totalHits, addrsHit, _sampleReqs);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+}
+
+void TargetProfiler::addDisassembly(const uint8_t* pMemory, uint32_t addr, char* pRespJson, int maxRespLen)
+{
+    // Text (from the tracker's disassembly cache) is the address then the instruction up to a tab
+    // and comment - only the instruction is used and quotes and backslashes would break the JSON
+    const char* pInstr = "";
+    if (pMemory)
+        TargetTracker::getDisasmCache().disassemble(pMemory, addr, pInstr);
+    while (*pInstr == ' ')
+        pInstr++;
+    while (*pInstr && (*pInstr != ' '))
+        pInstr++;
+    while (*pInstr == ' ')
+        pInstr++;
+    char instrStr[100];
+    int instrLen = 0;
+    for (; *pInstr && (*pInstr != '\t') && (*pInstr != '\n') && (instrLen < (int)sizeof(instrStr) - 1); pInstr++)
+        instrStr[instrLen++] = ((*pInstr == '"') || (*pInstr == '\\')) ? '\'' : *pInstr;
+    instrStr[instrLen] = 0;
+    strlcat(pRespJson, ",\"", maxRespLen);
+    strlcat(pRespJson, instrStr, maxRespLen);
+    strlcat(pRespJson, "\"", maxRespLen);
+}
+
+void TargetProfiler::getTopJson(uint32_t topN, const uint8_t* pMemory, char* pRespJson, int maxRespLen)
+{
+    // Most hit addresses in descending order (lower address first for equal hits)
+    if (topN > MAX_TOP_N)
+        topN = MAX_TOP_N;
+    uint32_t topAddrs[MAX_TOP_N];
+    uint32_t topHits[MAX_TOP_N];
+    uint32_t numTop = 0;
+    for (uint32_t addr = 0; addr < NUM_ADDRS; addr++)
+    {
+        uint32_t hits = _hits[addr];
+        if ((hits == 0) || ((numTop == topN) && (hits <= topHits[numTop - 1])))
+            continue;
+        uint32_t pos = (numTop < topN) ? numTop++ : numTop - 1;
+        while ((pos > 0) && (topHits[pos - 1] < hits))
+        {
+            topAddrs[pos] = topAddrs[pos - 1];
+            topHits[pos] = topHits[pos - 1];
+            pos--;
+        }
+        topAddrs[pos] = addr;
+        topHits[pos] = hits;
+    }
+
+    // Each entry is [addr, hits, disassembly]
+    char tmpStr[100];
+    ee_sprintf(tmpStr, "\"err\":\"ok\",\"total\":%u,\"top\":[", _totalHits);
+    strlcpy(pRespJson, tmpStr, maxRespLen);
+    for (uint32_t i = 0; i < numTop; i++)
+    {
+        ee_sprintf(tmpStr, "%s[\"%04x\",%u", (i == 0) ? "" : ",", topAddrs[i], topHits[i]);
+        strlcat(pRespJson, tmpStr, maxRespLen);
+        addDisassembly(pMemory, topAddrs[i], pRespJson, maxRespLen);
+        strlcat(pRespJson, "]", maxRespLen);
+    }
+    strlcat(pRespJson, "]", maxRespLen);
+}
+
+void TargetProfiler::getRangesJson(const char* pRangesStr, const uint8_t* pMemory, char* pRespJson, int maxRespLen)
+{
+    // Ranges are inclusive hex start-end pairs separated by commas - e.g. "0100-017f,0200-02ff"
+    uint32_t rangeStarts[MAX_RANGES];
+    uint32_t rangeEnds[MAX_RANGES];
+    int numRanges = 0;
+    const char* pStr = pRangesStr;
+    while (*pStr && (numRanges < MAX_RANGES))
+    {
+        char* pEnd = NULL;
+        rangeStarts[numRanges] = strtoul(pStr, &pEnd, 16);
+        if ((pEnd == pStr) || (*pEnd != '-'))
+            break;
+        pStr = pEnd + 1;
+        rangeEnds[numRanges] = strtoul(pStr, &pEnd, 16);
+        if ((pEnd == pStr) || (rangeEnds[numRanges] < rangeStarts[numRanges]) || (rangeEnds[numRanges] >= NUM_ADDRS))
+            break;
+        numRanges++;
+        pStr = pEnd;
+        if (*pStr == ',')
+            pStr++;
+    }
+    if ((numRanges == 0) || (*pStr != 0))
+    {
+        strlcpy(pRespJson, "\"err\":\"invalidRanges\"", maxRespLen);
+        return;
+    }
+
+    // Each entry is [start, end, hits, hottest addr, its hits, its disassembly]
+    char tmpStr[100];
+    ee_sprintf(tmpStr, "\"err\":\"ok\",\"total\":%u,\"ranges\":[", _totalHits);
+    strlcpy(pRespJson, tmpStr, maxRespLen);
+    for (int i = 0; i < numRanges; i++)
+    {
+        uint32_t rangeHits = 0;
+        uint32_t hotAddr = rangeStarts[i];
+        for (uint32_t addr = rangeStarts[i]; addr <= rangeEnds[i]; addr++)
+        {
+            rangeHits += _hits[addr];
+            if (_hits[addr] > _hits[hotAddr])
+                hotAddr = addr;
+        }
+        ee_sprintf(tmpStr, "%s[\"%04x\",\"%04x\",%u,\"%04x\",%u", (i == 0) ? "" : ",",
+                    rangeStarts[i], rangeEnds[i], rangeHits, hotAddr, _hits[hotAddr]);
+        strlcat(pRespJson, tmpStr, maxRespLen);
+        addDisassembly(pMemory, hotAddr, pRespJson, maxRespLen);
+        strlcat(pRespJson, "]", maxRespLen);
+    }
+    strlcat(pRespJson, "]", maxRespLen);
+}
@@ -0,0 +1,101 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../CommandInterface/CommandHandler.h"
+#include "BusAccess.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Profiler - hit count per PC from opcode fetches
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// In count mode every opcode fetch is counted (this needs waits on memory) - the fetch after a
+// CB, DD, ED or FD prefix is counted against the prefix so each instruction counts once.
+// In sampled mode waits on memory are only turned on after each display refresh bus request and
+// the next opcode fetch is counted - a statistical profile for machines that can't run with
+// waits on every memory cycle.
+// Reports are the top N addresses or the totals for address ranges (functions from the host's
+// symbols), annotated with the disassembly of the mirror memory.
+
+class TargetProfiler
+{
+public:
+    static void init();
+    static void service();
+
+    enum PROFILER_MODE
+    {
+        PROFILER_MODE_OFF,
+        PROFILER_MODE_COUNT,
+        PROFILER_MODE_SAMPLED
+    };
+
+    // Control
+    static void start(PROFILER_MODE mode);
+    static void stop();
+    static void clear();
+    static PROFILER_MODE getMode()
+    {
+        return _mode;
+    }
+
+    // Hits
+    static uint32_t getHits(uint32_t addr)
+    {
+        return _hits[addr & 0xffff];
+    }
+    static uint32_t getTotalHits()
+    {
+        return _totalHits;
+    }
+
+    // Reports - memory is the 64K image used for disassembly (NULL for none)
+    static void getStatusJson(char* pRespJson, int maxRespLen);
+    static void getTopJson(uint32_t topN, const uint8_t* pMemory, char* pRespJson, int maxRespLen);
+    static void getRangesJson(const char* pRangesStr, const uint8_t* pMemory, char* pRespJson, int maxRespLen);
+
+    // Limits
+    static const uint32_t NUM_ADDRS = 0x10000;
+    static const uint32_t MAX_TOP_N = 50;
+    static const int MAX_RANGES = 32;
+
+private:
+    // Bus socket we're attached to and setup info
+    static int _busSocketId;
+    static BusSocketInfo _busSocketInfo;
+
+    // Comms socket we're attached to and setup info
+    static int _commsSocketId;
+    static CommsSocketInfo _commsSocketInfo;
+
+    // Handle messages
+    static bool handleRxMsg(const char* pCmdJson, const uint8_t* pParams, int paramsLen,
+                    char* pRespJson, int maxRespLen);
+
+    // Wait interrupt handler
+    static void handleWaitInterruptStatic(uint32_t addr, uint32_t data,
+            uint32_t flags, uint32_t& retVal);
+
+    // Bus action complete callback
+    static void busActionCompleteStatic(BR_BUS_ACTION actionType, BR_BUS_ACTION_REASON reason);
+
+    // Add the disassembly of the instruction at addr to a report
+    static void addDisassembly(const uint8_t* pMemory, uint32_t addr, char* pRespJson, int maxRespLen);
+
+    // Hit counts
+    static uint32_t _hits[NUM_ADDRS];
+    static volatile uint32_t _totalHits;
+
+    // Mode and state
+    static volatile PROFILER_MODE _mode;
+    static volatile bool _samplePending;
+    static volatile bool _sampleWaitsOn;
+    static uint32_t _prevFetchAddr;
+    static bool _prevFetchWasPrefix;
+
+    // Stats
+    static uint32_t _sampleReqs;
+};
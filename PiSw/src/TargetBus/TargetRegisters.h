@@ -8,6 +8,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include "../System/ee_sprintf.h"
+#include "../System/lowlib.h"
 
 class Z80Registers
 {
@@ -31,6 +32,26 @@ public:
     int INTENABLED;
     int VPS;
 
+public:
+    // Register masks - used to track which registers have been changed (e.g. by the debugger)
+    static const uint32_t REG_MASK_PC = 0x0001;
+    static const uint32_t REG_MASK_SP = 0x0002;
+    static const uint32_t REG_MASK_HL = 0x0004;
+    static const uint32_t REG_MASK_DE = 0x0008;
+    static const uint32_t REG_MASK_BC = 0x0010;
+    static const uint32_t REG_MASK_AF = 0x0020;
+    static const uint32_t REG_MASK_IX = 0x0040;
+    static const uint32_t REG_MASK_IY = 0x0080;
+    static const uint32_t REG_MASK_HLDASH = 0x0100;
+    static const uint32_t REG_MASK_DEDASH = 0x0200;
+    static const uint32_t REG_MASK_BCDASH = 0x0400;
+    static const uint32_t REG_MASK_AFDASH = 0x0800;
+    static const uint32_t REG_MASK_I = 0x1000;
+    static const uint32_t REG_MASK_R = 0x2000;
+    static const uint32_t REG_MASK_INTMODE = 0x4000;
+    static const uint32_t REG_MASK_INTENABLED = 0x8000;
+    static const uint32_t REG_MASK_ALL = 0xffff;
+
 public:
     Z80Registers()
     {
@@ -42,6 +63,52 @@ public:
         HLDASH = DEDASH = BCDASH = AFDASH = MEMPTR = 0;
         I = R = INTMODE = INTENABLED = VPS = 0;
     }
+    // Set a register by name (e.g. "HL", "A", "IXH", "DE'", "IM") - regMask has the mask of the
+    // register pair that was changed ORed in - returns false if the name isn't recognised
+    bool setByName(const char* pName, uint32_t val, uint32_t& regMask)
+    {
+        struct RegName
+        {
+            const char* pName;
+            int* pReg;
+            uint32_t mask;
+            // Bits within the register (8-bit registers are halves of a pair)
+            int shift;
+            int valMask;
+        };
+        const RegName regNames[] =
+        {
+            { "PC", &PC, REG_MASK_PC, 0, 0xffff }, { "SP", &SP, REG_MASK_SP, 0, 0xffff },
+            { "HL", &HL, REG_MASK_HL, 0, 0xffff }, { "DE", &DE, REG_MASK_DE, 0, 0xffff },
+            { "BC", &BC, REG_MASK_BC, 0, 0xffff }, { "AF", &AF, REG_MASK_AF, 0, 0xffff },
+            { "IX", &IX, REG_MASK_IX, 0, 0xffff }, { "IY", &IY, REG_MASK_IY, 0, 0xffff },
+            { "HL'", &HLDASH, REG_MASK_HLDASH, 0, 0xffff }, { "DE'", &DEDASH, REG_MASK_DEDASH, 0, 0xffff },
+            { "BC'", &BCDASH, REG_MASK_BCDASH, 0, 0xffff }, { "AF'", &AFDASH, REG_MASK_AFDASH, 0, 0xffff },
+            { "H", &HL, REG_MASK_HL, 8, 0xff }, { "L", &HL, REG_MASK_HL, 0, 0xff },
+            { "D", &DE, REG_MASK_DE, 8, 0xff }, { "E", &DE, REG_MASK_DE, 0, 0xff },
+            { "B", &BC, REG_MASK_BC, 8, 0xff }, { "C", &BC, REG_MASK_BC, 0, 0xff },
+            { "A", &AF, REG_MASK_AF, 8, 0xff }, { "F", &AF, REG_MASK_AF, 0, 0xff },
+            { "IXH", &IX, REG_MASK_IX, 8, 0xff }, { "IXL", &IX, REG_MASK_IX, 0, 0xff },
+            { "IYH", &IY, REG_MASK_IY, 8, 0xff }, { "IYL", &IY, REG_MASK_IY, 0, 0xff },
+            { "I", &I, REG_MASK_I, 0, 0xff }, { "R", &R, REG_MASK_R, 0, 0xff },
+            { "H'", &HLDASH, REG_MASK_HLDASH, 8, 0xff }, { "L'", &HLDASH, REG_MASK_HLDASH, 0, 0xff },
+            { "D'", &DEDASH, REG_MASK_DEDASH, 8, 0xff }, { "E'", &DEDASH, REG_MASK_DEDASH, 0, 0xff },
+            { "B'", &BCDASH, REG_MASK_BCDASH, 8, 0xff }, { "C'", &BCDASH, REG_MASK_BCDASH, 0, 0xff },
+            { "A'", &AFDASH, REG_MASK_AFDASH, 8, 0xff }, { "F'", &AFDASH, REG_MASK_AFDASH, 0, 0xff },
+            { "IM", &INTMODE, REG_MASK_INTMODE, 0, 0x03 }, { "IFF", &INTENABLED, REG_MASK_INTENABLED, 0, 0x01 }
+        };
+        for (unsigned int i = 0; i < sizeof(regNames) / sizeof(regNames[0]); i++)
+        {
+            if (strcasecmp(pName, regNames[i].pName) != 0)
+                continue;
+            int bitsMask = regNames[i].valMask << regNames[i].shift;
+            *regNames[i].pReg = (*regNames[i].pReg & ~bitsMask) | ((val << regNames[i].shift) & bitsMask);
+            regMask |= regNames[i].mask;
+            return true;
+        }
+        return false;
+    }
+
     void format(char* pResponse, int maxLen)
     {
         char tmpStr[200];
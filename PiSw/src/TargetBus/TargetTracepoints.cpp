@@ -0,0 +1,113 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetTracepoints.h"
+#include "../System/lowlib.h"
+#include "../System/ee_sprintf.h"
+#include "../System/logging.h"
+#include "../CommandInterface/CommandHandler.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char FromTargetTracepoints[] = "TargetTracepoints";
+
+TargetTracepoints::TargetTracepoints() :
+        _traceRingPosn(TRACE_RING_LEN)
+{
+    clear();
+}
+
+void TargetTracepoints::clear()
+{
+    _traceRingPosn.clear();
+    _recordCount = 0;
+    _overflowCount = 0;
+    _recsSent = 0;
+    _frameSeq = 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Record
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetTracepoints::record(int bpIdx, const Z80Registers& regs, const uint8_t* pMemory, uint32_t memAddr, uint32_t memLen)
+{
+    if (!_traceRingPosn.canPut())
+    {
+        _overflowCount++;
+        return;
+    }
+    TracepointRec& rec = _traceRing[_traceRingPosn.posToPut()];
+    rec.timeUs = micros();
+    rec.bpIdx = bpIdx;
+    rec.PC = regs.PC;
+    rec.SP = regs.SP;
+    rec.AF = regs.AF;
+    rec.BC = regs.BC;
+    rec.DE = regs.DE;
+    rec.HL = regs.HL;
+    rec.IX = regs.IX;
+    rec.IY = regs.IY;
+    rec.AFDASH = regs.AFDASH;
+    rec.BCDASH = regs.BCDASH;
+    rec.DEDASH = regs.DEDASH;
+    rec.HLDASH = regs.HLDASH;
+    rec.I = regs.I;
+    rec.R = regs.R;
+    rec.memAddr = memAddr;
+    rec.memLen = 0;
+    rec.reserved = 0;
+    if (pMemory)
+    {
+        rec.memLen = (memLen > TRACEPOINT_MAX_MEM_BYTES) ? TRACEPOINT_MAX_MEM_BYTES : memLen;
+        for (uint32_t i = 0; i < rec.memLen; i++)
+            rec.mem[i] = pMemory[(memAddr + i) & 0xffff];
+    }
+    _traceRingPosn.hasPut();
+    _recordCount++;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Drain
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool TargetTracepoints::sendFrame()
+{
+    if (!_traceRingPosn.canGet() || (CommandHandler::getTxAvailable() < MIN_TX_AVAILABLE_FOR_TRACE_FRAME))
+        return false;
+
+    // Records - copied without removing them from the ring until the frame has gone
+    TracepointRec recs[MAX_RECS_PER_FRAME];
+    uint32_t recCount = _traceRingPosn.count();
+    if (recCount > (uint32_t)MAX_RECS_PER_FRAME)
+        recCount = MAX_RECS_PER_FRAME;
+    for (uint32_t i = 0; i < recCount; i++)
+        recs[i] = _traceRing[(_traceRingPosn.posToGet() + i) % TRACE_RING_LEN];
+
+    // Header gives the index of the first record and the number still waiting
+    char headerJson[MAX_TRACE_FRAME_HEADER_LEN];
+    ee_sprintf(headerJson, "\"seq\":%u,\"first\":%u,\"recLen\":%d,\"ovf\":%u,\"more\":%u",
+                _frameSeq, _recsSent, (int)sizeof(TracepointRec), _overflowCount, _traceRingPosn.count() - recCount);
+    if (!CommandHandler::sendWithJSON("tracepointData", headerJson, 0, (const uint8_t*)recs, recCount * sizeof(TracepointRec)))
+    {
+        LogWrite(FromTargetTracepoints, LOG_DEBUG, "Frame of %u recs not sent", recCount);
+        return false;
+    }
+    for (uint32_t i = 0; i < recCount; i++)
+        _traceRingPosn.hasGot();
+    _frameSeq++;
+    _recsSent += recCount;
+    LogWrite(FromTargetTracepoints, LOG_VERBOSE, "Sent %u recs overflows %u", recCount, _overflowCount);
+    return true;
+}
+
+void TargetTracepoints::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    char tmpResp[200];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"recs\":%u,\"waiting\":%u,\"ovf\":%u,\"sent\":%u,\"recLen\":%d,\"ringLen\":%d",
+                _recordCount, _traceRingPosn.count(), _overflowCount, _recsSent, (int)sizeof(TracepointRec), TRACE_RING_LEN);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+}
@@ -0,0 +1,87 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "TargetRegisters.h"
+#include "../System/RingBufferPosn.h"
+#include "../CommandInterface/CommandHandler.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Tracepoints - register snapshots recorded when a tracepoint is hit without stopping
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Maximum memory bytes recorded with each snapshot
+#define TRACEPOINT_MAX_MEM_BYTES 16
+
+// Record as stored and streamed (little-endian)
+#pragma pack(push, 1)
+struct TracepointRec
+{
+    uint32_t timeUs;
+    uint16_t bpIdx;
+    uint16_t PC;
+    uint16_t SP;
+    uint16_t AF;
+    uint16_t BC;
+    uint16_t DE;
+    uint16_t HL;
+    uint16_t IX;
+    uint16_t IY;
+    uint16_t AFDASH;
+    uint16_t BCDASH;
+    uint16_t DEDASH;
+    uint16_t HLDASH;
+    uint8_t I;
+    uint8_t R;
+    // Memory bytes recorded from memAddr
+    uint16_t memAddr;
+    uint8_t memLen;
+    uint8_t reserved;
+    uint8_t mem[TRACEPOINT_MAX_MEM_BYTES];
+};
+#pragma pack(pop)
+
+class TargetTracepoints
+{
+public:
+    TargetTracepoints();
+    void clear();
+
+    // Record a snapshot (called from the wait handler)
+    void record(int bpIdx, const Z80Registers& regs, const uint8_t* pMemory, uint32_t memAddr, uint32_t memLen);
+
+    // Send a frame of records - returns false if there are none or there isn't room to send
+    bool sendFrame();
+
+    // Status
+    void getStatusJson(char* pRespJson, int maxRespLen);
+    uint32_t getCount()
+    {
+        return _traceRingPosn.count();
+    }
+
+    // Size of ring
+    static const int TRACE_RING_LEN = 1024;
+
+    // Streaming - records per frame leave room for the JSON header within the frame limit
+    static const int MAX_TRACE_FRAME_HEADER_LEN = 500;
+    static const int MAX_RECS_PER_FRAME = (CommandHandler::MAX_SEND_FRAME_LEN - MAX_TRACE_FRAME_HEADER_LEN) / sizeof(TracepointRec);
+
+private:
+    // Ring of records
+    TracepointRec _traceRing[TRACE_RING_LEN];
+    RingBufferPosn _traceRingPosn;
+
+    // Stats
+    volatile uint32_t _recordCount;
+    volatile uint32_t _overflowCount;
+    uint32_t _recsSent;
+    uint32_t _frameSeq;
+
+    // Streaming
+    static const int MIN_TX_AVAILABLE_FOR_TRACE_FRAME = 12000;
+};
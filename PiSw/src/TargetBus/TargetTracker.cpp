@@ -2,13 +2,15 @@
 // Rob Dobson 2019
 
 #include "TargetTracker.h"
+#include "TargetCPUZ80.h"
+#include "TargetHistory.h"
 #include "../System/PiWiring.h"
 #include "../System/lowlib.h"
 #include "../System/ee_sprintf.h"
 #include "../System/logging.h"
 #include "../Hardware/HwManager.h"
 #include "../Machines/McManager.h"
-#include "../Disassembler/src/mdZ80.h"
+#include "../StepTracer/StepTracer.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Variables
@@ -50,7 +52,11 @@ BusSocketInfo TargetTracker::_busSocketInfo =
     0,
     .busMasterRequest=false,
     .busMasterReason=BR_BUS_ACTION_GENERAL,
-    .holdInWaitReq=false
+    .holdInWaitReq=false,
+    .busCycleMask=BR_BUS_CYCLE_ALL,
+    .addrRangeStart=0,
+    .addrRangeLen=0,
+    .pName="TargetTracker"
 };
 
 // Code snippet
@@ -61,10 +67,15 @@ uint32_t TargetTracker::_snippetWriteIdx = 0;
 
 // Step over
 uint32_t TargetTracker::_stepOverPCValue = 0;
+uint32_t TargetTracker::_stepOverMaxDepth = TargetCallStack::DEPTH_ANY;
 
 // Injection type
 bool TargetTracker::_setRegs = false;
 
+// Registers to set and registers modified since grabbed
+uint32_t TargetTracker::_setRegsMask = Z80Registers::REG_MASK_ALL;
+uint32_t TargetTracker::_regsModifiedMask = 0;
+
 // Mirror memory requirements
 bool TargetTracker::_postInjectMemoryMirror = true;
 
@@ -94,6 +105,21 @@ TargetTracker::STEP_MODE_TYPE TargetTracker::_stepMode = STEP_MODE_STEP_PAUSED;
 
 // Breakpoints
 TargetBreakpoints TargetTracker::_breakpoints;
+bool TargetTracker::_breakpointHitPending = false;
+TargetTracker::STEP_MODE_TYPE TargetTracker::_stepModeBeforeBreak = STEP_MODE_STEP_PAUSED;
+
+// Tracepoints
+TargetTracepoints TargetTracker::_tracepoints;
+
+// Shadow call stack
+TargetCallStack TargetTracker::_callStack;
+
+// Disassembly cache
+TargetDisasmCache TargetTracker::_disasmCache;
+
+// Watchpoints
+TargetWatchpoints TargetTracker::_watchpoints;
+uint32_t TargetTracker::_instrStartAddr = 0;
 
 // Machine heartbeat
 uint32_t TargetTracker::_machineHeartbeatCounter = 0;
@@ -128,6 +154,8 @@ void TargetTracker::enable(bool en)
         LogWrite(FromTargetTracker, LOG_DEBUG, "enable %d", en);
         // Enable the bus socket so we get bus callbacks
         BusAccess::busSocketEnable(_busSocketId, en);
+        // Calls made before now aren't known
+        _callStack.clear();
         // Set mirror mode so we record memory accesses
         HwManager::setMirrorMode(true);
         _postInjectMemoryMirror = true;
@@ -178,9 +206,15 @@ bool TargetTracker::isTrackingActive()
     return BusAccess::busSocketIsEnabled(_busSocketId);
 }
 
+bool TargetTracker::isInjecting()
+{
+    return _targetStateAcqMode == TARGET_STATE_ACQ_INJECTING;
+}
+
 void TargetTracker::targetReset()
 {
     _targetResetPending = true;
+    _callStack.clear();
     McManager::targetReset();
 }
 
@@ -188,11 +222,12 @@ void TargetTracker::targetReset()
 // Control
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void TargetTracker::startSetRegisterSequence(Z80Registers* pRegs)
+bool TargetTracker::startSetRegisterSequence(Z80Registers* pRegs, uint32_t regsMask)
 {
     // Set regs
     if (pRegs)
         _z80Registers = *pRegs;
+    _setRegsMask = regsMask;
 
     // TODO probably don't need synch with instruction to ensure we are at starting M1 cycle
     // as there is a nop at the start of the sequence
@@ -201,7 +236,7 @@ void TargetTracker::startSetRegisterSequence(Z80Registers* pRegs)
     if (_targetStateAcqMode == TARGET_STATE_ACQ_INJECTING)
     {
         LogWrite(FromTargetTracker, LOG_DEBUG, "Can't inject as Injector is busy - state = %d", _targetStateAcqMode);
-        return;
+        return false;
     }
 
     // Set state machine to inject
@@ -215,89 +250,25 @@ void TargetTracker::startSetRegisterSequence(Z80Registers* pRegs)
     // Start sequence of setting registers
     _setRegs = true;
     _snippetPos = 0;
+    return true;
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Handle register setting
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-void TargetTracker::store16BitVal(uint8_t arry[], int offset, uint16_t val)
+int TargetTracker::getInstructionsToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen, uint32_t regsMask)
 {
-    arry[offset] = val & 0xff;
-    arry[offset+1] = (val >> 8) & 0xff;
+    return TargetCPUZ80::getInjectToSetRegs(regs, pCodeBuffer, codeMaxlen, regsMask);
 }
 
-int TargetTracker::getInstructionsToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen)
+// Set a register (e.g. from the debugger) - the registers changed since they were grabbed are
+// injected straight away - false if the name is invalid or the injector is busy
+bool TargetTracker::setRegister(const char* pRegName, uint32_t value)
 {
-    // Instructions to set register values
-    static uint8_t regSetInstructions[] = 
-    {
-        0x00,                       // nop - in case previous instruction was prefixed
-        0xdd, 0x21, 0x00, 0x00,     // ld ix, xxxx
-        0xfd, 0x21, 0x00, 0x00,     // ld iy, xxxx
-        0x21, 0x00, 0x00,           // ld hl, xxxx
-        0x11, 0x00, 0x00,           // ld de, xxxx
-        0x01, 0x00, 0x00,           // ld bc, xxxx
-        0xd9,                       // exx
-        0x21, 0x00, 0x00,           // ld hl, xxxx
-        0x11, 0x00, 0x00,           // ld de, xxxx
-        0x01, 0x00, 0x00,           // ld bc, xxxx
-        0xf1, 0x00, 0x00,           // pop af + two bytes that are read as if from stack
-        0x08,                       // ex af,af'
-        0xf1, 0x00, 0x00,           // pop af + two bytes that are read as if from stack
-        0x31, 0x00, 0x00,           // ld sp, xxxx
-        0x3e, 0x00,                 // ld a, xx
-        0xed, 0x47,                 // ld i, a
-        0x3e, 0x00,                 // ld a, xx
-        0xed, 0x4f,                 // ld r, a
-        0x3e, 0x00,                 // ld a, xx
-        0xed, 0x46,                 // im 0
-        0xfb,                       // ei
-        0xc3, 0x00, 0x00            // jp xxxx
-    };
-    const int RegisterIXUpdatePos = 3;
-    const int RegisterIYUpdatePos = 7;
-    const int RegisterHLDASHUpdatePos = 10;
-    const int RegisterDEDASHUpdatePos = 13;
-    const int RegisterBCDASHUpdatePos = 16;
-    const int RegisterHLUpdatePos = 20;
-    const int RegisterDEUpdatePos = 23;
-    const int RegisterBCUpdatePos = 26;
-    const int RegisterAFDASHUpdatePos = 29;
-    const int RegisterAFUpdatePos = 33;
-    const int RegisterSPUpdatePos = 36;
-    const int RegisterIUpdatePos = 39;
-    const int RegisterRUpdatePos = 43;
-    const int RegisterAUpdatePos = 47;
-    const int RegisterIMUpdatePos = 49;
-    const int RegisterINTENUpdatePos = 50;
-    const int RegisterPCUpdatePos = 52;
-
-    // Fill in the register values
-    store16BitVal(regSetInstructions, RegisterIXUpdatePos, regs.IX);
-    store16BitVal(regSetInstructions, RegisterIYUpdatePos, regs.IY);
-    store16BitVal(regSetInstructions, RegisterHLDASHUpdatePos, regs.HLDASH);
-    store16BitVal(regSetInstructions, RegisterDEDASHUpdatePos, regs.DEDASH);
-    store16BitVal(regSetInstructions, RegisterBCDASHUpdatePos, regs.BCDASH);
-    store16BitVal(regSetInstructions, RegisterSPUpdatePos, regs.SP);
-    store16BitVal(regSetInstructions, RegisterHLUpdatePos, regs.HL);
-    store16BitVal(regSetInstructions, RegisterDEUpdatePos, regs.DE);
-    store16BitVal(regSetInstructions, RegisterBCUpdatePos, regs.BC);
-    store16BitVal(regSetInstructions, RegisterAFDASHUpdatePos, regs.AFDASH);
-    store16BitVal(regSetInstructions, RegisterAFUpdatePos, regs.AF);
-    regSetInstructions[RegisterIUpdatePos] = regs.I;
-    regSetInstructions[RegisterRUpdatePos] = (regs.R + 256 - 5) % 256;
-    regSetInstructions[RegisterAUpdatePos] = regs.AF >> 8;
-    regSetInstructions[RegisterIMUpdatePos] = (regs.INTMODE == 0) ? 0x46 : ((regs.INTMODE == 1) ? 0x56 : 0x5e);
-    regSetInstructions[RegisterINTENUpdatePos] = (regs.INTENABLED == 0) ? 0xf3 : 0xfb;
-    store16BitVal(regSetInstructions, RegisterPCUpdatePos, regs.PC);
-
-    if (codeMaxlen >= sizeof(regSetInstructions))
-    {
-        memcopyfast(pCodeBuffer, regSetInstructions, sizeof(regSetInstructions));
-        return sizeof(regSetInstructions);
-    }
-    return 0;
+    if (!_z80Registers.setByName(pRegName, value, _regsModifiedMask))
+        return false;
+    return startSetRegisterSequence(NULL, _regsModifiedMask);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -490,7 +461,8 @@ TargetTracker::OPCODE_INJECT_PROGRESS TargetTracker::handleRegisterSet(uint32_t&
     // Fill in the register values
     if (_snippetPos == 0)
     {
-        _snippetLen = getInstructionsToSetRegs(_z80Registers, _snippetBuf, MAX_REGISTER_SET_CODE_LEN);
+        _snippetLen = getInstructionsToSetRegs(_z80Registers, _snippetBuf, MAX_REGISTER_SET_CODE_LEN, _setRegsMask);
+        _regsModifiedMask = 0;
         if (_snippetLen == 0)
         {
             // Nothing to do
@@ -515,7 +487,8 @@ void TargetTracker::stepInto()
 {
     // LogWrite(FromTargetTracker, LOG_DEBUG, "stepInto");
 
-    // Set flag to indicate mode
+    // Set flag to indicate mode (overrides a pending conditional breakpoint)
+    _breakpointHitPending = false;
     _stepMode = STEP_MODE_STEP_INTO;
 
     // Release bus hold if held
@@ -538,12 +511,51 @@ void TargetTracker::stepOver()
     if (!pMirrorMemory)
         return;
     uint32_t curAddr = _z80Registers.PC;
-    char pDisassembly[MAX_Z80_DISASSEMBLY_LINE_LEN];
-    int instrLen = disasmZ80(pMirrorMemory, 0, curAddr, pDisassembly, INTEL, false, true);
-    _stepOverPCValue = curAddr + instrLen;
-    LogWrite(FromTargetTracker, LOG_DEBUG, "cpu-step-over PCnow %04x StepToPC %04x", _z80Registers.PC, _stepOverPCValue);
+    const char* pDisassembly = NULL;
+    int instrLen = _disasmCache.disassemble(pMirrorMemory, curAddr, pDisassembly);
+    LogWrite(FromTargetTracker, LOG_DEBUG, "cpu-step-over PCnow %04x StepToPC %04x", _z80Registers.PC, curAddr + instrLen);
 
-    // Set flag to indicate mode
+    // Not in a deeper call (e.g. if the call recurses)
+    startStepOver(curAddr + instrLen, _callStack.getDepth());
+}
+
+void TargetTracker::stepOut()
+{
+    // Return address of the current frame - if the call wasn't seen then use the address at SP
+    CallStackFrame frame;
+    uint32_t retAddr = 0;
+    uint32_t maxCallDepth = 0;
+    if (_callStack.getFrame(0, frame))
+    {
+        retAddr = frame.retAddr;
+        maxCallDepth = _callStack.getDepth() - 1;
+    }
+    else
+    {
+        uint8_t* pMirrorMemory = HwManager::getMirrorMemForAddr(0);
+        if (!pMirrorMemory)
+            return;
+        retAddr = pMirrorMemory[_z80Registers.SP & 0xffff] | (pMirrorMemory[(_z80Registers.SP + 1) & 0xffff] << 8);
+    }
+    LogWrite(FromTargetTracker, LOG_DEBUG, "cpu-step-out PCnow %04x RetAddr %04x depth %u", 
+                _z80Registers.PC, retAddr, _callStack.getDepth());
+    startStepOver(retAddr, maxCallDepth);
+}
+
+void TargetTracker::stepRunTo(uint32_t pcValue)
+{
+    LogWrite(FromTargetTracker, LOG_DEBUG, "cpu-run-to PCnow %04x RunToPC %04x", _z80Registers.PC, pcValue);
+    startStepOver(pcValue, TargetCallStack::DEPTH_ANY);
+}
+
+// Run at full speed to a PC value (a one-shot breakpoint checked on each M1)
+void TargetTracker::startStepOver(uint32_t pcValue, uint32_t maxCallDepth)
+{
+    _stepOverPCValue = pcValue;
+    _stepOverMaxDepth = maxCallDepth;
+
+    // Set flag to indicate mode (overrides a pending conditional breakpoint)
+    _breakpointHitPending = false;
     _stepMode = STEP_MODE_STEP_OVER;
 
     // Release bus hold if held
@@ -554,11 +566,27 @@ void TargetTracker::stepOver()
     }
 }
 
+// Step back to the previous register checkpoint in the execution history - memory written since is
+// restored and the checkpoint's registers are injected
+bool TargetTracker::stepBack()
+{
+    if (!isPaused())
+        return false;
+    Z80Registers regs;
+    if (!TargetHistory::rollBack(regs))
+        return false;
+    LogWrite(FromTargetTracker, LOG_DEBUG, "cpu-step-back PCnow %04x BackToPC %04x", _z80Registers.PC, regs.PC);
+    _regsModifiedMask = 0;
+    startSetRegisterSequence(&regs);
+    return true;
+}
+
 void TargetTracker::stepRun()
 {
     // LogWrite(FromTargetTracker, LOG_DEBUG, "stepRun");
 
-    // Set flag to indicate mode
+    // Set flag to indicate mode (overrides a pending conditional breakpoint)
+    _breakpointHitPending = false;
     _stepMode = STEP_MODE_RUN;
 
     // Release bus hold if held
@@ -697,6 +725,10 @@ void TargetTracker::busActionCompleteStatic([[maybe_unused]]BR_BUS_ACTION action
 void TargetTracker::handleWaitInterruptStatic(uint32_t addr, uint32_t data, 
         uint32_t flags, uint32_t& retVal)
 {
+    // Shadow call stack (including interrupt acknowledge cycles) - not while injecting
+    if (_targetStateAcqMode != TARGET_STATE_ACQ_INJECTING)
+        _callStack.handleBusCycle(addr, data, flags);
+
     // Only handle MREQs
     if ((flags & BR_CTRL_BUS_MREQ_MASK) == 0)
         return;
@@ -709,6 +741,23 @@ void TargetTracker::handleWaitInterruptStatic(uint32_t addr, uint32_t data,
 //                 (flags & BR_CTRL_BUS_M1_MASK) != 0, _prefixTracker[0], _prefixTracker[1], 
 //                 flags);
 
+    // Watchpoints on data accesses - not while injecting as those cycles aren't the target's
+    if (_targetStateAcqMode != TARGET_STATE_ACQ_INJECTING)
+    {
+        if (flags & BR_CTRL_BUS_M1_MASK)
+        {
+            // Start of instruction unless following a prefix
+            if (!_prefixTracker[1])
+                _instrStartAddr = addr;
+        }
+        else if (_watchpoints.checkForWatch(addr, data, flags, _instrStartAddr))
+        {
+            // Stop at the start of the next instruction
+            _stepMode = STEP_MODE_STEP_INTO;
+            LogWrite(FromTargetTracker, LOG_DEBUG, "Hit Watchpoint %04x PC %04x", addr, _instrStartAddr);
+        }
+    }
+
     // Handle state machine
     TARGET_STATE_ACQ startAcqMode = _targetStateAcqMode;
     switch (_targetStateAcqMode)
@@ -776,8 +825,8 @@ void TargetTracker::handleWaitInterruptStatic(uint32_t addr, uint32_t data,
                 //         (flags & BR_CTRL_BUS_RD_MASK) ? "R" : "", 
                 //         (flags & BR_CTRL_BUS_WR_MASK) ? "W" : "",
                 //         _prefixTracker[0], _prefixTracker[1]);
-                // Bump state if in step mode or a grab is needed
-                if ((_stepMode == STEP_MODE_STEP_INTO) || _requestDisplayWhileStepping)
+                // Bump state if in step mode or a grab is needed (including for a history checkpoint)
+                if ((_stepMode == STEP_MODE_STEP_INTO) || _requestDisplayWhileStepping || TargetHistory::isCheckpointDue())
                 {
                     // TODO DEBUG
                     // ISR_ASSERT(ISR_ASSERT_CODE_DEBUG_A);
@@ -839,7 +888,8 @@ void TargetTracker::handleStepOverBkpts([[maybe_unused]] uint32_t addr, [[maybe_
         return;
 
     // Step-over handling: enabled and M1 cycle
-    if ((_stepMode == STEP_MODE_STEP_OVER) && (flags & BR_CTRL_BUS_M1_MASK) && (_stepOverPCValue == addr))
+    if ((_stepMode == STEP_MODE_STEP_OVER) && (flags & BR_CTRL_BUS_M1_MASK) && (_stepOverPCValue == addr) &&
+                (_callStack.getDepth() <= _stepOverMaxDepth))
     {
         _targetStateAcqMode = TARGET_STATE_ACQ_INJECTING;
         _stepMode = STEP_MODE_STEP_PAUSED;
@@ -847,9 +897,13 @@ void TargetTracker::handleStepOverBkpts([[maybe_unused]] uint32_t addr, [[maybe_
     }
     else if (_breakpoints.checkForBreak(addr, data, flags, retVal))
     {
+        // Conditional breakpoints and tracepoints are only logged if they stop
+        _breakpointHitPending = _breakpoints.isHitDeferred();
+        _stepModeBeforeBreak = _stepMode;
         _targetStateAcqMode = TARGET_STATE_ACQ_INJECTING;
         _stepMode = STEP_MODE_STEP_PAUSED;
-        LogWrite(FromTargetTracker, LOG_DEBUG, "Hit Breakpoint %04x", addr);
+        if (!_breakpointHitPending)
+            LogWrite(FromTargetTracker, LOG_DEBUG, "Hit Breakpoint %04x", addr);
     }
 }
 
@@ -939,10 +993,37 @@ void TargetTracker::handleInjection(uint32_t addr, uint32_t data,
         _setRegs = false;
         _snippetPos = 0;
 
+        // Registers are known here so execution history can step back to this point and a
+        // streamed trace can be validated from it
+        TargetHistory::recordCheckpoint(_z80Registers);
+        StepTracer::recordCheckpoint(_z80Registers);
+
         // Use the bus socket to request page-in delayed to next wait event
         BusAccess::targetPageForInjection(_busSocketId, false);
         _pageOutForInjectionActive = false;
 
+        // Conditional breakpoint or tracepoint - carry on as before unless it should stop
+        if (_breakpointHitPending)
+        {
+            _breakpointHitPending = false;
+            const uint8_t* pMirrorMemory = HwManager::getMirrorMemForAddr(0);
+            if (!_breakpoints.isHitConditionMet(_z80Registers, pMirrorMemory))
+            {
+                _stepMode = _stepModeBeforeBreak;
+            }
+            else if (_breakpoints.isHitTracepoint())
+            {
+                _tracepoints.record(_breakpoints.getHitIndex(), _z80Registers, pMirrorMemory,
+                            _breakpoints.getHitTraceMemAddr(_z80Registers, pMirrorMemory),
+                            _breakpoints.getHitTraceMemLen());
+                _stepMode = _stepModeBeforeBreak;
+            }
+            else
+            {
+                LogWrite(FromTargetTracker, LOG_DEBUG, "Hit Breakpoint %04x condition met", _z80Registers.PC);
+            }
+        }
+
         // Go back to allowing a single instruction to run before reg get
 #ifdef PAUSE_GET_REGS_AT_CUR_ADDR
         _targetStateAcqMode = TARGET_STATE_ACQ_POST_INJECT;
@@ -10,6 +10,10 @@
 #include "BusAccess.h"
 #include "TargetRegisters.h"
 #include "TargetBreakpoints.h"
+#include "TargetWatchpoints.h"
+#include "TargetTracepoints.h"
+#include "TargetCallStack.h"
+#include "TargetDisasmCache.h"
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Defs
@@ -28,6 +32,9 @@ public:
     static void stepInto();
     static void stepRun();
     static void stepOver();
+    static void stepOut();
+    static void stepRunTo(uint32_t pcValue);
+    static bool stepBack();
 
     // Regs
     static Z80Registers& getRegs()
@@ -42,6 +49,7 @@ public:
     // Get mode
     static bool isPaused(); 
     static bool isTrackingActive();
+    static bool isInjecting();
 
     // Complete the process of programming the target
     static void completeTargetProgram();
@@ -50,10 +58,12 @@ public:
     static void targetReset();
 
     // Register injection and code snippet generation
-    static void startSetRegisterSequence(Z80Registers* pRegs = NULL);
+    static bool startSetRegisterSequence(Z80Registers* pRegs = NULL, uint32_t regsMask = Z80Registers::REG_MASK_ALL);
     // static void startGetRegisterSequence();
     static const int MAX_CODE_SNIPPET_LEN = 100;
-    static int getInstructionsToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen);
+    static int getInstructionsToSetRegs(Z80Registers& regs, uint8_t* pCodeBuffer, uint32_t codeMaxlen,
+                uint32_t regsMask = Z80Registers::REG_MASK_ALL);
+    static bool setRegister(const char* pRegName, uint32_t value);
 
     // Disassembly
     static const int MAX_Z80_DISASSEMBLY_LINE_LEN = 300;
@@ -95,6 +105,10 @@ public:
     {
         _breakpoints.setBreakpointPCAddr(idx, pcVal);
     }
+    static bool setBreakpointCondition(int idx, const char* condition)
+    {
+        return _breakpoints.setBreakpointCondition(idx, condition);
+    }
     static void setFastBreakpoint(uint32_t addr, bool en)
     {
         _breakpoints.setFastBreakpoint(addr, en);
@@ -104,6 +118,70 @@ public:
         _breakpoints.clearFastBreakpoints();
     }
 
+    // Tracepoints - breakpoints that record the registers (and optionally memory) then carry on
+    static bool setTracepoint(int idx, uint32_t pcVal, const char* condition, const char* memAddrExpr, uint32_t memLen)
+    {
+        _breakpoints.setBreakpointPCAddr(idx, pcVal);
+        bool exprsOk = _breakpoints.setBreakpointCondition(idx, condition);
+        exprsOk &= _breakpoints.setBreakpointTrace(idx, true, memAddrExpr, memLen);
+        _breakpoints.enableBreakpoint(idx, true);
+        return exprsOk;
+    }
+    static bool setBreakpointTrace(int idx, bool tracepoint, const char* memAddrExpr, uint32_t memLen)
+    {
+        return _breakpoints.setBreakpointTrace(idx, tracepoint, memAddrExpr, memLen);
+    }
+    static bool sendTracepointFrame()
+    {
+        return _tracepoints.sendFrame();
+    }
+    static void clearTracepointRecs()
+    {
+        _tracepoints.clear();
+    }
+    static void getTracepointStatusJson(char* pRespJson, int maxRespLen)
+    {
+        _tracepoints.getStatusJson(pRespJson, maxRespLen);
+    }
+
+    // Shadow call stack
+    static TargetCallStack& getCallStack()
+    {
+        return _callStack;
+    }
+
+    // Disassembly cache
+    static TargetDisasmCache& getDisasmCache()
+    {
+        return _disasmCache;
+    }
+
+    // Watchpoints
+    static void setWatchpoint(int idx, uint32_t addrStart, uint32_t addrLen, uint32_t accessMask, bool logOnly)
+    {
+        _watchpoints.setWatchpoint(idx, addrStart, addrLen, accessMask, logOnly);
+    }
+    static void enableWatchpoint(int idx, bool enabled)
+    {
+        _watchpoints.enableWatchpoint(idx, enabled);
+    }
+    static bool setWatchpointAtAddr(uint32_t addrStart, uint32_t addrLen, uint32_t accessMask)
+    {
+        return _watchpoints.setWatchpointAtAddr(addrStart, addrLen, accessMask);
+    }
+    static void clearWatchpoints()
+    {
+        _watchpoints.clearWatchpoints();
+    }
+    static void getWatchpointStatusJson(char* pRespJson, int maxRespLen)
+    {
+        _watchpoints.getStatusJson(pRespJson, maxRespLen);
+    }
+    static void getWatchpointLogJson(char* pRespJson, int maxRespLen)
+    {
+        _watchpoints.getLogJson(pRespJson, maxRespLen);
+    }
+
 private:
 
     // Can't turn off mid-injection so store flag to indicate disable pending
@@ -118,8 +196,11 @@ private:
     // Step mode
     static STEP_MODE_TYPE _stepMode;
 
-    // Step over
+    // Step over (also used for step out and run to) - stops at the PC value when the call depth is
+    // no more than the max
     static uint32_t _stepOverPCValue;
+    static uint32_t _stepOverMaxDepth;
+    static void startStepOver(uint32_t pcValue, uint32_t maxCallDepth);
 
     // Code snippet
     static uint32_t _snippetLen;
@@ -130,6 +211,10 @@ private:
     // Injection type
     static bool _setRegs;
 
+    // Registers to set and registers modified since grabbed
+    static uint32_t _setRegsMask;
+    static uint32_t _regsModifiedMask;
+
     // Mirror memory requirements
     static bool _postInjectMemoryMirror;
 
@@ -156,7 +241,6 @@ private:
     // Utils
     static bool isPrefixInstruction(uint32_t instr);
     static bool trackPrefixedInstructions(uint32_t flags, uint32_t data, uint32_t retVal);
-    static void store16BitVal(uint8_t arry[], int offset, uint16_t val);
     static bool handlePendingDisable();
 
     // Bus socket we're attached to and setup info
@@ -185,6 +269,23 @@ private:
     // Breakpoints
     static TargetBreakpoints _breakpoints;
 
+    // Tracepoint snapshots
+    static TargetTracepoints _tracepoints;
+
+    // Shadow call stack
+    static TargetCallStack _callStack;
+
+    // Disassembly cache
+    static TargetDisasmCache _disasmCache;
+
+    // Watchpoints and the address of the current instruction (for the watchpoint log)
+    static TargetWatchpoints _watchpoints;
+    static uint32_t _instrStartAddr;
+
+    // Conditional breakpoint or tracepoint hit - handled when register grab completes
+    static bool _breakpointHitPending;
+    static STEP_MODE_TYPE _stepModeBeforeBreak;
+
     // Machine heartbeat cycle counter
     static uint32_t _machineHeartbeatCounter;
 
@@ -0,0 +1,202 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#include "TargetWatchpoints.h"
+#include "../System/lowlib.h"
+#include "../System/ee_sprintf.h"
+#include "../System/logging.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Variables
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Module name
+static const char FromTargetWatchpoints[] = "TargetWatchpoints";
+
+TargetWatchpoints::TargetWatchpoints() :
+        _logRingPosn(LOG_RING_LEN)
+{
+    _logOverflowCount = 0;
+    clearWatchpoints();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Watchpoints
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetWatchpoints::clearWatchpoints()
+{
+    for (int i = 0; i < MAX_WATCHPOINTS; i++)
+    {
+        _watchpoints[i].enabled = false;
+        _watchpoints[i].hitCount = 0;
+    }
+    _watchpointNumEnabled = 0;
+    _logRingPosn.clear();
+    _logOverflowCount = 0;
+    updatePageFilter();
+}
+
+void TargetWatchpoints::setWatchpoint(int idx, uint32_t addrStart, uint32_t addrLen, uint32_t accessMask, bool logOnly)
+{
+    if ((idx < 0) || (idx >= MAX_WATCHPOINTS))
+        return;
+    SimpleWatchpoint& wp = _watchpoints[idx];
+    wp.addrStart = addrStart & (STD_TARGET_MEMORY_LEN - 1);
+    wp.addrLen = (addrLen == 0) ? 1 : addrLen;
+    if (wp.addrStart + wp.addrLen > STD_TARGET_MEMORY_LEN)
+        wp.addrLen = STD_TARGET_MEMORY_LEN - wp.addrStart;
+    wp.accessMask = accessMask & (WATCHPOINT_ACCESS_READ | WATCHPOINT_ACCESS_WRITE);
+    wp.logOnly = logOnly;
+    wp.hitCount = 0;
+    updatePageFilter();
+}
+
+void TargetWatchpoints::enableWatchpoint(int idx, bool enabled)
+{
+    if ((idx < 0) || (idx >= MAX_WATCHPOINTS))
+        return;
+    if (_watchpoints[idx].enabled == enabled)
+        return;
+    _watchpoints[idx].enabled = enabled;
+    _watchpointNumEnabled += enabled ? 1 : -1;
+    updatePageFilter();
+}
+
+bool TargetWatchpoints::setWatchpointAtAddr(uint32_t addrStart, uint32_t addrLen, uint32_t accessMask)
+{
+    // Find the watchpoint already at this address or a free one
+    addrStart &= (STD_TARGET_MEMORY_LEN - 1);
+    int freeIdx = -1;
+    for (int i = 0; i < MAX_WATCHPOINTS; i++)
+    {
+        if (_watchpoints[i].enabled && (_watchpoints[i].addrStart == addrStart))
+        {
+            if (accessMask == 0)
+            {
+                enableWatchpoint(i, false);
+                return true;
+            }
+            setWatchpoint(i, addrStart, addrLen, accessMask, _watchpoints[i].logOnly);
+            return true;
+        }
+        if (!_watchpoints[i].enabled && (freeIdx < 0))
+            freeIdx = i;
+    }
+    if (accessMask == 0)
+        return true;
+    if (freeIdx < 0)
+    {
+        LogWrite(FromTargetWatchpoints, LOG_DEBUG, "No free watchpoint for addr %04x", addrStart);
+        return false;
+    }
+    setWatchpoint(freeIdx, addrStart, addrLen, accessMask, false);
+    enableWatchpoint(freeIdx, true);
+    return true;
+}
+
+uint32_t TargetWatchpoints::getHitCount(int idx)
+{
+    if ((idx < 0) || (idx >= MAX_WATCHPOINTS))
+        return 0;
+    return _watchpoints[idx].hitCount;
+}
+
+// Rebuild the page filter from the enabled watchpoints
+void TargetWatchpoints::updatePageFilter()
+{
+    for (int page = 0; page < NUM_PAGES; page++)
+        _pageFilter[page] = 0;
+    for (int i = 0; i < MAX_WATCHPOINTS; i++)
+    {
+        SimpleWatchpoint& wp = _watchpoints[i];
+        if (!wp.enabled || (wp.addrLen == 0))
+            continue;
+        uint32_t lastPage = (wp.addrStart + wp.addrLen - 1) >> 8;
+        for (uint32_t page = wp.addrStart >> 8; page <= lastPage; page++)
+            _pageFilter[page] |= wp.accessMask;
+    }
+}
+
+// Exact range check - only called when the page filter matches
+bool TargetWatchpoints::checkRanges(uint32_t addr, uint32_t data, uint32_t accessMask, uint32_t pc)
+{
+    bool stop = false;
+    for (int i = 0; i < MAX_WATCHPOINTS; i++)
+    {
+        SimpleWatchpoint& wp = _watchpoints[i];
+        if (!wp.enabled || ((wp.accessMask & accessMask) == 0) || (addr - wp.addrStart >= wp.addrLen))
+            continue;
+        wp.hitCount++;
+        if (!wp.logOnly)
+        {
+            stop = true;
+            continue;
+        }
+
+        // Log the access
+        if (!_logRingPosn.canPut())
+        {
+            _logOverflowCount++;
+            continue;
+        }
+        WatchpointLogRec& rec = _logRing[_logRingPosn.posToPut()];
+        rec.addr = addr;
+        rec.pc = pc;
+        rec.data = data;
+        rec.accessMask = accessMask;
+        rec.watchIdx = i;
+        rec.reserved = 0;
+        _logRingPosn.hasPut();
+    }
+    return stop;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Status and log
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void TargetWatchpoints::getStatusJson(char* pRespJson, int maxRespLen)
+{
+    char tmpResp[100];
+    ee_sprintf(tmpResp, "\"err\":\"ok\",\"logged\":%u,\"logOvf\":%u,\"watch\":[",
+                _logRingPosn.count(), _logOverflowCount);
+    strlcpy(pRespJson, tmpResp, maxRespLen);
+    bool firstWp = true;
+    for (int i = 0; i < MAX_WATCHPOINTS; i++)
+    {
+        SimpleWatchpoint& wp = _watchpoints[i];
+        if (!wp.enabled)
+            continue;
+        ee_sprintf(tmpResp, "%s{\"idx\":%d,\"addr\":%u,\"len\":%u,\"access\":\"%s%s\",\"log\":%d,\"hits\":%u}",
+                    firstWp ? "" : ",", i, wp.addrStart, wp.addrLen,
+                    (wp.accessMask & WATCHPOINT_ACCESS_READ) ? "r" : "",
+                    (wp.accessMask & WATCHPOINT_ACCESS_WRITE) ? "w" : "",
+                    wp.logOnly ? 1 : 0, wp.hitCount);
+        strlcat(pRespJson, tmpResp, maxRespLen);
+        firstWp = false;
+    }
+    strlcat(pRespJson, "]", maxRespLen);
+}
+
+// Drain logged accesses as [idx,addr,data,pc,access] - records that don't fit are left for the next call
+void TargetWatchpoints::getLogJson(char* pRespJson, int maxRespLen)
+{
+    static const int MAX_REC_JSON_LEN = 40;
+    strlcpy(pRespJson, "\"err\":\"ok\",\"log\":[", maxRespLen);
+    int curLen = strlen(pRespJson);
+    bool firstRec = true;
+    char tmpResp[MAX_REC_JSON_LEN];
+    while (_logRingPosn.canGet() && (curLen + MAX_REC_JSON_LEN + 20 < maxRespLen))
+    {
+        WatchpointLogRec& rec = _logRing[_logRingPosn.posToGet()];
+        ee_sprintf(tmpResp, "%s[%u,%u,%u,%u,%u]", firstRec ? "" : ",",
+                    rec.watchIdx, rec.addr, rec.data, rec.pc, rec.accessMask);
+        strlcat(pRespJson, tmpResp, maxRespLen);
+        curLen += strlen(tmpResp);
+        _logRingPosn.hasGot();
+        firstRec = false;
+    }
+    ee_sprintf(tmpResp, "],\"more\":%u", _logRingPosn.count());
+    strlcat(pRespJson, tmpResp, maxRespLen);
+}
@@ -0,0 +1,106 @@
+// Bus Raider
+// Rob Dobson 2019
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "TargetCPU.h"
+#include "../System/RingBufferPosn.h"
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Defs
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Access types watched
+#define WATCHPOINT_ACCESS_READ 0x01
+#define WATCHPOINT_ACCESS_WRITE 0x02
+
+class SimpleWatchpoint
+{
+public:
+    bool enabled;
+    uint32_t addrStart;
+    uint32_t addrLen;
+    uint32_t accessMask;
+    // Log the access rather than stopping
+    bool logOnly;
+    volatile uint32_t hitCount;
+
+    SimpleWatchpoint()
+    {
+        enabled = false;
+        addrStart = 0;
+        addrLen = 0;
+        accessMask = 0;
+        logOnly = false;
+        hitCount = 0;
+    }
+};
+
+// Logged access
+#pragma pack(push, 1)
+struct WatchpointLogRec
+{
+    uint16_t addr;
+    uint16_t pc;
+    uint8_t data;
+    uint8_t accessMask;
+    uint8_t watchIdx;
+    uint8_t reserved;
+};
+#pragma pack(pop)
+
+class TargetWatchpoints
+{
+public:
+
+    // Construct
+    TargetWatchpoints();
+
+    // Control
+    void setWatchpoint(int idx, uint32_t addrStart, uint32_t addrLen, uint32_t accessMask, bool logOnly);
+    void enableWatchpoint(int idx, bool enabled);
+    // Set by address (as used by the ZEsarUX membreakpoint command) - accessMask 0 removes
+    bool setWatchpointAtAddr(uint32_t addrStart, uint32_t addrLen, uint32_t accessMask);
+    void clearWatchpoints();
+    int getNumEnabled()
+    {
+        return _watchpointNumEnabled;
+    }
+
+    // Check a memory data access - the page filter rejects most accesses with a single load,
+    // returns true if the target should stop
+    bool checkForWatch(uint32_t addr, uint32_t data, uint32_t flags, uint32_t pc)
+    {
+        uint32_t accessMask = (flags & BR_CTRL_BUS_WR_MASK) ? WATCHPOINT_ACCESS_WRITE : WATCHPOINT_ACCESS_READ;
+        if ((_pageFilter[(addr >> 8) & (NUM_PAGES - 1)] & accessMask) == 0)
+            return false;
+        return checkRanges(addr, data, accessMask, pc);
+    }
+
+    // Hit counts and log
+    uint32_t getHitCount(int idx);
+    void getStatusJson(char* pRespJson, int maxRespLen);
+    void getLogJson(char* pRespJson, int maxRespLen);
+
+    // Limits
+    static const int MAX_WATCHPOINTS = 32;
+    static const int LOG_RING_LEN = 1024;
+
+private:
+    void updatePageFilter();
+    bool checkRanges(uint32_t addr, uint32_t data, uint32_t accessMask, uint32_t pc);
+    SimpleWatchpoint _watchpoints[MAX_WATCHPOINTS];
+    int _watchpointNumEnabled;
+
+    // Page filter - access mask of the enabled watchpoints overlapping each 256 byte page
+    static const int NUM_PAGES = 256;
+    uint8_t _pageFilter[NUM_PAGES];
+
+    // Log ring
+    WatchpointLogRec _logRing[LOG_RING_LEN];
+    RingBufferPosn _logRingPosn;
+    volatile uint32_t _logOverflowCount;
+};
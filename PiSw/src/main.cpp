@@ -11,6 +11,10 @@
 #include "System/Display.h"
 #include "TargetBus/BusAccess.h"
 #include "TargetBus/TargetTracker.h"
+#include "TargetBus/BusCapture.h"
+#include "TargetBus/TargetProfiler.h"
+#include "TargetBus/TargetHistory.h"
+#include "TargetBus/TargetMemChanges.h"
 #include "Hardware/HwManager.h"
 #include "Machines/McManager.h"
 #include "BusController/BusController.h"
@@ -92,12 +96,25 @@ extern "C" int main()
     // Bus raider setup
     BusAccess::init();
 
+    // Execution history - its bus socket is added before the hardware manager's so memory writes
+    // are seen before the mirror is updated
+    TargetHistory::init();
+
+    // Memory changes pushed to the debugger
+    TargetMemChanges::init();
+
     // Hardware manager
     HwManager::init();
 
     // Target tracker
     TargetTracker::init();
 
+    // Bus capture
+    BusCapture::init();
+
+    // Profiler
+    TargetProfiler::init();
+
     // BusController, StepTracer
     busController.init();
     stepTracer.init();
@@ -140,6 +157,18 @@ extern "C" int main()
         // Target tracker
         TargetTracker::service();
 
+        // Bus capture
+        BusCapture::service();
+
+        // Profiler
+        TargetProfiler::service();
+
+        // Execution history
+        TargetHistory::service();
+
+        // Memory changes
+        TargetMemChanges::service();
+
         // Service machine manager
         McManager::service();
 
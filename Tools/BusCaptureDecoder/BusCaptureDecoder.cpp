@@ -0,0 +1,225 @@
+// Bus Raider
+// Bus capture decoder - converts captureData frames from the Pi to VCD or CSV
+// Rob Dobson 2019
+
+// Input is the captureData frames (as received from the ESP32 after HDLC decoding) written
+// one after another. Each frame is a null terminated JSON header followed by dataLen bytes of
+// records and a further null terminator:
+//   {"cmdName":"captureData","seq":N,"first":N,"trig":N,"tpu":N,"ovf":N,"end":0/1,"msgIdx":0,"dataLen":N}
+// Each record is 8 bytes little-endian:
+//   uint32 deltaTicks (cycle counter ticks since the previous record), uint16 addr, uint8 data, uint8 flags
+// Flags bits 0..5 are RD, WR, MREQ, IORQ, M1, WAIT, bit 6 marks the trigger record and bit 7 is set
+// when a bus socket decoded the cycle (data is then what was placed on the bus)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const int REC_LEN = 8;
+static const int NUM_FLAGS = 8;
+static const char* FLAG_NAMES[NUM_FLAGS] = { "rd", "wr", "mreq", "iorq", "m1", "wait", "trigger", "decoded" };
+
+struct CaptureRec
+{
+    uint64_t timeNs;
+    uint32_t addr;
+    uint32_t data;
+    uint32_t flags;
+};
+
+// Get an integer value from the frame header JSON
+static bool headerGetInt(const char* pJson, const char* key, long& value)
+{
+    char srchStr[50];
+    snprintf(srchStr, sizeof(srchStr), "\"%s\":", key);
+    const char* pVal = strstr(pJson, srchStr);
+    if (!pVal)
+        return false;
+    value = strtol(pVal + strlen(srchStr), NULL, 10);
+    return true;
+}
+
+// Parse frames into records
+static bool parseFrames(const std::vector<uint8_t>& inBuf, std::vector<CaptureRec>& recs,
+            long& trigIdx, long& overflows, bool& endSeen)
+{
+    uint64_t ticksAccum = 0;
+    size_t pos = 0;
+    long frameCount = 0;
+    while (pos < inBuf.size())
+    {
+        // Skip terminators between frames
+        if (inBuf[pos] == 0)
+        {
+            pos++;
+            continue;
+        }
+
+        // Header
+        const uint8_t* pNull = (const uint8_t*)memchr(inBuf.data() + pos, 0, inBuf.size() - pos);
+        if (!pNull)
+        {
+            fprintf(stderr, "Frame %ld header not terminated\n", frameCount);
+            return false;
+        }
+        const char* pJson = (const char*)inBuf.data() + pos;
+        long dataLen = 0, tpu = 1, first = 0, end = 0;
+        if ((strstr(pJson, "\"captureData\"") == NULL) || !headerGetInt(pJson, "dataLen", dataLen) ||
+                    !headerGetInt(pJson, "tpu", tpu) || !headerGetInt(pJson, "first", first))
+        {
+            fprintf(stderr, "Frame %ld header invalid %s\n", frameCount, pJson);
+            return false;
+        }
+        headerGetInt(pJson, "trig", trigIdx);
+        headerGetInt(pJson, "ovf", overflows);
+        if (headerGetInt(pJson, "end", end) && end)
+            endSeen = true;
+        if (tpu <= 0)
+            tpu = 1;
+        if (first != (long)recs.size())
+            fprintf(stderr, "Frame %ld first record %ld expected %zu\n", frameCount, first, recs.size());
+
+        // Records
+        pos = (pNull - inBuf.data()) + 1;
+        if ((dataLen % REC_LEN != 0) || (pos + dataLen > inBuf.size()))
+        {
+            fprintf(stderr, "Frame %ld data length %ld invalid\n", frameCount, dataLen);
+            return false;
+        }
+        for (long i = 0; i < dataLen; i += REC_LEN)
+        {
+            const uint8_t* pRec = inBuf.data() + pos + i;
+            ticksAccum += pRec[0] | (pRec[1] << 8) | (pRec[2] << 16) | ((uint32_t)pRec[3] << 24);
+            CaptureRec rec;
+            rec.timeNs = ticksAccum * 1000 / tpu;
+            rec.addr = pRec[4] | (pRec[5] << 8);
+            rec.data = pRec[6];
+            rec.flags = pRec[7];
+            recs.push_back(rec);
+        }
+        pos += dataLen;
+        frameCount++;
+    }
+    return true;
+}
+
+static void writeCsv(FILE* pOut, const std::vector<CaptureRec>& recs)
+{
+    fprintf(pOut, "idx,timeNs,addr,data");
+    for (int i = 0; i < NUM_FLAGS; i++)
+        fprintf(pOut, ",%s", FLAG_NAMES[i]);
+    fprintf(pOut, "\n");
+    for (size_t idx = 0; idx < recs.size(); idx++)
+    {
+        const CaptureRec& rec = recs[idx];
+        fprintf(pOut, "%zu,%llu,%04x,%02x", idx, (unsigned long long)rec.timeNs, rec.addr, rec.data);
+        for (int i = 0; i < NUM_FLAGS; i++)
+            fprintf(pOut, ",%d", (rec.flags >> i) & 1);
+        fprintf(pOut, "\n");
+    }
+}
+
+static void vcdBits(FILE* pOut, uint32_t val, int numBits, const char* id)
+{
+    fprintf(pOut, "b");
+    for (int i = numBits - 1; i >= 0; i--)
+        fprintf(pOut, "%c", ((val >> i) & 1) ? '1' : '0');
+    fprintf(pOut, " %s\n", id);
+}
+
+// Control lines are shown active high and inactive half way to the next cycle
+static void writeVcd(FILE* pOut, const std::vector<CaptureRec>& recs)
+{
+    static const uint64_t LAST_CYCLE_NS = 100;
+    fprintf(pOut, "$timescale 1ns $end\n$scope module busraider $end\n");
+    fprintf(pOut, "$var wire 16 A addr $end\n$var wire 8 D data $end\n");
+    for (int i = 0; i < NUM_FLAGS; i++)
+        fprintf(pOut, "$var wire 1 %c %s $end\n", 'a' + i, FLAG_NAMES[i]);
+    fprintf(pOut, "$upscope $end\n$enddefinitions $end\n");
+    fprintf(pOut, "#0\n$dumpvars\n");
+    vcdBits(pOut, 0, 16, "A");
+    vcdBits(pOut, 0, 8, "D");
+    for (int i = 0; i < NUM_FLAGS; i++)
+        fprintf(pOut, "0%c\n", 'a' + i);
+    fprintf(pOut, "$end\n");
+    for (size_t idx = 0; idx < recs.size(); idx++)
+    {
+        const CaptureRec& rec = recs[idx];
+        fprintf(pOut, "#%llu\n", (unsigned long long)rec.timeNs);
+        vcdBits(pOut, rec.addr, 16, "A");
+        vcdBits(pOut, rec.data, 8, "D");
+        for (int i = 0; i < NUM_FLAGS; i++)
+            fprintf(pOut, "%d%c\n", (rec.flags >> i) & 1, 'a' + i);
+        uint64_t endNs = (idx + 1 < recs.size()) ? (rec.timeNs + recs[idx + 1].timeNs) / 2 : rec.timeNs + LAST_CYCLE_NS;
+        if (endNs > rec.timeNs)
+        {
+            fprintf(pOut, "#%llu\n", (unsigned long long)endNs);
+            for (int i = 0; i < NUM_FLAGS; i++)
+                fprintf(pOut, "0%c\n", 'a' + i);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    bool useCsv = false;
+    const char* pInFile = NULL;
+    const char* pOutFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-csv") == 0)
+            useCsv = true;
+        else if (strcmp(argv[i], "-vcd") == 0)
+            useCsv = false;
+        else if (!pInFile)
+            pInFile = argv[i];
+        else
+            pOutFile = argv[i];
+    }
+    if (!pInFile || !pOutFile)
+    {
+        fprintf(stderr, "Usage: %s [-vcd|-csv] captureFile outFile\n", argv[0]);
+        return 2;
+    }
+
+    // Read input
+    FILE* pIn = fopen(pInFile, "rb");
+    if (!pIn)
+    {
+        fprintf(stderr, "Can't open %s\n", pInFile);
+        return 1;
+    }
+    std::vector<uint8_t> inBuf;
+    uint8_t readBuf[4096];
+    size_t readLen = 0;
+    while ((readLen = fread(readBuf, 1, sizeof(readBuf), pIn)) > 0)
+        inBuf.insert(inBuf.end(), readBuf, readBuf + readLen);
+    fclose(pIn);
+
+    // Decode
+    std::vector<CaptureRec> recs;
+    long trigIdx = -1;
+    long overflows = 0;
+    bool endSeen = false;
+    if (!parseFrames(inBuf, recs, trigIdx, overflows, endSeen))
+        return 1;
+
+    // Write output
+    FILE* pOut = fopen(pOutFile, "w");
+    if (!pOut)
+    {
+        fprintf(stderr, "Can't create %s\n", pOutFile);
+        return 1;
+    }
+    if (useCsv)
+        writeCsv(pOut, recs);
+    else
+        writeVcd(pOut, recs);
+    fclose(pOut);
+
+    printf("records %zu trigger %ld overflows %ld %s\n", recs.size(), trigIdx, overflows,
+                endSeen ? "complete" : "incomplete");
+    return 0;
+}
@@ -0,0 +1,265 @@
+// Bus Raider
+// Trace stream decoder - converts tracerStreamData frames from the Pi to CSV
+// Rob Dobson 2019
+
+// Input is the tracerStreamData frames (as received from the ESP32 after HDLC decoding) written
+// one after another. Each frame is a null terminated JSON header followed by dataLen bytes of
+// records and a further null terminator:
+//   {"cmdName":"tracerStreamData","seq":N,"first":N,"recs":N,"ovf":N,"msgIdx":0,"dataLen":N}
+// Each record is a header byte:
+//   bits 0..3 - RD, WR, IORQ, M1 (MREQ when IORQ is clear)
+//   bits 4..5 - address mode: 0 predicted PC + 1, 1 previous address + 1, 2 varint zigzag difference
+//               from the previous address, 3 varint zigzag difference from the predicted PC + 1
+//   bit 6     - retData (data supplied by a bus socket) follows the bus data
+//   bit 7     - bus data omitted as it is the same as retData
+// then the varint (7 bits per byte, least significant first), bus data and retData as present.
+// The predicted PC is the address of the last opcode fetch or of a memory read at the predicted
+// PC + 1. The previous address is kept separately for memory reads, memory writes and IO and is
+// updated by the cycles that don't update the predicted PC. All predictors start at 0xffff in each frame.
+// A header byte of 0 is a register checkpoint (28 bytes of registers, see Tools/TraceValidator) which
+// sets the predicted PC to the checkpoint's PC - 1. Checkpoints are counted but not written to the CSV.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static const uint32_t ADDR_PC_NEXT = 0;
+static const uint32_t ADDR_PREV_NEXT = 1;
+static const uint32_t ADDR_PREV_DELTA = 2;
+static const uint32_t FLAG_RD = 0x01;
+static const uint32_t FLAG_WR = 0x02;
+static const uint32_t FLAG_IORQ = 0x04;
+static const uint32_t FLAG_M1 = 0x08;
+static const uint32_t HDR_RET_DATA = 0x40;
+static const uint32_t HDR_BUS_DATA_OMITTED = 0x80;
+static const uint32_t HDR_CHECKPOINT = 0x00;
+static const long CHECKPOINT_REGS_LEN = 28;
+
+struct TraceRec
+{
+    uint32_t cycle;
+    uint32_t addr;
+    uint32_t busData;
+    uint32_t retData;
+    bool retDataValid;
+    uint32_t flags;
+};
+
+// Get an integer value from the frame header JSON
+static bool headerGetInt(const char* pJson, const char* key, long& value)
+{
+    char srchStr[50];
+    snprintf(srchStr, sizeof(srchStr), "\"%s\":", key);
+    const char* pVal = strstr(pJson, srchStr);
+    if (!pVal)
+        return false;
+    value = strtol(pVal + strlen(srchStr), NULL, 10);
+    return true;
+}
+
+// Decode the records in a frame
+static bool decodeFrame(const uint8_t* pData, long dataLen, long firstCycle, long numRecs,
+            std::vector<TraceRec>& recs, long& checkpoints)
+{
+    uint32_t prevAddrs[3] = { 0xffff, 0xffff, 0xffff };
+    uint32_t pcAddr = 0xffff;
+    long pos = 0;
+    long recIdx = 0;
+    while (pos < dataLen)
+    {
+        TraceRec rec;
+        uint32_t header = pData[pos++];
+        if (header == HDR_CHECKPOINT)
+        {
+            if (pos + CHECKPOINT_REGS_LEN > dataLen)
+                return false;
+            pcAddr = (pData[pos] + (pData[pos + 1] << 8) - 1) & 0xffff;
+            pos += CHECKPOINT_REGS_LEN;
+            checkpoints++;
+            continue;
+        }
+        uint32_t& prevAddr = prevAddrs[(header & FLAG_IORQ) ? 2 : ((header & FLAG_WR) ? 1 : 0)];
+        uint32_t pcNext = (pcAddr + 1) & 0xffff;
+        uint32_t addrMode = (header >> 4) & 0x03;
+        if (addrMode == ADDR_PC_NEXT)
+        {
+            rec.addr = pcNext;
+        }
+        else if (addrMode == ADDR_PREV_NEXT)
+        {
+            rec.addr = (prevAddr + 1) & 0xffff;
+        }
+        else
+        {
+            uint32_t val = 0;
+            for (int shift = 0; ; shift += 7)
+            {
+                if ((pos >= dataLen) || (shift > 14))
+                    return false;
+                uint32_t byteVal = pData[pos++];
+                val |= (byteVal & 0x7f) << shift;
+                if (!(byteVal & 0x80))
+                    break;
+            }
+            int32_t delta = (val & 1) ? -(int32_t)((val + 1) >> 1) : (int32_t)(val >> 1);
+            rec.addr = (((addrMode == ADDR_PREV_DELTA) ? prevAddr : pcNext) + delta) & 0xffff;
+        }
+        rec.retDataValid = (header & HDR_RET_DATA) != 0;
+        rec.busData = 0;
+        rec.retData = 0;
+        if (!(header & HDR_BUS_DATA_OMITTED))
+        {
+            if (pos >= dataLen)
+                return false;
+            rec.busData = pData[pos++];
+        }
+        if (rec.retDataValid)
+        {
+            if (pos >= dataLen)
+                return false;
+            rec.retData = pData[pos++];
+            if (header & HDR_BUS_DATA_OMITTED)
+                rec.busData = rec.retData;
+        }
+        rec.flags = header & 0x0f;
+        rec.cycle = firstCycle + recIdx;
+
+        // Predictors
+        if ((rec.flags & FLAG_M1) && !(rec.flags & FLAG_IORQ))
+            pcAddr = rec.addr;
+        else if ((rec.addr == pcNext) && (rec.flags & FLAG_RD) && !(rec.flags & FLAG_IORQ))
+            pcAddr = rec.addr;
+        else
+            prevAddr = rec.addr;
+        recs.push_back(rec);
+        recIdx++;
+    }
+    return recIdx == numRecs;
+}
+
+// Parse frames into records
+static bool parseFrames(const std::vector<uint8_t>& inBuf, std::vector<TraceRec>& recs,
+            long& frameCount, long& gapCycles, long& overflows, long& checkpoints)
+{
+    size_t pos = 0;
+    while (pos < inBuf.size())
+    {
+        // Skip terminators between frames
+        if (inBuf[pos] == 0)
+        {
+            pos++;
+            continue;
+        }
+
+        // Header
+        const uint8_t* pNull = (const uint8_t*)memchr(inBuf.data() + pos, 0, inBuf.size() - pos);
+        if (!pNull)
+        {
+            fprintf(stderr, "Frame %ld header not terminated\n", frameCount);
+            return false;
+        }
+        const char* pJson = (const char*)inBuf.data() + pos;
+        long dataLen = 0, first = 0, numRecs = 0;
+        if ((strstr(pJson, "\"tracerStreamData\"") == NULL) || !headerGetInt(pJson, "dataLen", dataLen) ||
+                    !headerGetInt(pJson, "first", first) || !headerGetInt(pJson, "recs", numRecs))
+        {
+            fprintf(stderr, "Frame %ld header invalid %s\n", frameCount, pJson);
+            return false;
+        }
+        headerGetInt(pJson, "ovf", overflows);
+        pos = (pNull - inBuf.data()) + 1;
+        if (pos + dataLen > inBuf.size())
+        {
+            fprintf(stderr, "Frame %ld data length %ld invalid\n", frameCount, dataLen);
+            return false;
+        }
+
+        // Cycles dropped before this frame
+        long nextCycle = recs.empty() ? 0 : recs.back().cycle + 1;
+        if (first > nextCycle)
+            gapCycles += first - nextCycle;
+
+        // Records
+        if (!decodeFrame(inBuf.data() + pos, dataLen, first, numRecs, recs, checkpoints))
+        {
+            fprintf(stderr, "Frame %ld records invalid\n", frameCount);
+            return false;
+        }
+        pos += dataLen;
+        frameCount++;
+    }
+    return true;
+}
+
+// Same layout as the reference written by the host simulation
+static void writeCsv(FILE* pOut, const std::vector<TraceRec>& recs)
+{
+    fprintf(pOut, "cycle,addr,data,retData,rd,wr,mreq,iorq,m1\n");
+    for (const TraceRec& rec : recs)
+    {
+        fprintf(pOut, "%u,%04x,%02x,", rec.cycle, rec.addr, rec.busData);
+        if (rec.retDataValid)
+            fprintf(pOut, "%02x", rec.retData);
+        fprintf(pOut, ",%d,%d,%d,%d,%d\n", (rec.flags & FLAG_RD) ? 1 : 0, (rec.flags & FLAG_WR) ? 1 : 0,
+                    (rec.flags & FLAG_IORQ) ? 0 : 1, (rec.flags & FLAG_IORQ) ? 1 : 0, (rec.flags & FLAG_M1) ? 1 : 0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* pInFile = NULL;
+    const char* pOutFile = NULL;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-csv") == 0)
+            continue;
+        else if (!pInFile)
+            pInFile = argv[i];
+        else
+            pOutFile = argv[i];
+    }
+    if (!pInFile || !pOutFile)
+    {
+        fprintf(stderr, "Usage: %s [-csv] traceFile outFile\n", argv[0]);
+        return 2;
+    }
+
+    // Read input
+    FILE* pIn = fopen(pInFile, "rb");
+    if (!pIn)
+    {
+        fprintf(stderr, "Can't open %s\n", pInFile);
+        return 1;
+    }
+    std::vector<uint8_t> inBuf;
+    uint8_t readBuf[4096];
+    size_t readLen = 0;
+    while ((readLen = fread(readBuf, 1, sizeof(readBuf), pIn)) > 0)
+        inBuf.insert(inBuf.end(), readBuf, readBuf + readLen);
+    fclose(pIn);
+
+    // Decode
+    std::vector<TraceRec> recs;
+    long frameCount = 0;
+    long gapCycles = 0;
+    long overflows = 0;
+    long checkpoints = 0;
+    if (!parseFrames(inBuf, recs, frameCount, gapCycles, overflows, checkpoints))
+        return 1;
+
+    // Write output
+    FILE* pOut = fopen(pOutFile, "w");
+    if (!pOut)
+    {
+        fprintf(stderr, "Can't create %s\n", pOutFile);
+        return 1;
+    }
+    writeCsv(pOut, recs);
+    fclose(pOut);
+
+    printf("cycles %zu frames %ld gapCycles %ld overflows %ld checkpoints %ld bytes %zu\n", recs.size(), frameCount,
+                gapCycles, overflows, checkpoints, inBuf.size());
+    return 0;
+}
@@ -0,0 +1,773 @@
+// Bus Raider
+// Trace validator - replays a streamed trace against the step tracer's Z80 model
+// Rob Dobson 2019
+
+// Input is the tracerStreamData frames (see Tools/TraceStreamDecoder) and optionally a 64K image of
+// target memory when the trace started. The trace is split into segments at its register checkpoints
+// (and the start if the trace starts at reset) and the segments are validated in parallel - each
+// runs libz80 from the segment's registers with the instructions' accesses put in bus order by the
+// step tracer's cycle model and compared with the recorded cycles.
+// Memory for each segment is the image updated with every memory cycle before it in the trace (a
+// quick sequential pass) and the emulated memory is kept in step with the trace as it runs, so
+// a difference shows at the cycle where it happens and doesn't carry on. IO reads return the data
+// recorded. After a divergence (or a gap where cycles were dropped) the rest of the segment is
+// skipped and validation continues from the next checkpoint.
+// Long traces are handled in batches so memory use is bounded. The segment open at the end of a batch
+// is carried into the next, except when a batch has no checkpoints where the open segment is validated
+// as far as the batch goes and carried on from there (in sequence) so records don't pile up.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include "StepTracer/libz80/z80.h"
+#include "StepTracer/Z80CycleModel.h"
+#include "TargetBus/TargetCPU.h"
+
+static const uint32_t FLAG_RD = 0x01;
+static const uint32_t FLAG_WR = 0x02;
+static const uint32_t FLAG_IORQ = 0x04;
+static const uint32_t FLAG_M1 = 0x08;
+static const uint32_t FLAG_GAP_BEFORE = 0x10;
+static const uint32_t ADDR_PC_NEXT = 0;
+static const uint32_t ADDR_PREV_NEXT = 1;
+static const uint32_t ADDR_PREV_DELTA = 2;
+static const uint32_t HDR_RET_DATA = 0x40;
+static const uint32_t HDR_BUS_DATA_OMITTED = 0x80;
+static const uint32_t HDR_CHECKPOINT = 0x00;
+static const long CHECKPOINT_REGS_LEN = 28;
+static const uint32_t MEM_LEN = 0x10000;
+
+// Cycles the opcode fetch at a checkpoint's PC may follow it by (the tracker's last injected cycle)
+static const size_t CHECKPOINT_SYNC_CYCLES = 8;
+
+// Cycles decoded per batch (default) and work units per thread (for balancing)
+static const size_t DEFAULT_BATCH_CYCLES = 16 * 1024 * 1024;
+static const size_t UNITS_PER_THREAD = 4;
+
+// Cycle - data is what the processor read or wrote (the data supplied by a bus socket if any)
+struct TraceRec
+{
+    uint32_t cycle;
+    uint16_t addr;
+    uint8_t data;
+    uint8_t flags;
+};
+
+// Register checkpoint - taken before the record at recIdx
+struct Checkpoint
+{
+    size_t recIdx;
+    uint8_t regs[CHECKPOINT_REGS_LEN];
+};
+
+// Segment - validated from a checkpoint (or reset) up to the next
+struct Segment
+{
+    size_t startIdx;
+    size_t endIdx;
+    bool fromReset;
+    bool hasCheckpoint;
+    Checkpoint checkpoint;
+};
+
+// Divergence from the model
+struct Divergence
+{
+    uint32_t cycle;
+    uint32_t instrAddr;
+    int cycleIdx;
+    TraceRec got;
+    Z80BusCycle expected;
+};
+
+// Frame in a batch
+struct FrameInfo
+{
+    size_t dataPos;
+    long dataLen;
+    long first;
+    long numRecs;
+    size_t recIdx;
+    std::vector<Checkpoint> checkpoints;
+    bool ok;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Decoding
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Get an integer value from the frame header JSON
+static bool headerGetInt(const char* pJson, const char* key, long& value)
+{
+    char srchStr[50];
+    snprintf(srchStr, sizeof(srchStr), "\"%s\":", key);
+    const char* pVal = strstr(pJson, srchStr);
+    if (!pVal)
+        return false;
+    value = strtol(pVal + strlen(srchStr), NULL, 10);
+    return true;
+}
+
+// Decode the records in a frame (frames decode independently so this runs in parallel)
+static bool decodeFrame(const uint8_t* pData, FrameInfo& frame, TraceRec* pRecs)
+{
+    uint32_t prevAddrs[3] = { 0xffff, 0xffff, 0xffff };
+    uint32_t pcAddr = 0xffff;
+    long pos = 0;
+    long recIdx = 0;
+    while (pos < frame.dataLen)
+    {
+        uint32_t header = pData[pos++];
+        if (header == HDR_CHECKPOINT)
+        {
+            if (pos + CHECKPOINT_REGS_LEN > frame.dataLen)
+                return false;
+            Checkpoint checkpoint;
+            checkpoint.recIdx = frame.recIdx + recIdx;
+            memcpy(checkpoint.regs, pData + pos, CHECKPOINT_REGS_LEN);
+            frame.checkpoints.push_back(checkpoint);
+            pcAddr = (pData[pos] + (pData[pos + 1] << 8) - 1) & 0xffff;
+            pos += CHECKPOINT_REGS_LEN;
+            continue;
+        }
+        if (recIdx >= frame.numRecs)
+            return false;
+        uint32_t& prevAddr = prevAddrs[(header & FLAG_IORQ) ? 2 : ((header & FLAG_WR) ? 1 : 0)];
+        uint32_t pcNext = (pcAddr + 1) & 0xffff;
+        uint32_t addrMode = (header >> 4) & 0x03;
+        uint32_t addr = 0;
+        if (addrMode == ADDR_PC_NEXT)
+        {
+            addr = pcNext;
+        }
+        else if (addrMode == ADDR_PREV_NEXT)
+        {
+            addr = (prevAddr + 1) & 0xffff;
+        }
+        else
+        {
+            uint32_t val = 0;
+            for (int shift = 0; ; shift += 7)
+            {
+                if ((pos >= frame.dataLen) || (shift > 14))
+                    return false;
+                uint32_t byteVal = pData[pos++];
+                val |= (byteVal & 0x7f) << shift;
+                if (!(byteVal & 0x80))
+                    break;
+            }
+            int32_t delta = (val & 1) ? -(int32_t)((val + 1) >> 1) : (int32_t)(val >> 1);
+            addr = (((addrMode == ADDR_PREV_DELTA) ? prevAddr : pcNext) + delta) & 0xffff;
+        }
+        uint32_t data = 0;
+        if (!(header & HDR_BUS_DATA_OMITTED))
+        {
+            if (pos >= frame.dataLen)
+                return false;
+            data = pData[pos++];
+        }
+        if (header & HDR_RET_DATA)
+        {
+            if (pos >= frame.dataLen)
+                return false;
+            data = pData[pos++];
+        }
+        TraceRec& rec = pRecs[frame.recIdx + recIdx];
+        rec.cycle = frame.first + recIdx;
+        rec.addr = addr;
+        rec.data = data;
+        rec.flags = header & 0x0f;
+
+        // Predictors
+        if ((rec.flags & FLAG_M1) && !(rec.flags & FLAG_IORQ))
+            pcAddr = addr;
+        else if ((addr == pcNext) && (rec.flags & FLAG_RD) && !(rec.flags & FLAG_IORQ))
+            pcAddr = addr;
+        else
+            prevAddr = addr;
+        recIdx++;
+    }
+    return recIdx == frame.numRecs;
+}
+
+// Read the frames of a batch - returns false at the end of the file
+static bool readBatch(FILE* pIn, size_t batchCycles, std::vector<uint8_t>& batchData, std::vector<FrameInfo>& frames, size_t& numRecs)
+{
+    batchData.clear();
+    frames.clear();
+    numRecs = 0;
+    while (numRecs < batchCycles)
+    {
+        // Header (skipping terminators between frames)
+        int ch = 0;
+        while ((ch = fgetc(pIn)) == 0)
+            ;
+        if (ch == EOF)
+            break;
+        std::vector<char> header;
+        while ((ch != EOF) && (ch != 0))
+        {
+            header.push_back(ch);
+            ch = fgetc(pIn);
+        }
+        header.push_back(0);
+        FrameInfo frame;
+        frame.dataLen = 0;
+        frame.ok = false;
+        if ((strstr(header.data(), "\"tracerStreamData\"") == NULL) || !headerGetInt(header.data(), "dataLen", frame.dataLen) ||
+                    !headerGetInt(header.data(), "first", frame.first) || !headerGetInt(header.data(), "recs", frame.numRecs))
+        {
+            fprintf(stderr, "Frame header invalid %s\n", header.data());
+            continue;
+        }
+
+        // Data
+        frame.dataPos = batchData.size();
+        batchData.resize(frame.dataPos + frame.dataLen);
+        if (fread(batchData.data() + frame.dataPos, 1, frame.dataLen, pIn) != (size_t)frame.dataLen)
+        {
+            fprintf(stderr, "Frame data truncated\n");
+            batchData.resize(frame.dataPos);
+            break;
+        }
+        frame.recIdx = numRecs;
+        numRecs += frame.numRecs;
+        frames.push_back(frame);
+    }
+    return !frames.empty();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Validation
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Trace flags for the model's bus flags
+static uint32_t traceFlags(uint32_t busFlags)
+{
+    return ((busFlags & BR_CTRL_BUS_RD_MASK) ? FLAG_RD : 0) | ((busFlags & BR_CTRL_BUS_WR_MASK) ? FLAG_WR : 0) |
+            ((busFlags & BR_CTRL_BUS_IORQ_MASK) ? FLAG_IORQ : 0) | ((busFlags & BR_CTRL_BUS_M1_MASK) ? FLAG_M1 : 0);
+}
+
+class Validator
+{
+public:
+    Validator(const std::vector<TraceRec>& recs) : _recs(recs)
+    {
+        instrCount = 0;
+        cyclesValidated = 0;
+        segmentsDiverged = 0;
+        segmentsSkipped = 0;
+        _segStopped = false;
+    }
+
+    // Validate a segment - memory must be as it was at the start of the segment and is left as at the end
+    void validateSegment(const Segment& seg, uint8_t* pMem);
+
+    // Validate the instructions of a segment starting before endIdx - with resume set validation carries
+    // on from the previous call with the records from there now starting at seg.startIdx - returns the
+    // index reached (memory is left as there)
+    size_t validateSegmentPart(const Segment& seg, size_t endIdx, bool resume, uint8_t* pMem);
+
+    // Results
+    std::vector<Divergence> divergences;
+    uint64_t instrCount;
+    uint64_t cyclesValidated;
+    uint32_t segmentsDiverged;
+    uint32_t segmentsSkipped;
+
+    // Keep memory in step with the trace
+    static void applyTraceMem(const std::vector<TraceRec>& recs, size_t startIdx, size_t endIdx, uint8_t* pMem)
+    {
+        for (size_t i = startIdx; i < endIdx; i++)
+            if (!(recs[i].flags & FLAG_IORQ))
+                pMem[recs[i].addr] = recs[i].data;
+    }
+
+private:
+    const std::vector<TraceRec>& _recs;
+    uint8_t* _pMem;
+    Z80Context _ctx;
+
+    // Validation of the segment stopped (diverged, cycles dropped or nothing to start from)
+    bool _segStopped;
+
+    // Accesses made by libz80 for an instruction
+    Z80BusCycle _accesses[Z80CycleModel::MAX_ACCESSES];
+    int _numAccesses;
+    size_t _ioPos;
+    size_t _ioEnd;
+    void addAccess(uint32_t addr, uint32_t data, uint32_t flags)
+    {
+        if (_numAccesses >= Z80CycleModel::MAX_ACCESSES)
+            return;
+        _accesses[_numAccesses].addr = addr;
+        _accesses[_numAccesses].data = data;
+        _accesses[_numAccesses].flags = flags;
+        _numAccesses++;
+    }
+
+    // libz80 callbacks - each thread has its own validator
+    static thread_local Validator* _pThisValidator;
+    static byte memRead(int param, ushort address);
+    static void memWrite(int param, ushort address, byte data);
+    static byte ioRead(int param, ushort address);
+    static void ioWrite(int param, ushort address, byte data);
+
+    // Set registers from a checkpoint
+    void setRegs(const Checkpoint& checkpoint);
+
+    // Run and compare instructions starting before endIdx - returns the index reached
+    size_t validateInstrs(size_t pos, size_t endIdx, bool atSegStart);
+};
+
+thread_local Validator* Validator::_pThisValidator = NULL;
+
+byte Validator::memRead([[maybe_unused]] int param, ushort address)
+{
+    Validator* pV = _pThisValidator;
+    uint32_t val = pV->_pMem[address];
+    pV->addAccess(address, val, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_RD_MASK | (pV->_ctx.M1 ? BR_CTRL_BUS_M1_MASK : 0));
+    return val;
+}
+
+void Validator::memWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    Validator* pV = _pThisValidator;
+    pV->addAccess(address, data, BR_CTRL_BUS_MREQ_MASK | BR_CTRL_BUS_WR_MASK);
+    pV->_pMem[address] = data;
+}
+
+// IO reads return the data of the next IO read recorded for the instruction
+byte Validator::ioRead([[maybe_unused]] int param, ushort address)
+{
+    Validator* pV = _pThisValidator;
+    uint32_t val = 0xff;
+    for (; pV->_ioPos < pV->_ioEnd; pV->_ioPos++)
+    {
+        const TraceRec& rec = pV->_recs[pV->_ioPos];
+        if ((rec.flags & FLAG_IORQ) && (rec.flags & FLAG_RD) && !(rec.flags & FLAG_M1))
+        {
+            val = rec.data;
+            pV->_ioPos++;
+            break;
+        }
+    }
+    pV->addAccess(address, val, BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_RD_MASK);
+    return val;
+}
+
+void Validator::ioWrite([[maybe_unused]] int param, ushort address, byte data)
+{
+    _pThisValidator->addAccess(address, data, BR_CTRL_BUS_IORQ_MASK | BR_CTRL_BUS_WR_MASK);
+}
+
+void Validator::setRegs(const Checkpoint& checkpoint)
+{
+    const uint8_t* pRegs = checkpoint.regs;
+    uint16_t words[12];
+    for (int i = 0; i < 12; i++)
+        words[i] = pRegs[i * 2] | (pRegs[i * 2 + 1] << 8);
+    _ctx.PC = words[0];
+    _ctx.R1.wr.SP = words[1];
+    _ctx.R1.wr.AF = words[2];
+    _ctx.R1.wr.BC = words[3];
+    _ctx.R1.wr.DE = words[4];
+    _ctx.R1.wr.HL = words[5];
+    _ctx.R1.wr.IX = words[6];
+    _ctx.R1.wr.IY = words[7];
+    _ctx.R2.wr.AF = words[8];
+    _ctx.R2.wr.BC = words[9];
+    _ctx.R2.wr.DE = words[10];
+    _ctx.R2.wr.HL = words[11];
+    _ctx.I = pRegs[24];
+    _ctx.R = pRegs[25];
+    _ctx.IM = pRegs[26];
+    _ctx.IFF1 = _ctx.IFF2 = pRegs[27] ? 1 : 0;
+}
+
+void Validator::validateSegment(const Segment& seg, uint8_t* pMem)
+{
+    size_t pos = validateSegmentPart(seg, seg.endIdx, false, pMem);
+
+    // Rest of the segment
+    if (pos < seg.endIdx)
+        applyTraceMem(_recs, pos, seg.endIdx, pMem);
+}
+
+size_t Validator::validateSegmentPart(const Segment& seg, size_t endIdx, bool resume, uint8_t* pMem)
+{
+    _pThisValidator = this;
+    _pMem = pMem;
+    if (resume)
+        return _segStopped ? seg.startIdx : validateInstrs(seg.startIdx, endIdx, false);
+    _segStopped = false;
+    memset(&_ctx, 0, sizeof(_ctx));
+    Z80RESET(&_ctx);
+    _ctx.memRead = memRead;
+    _ctx.memWrite = memWrite;
+    _ctx.ioRead = ioRead;
+    _ctx.ioWrite = ioWrite;
+
+    // Start from reset or at the first opcode fetch from the checkpoint's PC
+    size_t pos = seg.startIdx;
+    bool canValidate = seg.fromReset || seg.hasCheckpoint;
+    if (seg.hasCheckpoint)
+    {
+        setRegs(seg.checkpoint);
+        size_t syncEnd = std::min(seg.startIdx + CHECKPOINT_SYNC_CYCLES, seg.endIdx);
+        while ((pos < syncEnd) && !((_recs[pos].flags & FLAG_M1) && !(_recs[pos].flags & FLAG_IORQ) && (_recs[pos].addr == _ctx.PC)))
+            pos++;
+        canValidate = pos < syncEnd;
+        if (!canValidate)
+            pos = seg.startIdx;
+    }
+    if (!canValidate)
+    {
+        segmentsSkipped++;
+        _segStopped = true;
+        return seg.startIdx;
+    }
+    applyTraceMem(_recs, seg.startIdx, pos, pMem);
+    return validateInstrs(pos, endIdx, pos == seg.startIdx);
+}
+
+size_t Validator::validateInstrs(size_t pos, size_t endIdx, bool atSegStart)
+{
+    size_t startPos = pos;
+    while (pos < endIdx)
+    {
+        // Can't continue over dropped cycles
+        if (!(atSegStart && (pos == startPos)) && (_recs[pos].flags & FLAG_GAP_BEFORE))
+        {
+            segmentsSkipped++;
+            _segStopped = true;
+            break;
+        }
+
+        // Run the model
+        _numAccesses = 0;
+        _ioPos = pos;
+        _ioEnd = std::min(pos + Z80CycleModel::MAX_ACCESSES, _recs.size());
+        uint32_t instrAddr = _ctx.PC;
+        Z80Execute(&_ctx);
+        Z80BusCycle cycles[Z80CycleModel::MAX_ACCESSES];
+        Z80CycleModel::orderCycles(_accesses, _numAccesses, cycles);
+
+        // The trace ends mid instruction
+        if (pos + _numAccesses > _recs.size())
+            break;
+
+        // Compare
+        int divergeIdx = -1;
+        for (int i = 0; i < _numAccesses; i++)
+        {
+            const TraceRec& rec = _recs[pos + i];
+            if ((rec.addr != cycles[i].addr) || (rec.data != (cycles[i].data & 0xff)) ||
+                        ((rec.flags & 0x0f) != traceFlags(cycles[i].flags)))
+            {
+                divergeIdx = i;
+                break;
+            }
+        }
+        if (divergeIdx >= 0)
+        {
+            Divergence divergence;
+            divergence.cycle = _recs[pos + divergeIdx].cycle;
+            divergence.instrAddr = instrAddr;
+            divergence.cycleIdx = divergeIdx;
+            divergence.got = _recs[pos + divergeIdx];
+            divergence.expected = cycles[divergeIdx];
+            divergences.push_back(divergence);
+            segmentsDiverged++;
+            _segStopped = true;
+            break;
+        }
+
+        // Keep memory as the trace shows it
+        applyTraceMem(_recs, pos, pos + _numAccesses, _pMem);
+        cyclesValidated += _numAccesses;
+        instrCount++;
+        pos += _numAccesses;
+    }
+    return pos;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Main
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* flagsStr(uint32_t flags, char* pStr)
+{
+    pStr[0] = (flags & FLAG_RD) ? 'R' : '-';
+    pStr[1] = (flags & FLAG_WR) ? 'W' : '-';
+    pStr[2] = (flags & FLAG_IORQ) ? 'I' : 'M';
+    pStr[3] = (flags & FLAG_M1) ? '1' : '-';
+    pStr[4] = 0;
+    return pStr;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* pInFile = NULL;
+    const char* pMemFile = NULL;
+    int numThreads = std::thread::hardware_concurrency();
+    long maxReport = 20;
+    size_t batchCycles = DEFAULT_BATCH_CYCLES;
+    bool argsOk = true;
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+            numThreads = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-max") == 0) && (i + 1 < argc))
+            maxReport = atol(argv[++i]);
+        else if ((strcmp(argv[i], "-mem") == 0) && (i + 1 < argc))
+            pMemFile = argv[++i];
+        else if ((strcmp(argv[i], "-batch") == 0) && (i + 1 < argc))
+            batchCycles = strtoul(argv[++i], NULL, 10);
+        else if (!pInFile && (argv[i][0] != '-'))
+            pInFile = argv[i];
+        else
+            argsOk = false;
+    }
+    if (!pInFile || !argsOk)
+    {
+        fprintf(stderr, "Usage: %s [-j threads] [-max reportCount] [-mem memImage] [-batch cycles] traceFile\n", argv[0]);
+        return 2;
+    }
+    if (numThreads < 1)
+        numThreads = 1;
+    if (batchCycles < 1)
+        batchCycles = 1;
+
+    // Memory at the start of the trace
+    std::vector<uint8_t> batchMem(MEM_LEN, 0);
+    if (pMemFile)
+    {
+        FILE* pMem = fopen(pMemFile, "rb");
+        if (!pMem)
+        {
+            fprintf(stderr, "Can't open %s\n", pMemFile);
+            return 1;
+        }
+        size_t memLen = fread(batchMem.data(), 1, MEM_LEN, pMem);
+        fclose(pMem);
+        if (memLen != MEM_LEN)
+            fprintf(stderr, "Memory image is %zu bytes - the rest is zero\n", memLen);
+    }
+    FILE* pIn = fopen(pInFile, "rb");
+    if (!pIn)
+    {
+        fprintf(stderr, "Can't open %s\n", pInFile);
+        return 1;
+    }
+
+    // Segment carried between batches (records from its start are kept) and the validator for it when
+    // it is validated as it goes (batches without checkpoints)
+    std::vector<TraceRec> recs;
+    Segment openSeg;
+    memset(&openSeg, 0, sizeof(openSeg));
+    Validator* pOpenValidator = NULL;
+    bool firstBatch = true;
+    long nextCycle = 0;
+    uint64_t totalCycles = 0;
+    uint64_t gapCycles = 0;
+    uint32_t totalCheckpoints = 0;
+    uint32_t totalSegments = 0;
+    uint64_t totalInstrs = 0;
+    uint64_t totalValidated = 0;
+    uint32_t totalDiverged = 0;
+    uint32_t totalSkipped = 0;
+    std::vector<Divergence> divergences;
+    std::vector<uint8_t> batchData;
+    std::vector<FrameInfo> frames;
+    auto startTime = std::chrono::steady_clock::now();
+    bool moreData = true;
+    while (moreData)
+    {
+        size_t batchRecs = 0;
+        moreData = readBatch(pIn, batchCycles, batchData, frames, batchRecs);
+        if (!moreData && (recs.empty()))
+            break;
+
+        // Decode frames in parallel after the records carried over
+        size_t carryLen = recs.size();
+        recs.resize(carryLen + batchRecs);
+        for (FrameInfo& frame : frames)
+            frame.recIdx += carryLen;
+        std::atomic<size_t> nextFrame(0);
+        auto decodeWorker = [&]() {
+            for (size_t i = nextFrame++; i < frames.size(); i = nextFrame++)
+                frames[i].ok = decodeFrame(batchData.data() + frames[i].dataPos, frames[i], recs.data());
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; i++)
+            threads.emplace_back(decodeWorker);
+        for (std::thread& thread : threads)
+            thread.join();
+        threads.clear();
+
+        // Gaps and checkpoints
+        std::vector<Segment> segs;
+        if (firstBatch && !frames.empty())
+            openSeg.fromReset = (frames[0].first == 0);
+        for (FrameInfo& frame : frames)
+        {
+            if (!frame.ok)
+            {
+                fprintf(stderr, "Frame at cycle %ld records invalid\n", frame.first);
+                return 1;
+            }
+            if ((frame.first != nextCycle) && (frame.numRecs > 0))
+            {
+                if (frame.first > nextCycle)
+                    gapCycles += frame.first - nextCycle;
+                recs[frame.recIdx].flags |= FLAG_GAP_BEFORE;
+            }
+            nextCycle = frame.first + frame.numRecs;
+            for (const Checkpoint& checkpoint : frame.checkpoints)
+            {
+                openSeg.endIdx = checkpoint.recIdx;
+                segs.push_back(openSeg);
+                openSeg.startIdx = checkpoint.recIdx;
+                openSeg.fromReset = false;
+                openSeg.hasCheckpoint = true;
+                openSeg.checkpoint = checkpoint;
+                totalCheckpoints++;
+            }
+        }
+        firstBatch = false;
+        totalCycles += batchRecs;
+
+        // The last segment is closed at the end of the trace
+        if (!moreData)
+        {
+            openSeg.endIdx = recs.size();
+            segs.push_back(openSeg);
+        }
+
+        // Without a checkpoint in the batch the open segment would carry all of its records on - validate
+        // it as far as instructions are sure to be complete and carry on from there in the next batch
+        if (segs.empty())
+        {
+            fprintf(stderr, "No checkpoints in the %zu cycles from cycle %ld - validating in sequence\n",
+                        batchRecs, frames.empty() ? 0 : frames[0].first);
+            openSeg.endIdx = recs.size();
+            size_t partEndIdx = (recs.size() > Z80CycleModel::MAX_ACCESSES) ? recs.size() - Z80CycleModel::MAX_ACCESSES : 0;
+            bool resume = pOpenValidator != NULL;
+            if (!pOpenValidator)
+                pOpenValidator = new Validator(recs);
+            size_t pos = pOpenValidator->validateSegmentPart(openSeg, partEndIdx, resume, batchMem.data());
+            if (pos < partEndIdx)
+                Validator::applyTraceMem(recs, pos, partEndIdx, batchMem.data());
+            recs.erase(recs.begin(), recs.begin() + std::max(pos, partEndIdx));
+            openSeg.startIdx = 0;
+            openSeg.checkpoint.recIdx = 0;
+            continue;
+        }
+
+        // The segment validated as it went ends at the first checkpoint (or the end of the trace)
+        size_t memIdx = 0;
+        if (pOpenValidator)
+        {
+            Segment& seg = segs.front();
+            size_t pos = pOpenValidator->validateSegmentPart(seg, seg.endIdx, true, batchMem.data());
+            if (pos < seg.endIdx)
+                Validator::applyTraceMem(recs, pos, seg.endIdx, batchMem.data());
+            memIdx = std::max(pos, seg.endIdx);
+            divergences.insert(divergences.end(), pOpenValidator->divergences.begin(), pOpenValidator->divergences.end());
+            totalInstrs += pOpenValidator->instrCount;
+            totalValidated += pOpenValidator->cyclesValidated;
+            totalDiverged += pOpenValidator->segmentsDiverged;
+            totalSkipped += pOpenValidator->segmentsSkipped;
+            delete pOpenValidator;
+            pOpenValidator = NULL;
+            segs.erase(segs.begin());
+            totalSegments++;
+        }
+        segs.erase(std::remove_if(segs.begin(), segs.end(), [](const Segment& seg) { return seg.endIdx <= seg.startIdx; }), segs.end());
+        totalSegments += segs.size();
+
+        // Work units of consecutive segments with the memory at their start from a pass over the records
+        size_t numUnits = std::min(segs.size(), (size_t)numThreads * UNITS_PER_THREAD);
+        std::vector<size_t> unitFirstSeg;
+        std::vector<std::vector<uint8_t>> unitMem;
+        size_t segsEndIdx = segs.empty() ? memIdx : segs.back().endIdx;
+        for (size_t unit = 0; unit < numUnits; unit++)
+        {
+            size_t targetIdx = (segsEndIdx * unit) / numUnits;
+            size_t segIdx = unitFirstSeg.empty() ? 0 : unitFirstSeg.back() + 1;
+            while ((segIdx + 1 < segs.size()) && (segs[segIdx].endIdx <= targetIdx))
+                segIdx++;
+            if (segIdx >= segs.size())
+                break;
+            Validator::applyTraceMem(recs, memIdx, segs[segIdx].startIdx, batchMem.data());
+            memIdx = segs[segIdx].startIdx;
+            unitFirstSeg.push_back(segIdx);
+            unitMem.push_back(batchMem);
+        }
+        Validator::applyTraceMem(recs, memIdx, segsEndIdx, batchMem.data());
+
+        // Validate units in parallel
+        std::vector<Validator*> validators;
+        for (size_t unit = 0; unit < unitFirstSeg.size(); unit++)
+            validators.push_back(new Validator(recs));
+        std::atomic<size_t> nextUnit(0);
+        auto validateWorker = [&]() {
+            for (size_t unit = nextUnit++; unit < unitFirstSeg.size(); unit = nextUnit++)
+            {
+                size_t lastSeg = (unit + 1 < unitFirstSeg.size()) ? unitFirstSeg[unit + 1] : segs.size();
+                for (size_t segIdx = unitFirstSeg[unit]; segIdx < lastSeg; segIdx++)
+                    validators[unit]->validateSegment(segs[segIdx], unitMem[unit].data());
+            }
+        };
+        for (int i = 0; i < numThreads; i++)
+            threads.emplace_back(validateWorker);
+        for (std::thread& thread : threads)
+            thread.join();
+        for (Validator* pValidator : validators)
+        {
+            divergences.insert(divergences.end(), pValidator->divergences.begin(), pValidator->divergences.end());
+            totalInstrs += pValidator->instrCount;
+            totalValidated += pValidator->cyclesValidated;
+            totalDiverged += pValidator->segmentsDiverged;
+            totalSkipped += pValidator->segmentsSkipped;
+            delete pValidator;
+        }
+
+        // Carry the open segment's records into the next batch
+        if (moreData)
+        {
+            recs.erase(recs.begin(), recs.begin() + openSeg.startIdx);
+            openSeg.startIdx = 0;
+            openSeg.checkpoint.recIdx = 0;
+        }
+        else
+        {
+            recs.clear();
+        }
+    }
+    fclose(pIn);
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    // Report
+    std::sort(divergences.begin(), divergences.end(), [](const Divergence& a, const Divergence& b) { return a.cycle < b.cycle; });
+    for (size_t i = 0; (i < divergences.size()) && ((long)i < maxReport); i++)
+    {
+        const Divergence& div = divergences[i];
+        char gotFlags[5], expFlags[5];
+        printf("cycle %u instr %04x cycle %d got %04x %02x %s exp %04x %02x %s\n", div.cycle, div.instrAddr,
+                    div.cycleIdx, div.got.addr, div.got.data, flagsStr(div.got.flags, gotFlags),
+                    div.expected.addr, div.expected.data & 0xff, flagsStr(traceFlags(div.expected.flags), expFlags));
+    }
+    printf("cycles %llu gapCycles %llu checkpoints %u segments %u instrs %llu validated %llu diverged %u skipped %u threads %d ms %lld\n",
+                (unsigned long long)totalCycles, (unsigned long long)gapCycles, totalCheckpoints, totalSegments,
+                (unsigned long long)totalInstrs, (unsigned long long)totalValidated, totalDiverged, totalSkipped,
+                numThreads, (long long)elapsedMs);
+    return divergences.empty() ? 0 : 1;
+}